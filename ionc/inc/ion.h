@@ -20,6 +20,7 @@
 #define ION_H_
 
 #include "ion_types.h"  // ion_types.h includes ion_errors.h
+#include "ion_allocator.h"
 #include "ion_string.h"
 #include "ion_timestamp.h"
 #include "ion_decimal.h"
@@ -30,6 +31,9 @@
 #include "ion_reader.h"
 #include "ion_writer.h"
 #include "ion_catalog.h"
+#include "ion_extractor.h"
+#include "ion_offset_index.h"
+#include "ion_parallel.h"
 #include "ion_debug.h"
 
 #endif
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2009-2016 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at:
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#ifndef ION_ALLOCATOR_H_
+#define ION_ALLOCATOR_H_
+
+#include <stddef.h>
+#include "ion_types.h"
+#include "ion_platform_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Where Ion gets its memory. By default this is malloc and free, and the
+ *  blocks readers, writers, catalogs and symbol tables allocate in (see
+ *  ion_alloc.h) come from the shared page pool.
+ *
+ *  An allocator can be made the default for everything with
+ *  ion_allocator_set_default, or given to a single reader or writer (and the
+ *  streams it opens for itself) through its options. The allocator has to
+ *  outlive everything allocated with it.
+ *
+ */
+struct _ion_allocator
+{
+    /** Returns size bytes, or NULL if there's no memory
+     *
+     */
+    void *(*alloc)(void *context, size_t size);
+
+    /** Frees memory returned by alloc or realloc
+     *
+     */
+    void  (*free)(void *context, void *ptr);
+
+    /** Optional. Resizes memory returned by alloc, keeping its contents. If
+     *  this is NULL Ion allocates, copies and frees instead
+     *
+     */
+    void *(*realloc)(void *context, void *ptr, size_t old_size, size_t new_size);
+
+    /** Optional, with free_block. Allocates the blocks an owner's memory is
+     *  carved out of, instead of alloc (or the page pool). owner is the owner
+     *  the block is for, NULL for the block that holds the owner itself. This
+     *  is the place for an arena per owner, or hugepage backed blocks
+     *
+     */
+    void *(*alloc_block)(void *context, void *owner, size_t size);
+
+    /** Frees a block from alloc_block, owner is as it was when it was allocated
+     *
+     */
+    void  (*free_block)(void *context, void *owner, void *block);
+
+    /** Passed to each of the functions above
+     *
+     */
+    void  *context;
+};
+
+/** Makes allocator the default for all of Ion, or restores malloc and free
+ *  if it's NULL. This has to be done before Ion allocates anything, or after
+ *  ion_release_page_pool once everything has been closed, and fails with
+ *  IERR_INVALID_STATE while the page pool is in use.
+ *
+ */
+ION_API_EXPORT iERR           ion_allocator_set_default (ION_ALLOCATOR *allocator);
+
+/** Returns the allocator set with ion_allocator_set_default, NULL for the
+ *  built in malloc and free
+ *
+ */
+ION_API_EXPORT ION_ALLOCATOR *ion_allocator_get_default (void);
+
+/** Counts of the blocks Ion's memory is allocated in, for all of Ion (see
+ *  ion_alloc_stats_get) or for one reader, writer, catalog or symbol table
+ *  (see ion_reader_get_alloc_stats and the like). Nothing is counted until
+ *  ion_alloc_stats_enable is called, and only owners created after that are
+ *  counted on their own.
+ *
+ */
+struct _ion_alloc_stats
+{
+    int64_t bytes;          // in the blocks held now
+    int64_t peak_bytes;     // the most bytes has been
+    int64_t blocks;         // held now
+    int64_t owners;         // readers, writers, temporary pools etc the blocks belong to
+    int64_t total_bytes;    // in every block allocated, including those since freed
+    int64_t total_blocks;
+    int64_t pool_hits;      // page size blocks the page pool had free
+    int64_t pool_misses;    // page size blocks the page pool had to allocate
+};
+
+/** Turns the allocation statistics on or off. Counting costs a few adds per
+ *  block, which is a page (4K by default) or more
+ *
+ */
+ION_API_EXPORT void           ion_alloc_stats_enable    (BOOL enable);
+
+/** Returns the statistics for all of Ion since they were enabled
+ *
+ */
+ION_API_EXPORT iERR           ion_alloc_stats_get       (ION_ALLOC_STATS *p_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ION_ALLOCATOR_H_ */
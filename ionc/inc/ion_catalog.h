@@ -31,6 +31,7 @@ ION_API_EXPORT iERR ion_catalog_add_symbol_table          (hCATALOG hcatalog, hS
 ION_API_EXPORT iERR ion_catalog_find_symbol_table         (hCATALOG hcatalog, iSTRING name, long version, hSYMTAB *p_symtab);
 ION_API_EXPORT iERR ion_catalog_find_best_match           (hCATALOG hcatalog, iSTRING name, long version, hSYMTAB *p_symtab); // or newest version of a symtab pass in version == 0
 ION_API_EXPORT iERR ion_catalog_release_symbol_table      (hCATALOG hcatalog, hSYMTAB symtab);
+ION_API_EXPORT iERR ion_catalog_get_alloc_stats           (hCATALOG hcatalog, ION_ALLOC_STATS *p_stats); // memory held by the catalog's owner, see ion_alloc_stats_get
 ION_API_EXPORT iERR ion_catalog_close                     (hCATALOG hcatalog);
 
 #ifdef __cplusplus
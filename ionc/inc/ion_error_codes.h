@@ -88,6 +88,8 @@
     ERROR_CODE( IERR_NEW_LINE_IN_STRING,        51 )
     ERROR_CODE( IERR_INVALID_LEADING_ZEROS,     52 )
     ERROR_CODE( IERR_INVALID_LOB_TERMINATOR,    53 )
+    ERROR_CODE( IERR_TOO_MANY_PATHS,            54 )
+    ERROR_CODE( IERR_NOT_AN_OFFSET_INDEX,       55 )
 
 
 // if it was defined we undefine it now
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2009-2016 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at:
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#ifndef ION_EXTRACTOR_H_
+#define ION_EXTRACTOR_H_
+
+#include "ion_types.h"
+#include "ion_platform_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** An extractor finds the values at a set of paths in a stream and hands
+ *  each one to a callback, stepping the reader in and out of containers
+ *  itself. It only steps into containers on some path, so the rest are
+ *  skipped without being decoded: by length in binary and by the scanner
+ *  in text.
+ *
+ *  A path is a series of steps down from a top level value:
+ *
+ *      name    the field of a struct with that name
+ *      *       any field of a struct
+ *      [n]     the value at index n (from 0) of a list or s-expression
+ *      [*]     any value of a list or s-expression
+ *
+ *  Field names after the first are preceded by a '.', as in
+ *  "order.items[*].sku", and can't contain '.', '[' or ']'. The empty path
+ *  matches each top level value.
+ *
+ */
+
+#define ION_EXTRACTOR_MAX_PATHS  64
+
+/** Called with the reader on a value at the end of a path, with the path's
+ *  id from ion_extractor_add_path and the context given with it. The callback
+ *  can read the value and step into it, as long as it steps back out (and
+ *  doesn't step into a value that's also on a longer path), but it mustn't
+ *  move the reader on with ion_reader_next. An error it returns stops
+ *  ion_extractor_match, which returns it.
+ *
+ */
+typedef iERR (*ION_EXTRACTOR_CALLBACK)(hREADER hreader, int32_t path_id, void *context);
+
+ION_API_EXPORT iERR ion_extractor_open      (hEXTRACTOR *p_hextractor);
+
+/** Compiles path and adds it to the extractor. Fails with IERR_INVALID_SYNTAX
+ *  if it isn't a valid path, or IERR_TOO_MANY_PATHS if the extractor already
+ *  has ION_EXTRACTOR_MAX_PATHS.
+ *  @param   hextractor
+ *  @param   path          NUL terminated path expression, see above.
+ *  @param   fn_callback   Called for each value the path matches.
+ *  @param   context       Passed to fn_callback.
+ *  @param   p_path_id     Optional, set to the id fn_callback gets for the path,
+ *                         which is the number of paths added before it.
+ */
+ION_API_EXPORT iERR ion_extractor_add_path  (hEXTRACTOR hextractor
+                                            ,const char *path
+                                            ,ION_EXTRACTOR_CALLBACK fn_callback
+                                            ,void *context
+                                            ,int32_t *p_path_id);
+
+/** Reads the rest of the reader's values, calling back for each value on a
+ *  path. Where a value matches more than one path the callbacks are made in
+ *  the order the paths were added. The reader has to be at the top level.
+ *  The extractor sets the reader's projection (see
+ *  ion_reader_add_projection_path) to the fields its paths need while it
+ *  reads, and clears it when it's done.
+ */
+ION_API_EXPORT iERR ion_extractor_match     (hEXTRACTOR hextractor, hREADER hreader);
+
+ION_API_EXPORT iERR ion_extractor_close     (hEXTRACTOR hextractor);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ION_EXTRACTOR_H_ */
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2009-2016 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at:
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#ifndef ION_OFFSET_INDEX_H_
+#define ION_OFFSET_INDEX_H_
+
+#include "ion_types.h"
+#include "ion_platform_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** An offset index records where each top level value of a stream starts,
+ *  so a reader can be moved straight to value n with ion_offset_index_seek
+ *  instead of reading everything before it. The values are numbered from
+ *  0 in the order they were added.
+ *
+ *  Seeking to a value puts the symbol table it was read with back in place
+ *  first. The index remembers the first value read after each version
+ *  marker or local symbol table, and the seek reads the system values in
+ *  front of that value again, so only those are re-read, not the values
+ *  in between. For text the seek also puts back the line counts, so
+ *  ion_reader_get_position reports the same lines it would have.
+ *
+ *  An index is built from a reader opened at the start of its stream, and
+ *  can be used with any reader over the same bytes. It can be written out
+ *  as an Ion value and read back in with ion_offset_index_write and
+ *  ion_offset_index_read.
+ *
+ */
+
+typedef struct _ion_offset_index_entry
+{
+    POSITION    offset;         // of the value, including its annotations, as for ion_reader_seek
+    SIZE        length;         // of the value in binary, -1 in text
+    int32_t     symtab_id;      // values with the same id were read with the same symbol table
+    int32_t     line;           // in text, the line and offset in the line the value starts
+    int32_t     line_offset;    // at as ion_reader_get_position counts them, 0 in binary
+
+} ION_OFFSET_INDEX_ENTRY;
+
+ION_API_EXPORT iERR ion_offset_index_open       (hOFFSET_INDEX *p_hindex);
+
+/** Adds the top level value hreader is on to the end of the index. Every
+ *  value added to an index has to come from the same reader, in order and
+ *  without skipping any.
+ */
+ION_API_EXPORT iERR ion_offset_index_add_value  (hOFFSET_INDEX hindex, hREADER hreader);
+
+/** Reads the rest of hreader's top level values, adding each one to the
+ *  index. Leaves the reader at the end of the stream.
+ */
+ION_API_EXPORT iERR ion_offset_index_build      (hOFFSET_INDEX hindex, hREADER hreader);
+
+ION_API_EXPORT iERR ion_offset_index_get_count  (hOFFSET_INDEX hindex, int64_t *p_count);
+
+/** Fails with IERR_NO_SUCH_ELEMENT if value isn't in the index.
+ */
+ION_API_EXPORT iERR ion_offset_index_get_entry  (hOFFSET_INDEX hindex, int64_t value, ION_OFFSET_INDEX_ENTRY *p_entry);
+
+/** Moves hreader so that its next ion_reader_next returns value, with the
+ *  symbol table it was read with. Reading carries on past it to the rest of
+ *  the stream. The reader must be a seekable reader over the stream the
+ *  index was built from; if the values aren't where the index says this
+ *  fails with IERR_INVALID_STATE.
+ */
+ION_API_EXPORT iERR ion_offset_index_seek       (hOFFSET_INDEX hindex, hREADER hreader, int64_t value);
+
+/** Writes the index as a single annotated struct. Offsets are written as
+ *  the difference from the previous value, so in binary most of them are
+ *  a one byte int.
+ */
+ION_API_EXPORT iERR ion_offset_index_write      (hOFFSET_INDEX hindex, hWRITER hwriter);
+
+/** Reads an index written by ion_offset_index_write from the next value of
+ *  hreader, failing with IERR_NOT_AN_OFFSET_INDEX if that's something else.
+ */
+ION_API_EXPORT iERR ion_offset_index_read       (hREADER hreader, hOFFSET_INDEX *p_hindex);
+
+ION_API_EXPORT iERR ion_offset_index_close      (hOFFSET_INDEX hindex);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ION_OFFSET_INDEX_H_ */
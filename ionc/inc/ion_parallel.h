@@ -0,0 +1,82 @@
+/*
+ * Copyright 2009-2016 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at:
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#ifndef ION_PARALLEL_H_
+#define ION_PARALLEL_H_
+
+#include "ion_types.h"
+#include "ion_platform_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Reads the top level values of one stream on several threads at once.
+ *
+ *  The values are first indexed with an offset index (see
+ *  ion_offset_index.h), unless one is passed in. In binary this is a
+ *  sequential pass over the type descriptors and lengths that skips
+ *  each value without decoding it, in text it parses the whole stream.
+ *  The stream is then split at value boundaries into one run of values
+ *  of about the same number of bytes per thread. Each thread opens its
+ *  own reader, which the index gives the symbol table in effect at the
+ *  start of its run, and reads its run in order.
+ *
+ *  Without thread support in the library (it needs the per thread
+ *  allocator caches) the runs are read one after another on the calling
+ *  thread.
+ *
+ */
+
+/** Called with the reader on the top level value number value, counting
+ *  from 0. Calls for values in different runs happen at the same time on
+ *  different threads, calls in one run happen in order on one thread. The
+ *  callback can read the value and step in and out of it but mustn't move
+ *  the reader on with ion_reader_next. An error it returns stops all the
+ *  threads after the value they are on, and is returned.
+ */
+typedef iERR (*ION_PARALLEL_CALLBACK)(hREADER hreader, int64_t value, void *context);
+
+/** Calls fn_callback for each top level value in buffer, on up to
+ *  thread_count threads.
+ *  @param   hindex        Optional, an index of buffer to use instead of
+ *                         building one.
+ *  @param   p_options     Optional, the options for every reader opened. Any
+ *                         catalog is shared by all the threads and must not
+ *                         be changed until this returns.
+ */
+ION_API_EXPORT iERR ion_parallel_for_each_value         (BYTE *buffer
+                                                        ,SIZE length
+                                                        ,hOFFSET_INDEX hindex
+                                                        ,ION_READER_OPTIONS *p_options
+                                                        ,int32_t thread_count
+                                                        ,ION_PARALLEL_CALLBACK fn_callback
+                                                        ,void *context);
+
+/** Like ion_parallel_for_each_value for the file open on fd_in, which every
+ *  thread maps with ion_stream_open_mmap. A file that can't be mapped (a
+ *  pipe, say) is read on the calling thread alone.
+ */
+ION_API_EXPORT iERR ion_parallel_for_each_value_in_fd   (int fd_in
+                                                        ,hOFFSET_INDEX hindex
+                                                        ,ION_READER_OPTIONS *p_options
+                                                        ,int32_t thread_count
+                                                        ,ION_PARALLEL_CALLBACK fn_callback
+                                                        ,void *context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ION_PARALLEL_H_ */
@@ -100,6 +100,19 @@ typedef struct _ion_reader_options
      */
     SIZE allocation_page_size;
 
+    /** Size of the pages of the stream the data is read through when the
+     *  reader opens the stream itself (see ION_STREAM_OPTIONS), 0 for the
+     *  stream default of 8K
+     *
+     */
+    SIZE stream_page_size;
+
+    /** If larger than stream_page_size the stream's pages double in size, up
+     *  to this, while the stream is read sequentially. 0 for fixed size pages
+     *
+     */
+    SIZE stream_max_page_size;
+
     /** If true this will disable validation of string content which verifies the
      *  string returned is in fact a valid UTF-8 sequence.  This defaults to false.
      */
@@ -110,6 +123,12 @@ typedef struct _ion_reader_options
      */
     ION_CATALOG *pcatalog;
 
+    /** Allocator for the reader's memory and the streams it opens itself,
+     *  NULL for the default (see ion_allocator_set_default)
+     *
+     */
+    ION_ALLOCATOR *allocator;
+
 } ION_READER_OPTIONS;
 
 //
@@ -234,6 +253,14 @@ ION_API_EXPORT iERR ion_reader_open                    (hREADER *p_hreader
 ION_API_EXPORT iERR ion_reader_get_catalog             (hREADER hreader, hCATALOG *p_hcatalog);
 ION_API_EXPORT iERR ion_reader_get_symbol_table        (hREADER hreader, hSYMTAB  *p_hsymtab);
 
+/** Returns the memory held by the reader, its temporary pools and local
+ *  symbol tables, and the stream it opened for itself if it did. peak_bytes
+ *  adds up the peaks of the reader and its stream.
+ *  All 0 unless the reader was opened with ion_alloc_stats_enable on.
+ *  @see ion_alloc_stats_get
+ */
+ION_API_EXPORT iERR ion_reader_get_alloc_stats         (hREADER hreader, ION_ALLOC_STATS *p_stats);
+
 /** moves the stream position to the specified offset. Resets the 
  *  the state of the reader to be at the top level. As long as the
  *  specified position is at the first byte of a value (just before 
@@ -293,6 +320,32 @@ ION_API_EXPORT iERR ion_reader_step_in             (hREADER hreader);
 ION_API_EXPORT iERR ion_reader_step_out            (hREADER hreader);
 ION_API_EXPORT iERR ion_reader_get_depth           (hREADER hreader, SIZE *p_depth);
 
+/** Limits the fields ion_reader_next returns to the ones on a path of field
+ *  names, starting from the fields of top level structs. All of the value at
+ *  the end of a path is read. Lists and s-expressions along the way aren't
+ *  steps on the path, so reading {a:[{b:1,c:2}]} with the path a,b returns
+ *  a, the list, the struct in it and b but not c. Every path that's added
+ *  is read, and top level values are always returned.
+ *
+ *  The binary reader skips the other fields by their length, without
+ *  looking at their annotations. It matches names by the symbol id the
+ *  current symbol table has for them, so a name that's in the table more
+ *  than once only matches its first id. The text reader skips them with its
+ *  scanner.
+ *
+ *  Paths can only be added or cleared at the top level.
+ * @param   hreader
+ * @param   p_fields    The field names along the path.
+ * @param   count       Number of field names, at least 1.
+ * @see ion_reader_clear_projection
+ */
+ION_API_EXPORT iERR ion_reader_add_projection_path (hREADER hreader, ION_STRING *p_fields, SIZE count);
+
+/** Removes the paths added with ion_reader_add_projection_path, so every
+ *  field is read again.
+ */
+ION_API_EXPORT iERR ion_reader_clear_projection    (hREADER hreader);
+
 /**
  * Returns the type of the current value, or tid_none if no value has been assigned. (before next() is called)
  */
@@ -350,7 +403,8 @@ ION_API_EXPORT iERR ion_reader_read_symbol_sid     (hREADER hreader, SID *p_valu
  * Determines the content of the current text value, which must be an
  * Ion string or symbol.  The reader retains ownership of the returned byte
  * array, and the caller must copy the data out (if necessary) before moving
- * the cursor.
+ * the cursor. The binary reader returns the bytes in place in its input
+ * where it can, so the input mustn't change until then either.
  *
  * @param hreader must be a valid handle.
  *
@@ -34,7 +34,7 @@
  *
  
  
- MISSING: skip, fixes for block read/unread, collapse some functions
+ MISSING: fixes for block read/unread, collapse some functions
  
  
  use cases:
@@ -59,7 +59,8 @@
   --write - fail
   --seek - fail
   --skip N
-      next char N times
+      if mark, next char N times
+      else read and discard N bytes a page at a time (user handler buffers are just stepped over)
  
   write only stream - (aka (can read == false)
     --next char - fail 
@@ -167,10 +168,62 @@ struct _ion_user_stream
 
 typedef struct _ion_stream_user_paged ION_STREAM_USER_PAGED;
 typedef struct _ion_stream_paged  ION_STREAM_PAGED;
+typedef struct _ion_stream_mapped ION_STREAM_MAPPED;
+typedef struct _ion_stream_segmented ION_STREAM_SEGMENTED;
+typedef struct _ion_read_ahead    ION_READ_AHEAD;
 typedef struct _ion_page          ION_PAGE;
 typedef int32_t                   PAGE_ID;
 typedef int64_t                   POSITION;
 
+// the most bytes a single ion_stream_reserve call may ask for
+#define ION_STREAM_MAX_RESERVE            64
+
+typedef struct _ion_stream_options
+{
+    /** size of the stream's pages, 0 for the default page size (8K)
+     *
+     */
+    SIZE    page_size;
+
+    /** if larger than page_size a sequential stream doubles its page size,
+     *  up to this size, as it moves on from page to page. Streams that keep
+     *  their pages (marks, memory only streams, read ahead or a cache budget)
+     *  don't grow. 0 leaves the page size fixed.
+     *
+     */
+    SIZE    max_page_size;
+
+    /** number of pages to keep read ahead of the reader, 0 for the default (4),
+     *  only used by the read ahead constructors
+     *
+     */
+    int32_t read_ahead_depth;
+
+    /** allocator for the stream and its pages, NULL for the default
+     *  (see ion_allocator_set_default)
+     *
+     */
+    ION_ALLOCATOR *allocator;
+
+} ION_STREAM_OPTIONS;
+
+/** one piece of the input for ion_stream_open_segments, the bytes
+ *  belong to the caller and are read in place
+ *
+ */
+typedef struct _ion_stream_segment
+{
+    BYTE   *data;
+    SIZE    length;
+
+} ION_STREAM_SEGMENT;
+
+/** called by a segmented output stream with each run of bytes written, in
+ *  order, when a segment fills up and when the stream is flushed or closed
+ *
+ */
+typedef iERR (*ION_STREAM_SEGMENT_HANDLER)(void *handler_state, BYTE *data, SIZE length);
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //                     public constructors
@@ -200,6 +253,87 @@ ION_API_EXPORT iERR ion_stream_open_fd_in(int fd_in, ION_STREAM **pp_stream);
 ION_API_EXPORT iERR ion_stream_open_fd_out(int fd_out, ION_STREAM **pp_stream);
 ION_API_EXPORT iERR ion_stream_open_fd_rw(int fd, BOOL cache_all, ION_STREAM **pp_stream);
 
+/**
+ * The same constructors taking the stream's page size (and optionally
+ * adaptive page growth) from p_options. p_options may be NULL, which is
+ * the same as calling the constructors above.
+ */
+ION_API_EXPORT iERR ion_stream_open_memory_only_with_options(ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream);
+
+ION_API_EXPORT iERR ion_stream_open_stdin_with_options(ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream);
+ION_API_EXPORT iERR ion_stream_open_stdout_with_options(ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream);
+
+ION_API_EXPORT iERR ion_stream_open_file_in_with_options(FILE *in, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream);
+ION_API_EXPORT iERR ion_stream_open_file_out_with_options(FILE *out, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream);
+ION_API_EXPORT iERR ion_stream_open_file_rw_with_options(FILE *fp, BOOL cache_all, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream);
+
+ION_API_EXPORT iERR ion_stream_open_handler_in_with_options(ION_STREAM_HANDLER fn_input_handler, void *handler_state, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream);
+ION_API_EXPORT iERR ion_stream_open_handler_out_with_options(ION_STREAM_HANDLER fn_output_handler, void *handler_state, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream);
+
+ION_API_EXPORT iERR ion_stream_open_fd_in_with_options(int fd_in, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream);
+ION_API_EXPORT iERR ion_stream_open_fd_out_with_options(int fd_out, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream);
+ION_API_EXPORT iERR ion_stream_open_fd_rw_with_options(int fd, BOOL cache_all, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream);
+
+/**
+ * Opens a read only stream over a memory mapping of the whole of the regular
+ * file open on fd_in. The reader works directly on the mapped bytes, there is
+ * no copying into stream pages. The caller still owns (and closes) fd_in.
+ * If fd_in is not a regular file (a pipe, a tty, ...), is empty or can't be
+ * mapped this falls back to ion_stream_open_fd_in.
+ */
+ION_API_EXPORT iERR ion_stream_open_mmap(int fd_in, ION_STREAM **pp_stream);
+
+/**
+ * Opens a read only stream over the concatenation of count segments (for
+ * example the buffers a message arrived in). The bytes are read where they
+ * are, without being copied into one buffer, and values may span segments.
+ * The segment list is copied, but the segment data has to stay valid until
+ * the stream is closed. Empty segments are allowed.
+ */
+ION_API_EXPORT iERR ion_stream_open_segments(ION_STREAM_SEGMENT *segments, int32_t count, ION_STREAM **pp_stream);
+
+/**
+ * Opens a write only stream that writes into a chain of segments. The count
+ * caller segments (which may be 0) are filled first, in order, after which
+ * the stream allocates segments of p_options->page_size bytes (8K by default),
+ * doubling each one up to p_options->max_page_size if that is larger. The
+ * stream never runs out of room.
+ * If fn_handler is not NULL it is passed each run of bytes as it is finished,
+ * and the bytes of segments the stream allocated are only valid until the
+ * handler returns (the segment is reused). Without a handler the segments
+ * are kept until the stream is closed, see ion_stream_get_segments.
+ */
+ION_API_EXPORT iERR ion_stream_open_segments_out(ION_STREAM_SEGMENT *segments, int32_t count, ION_STREAM_SEGMENT_HANDLER fn_handler, void *handler_state, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream);
+
+/**
+ * Returns the segments written so far by a segmented output stream opened
+ * without a handler, each with the number of bytes written to it. Segments
+ * without any bytes are left out. The list belongs to the stream and is
+ * valid until the next write to it.
+ */
+ION_API_EXPORT iERR ion_stream_get_segments(ION_STREAM *stream, ION_STREAM_SEGMENT **p_segments, int32_t *p_count);
+
+/**
+ * Opens an input stream like ion_stream_open_file_in and ion_stream_open_fd_in
+ * but with a background thread reading the following pages while the current
+ * one is parsed, so reading and parsing overlap. The thread reads with pread,
+ * so the file has to be a regular file; otherwise (and on platforms without
+ * threads) the stream simply reads synchronously. p_options may be NULL,
+ * its max_page_size is ignored as read ahead pages are a fixed size.
+ */
+ION_API_EXPORT iERR ion_stream_open_file_in_read_ahead(FILE *in, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream);
+ION_API_EXPORT iERR ion_stream_open_fd_in_read_ahead(int fd_in, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream);
+
+/**
+ * Limits the pages a random access file or fd stream keeps in memory to
+ * max_bytes worth (but always at least 2 pages). When more are needed the
+ * least recently used pages are dropped and read again from the file if the
+ * stream goes back to them. Dirty bytes are always written back before the
+ * stream leaves a page, so only clean pages are ever dropped. 0 removes the
+ * limit, which is the default.
+ */
+ION_API_EXPORT iERR ion_stream_set_cache_budget(ION_STREAM *stream, int64_t max_bytes);
+
 ION_API_EXPORT iERR ion_stream_flush(ION_STREAM *stream);
 ION_API_EXPORT iERR ion_stream_close(ION_STREAM *stream);
 
@@ -219,6 +353,7 @@ ION_API_EXPORT POSITION  ion_stream_get_position      (ION_STREAM *stream);
 ION_API_EXPORT FILE     *ion_stream_get_file_stream   (ION_STREAM *stream);
 ION_API_EXPORT POSITION  ion_stream_get_mark_start    (ION_STREAM *stream);
 ION_API_EXPORT POSITION  ion_stream_get_marked_length (ION_STREAM *stream);
+ION_API_EXPORT iERR      ion_stream_get_read_ahead_stats(ION_STREAM *stream, int64_t *p_hits, int64_t *p_misses);
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -229,10 +364,15 @@ ION_API_EXPORT POSITION  ion_stream_get_marked_length (ION_STREAM *stream);
 ION_API_EXPORT iERR ion_stream_read_byte           (ION_STREAM *stream, int *p_c);
 ION_API_EXPORT iERR ion_stream_read                (ION_STREAM *stream, BYTE *buf, SIZE len, SIZE *p_bytes_read);
 ION_API_EXPORT iERR ion_stream_unread_byte         (ION_STREAM *stream, int c);
+ION_API_EXPORT iERR ion_stream_peek_span           (ION_STREAM *stream, BYTE **p_span, SIZE *p_available);
+ION_API_EXPORT iERR ion_stream_consume             (ION_STREAM *stream, SIZE len);
 ION_API_EXPORT iERR ion_stream_write               (ION_STREAM *stream, BYTE *buf, SIZE len, SIZE *p_bytes_written);
 ION_API_EXPORT iERR ion_stream_write_byte          (ION_STREAM *stream, int byte);
 ION_API_EXPORT iERR ion_stream_write_byte_no_checks(ION_STREAM *stream, int byte);
 ION_API_EXPORT iERR ion_stream_write_stream        (ION_STREAM *stream, ION_STREAM *stream_input, SIZE len, SIZE *p_written);
+ION_API_EXPORT iERR ion_stream_write_segments      (ION_STREAM *stream, ION_STREAM_SEGMENT *segments, int32_t count, SIZE *p_written);
+ION_API_EXPORT iERR ion_stream_reserve             (ION_STREAM *stream, SIZE len, BYTE **p_buf);
+ION_API_EXPORT iERR ion_stream_commit              (ION_STREAM *stream, SIZE used);
 ION_API_EXPORT iERR ion_stream_seek                (ION_STREAM *stream, POSITION position);
 ION_API_EXPORT iERR ion_stream_truncate            (ION_STREAM *stream);
 ION_API_EXPORT iERR ion_stream_skip                (ION_STREAM *stream, SIZE distance, SIZE *p_skipped);
@@ -226,6 +226,7 @@ ION_API_EXPORT iERR ion_symbol_table_unload             (hSYMTAB hsymtab, hWRITE
 ION_API_EXPORT iERR ion_symbol_table_lock               (hSYMTAB hsymtab);
 ION_API_EXPORT iERR ion_symbol_table_is_locked          (hSYMTAB hsymtab, BOOL *p_is_locked);
 ION_API_EXPORT iERR ion_symbol_table_get_type           (hSYMTAB hsymtab, ION_SYMBOL_TABLE_TYPE *p_type);
+ION_API_EXPORT iERR ion_symbol_table_get_alloc_stats    (hSYMTAB hsymtab, ION_ALLOC_STATS *p_stats); // memory held by the table's owner, which may be a reader or writer
 
 ION_API_EXPORT iERR ion_symbol_table_get_name           (hSYMTAB hsymtab, iSTRING p_name);
 ION_API_EXPORT iERR ion_symbol_table_get_version        (hSYMTAB hsymtab, int32_t *p_version);
@@ -243,7 +244,7 @@ ION_API_EXPORT iERR ion_symbol_table_find_by_name       (hSYMTAB hsymtab, iSTRIN
 ION_API_EXPORT iERR ion_symbol_table_find_by_sid        (hSYMTAB hsymtab, SID sid, iSTRING *p_name);
 ION_API_EXPORT iERR ion_symbol_table_is_symbol_known    (hSYMTAB hsymtab, SID sid, BOOL *p_is_known);
 
-ION_API_EXPORT iERR ion_symbol_table_get_symbol         (hSYMTAB hsymtab, SID sid, ION_SYMBOL **p_sym); // get symbols by sid, iterate from 1 to max_sid - returns all symbols
+ION_API_EXPORT iERR ion_symbol_table_get_symbol         (hSYMTAB hsymtab, SID sid, ION_SYMBOL **p_sym); // get symbols by sid, iterate from 1 to max_sid - returns all symbols, imported ones with the sid they have in the imported table
 ION_API_EXPORT iERR ion_symbol_table_get_local_symbol   (hSYMTAB hsymtab, SID sid, ION_SYMBOL **p_sym); // get symbols by sid, iterate from 1 to max_sid - returns only locally defined symbols
 
 ION_API_EXPORT iERR ion_symbol_table_add_symbol         (hSYMTAB hsymtab, iSTRING name, SID *p_sid);
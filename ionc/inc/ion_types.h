@@ -127,6 +127,10 @@ typedef struct _ion_writer              ION_WRITER;
 typedef struct _ion_int                 ION_INT;
 typedef struct _ion_timestamp           ION_TIMESTAMP;
 typedef struct _ion_collection          ION_COLLECTION;
+typedef struct _ion_allocator           ION_ALLOCATOR;
+typedef struct _ion_alloc_stats         ION_ALLOC_STATS;
+typedef struct _ion_extractor           ION_EXTRACTOR;
+typedef struct _ion_offset_index        ION_OFFSET_INDEX;
 
 #ifndef ION_STREAM_DECL
 #define ION_STREAM_DECL
@@ -165,6 +169,8 @@ typedef ION_READER              *hREADER;
 typedef ION_WRITER              *hWRITER;
 typedef ION_SYMBOL_TABLE        *hSYMTAB;
 typedef ION_CATALOG             *hCATALOG;
+typedef ION_EXTRACTOR           *hEXTRACTOR;
+typedef ION_OFFSET_INDEX        *hOFFSET_INDEX;
 
 #ifdef __cplusplus
 }
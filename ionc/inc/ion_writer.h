@@ -80,6 +80,29 @@ typedef struct _ion_writer_options
      */
     SIZE allocation_page_size;
 
+    /** Size of the pages of the stream the data is written through when the
+     *  writer opens the stream itself (see ION_STREAM_OPTIONS), 0 for the
+     *  stream default of 8K
+     *
+     */
+    SIZE stream_page_size;
+
+    /** If larger than stream_page_size the stream's pages double in size, up
+     *  to this, while the stream is written sequentially. 0 for fixed size pages
+     *
+     */
+    SIZE stream_max_page_size;
+
+    /** Binary only. Writes each value once, into one contiguous buffer, and
+     *  fills in container and annotation lengths in place as they close
+     *  instead of merging a list of length patches into the output on flush.
+     *  The bytes written are the same either way. The buffer holds everything
+     *  written since the last flush and can't grow past 1 GiB; a write that
+     *  would take it further fails with IERR_NO_MEMORY
+     *
+     */
+    BOOL binary_single_pass;
+
     /** Handle to catalog of shared symbol tables for the writer to use
      *
      */
@@ -90,6 +113,12 @@ typedef struct _ion_writer_options
      */
     ION_SYMBOL_TABLE *encoding_psymbol_table;
 
+    /** Allocator for the writer's memory and the streams it opens itself,
+     *  NULL for the default (see ion_allocator_set_default)
+     *
+     */
+    ION_ALLOCATOR *allocator;
+
 } ION_WRITER_OPTIONS;
 
 
@@ -100,6 +129,7 @@ typedef struct _ion_writer_options
  *  @param  buf_length  size of the buffer (0 or greater). If the buffer is not big enough, ion_write
  *                      operation will return IERR_EOF rather than IERR_OK.
  *  @param  p_option    writer configuration object.
+ *  @see ion_writer_open_segments for output that grows as needed
  */
 ION_API_EXPORT iERR ion_writer_open_buffer          (hWRITER *p_hwriter
                                                     ,BYTE *buffer
@@ -121,6 +151,35 @@ ION_API_EXPORT iERR ion_writer_open_stream          (hWRITER *p_hwriter
                                                     ,void *handler_state
                                                     ,ION_WRITER_OPTIONS *p_options);
 
+/** Open a writer over a chain of output segments which grows as needed, so
+ *  unlike ion_writer_open_buffer the writer never runs out of room.
+ * @param   segments            Caller provided segments to fill first, may be NULL if count is 0.
+ * @param   count               Number of caller provided segments.
+ * @param   fn_segment_handler  Optional, called with each run of output bytes as it is finished
+ *                              (a segment filled, or the writer flushed or closed), for example
+ *                              to hand it to writev. The writer's own segments are reused once
+ *                              the handler returns.
+ * @param   handler_state       Passed to fn_segment_handler.
+ * @param   p_options           writer configuration object. stream_page_size is the size of the
+ *                              segments the writer adds, which double up to stream_max_page_size.
+ * @see ion_stream_open_segments_out
+ * @see ion_writer_get_segments
+ */
+ION_API_EXPORT iERR ion_writer_open_segments        (hWRITER *p_hwriter
+                                                    ,ION_STREAM_SEGMENT *segments
+                                                    ,int32_t count
+                                                    ,ION_STREAM_SEGMENT_HANDLER fn_segment_handler
+                                                    ,void *handler_state
+                                                    ,ION_WRITER_OPTIONS *p_options);
+
+/** Returns the filled segments of a writer opened with ion_writer_open_segments
+ *  without a handler. Call ion_writer_flush first, the binary writer holds
+ *  values back until it is flushed. The list is valid until the next write.
+ */
+ION_API_EXPORT iERR ion_writer_get_segments         (hWRITER hwriter
+                                                    ,ION_STREAM_SEGMENT **p_segments
+                                                    ,int32_t *p_count);
+
 ION_API_EXPORT iERR ion_writer_open                 (hWRITER *p_hwriter
                                                     ,ION_STREAM *p_stream
                                                     ,ION_WRITER_OPTIONS *p_options);
@@ -132,6 +191,15 @@ ION_API_EXPORT iERR ion_writer_get_catalog          (hWRITER hwriter, hCATALOG *
 ION_API_EXPORT iERR ion_writer_set_symbol_table     (hWRITER hwriter, hSYMTAB     hsymtab);
 ION_API_EXPORT iERR ion_writer_get_symbol_table     (hWRITER hwriter, hSYMTAB  *p_hsymtab);
 
+/** Returns the memory held by the writer, its temporary pool and symbol
+ *  tables, the buffer a binary writer holds values in until they're flushed,
+ *  and the stream it opened for itself if it did. peak_bytes adds up the
+ *  peaks of each of these.
+ *  All 0 unless the writer was opened with ion_alloc_stats_enable on.
+ *  @see ion_alloc_stats_get
+ */
+ION_API_EXPORT iERR ion_writer_get_alloc_stats      (hWRITER hwriter, ION_ALLOC_STATS *p_stats);
+
 ION_API_EXPORT iERR ion_writer_write_field_name     (hWRITER hwriter, iSTRING name);
 ION_API_EXPORT iERR ion_writer_write_field_sid      (hWRITER hwriter, SID sid);
 ION_API_EXPORT iERR ion_writer_clear_field_name     (hWRITER hwriter);
@@ -53,6 +53,19 @@ ION_API_EXPORT decQuad    *ion_alloc_decimal   (hOWNER  owner);
 ION_API_EXPORT iTIMESTAMP  ion_alloc_timestamp (hOWNER  owner);
 ION_API_EXPORT void        ion_alloc_free      (void *ptr);
 
+//
+// the system memory everything else is built on comes from the default
+// allocator (see ion_allocator.h), malloc and free unless it has been set
+//
+void *_ion_xalloc  (SIZE size);
+void  _ion_xfree   (void *ptr);
+void *_ion_xrealloc(void *ptr, SIZE old_size, SIZE new_size);
+
+// the same, from a given allocator, NULL being malloc and free
+void *_ion_allocator_alloc  (ION_ALLOCATOR *allocator, SIZE size);
+void  _ion_allocator_free   (ION_ALLOCATOR *allocator, void *ptr);
+void *_ion_allocator_realloc(ION_ALLOCATOR *allocator, void *ptr, SIZE old_size, SIZE new_size);
+
 // define MEM_DEBUG with compiler flag to turn on memory debugging
     
 #if defined(MEM_DEBUG)
@@ -69,11 +82,13 @@ ION_API_EXPORT void        ion_alloc_free      (void *ptr);
 
     #include <stdlib.h>
 
-    #define ion_xalloc(sz)  malloc(sz)
-    #define ion_xfree(ptr)  free(ptr)
+    #define ion_xalloc(sz)  _ion_xalloc(sz)
+    #define ion_xfree(ptr)  _ion_xfree(ptr)
 
 #endif
 
+#define ion_xrealloc(ptr, old_size, new_size) _ion_xrealloc(ptr, old_size, new_size)
+
 //#ifndef ION_ALLOCATION_BLOCK_SIZE
 //#define ION_ALLOCATION_BLOCK_SIZE DEFAULT_BLOCK_SIZE
 //#endif
@@ -99,6 +114,8 @@ struct _ion_allocation_chain
     SIZE                  size;
     ION_ALLOCATION_CHAIN *next;
     ION_ALLOCATION_CHAIN *head;
+    ION_ALLOCATOR        *allocator; // where the chain's blocks come from, NULL for the page pool
+    ION_ALLOC_STATS      *stats;     // where the block is counted, NULL if it isn't
 
     BYTE                 *position;
     BYTE                 *limit;
@@ -113,11 +130,17 @@ struct _ion_allocation_chain
 typedef struct _ion_allocation_chain DBG_ION_ALLOCATION_CHAIN;
 
 #define ion_alloc_owner(len)                _dbg_ion_alloc_owner(len, __FILE__, __LINE__)
+#define ion_alloc_owner_with_allocator(len, allocator) \
+                                            _dbg_ion_alloc_owner_with_allocator(len, allocator, __FILE__, __LINE__)
+#define ion_alloc_dependent_owner(parent, len) _ion_alloc_dependent_owner(parent, len)
 #define ion_alloc_with_owner(owner, length) _dbg_ion_alloc_with_owner(owner, length, __FILE__, __LINE__)
 #define ion_free_owner(owner)               _dbg_ion_free_owner(owner, __FILE__, __LINE__)
 #define ion_strdup(owner, dst, src)         _dbg_ion_strdup(owner, dst, src, __FILE__, __LINE__)
 #else
 #define ion_alloc_owner(len)                _ion_alloc_owner(len) 
+#define ion_alloc_owner_with_allocator(len, allocator) \
+                                            _ion_alloc_owner_with_allocator(len, allocator)
+#define ion_alloc_dependent_owner(parent, len) _ion_alloc_dependent_owner(parent, len)
 #define ion_alloc_with_owner(owner, length) _ion_alloc_with_owner(owner, length)
 #define ion_free_owner(owner)               _ion_free_owner(owner)
 #define ion_strdup(owner, dst, src)         _ion_strdup(owner, dst, src)
@@ -130,7 +153,13 @@ typedef struct _ion_allocation_chain DBG_ION_ALLOCATION_CHAIN;
 //  pools created by the Ion routines on behalf of the various
 //  objects, such as the reader, writer, or catalog.
 //
-//  THIS IS NOT THREAD SAFE - (which could be corrected)
+//  where we have threads and atomics (ION_ALLOC_HAS_THREAD_CACHE) each
+//  thread keeps a few free pages of its own, which it uses without any
+//  synchronization. Pages past that go to the shared list, which is
+//  lock free: pages are pushed onto it, and a thread that runs out takes
+//  the whole list and gives back what it doesn't keep. A thread's pages
+//  go back to the shared list when the thread exits.
+//  Elsewhere there is only the shared list, and it is NOT THREAD SAFE.
 //
 
 typedef struct _ion_alloc_page      ION_ALLOC_PAGE;
@@ -149,6 +178,25 @@ struct _ion_alloc_page_list
     ION_ALLOC_PAGE *head;
 };
 
+#if !defined(ION_PLATFORM_WINDOWS) && defined(__GNUC__)
+#define ION_ALLOC_HAS_THREAD_CACHE
+#endif
+
+typedef struct _ion_alloc_page_cache ION_ALLOC_PAGE_CACHE;
+
+struct _ion_alloc_page_cache
+{
+    SIZE            page_size;  // the pool's page size when these pages were cached
+    ION_ALLOCATOR  *allocator;  // and the default allocator they came from
+    int             page_count;
+    ION_ALLOC_PAGE *head;
+    ION_ALLOC_PAGE *tail;
+};
+
+// the pages a thread keeps for itself. When it has more than this
+// it gives the shared list enough to bring it down to half
+#define ION_ALLOC_PAGE_CACHE_LIMIT             (8)
+
 #define ION_ALLOC_PAGE_POOL_NO_LIMIT           (-1)
 #define ION_ALLOC_PAGE_POOL_DEFAULT_LIMIT      (16)
 #define ION_ALLOC_PAGE_MIN_SIZE                (ALIGN_SIZE(sizeof(ION_ALLOCATION_CHAIN)))
@@ -164,7 +212,7 @@ GLOBAL ION_ALLOC_PAGE_LIST g_ion_alloc_page_list
 ION_API_EXPORT void             ion_initialize_page_pool    (SIZE page_size, int free_page_limit);
 ION_API_EXPORT void             ion_release_page_pool       (void);
 
-ION_ALLOC_PAGE *_ion_alloc_page              (void);
+ION_ALLOC_PAGE *_ion_alloc_page              (BOOL *p_from_pool);
 void            _ion_release_page            (ION_ALLOC_PAGE *page);
 
 void *_ion_alloc_owner     (SIZE len);
@@ -172,10 +220,23 @@ void *_ion_alloc_with_owner(hOWNER owner, SIZE length);
 void  _ion_free_owner      (hOWNER owner);
 iERR  _ion_strdup          (hOWNER owner, iSTRING dst, iSTRING src);
 
+// an owner whose blocks come from allocator rather than the page pool,
+// a NULL allocator is the same as ion_alloc_owner
+void          *_ion_alloc_owner_with_allocator(SIZE len, ION_ALLOCATOR *allocator);
+
+// an owner, such as a reader's temporary pool, that is freed separately
+// but never after parent. It allocates the way parent does and is counted
+// in parent's statistics
+void          *_ion_alloc_dependent_owner     (hOWNER parent, SIZE len);
+
+// adds the statistics owner is counted in (if it's counted) to p_stats
+void           _ion_alloc_owner_add_stats     (hOWNER owner, ION_ALLOC_STATS *p_stats);
+
 
 
 #ifdef MEM_DEBUG 
 void *_dbg_ion_alloc_owner     (SIZE len, const char *file, int line);
+void *_dbg_ion_alloc_owner_with_allocator(SIZE len, ION_ALLOCATOR *allocator, const char *file, int line);
 void *_dbg_ion_alloc_with_owner(hOWNER owner, SIZE length, const char *file, int line);
 void  _dbg_ion_free_owner      (hOWNER owner, const char *file, int line);
 iERR  _dbg_ion_strdup          (hOWNER owner, iSTRING dst, iSTRING src, const char *file, int line);
@@ -28,8 +28,62 @@ void _dbg_ion_message_validate(const char *fn_name, void *addr, SIZE len, int va
 
 void                 *_ion_alloc_with_owner_helper  (ION_ALLOCATION_CHAIN *phead, SIZE length, BOOL force_new_block);
 void                 *_ion_alloc_on_chain           (ION_ALLOCATION_CHAIN *phead, SIZE length);
-ION_ALLOCATION_CHAIN *_ion_alloc_block              (SIZE min_needed);
-void                  _ion_free_block               (ION_ALLOCATION_CHAIN *pblock);
+void                 *_ion_alloc_owner_helper       (SIZE len, ION_ALLOCATOR *allocator, ION_ALLOC_STATS *stats);
+ION_ALLOCATION_CHAIN *_ion_alloc_block              (SIZE min_needed, ION_ALLOCATOR *allocator, void *owner, ION_ALLOC_STATS *stats);
+void                  _ion_free_block               (ION_ALLOCATION_CHAIN *pblock, void *owner);
+ION_ALLOCATOR        *_ion_alloc_chain_allocator    (ION_ALLOCATOR *allocator);
+void                  _ion_alloc_stats_add_block    (ION_ALLOC_STATS *stats, SIZE size, int source);
+void                  _ion_alloc_stats_remove_block (ION_ALLOC_STATS *stats, SIZE size);
+void                  _ion_alloc_stats_add_owner    (ION_ALLOC_STATS *stats, int count);
+BOOL                  _ion_alloc_stats_is_enabled   (void);
+
+// the default allocator, NULL for malloc and free. This only changes
+// while the page pool is inactive, so it's read without synchronization
+static ION_ALLOCATOR *g_ion_allocator = NULL;
+
+// the statistics for all of Ion, and whether new owners are counted
+static ION_ALLOC_STATS g_ion_alloc_stats;
+static BOOL            g_ion_alloc_stats_enabled = FALSE;
+
+// where a block came from, for the statistics
+#define ION_ALLOC_SOURCE_OTHER      0   // an allocator, or malloc for an oversize block
+#define ION_ALLOC_SOURCE_POOL_HIT   1
+#define ION_ALLOC_SOURCE_POOL_MISS  2
+
+// the global counts are shared by every thread
+#ifdef ION_ALLOC_HAS_THREAD_CACHE
+#define ION_ALLOC_STAT_ADD(field, n) __atomic_add_fetch(&g_ion_alloc_stats.field, (n), __ATOMIC_RELAXED)
+#define ION_ALLOC_STAT_GET(field)    __atomic_load_n(&g_ion_alloc_stats.field, __ATOMIC_RELAXED)
+#else
+#define ION_ALLOC_STAT_ADD(field, n) (g_ion_alloc_stats.field += (n))
+#define ION_ALLOC_STAT_GET(field)    (g_ion_alloc_stats.field)
+#endif
+
+#ifdef ION_ALLOC_HAS_THREAD_CACHE
+#include <pthread.h>
+
+static pthread_once_t g_ion_alloc_page_cache_once = PTHREAD_ONCE_INIT;
+static pthread_key_t  g_ion_alloc_page_cache_key;
+static BOOL           g_ion_alloc_page_cache_key_ready = FALSE;
+
+// a thread's cached pages may have come from an allocator that's since
+// stopped being the default, so they go back to the one they came from
+#ifdef MEM_DEBUG
+#define ION_ALLOC_PAGE_FREE(allocator, page) ion_xfree(page)
+#else
+#define ION_ALLOC_PAGE_FREE(allocator, page) _ion_allocator_free(allocator, page)
+#endif
+
+ION_ALLOC_PAGE_CACHE *_ion_alloc_page_cache         (void);
+void                  _ion_alloc_page_cache_key_create(void);
+void                  _ion_alloc_page_cache_destroy (void *context);
+void                  _ion_alloc_page_cache_refill  (ION_ALLOC_PAGE_CACHE *cache);
+void                  _ion_alloc_page_cache_spill   (ION_ALLOC_PAGE_CACHE *cache, int keep, BOOL discard);
+void                  _ion_alloc_page_shared_push   (ION_ALLOC_PAGE *first, ION_ALLOC_PAGE *last, int count);
+ION_ALLOC_PAGE       *_ion_alloc_page_shared_take   (int *p_count, ION_ALLOC_PAGE **p_tail);
+void                  _ion_alloc_page_free_chain    (ION_ALLOC_PAGE *page);
+BOOL                  _ion_alloc_page_cache_is_stale(ION_ALLOC_PAGE_CACHE *cache);
+#endif
 
 
 //
@@ -38,19 +92,42 @@ void                  _ion_free_block               (ION_ALLOCATION_CHAIN *pbloc
 
 void *_ion_alloc_owner(SIZE len)
 {
-    void                 *owner;
-    ION_ALLOCATION_CHAIN *new_chain;
+    return _ion_alloc_owner_with_allocator(len, NULL);
+}
 
-    if (g_ion_alloc_page_list.page_size == ION_ALLOC_PAGE_POOL_PAGE_SIZE_NONE) {
-        ion_initialize_page_pool(ION_ALLOC_PAGE_POOL_DEFAULT_PAGE_SIZE, ION_ALLOC_PAGE_POOL_DEFAULT_LIMIT);
-    }
+void *_ion_alloc_owner_with_allocator(SIZE len, ION_ALLOCATOR *allocator)
+{
+    return _ion_alloc_owner_helper(len, _ion_alloc_chain_allocator(allocator), NULL);
+}
 
-    new_chain = _ion_alloc_block(len);
-    if (!new_chain) return NULL;
+void *_ion_alloc_dependent_owner(hOWNER parent, SIZE len)
+{
+    ION_ALLOCATION_CHAIN *pparent;
 
-    owner = _ion_alloc_with_owner_helper(new_chain, len, FALSE);
+    ASSERT(parent);
 
-    return owner;
+    pparent = ION_ALLOC_USER_PTR_TO_BLOCK(parent);
+    return _ion_alloc_owner_helper(len, pparent->allocator, pparent->stats);
+}
+
+void _ion_alloc_owner_add_stats(hOWNER owner, ION_ALLOC_STATS *p_stats)
+{
+    ION_ALLOC_STATS *stats;
+
+    ASSERT(p_stats);
+
+    if (!owner) return;
+    stats = ION_ALLOC_USER_PTR_TO_BLOCK(owner)->stats;
+    if (!stats) return;
+
+    p_stats->bytes        += stats->bytes;
+    p_stats->peak_bytes   += stats->peak_bytes;
+    p_stats->blocks       += stats->blocks;
+    p_stats->owners       += stats->owners;
+    p_stats->total_bytes  += stats->total_bytes;
+    p_stats->total_blocks += stats->total_blocks;
+    p_stats->pool_hits    += stats->pool_hits;
+    p_stats->pool_misses  += stats->pool_misses;
 }
 
 void *_ion_alloc_with_owner(hOWNER owner, SIZE length)
@@ -71,15 +148,19 @@ void _ion_free_owner(hOWNER owner)
     ION_ALLOCATION_CHAIN *powner = ION_ALLOC_USER_PTR_TO_BLOCK(owner);
     ION_ALLOCATION_CHAIN *pblk, *pnext;
 
+    if (powner->stats) {
+        _ion_alloc_stats_add_owner(powner->stats, -1);
+    }
+
     // free all the blocks in the owners allocation chain
     // (release them back to the shared block pool)
     for (pblk = powner->head; pblk; pblk = pnext) {
         pnext = pblk->next;
-        _ion_free_block(pblk);
+        _ion_free_block(pblk, owner);
     }
 
     // now free the owner
-    _ion_free_block(powner);
+    _ion_free_block(powner, NULL);
 
     return;
 }
@@ -103,6 +184,45 @@ iERR _ion_strdup(hOWNER owner, iSTRING dst, iSTRING src)
 //
 // internal (to this file) helper functions
 //
+
+// when the owner is counted on its own its statistics go in its first
+// block, just after the owner, and they count that block too
+void *_ion_alloc_owner_helper(SIZE len, ION_ALLOCATOR *allocator, ION_ALLOC_STATS *stats)
+{
+    void                 *owner;
+    ION_ALLOCATION_CHAIN *new_chain;
+    ION_ALLOC_STATS       first_block, *own_stats = NULL;
+    SIZE                  needed = len;
+
+    if (g_ion_alloc_page_list.page_size == ION_ALLOC_PAGE_POOL_PAGE_SIZE_NONE) {
+        ion_initialize_page_pool(ION_ALLOC_PAGE_POOL_DEFAULT_PAGE_SIZE, ION_ALLOC_PAGE_POOL_DEFAULT_LIMIT);
+    }
+
+    if (!stats && _ion_alloc_stats_is_enabled()) {
+        memset(&first_block, 0, sizeof(first_block));
+        own_stats = &first_block;
+        needed = ALIGN_SIZE(len) + ALIGN_SIZE(sizeof(ION_ALLOC_STATS));
+    }
+
+    new_chain = _ion_alloc_block(needed, allocator, NULL, own_stats ? own_stats : stats);
+    if (!new_chain) return NULL;
+
+    owner = _ion_alloc_with_owner_helper(new_chain, len, FALSE);
+
+    if (own_stats) {
+        // the block was made big enough for both
+        stats = (ION_ALLOC_STATS *)_ion_alloc_with_owner_helper(new_chain, sizeof(ION_ALLOC_STATS), FALSE);
+        ASSERT(stats && new_chain->head == NULL);
+        *stats = first_block;
+        new_chain->stats = stats;
+    }
+    if (stats) {
+        _ion_alloc_stats_add_owner(stats, 1);
+    }
+
+    return owner;
+}
+
 void *_ion_alloc_with_owner_helper(ION_ALLOCATION_CHAIN *powner, SIZE request_length, BOOL force_new_block)
 {
     ION_ALLOCATION_CHAIN *pblock = powner;
@@ -139,7 +259,7 @@ void *_ion_alloc_with_owner_helper(ION_ALLOCATION_CHAIN *powner, SIZE request_le
     // create a new block we might need to just to make room
     if ( force_new_block ) {
         // otherwise we add a new block
-        pblock = _ion_alloc_block(length);
+        pblock = _ion_alloc_block(length, powner->allocator, ION_ALLOC_BLOCK_TO_USER_PTR(powner), powner->stats);
         if (!pblock) return NULL;
 
         if (pblock->size > g_ion_alloc_page_list.page_size && powner->head != NULL) {
@@ -174,29 +294,64 @@ void *_ion_alloc_with_owner_helper(ION_ALLOCATION_CHAIN *powner, SIZE request_le
     return ptr;
 }
 
-ION_ALLOCATION_CHAIN *_ion_alloc_block(SIZE min_needed)
+// the allocator an owner's chain takes its blocks from: its own, or the
+// default one if that allocates blocks itself. NULL is the page pool
+ION_ALLOCATOR *_ion_alloc_chain_allocator(ION_ALLOCATOR *allocator)
+{
+    if (allocator) return allocator;
+    if (g_ion_allocator && g_ion_allocator->alloc_block) return g_ion_allocator;
+    return NULL;
+}
+
+ION_ALLOCATION_CHAIN *_ion_alloc_block(SIZE min_needed, ION_ALLOCATOR *allocator, void *owner, ION_ALLOC_STATS *stats)
 {
     ION_ALLOCATION_CHAIN *new_block;
     SIZE                  alloc_size = min_needed + sizeof(ION_ALLOCATION_CHAIN); // subtract out the block[1]
-
-    if (alloc_size > g_ion_alloc_page_list.page_size) {
+    BOOL                  from_pool = FALSE;
+    int                   source = ION_ALLOC_SOURCE_OTHER;
+
+    if (allocator) {
+        // the allocator's blocks don't go through the pool, but they're
+        // never smaller than a page, so a chain grows the same way either way
+        if (alloc_size < g_ion_alloc_page_list.page_size) {
+            alloc_size = g_ion_alloc_page_list.page_size;
+        }
+        if (allocator->alloc_block) {
+            new_block = (ION_ALLOCATION_CHAIN *)allocator->alloc_block(allocator->context, owner, (size_t)alloc_size);
+        }
+        else {
+            new_block = (ION_ALLOCATION_CHAIN *)allocator->alloc(allocator->context, (size_t)alloc_size);
+        }
+        if (new_block) {
+            new_block->size = alloc_size;
+        }
+    }
+    else if (alloc_size > g_ion_alloc_page_list.page_size) {
         // it's an oversize block - we'll ask the system for this one
         new_block = (ION_ALLOCATION_CHAIN *)ion_xalloc(alloc_size);    
-        new_block->size = alloc_size;
+        if (new_block) {
+            new_block->size = alloc_size;
+        }
     }
     else {
         // it's a normal size block - go out to the block pool for it
-        new_block = (ION_ALLOCATION_CHAIN *)_ion_alloc_page();
+        new_block = (ION_ALLOCATION_CHAIN *)_ion_alloc_page(&from_pool);
         if (new_block) {
             new_block->size = g_ion_alloc_page_list.page_size;
         }
+        source = from_pool ? ION_ALLOC_SOURCE_POOL_HIT : ION_ALLOC_SOURCE_POOL_MISS;
     }
     
     // see if we suceeded
     if (!new_block) return NULL;
     
-    new_block->next     = NULL;
-    new_block->head     = NULL;
+    new_block->next      = NULL;
+    new_block->head      = NULL;
+    new_block->allocator = allocator;
+    new_block->stats     = stats;
+    if (stats) {
+        _ion_alloc_stats_add_block(stats, new_block->size, source);
+    }
 
     new_block->position = ION_ALLOC_BLOCK_TO_USER_PTR(new_block);
     new_block->limit    = ((BYTE*)new_block) + new_block->size;
@@ -206,10 +361,23 @@ ION_ALLOCATION_CHAIN *_ion_alloc_block(SIZE min_needed)
     return new_block;
 }
 
-void _ion_free_block(ION_ALLOCATION_CHAIN *pblock)
+void _ion_free_block(ION_ALLOCATION_CHAIN *pblock, void *owner)
 {
+    ION_ALLOCATOR *allocator;
+
     if (!pblock) return;
-    if (pblock->size > g_ion_alloc_page_list.page_size) {
+    if (pblock->stats) {
+        _ion_alloc_stats_remove_block(pblock->stats, pblock->size);
+    }
+    if ((allocator = pblock->allocator) != NULL) {
+        if (allocator->free_block) {
+            allocator->free_block(allocator->context, owner, pblock);
+        }
+        else {
+            allocator->free(allocator->context, pblock);
+        }
+    }
+    else if (pblock->size > g_ion_alloc_page_list.page_size) {
         ion_xfree(pblock);
     }
     else {
@@ -218,27 +386,454 @@ void _ion_free_block(ION_ALLOCATION_CHAIN *pblock)
     return;
 }
 
-void ion_initialize_page_pool(SIZE page_size, int free_page_limit)
+iERR ion_allocator_set_default(ION_ALLOCATOR *allocator)
 {
-    // once the page list is in use, you can't change your mind
-    if (g_ion_alloc_page_list.page_size != ION_ALLOC_PAGE_POOL_PAGE_SIZE_NONE)
-    {
-        return;
+    iENTER;
+
+    if (allocator) {
+        if (!allocator->alloc || !allocator->free) FAILWITH(IERR_INVALID_ARG);
+        if (!allocator->alloc_block != !allocator->free_block) FAILWITH(IERR_INVALID_ARG);
     }
-    
+    // pages already in the pool came from the allocator we have now
+    if (g_ion_alloc_page_list.page_size != ION_ALLOC_PAGE_POOL_PAGE_SIZE_NONE) FAILWITH(IERR_INVALID_STATE);
+
+    g_ion_allocator = allocator;
+
+    iRETURN;
+}
+
+ION_ALLOCATOR *ion_allocator_get_default(void)
+{
+    return g_ion_allocator;
+}
+
+void *_ion_xalloc(SIZE size)
+{
+    return _ion_allocator_alloc(g_ion_allocator, size);
+}
+
+void _ion_xfree(void *ptr)
+{
+    _ion_allocator_free(g_ion_allocator, ptr);
+}
+
+void *_ion_xrealloc(void *ptr, SIZE old_size, SIZE new_size)
+{
+    return _ion_allocator_realloc(g_ion_allocator, ptr, old_size, new_size);
+}
+
+void *_ion_allocator_alloc(ION_ALLOCATOR *allocator, SIZE size)
+{
+    if (!allocator) return malloc(size);
+    return allocator->alloc(allocator->context, (size_t)size);
+}
+
+void _ion_allocator_free(ION_ALLOCATOR *allocator, void *ptr)
+{
+    if (!ptr) return;
+    if (!allocator) {
+        free(ptr);
+    }
+    else {
+        allocator->free(allocator->context, ptr);
+    }
+}
+
+void *_ion_allocator_realloc(ION_ALLOCATOR *allocator, void *ptr, SIZE old_size, SIZE new_size)
+{
+    void *new_ptr;
+
+    if (!allocator) {
+        return realloc(ptr, new_size);
+    }
+    if (allocator->realloc) {
+        return allocator->realloc(allocator->context, ptr, (size_t)old_size, (size_t)new_size);
+    }
+    new_ptr = allocator->alloc(allocator->context, (size_t)new_size);
+    if (new_ptr && ptr) {
+        memcpy(new_ptr, ptr, (old_size < new_size) ? old_size : new_size);
+        allocator->free(allocator->context, ptr);
+    }
+    return new_ptr;
+}
+
+void ion_alloc_stats_enable(BOOL enable)
+{
+#ifdef ION_ALLOC_HAS_THREAD_CACHE
+    __atomic_store_n(&g_ion_alloc_stats_enabled, enable, __ATOMIC_RELAXED);
+#else
+    g_ion_alloc_stats_enabled = enable;
+#endif
+}
+
+BOOL _ion_alloc_stats_is_enabled(void)
+{
+#ifdef ION_ALLOC_HAS_THREAD_CACHE
+    return __atomic_load_n(&g_ion_alloc_stats_enabled, __ATOMIC_RELAXED);
+#else
+    return g_ion_alloc_stats_enabled;
+#endif
+}
+
+iERR ion_alloc_stats_get(ION_ALLOC_STATS *p_stats)
+{
+    iENTER;
+
+    if (!p_stats) FAILWITH(IERR_INVALID_ARG);
+
+    p_stats->bytes        = ION_ALLOC_STAT_GET(bytes);
+    p_stats->peak_bytes   = ION_ALLOC_STAT_GET(peak_bytes);
+    p_stats->blocks       = ION_ALLOC_STAT_GET(blocks);
+    p_stats->owners       = ION_ALLOC_STAT_GET(owners);
+    p_stats->total_bytes  = ION_ALLOC_STAT_GET(total_bytes);
+    p_stats->total_blocks = ION_ALLOC_STAT_GET(total_blocks);
+    p_stats->pool_hits    = ION_ALLOC_STAT_GET(pool_hits);
+    p_stats->pool_misses  = ION_ALLOC_STAT_GET(pool_misses);
+
+    iRETURN;
+}
+
+// counts a new block in an owner's statistics, which belong to the thread
+// using the owner, and in the global ones, which don't
+void _ion_alloc_stats_add_block(ION_ALLOC_STATS *stats, SIZE size, int source)
+{
+    int64_t bytes, peak;
+
+    stats->bytes += size;
+    stats->blocks++;
+    stats->total_bytes += size;
+    stats->total_blocks++;
+    if (stats->bytes > stats->peak_bytes) stats->peak_bytes = stats->bytes;
+
+    bytes = ION_ALLOC_STAT_ADD(bytes, size);
+    ION_ALLOC_STAT_ADD(blocks, 1);
+    ION_ALLOC_STAT_ADD(total_bytes, size);
+    ION_ALLOC_STAT_ADD(total_blocks, 1);
+#ifdef ION_ALLOC_HAS_THREAD_CACHE
+    peak = __atomic_load_n(&g_ion_alloc_stats.peak_bytes, __ATOMIC_RELAXED);
+    while (bytes > peak
+        && !__atomic_compare_exchange_n(&g_ion_alloc_stats.peak_bytes, &peak, bytes, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+    ) {
+        // peak has been reloaded, try again
+    }
+#else
+    peak = g_ion_alloc_stats.peak_bytes;
+    if (bytes > peak) g_ion_alloc_stats.peak_bytes = bytes;
+#endif
+
+    switch (source) {
+    case ION_ALLOC_SOURCE_POOL_HIT:
+        stats->pool_hits++;
+        ION_ALLOC_STAT_ADD(pool_hits, 1);
+        break;
+    case ION_ALLOC_SOURCE_POOL_MISS:
+        stats->pool_misses++;
+        ION_ALLOC_STAT_ADD(pool_misses, 1);
+        break;
+    default:
+        break;
+    }
+}
+
+void _ion_alloc_stats_remove_block(ION_ALLOC_STATS *stats, SIZE size)
+{
+    stats->bytes -= size;
+    stats->blocks--;
+    ION_ALLOC_STAT_ADD(bytes, -(int64_t)size);
+    ION_ALLOC_STAT_ADD(blocks, -1);
+}
+
+void _ion_alloc_stats_add_owner(ION_ALLOC_STATS *stats, int count)
+{
+    stats->owners += count;
+    ION_ALLOC_STAT_ADD(owners, count);
+}
+
+void ion_initialize_page_pool(SIZE page_size, int free_page_limit)
+{
     // we need a min size to hold the pointers we use to maintain the page list
     if (page_size < ION_ALLOC_PAGE_MIN_SIZE) 
     {
         page_size = ION_ALLOC_PAGE_MIN_SIZE;
     }
+
+#ifdef ION_ALLOC_HAS_THREAD_CACHE
+    {
+        // several threads may get here at once through _ion_alloc_owner,
+        // only the first one to set the page size gets to set the pool up
+        SIZE none = ION_ALLOC_PAGE_POOL_PAGE_SIZE_NONE;
+        if (__atomic_compare_exchange_n(&g_ion_alloc_page_list.page_size, &none, page_size, FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            __atomic_store_n(&g_ion_alloc_page_list.free_page_limit, free_page_limit, __ATOMIC_RELAXED);
+        }
+    }
+#else
+    // once the page list is in use, you can't change your mind
+    if (g_ion_alloc_page_list.page_size != ION_ALLOC_PAGE_POOL_PAGE_SIZE_NONE)
+    {
+        return;
+    }
     g_ion_alloc_page_list.page_size       = page_size;
     g_ion_alloc_page_list.free_page_limit = free_page_limit;
+#endif
 
     // TODO: should we pre-allocate the pages?
     
     return;
 }
 
+#ifdef ION_ALLOC_HAS_THREAD_CACHE
+
+void ion_release_page_pool(void)
+{
+    ION_ALLOC_PAGE_CACHE *cache = _ion_alloc_page_cache();
+    ION_ALLOC_PAGE       *page;
+    int                   count;
+
+    // this thread's pages and the shared ones, other threads free
+    // their own pages when they find the pool has changed
+    if (cache) {
+        _ion_alloc_page_cache_spill(cache, 0, TRUE);
+    }
+    page = _ion_alloc_page_shared_take(&count, NULL);
+    _ion_alloc_page_free_chain(page);
+
+    // here we mark the page size to indicate the pool is inactive
+    __atomic_store_n(&g_ion_alloc_page_list.page_size, ION_ALLOC_PAGE_POOL_PAGE_SIZE_NONE, __ATOMIC_RELEASE);
+
+    return;
+}
+
+ION_ALLOC_PAGE *_ion_alloc_page(BOOL *p_from_pool)
+{
+    ION_ALLOC_PAGE_CACHE *cache = _ion_alloc_page_cache();
+    ION_ALLOC_PAGE       *page;
+
+    ASSERT(g_ion_alloc_page_list.page_size != ION_ALLOC_PAGE_POOL_PAGE_SIZE_NONE);
+
+    if (cache) {
+        if (cache->head == NULL) {
+            _ion_alloc_page_cache_refill(cache);
+        }
+        if ((page = cache->head) != NULL) {
+            cache->head = page->next;
+            if (cache->head == NULL) cache->tail = NULL;
+            cache->page_count--;
+            *p_from_pool = TRUE;
+            return page;
+        }
+    }
+    page = ion_xalloc(g_ion_alloc_page_list.page_size);
+    *p_from_pool = FALSE;
+    return page;
+}
+
+void _ion_release_page(ION_ALLOC_PAGE *page)
+{
+    ION_ALLOC_PAGE_CACHE *cache;
+
+    if (page == NULL) return;
+
+    cache = _ion_alloc_page_cache();
+    if (!cache) {
+        // without a cache of our own we don't pool at all
+        ion_xfree(page);
+        return;
+    }
+
+    page->next = cache->head;
+    cache->head = page;
+    if (cache->tail == NULL) cache->tail = page;
+    cache->page_count++;
+
+    if (cache->page_count > ION_ALLOC_PAGE_CACHE_LIMIT) {
+        _ion_alloc_page_cache_spill(cache, ION_ALLOC_PAGE_CACHE_LIMIT / 2, FALSE);
+    }
+    return;
+}
+
+// returns this thread's page cache, creating it on the thread's first
+// use of the pool. NULL if we can't have one, in which case the caller
+// allocates and frees its pages directly
+ION_ALLOC_PAGE_CACHE *_ion_alloc_page_cache(void)
+{
+    ION_ALLOC_PAGE_CACHE *cache;
+
+    if (pthread_once(&g_ion_alloc_page_cache_once, _ion_alloc_page_cache_key_create) != 0) return NULL;
+    if (!g_ion_alloc_page_cache_key_ready) return NULL;
+
+    cache = (ION_ALLOC_PAGE_CACHE *)pthread_getspecific(g_ion_alloc_page_cache_key);
+    if (cache) {
+        if (_ion_alloc_page_cache_is_stale(cache)) {
+            // the pool was released (and maybe set up again) since we cached these
+            _ion_alloc_page_cache_spill(cache, 0, TRUE);
+            cache->page_size = g_ion_alloc_page_list.page_size;
+            cache->allocator = ion_allocator_get_default();
+        }
+        return cache;
+    }
+
+    // the cache itself is bookkeeping that outlives any one default
+    // allocator, so it comes straight from malloc
+    cache = (ION_ALLOC_PAGE_CACHE *)malloc(sizeof(ION_ALLOC_PAGE_CACHE));
+    if (!cache) return NULL;
+    cache->page_size  = g_ion_alloc_page_list.page_size;
+    cache->allocator  = ion_allocator_get_default();
+    cache->page_count = 0;
+    cache->head       = NULL;
+    cache->tail       = NULL;
+    if (pthread_setspecific(g_ion_alloc_page_cache_key, cache) != 0) {
+        free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+BOOL _ion_alloc_page_cache_is_stale(ION_ALLOC_PAGE_CACHE *cache)
+{
+    return cache->page_size != g_ion_alloc_page_list.page_size
+        || cache->allocator != ion_allocator_get_default();
+}
+
+void _ion_alloc_page_cache_key_create(void)
+{
+    g_ion_alloc_page_cache_key_ready = (pthread_key_create(&g_ion_alloc_page_cache_key, _ion_alloc_page_cache_destroy) == 0);
+}
+
+// runs as a thread that has used the pool exits
+void _ion_alloc_page_cache_destroy(void *context)
+{
+    ION_ALLOC_PAGE_CACHE *cache = (ION_ALLOC_PAGE_CACHE *)context;
+
+    if (!cache) return;
+    _ion_alloc_page_cache_spill(cache, 0, _ion_alloc_page_cache_is_stale(cache));
+    free(cache);
+}
+
+// takes the whole shared list for this thread and, if that's more
+// than a thread should keep, gives the excess straight back
+void _ion_alloc_page_cache_refill(ION_ALLOC_PAGE_CACHE *cache)
+{
+    ION_ALLOC_PAGE *head, *tail;
+    int             count;
+
+    ASSERT(cache->head == NULL);
+
+    head = _ion_alloc_page_shared_take(&count, &tail);
+    if (head == NULL) return;
+
+    cache->page_size  = g_ion_alloc_page_list.page_size;
+    cache->allocator  = ion_allocator_get_default();
+    cache->head       = head;
+    cache->tail       = tail;
+    cache->page_count = count;
+    if (count > ION_ALLOC_PAGE_CACHE_LIMIT) {
+        _ion_alloc_page_cache_spill(cache, ION_ALLOC_PAGE_CACHE_LIMIT, FALSE);
+    }
+    return;
+}
+
+// moves all but keep of the thread's pages to the shared list, as many as
+// fit under the pool's free page limit anyway, and frees the rest. With
+// discard they're all freed
+void _ion_alloc_page_cache_spill(ION_ALLOC_PAGE_CACHE *cache, int keep, BOOL discard)
+{
+    ION_ALLOC_PAGE *first, *last, *page;
+    int             count, room, limit, ii;
+
+    if (cache->page_count <= keep) return;
+
+    // the pages after the first keep are the ones that go
+    if (keep > 0) {
+        page = cache->head;
+        for (ii = 1; ii < keep; ii++) {
+            page = page->next;
+        }
+        first = page->next;
+        page->next = NULL;
+        last = cache->tail;
+        cache->tail = page;
+    }
+    else {
+        first = cache->head;
+        last = cache->tail;
+        cache->head = NULL;
+        cache->tail = NULL;
+    }
+    count = cache->page_count - keep;
+    cache->page_count = keep;
+
+    limit = __atomic_load_n(&g_ion_alloc_page_list.free_page_limit, __ATOMIC_RELAXED);
+    if (discard || __atomic_load_n(&g_ion_alloc_page_list.page_size, __ATOMIC_ACQUIRE) == ION_ALLOC_PAGE_POOL_PAGE_SIZE_NONE) {
+        room = 0;
+    }
+    else if (limit == ION_ALLOC_PAGE_POOL_NO_LIMIT) {
+        room = count;
+    }
+    else {
+        // this is only a soft limit, several threads may make room at once
+        room = limit - __atomic_load_n(&g_ion_alloc_page_list.page_count, __ATOMIC_RELAXED);
+    }
+
+    if (room < count) {
+        // free the pages there's no room for off the front of the run
+        for (ii = (room > 0) ? room : 0; ii < count; ii++) {
+            page = first;
+            first = first->next;
+            ION_ALLOC_PAGE_FREE(cache->allocator, page);
+        }
+        count = (room > 0) ? room : 0;
+    }
+    if (count > 0) {
+        _ion_alloc_page_shared_push(first, last, count);
+    }
+    return;
+}
+
+// pushes the run of count pages from first to last onto the shared list
+void _ion_alloc_page_shared_push(ION_ALLOC_PAGE *first, ION_ALLOC_PAGE *last, int count)
+{
+    ION_ALLOC_PAGE *head;
+
+    __atomic_add_fetch(&g_ion_alloc_page_list.page_count, count, __ATOMIC_RELAXED);
+    head = __atomic_load_n(&g_ion_alloc_page_list.head, __ATOMIC_RELAXED);
+    do {
+        last->next = head;
+    } while (!__atomic_compare_exchange_n(&g_ion_alloc_page_list.head, &head, first, TRUE, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    return;
+}
+
+// takes every page on the shared list. Since nothing ever takes single pages
+// off it, the list can't change under us between reading the head and
+// swapping it out (the ABA problem a lock free pop would have)
+ION_ALLOC_PAGE *_ion_alloc_page_shared_take(int *p_count, ION_ALLOC_PAGE **p_tail)
+{
+    ION_ALLOC_PAGE *head, *page;
+    int             count = 0;
+
+    head = __atomic_exchange_n(&g_ion_alloc_page_list.head, NULL, __ATOMIC_ACQUIRE);
+    for (page = head; page; page = page->next) {
+        count++;
+        if (p_tail && page->next == NULL) *p_tail = page;
+    }
+    __atomic_sub_fetch(&g_ion_alloc_page_list.page_count, count, __ATOMIC_RELAXED);
+
+    *p_count = count;
+    return head;
+}
+
+void _ion_alloc_page_free_chain(ION_ALLOC_PAGE *page)
+{
+    ION_ALLOC_PAGE *next;
+
+    for (; page; page = next) {
+        next = page->next;
+        ion_xfree(page);
+    }
+    return;
+}
+
+#else
+
 void ion_release_page_pool(void)
 {
     ION_ALLOC_PAGE *page;
@@ -256,17 +851,19 @@ void ion_release_page_pool(void)
     return;
 }
 
-ION_ALLOC_PAGE *_ion_alloc_page(void)
+ION_ALLOC_PAGE *_ion_alloc_page(BOOL *p_from_pool)
 {
     ION_ALLOC_PAGE *page;
     
     if ((page = g_ion_alloc_page_list.head) != NULL) {
         g_ion_alloc_page_list.head = page->next;
         g_ion_alloc_page_list.page_count--;
+        *p_from_pool = TRUE;
     }
     else {
         ASSERT(g_ion_alloc_page_list.page_size != ION_ALLOC_PAGE_POOL_PAGE_SIZE_NONE);
         page = ion_xalloc(g_ion_alloc_page_list.page_size);
+        *p_from_pool = FALSE;
     }
     return page;
 }
@@ -288,6 +885,8 @@ void _ion_release_page(ION_ALLOC_PAGE *page)
     return;
 }
 
+#endif /* ION_ALLOC_HAS_THREAD_CACHE */
+
 
 
 #ifdef MEM_DEBUG
@@ -398,15 +997,17 @@ void debug_free(const void *addr, const char *file, int line)
 }
 
 void *_dbg_ion_alloc_owner(SIZE len, const char *file, int line)
+{
+    return _dbg_ion_alloc_owner_with_allocator(len, NULL, file, line);
+}
+
+void *_dbg_ion_alloc_owner_with_allocator(SIZE len, ION_ALLOCATOR *allocator, const char *file, int line)
 {
     long                  cmd  = debug_cmd_counter();
     void                 *owner;
-    ION_ALLOCATION_CHAIN *new_chain;
-
-    new_chain = _ion_alloc_block(len);
-    if (!new_chain) return NULL;
 
-    owner = _ion_alloc_with_owner_helper(new_chain, len, FALSE);
+    owner = _ion_alloc_owner_helper(len, _ion_alloc_chain_allocator(allocator), NULL);
+    if (!owner) return NULL;
 
     _dbg_ion_message("___OWNER", ION_ALLOC_USER_PTR_TO_BLOCK(owner), len);
 
@@ -432,17 +1033,33 @@ void *_dbg_ion_alloc_with_owner(hOWNER owner, SIZE length, const char *file, int
 void _dbg_ion_free_owner(hOWNER owner, const char *file, int line)
 {
     long cmd  = debug_cmd_counter();
-    DBG_ION_ALLOCATION_CHAIN *pcurr = ION_ALLOC_USER_PTR_TO_BLOCK(owner);
-    DBG_ION_ALLOCATION_CHAIN *pnext = pcurr->head;
+    DBG_ION_ALLOCATION_CHAIN *powner = ION_ALLOC_USER_PTR_TO_BLOCK(owner);
+    DBG_ION_ALLOCATION_CHAIN *pcurr, *pnext = powner->head;
 
-    _dbg_ion_message("___FREE_OWNER", pcurr, -1);
+    _dbg_ion_message("___FREE_OWNER", powner, -1);
 
-    ion_xfree(pcurr);
+    if (powner->stats) {
+        _ion_alloc_stats_add_owner(powner->stats, -1);
+    }
 
+    // the owner's block goes last, it may hold the statistics
+    // the other blocks are counted in
     while (pnext) {
         pcurr = pnext;
         pnext = pcurr->next;
-        ion_xfree(pcurr);
+        if (pcurr->allocator || pcurr->stats) {
+            _ion_free_block(pcurr, owner);
+        }
+        else {
+            ion_xfree(pcurr);
+        }
+    }
+
+    if (powner->allocator || powner->stats) {
+        _ion_free_block(powner, NULL);
+    }
+    else {
+        ion_xfree(powner);
     }
 }
 
@@ -42,12 +42,16 @@ int ion_binary_len_int_64(int64_t value) {
 }
 
 int ion_binary_len_var_uint_64(uint64_t value) {
+#ifdef ION_BINARY_HAS_WORD_KERNELS
+    return (63 - __builtin_clzll(value | 1)) / 7 + 1;
+#else
     int len = 0;
     do {
         len++;
         value >>=7;
     } while (value > 0);
     return len;
+#endif
 }
 
 // for the signed 7 bit variable length format
@@ -152,6 +156,30 @@ iERR ion_binary_read_var_int_64(ION_STREAM *pstream, int64_t *p_value)
     uint64_t unsignedValue = 0;
     BOOL     is_negative = FALSE;
     int      b;
+    BYTE    *pb, *end;
+
+    // if the whole value is in the current page decode it in place,
+    // otherwise (it straddles the page) fall back to reading byte by byte
+    pb  = ION_SPAN_START(pstream);
+    end = pb + ION_SPAN_AVAILABLE(pstream);
+    if (pb < end) {
+        b = *pb++;
+        is_negative = ((b & 0x40) != 0);
+        unsignedValue = (b & 0x3F);
+        while ((b & 0x80) == 0 && pb < end) {
+            b = *pb++;
+            unsignedValue = (unsignedValue << 7) | (b & 0x7F);
+            if ((b & 0x80) == 0 && (unsignedValue & HIGH_BIT_INT64) != 0) {
+                FAILWITH(IERR_NUMERIC_OVERFLOW);
+            }
+        }
+        if ((b & 0x80) != 0) {
+            ION_SPAN_CONSUME(pstream, (SIZE)(pb - ION_SPAN_START(pstream)));
+            goto return_value;
+        }
+        unsignedValue = 0;
+        is_negative = FALSE;
+    }
 
     // read the first byte
     // first byte doesn't need to shift and has two bits 
@@ -199,6 +227,40 @@ iERR ion_binary_read_var_uint_64(ION_STREAM *pstream, uint64_t *p_value)
     iENTER;
     uint64_t retvalue = 0;
     int      b;
+    BYTE    *pb, *end;
+
+#ifdef ION_BINARY_HAS_WORD_KERNELS
+    if (ION_SPAN_AVAILABLE(pstream) >= ION_BINARY_WORD_KERNEL_BYTES) {
+        b = _ion_binary_decode_var_uint_word(ION_SPAN_START(pstream), &retvalue);
+        if (b > 0) {
+            ION_SPAN_CONSUME(pstream, b);
+            *p_value = retvalue;
+            SUCCEED();
+        }
+        retvalue = 0;
+    }
+#endif
+
+    // if the whole value is in the current page decode it in place,
+    // otherwise (it straddles the page) fall back to reading byte by byte
+    pb  = ION_SPAN_START(pstream);
+    end = pb + ION_SPAN_AVAILABLE(pstream);
+    if (pb < end) {
+        b = *pb++;
+        retvalue = (b & 0x7F);
+        while ((b & 0x80) == 0 && pb < end) {
+            b = *pb++;
+            retvalue = (retvalue << 7) | (b & 0x7F);
+            if ((b & 0x80) == 0 && (retvalue & HIGH_BIT_INT64) != 0) {
+                FAILWITH(IERR_NUMERIC_OVERFLOW);
+            }
+        }
+        if ((b & 0x80) != 0) {
+            ION_SPAN_CONSUME(pstream, (SIZE)(pb - ION_SPAN_START(pstream)));
+            goto return_value;
+        }
+        retvalue = 0;
+    }
 
     // read the first byte
     ION_GET(pstream, b);
@@ -241,10 +303,32 @@ iERR ion_binary_read_uint_64(ION_STREAM *pstream, int32_t len, uint64_t *p_value
     uint64_t retvalue = 0;
     int     b = 0;
 
+    BYTE    *pb;
+
     if (len > sizeof(uint64_t)) {
         FAILWITH(IERR_NUMERIC_OVERFLOW);
     }
 
+#ifdef ION_BINARY_HAS_WORD_KERNELS
+    if (ION_SPAN_AVAILABLE(pstream) >= ION_BINARY_WORD_KERNEL_BYTES) {
+        *p_value = _ion_binary_decode_uint_word(ION_SPAN_START(pstream), len);
+        ION_SPAN_CONSUME(pstream, len);
+        SUCCEED();
+    }
+#endif
+
+    if (len <= ION_SPAN_AVAILABLE(pstream)) {
+        // the whole value is in the current page, so decode it in place
+        pb = ION_SPAN_START(pstream);
+        ION_SPAN_CONSUME(pstream, len);
+        while (len > 0) {
+            retvalue = (retvalue << 8) | *pb++;
+            len--;
+        }
+        *p_value = retvalue;
+        SUCCEED();
+    }
+
     while (len > 0) {
         ION_GET(pstream, b);
         retvalue = (retvalue << 8) | b;
@@ -348,7 +432,6 @@ iERR ion_binary_read_double(ION_STREAM *pstream, int32_t len, double *p_value)
 {
     iENTER;
     uint64_t intvalue = 0;
-    int      b;
 
     ASSERT(pstream != NULL);
     ASSERT(p_value != NULL);
@@ -361,12 +444,8 @@ iERR ion_binary_read_double(ION_STREAM *pstream, int32_t len, double *p_value)
         FAILWITHMSG(IERR_INVALID_BINARY, "Invalid binary size for double typed variable");
     }
 
-    while (len > 0) {
-        ION_GET(pstream, b);
-        intvalue = (intvalue << 8) | b;
-        len--;
-    }
-    if (b < 0) FAILWITH(IERR_UNEXPECTED_EOF); // ION_GET will return EOF's so we can just test the last byte read
+    // read_uint_64 decodes in place when the value is in the current page
+    IONCHECK(ion_binary_read_uint_64(pstream, len, &intvalue));
     
     // int will fix any endian issues since (as far as I can find) the
     // endianness of int and floating point are the same
@@ -581,22 +660,71 @@ iERR ion_binary_write_string_with_td_byte( ION_STREAM *pstream, ION_STRING *str
     iRETURN;
 }
 
+// reserves exactly length bytes of pstream and copies image into them. Only
+// the bytes the value takes may be reserved, the stream may have bytes after
+// them (after a seek back) that must not be touched
+static iERR _ion_binary_put_image( ION_STREAM *pstream, BYTE *image, SIZE length )
+{
+    iENTER;
+    BYTE *dst;
+
+    IONCHECK( ion_stream_reserve( pstream, length, &dst ));
+    memcpy( dst, image, length );
+    IONCHECK( ion_stream_commit( pstream, length ));
+
+    iRETURN;
+}
+
 iERR ion_binary_write_type_desc_with_length( ION_STREAM *pstream, int type, int32_t len )
 {
     iENTER;
+    BYTE image[ TYPE_DESC_WITH_LENGTH_IMAGE_LENGTH ];
+
     ASSERT(pstream != NULL);
 
-    if (len >= ION_lnIsVarLen) {
-        ION_PUT( pstream, makeTypeDescriptor( type, ION_lnIsVarLen ));
-        IONCHECK( ion_binary_write_var_uint_64( pstream, len ));
-    }
-    else {
+    if (len < ION_lnIsVarLen) {
         ION_PUT( pstream, makeTypeDescriptor( type, len ));
+        SUCCEED();
     }
 
+    // the type descriptor and length are encoded together then written in one piece
+    IONCHECK( _ion_binary_put_image( pstream, image, ion_binary_encode_type_desc_with_length( image, type, len )));
+
     iRETURN;
 }
 
+int ion_binary_encode_type_desc_with_length( BYTE *image, int tid, int32_t len )
+{
+    uint64_t value = (uint64_t)len;
+
+    ASSERT(image != NULL);
+    ASSERT(len >= 0);
+
+    if (len < ION_lnIsVarLen) {
+        image[0] = makeTypeDescriptor( tid, len );
+        return ION_BINARY_TYPE_DESC_LENGTH;
+    }
+
+    image[0] = makeTypeDescriptor( tid, ION_lnIsVarLen );
+#ifdef ION_BINARY_HAS_WORD_KERNELS
+    // a 31 bit length is at most 5 bytes, the image has room for the whole word
+    ASSERT(TYPE_DESC_WITH_LENGTH_IMAGE_LENGTH >= ION_BINARY_TYPE_DESC_LENGTH + ION_BINARY_WORD_KERNEL_BYTES);
+    return ION_BINARY_TYPE_DESC_LENGTH + _ion_binary_encode_var_uint_word(image + 1, value);
+#else
+    int ii, var_len;
+
+    // the var uint goes most significant bits first, with the stop flag on the last byte
+    var_len = ion_binary_len_var_uint_64(value);
+    for (ii = var_len; ii > 0; ii--) {
+        image[ii] = (BYTE)(value & 0x7f);
+        value >>= 7;
+    }
+    image[var_len] |= 0x80;
+
+    return ION_BINARY_TYPE_DESC_LENGTH + var_len;
+#endif
+}
+
 iERR ion_binary_write_byte_array(ION_STREAM *pstream, BYTE image[], int startIndex, int endIndex) 
 {
     iENTER;
@@ -619,6 +747,14 @@ iERR ion_binary_write_var_uint_64( ION_STREAM *pstream, uint64_t value )
     ASSERT( VAR_UINT_64_IMAGE_LENGTH == 10);      // we do depend on this in a switch below
     ASSERT( pstream != NULL );
 
+#ifdef ION_BINARY_HAS_WORD_KERNELS
+    if (value <= ION_BINARY_WORD_KERNEL_MAX) {
+        // the kernel stores a whole word, so it goes to image first
+        IONCHECK(_ion_binary_put_image(pstream, image, _ion_binary_encode_var_uint_word(image, value)));
+        SUCCEED();
+    }
+#endif
+
     // the code in the else depends on the value being non-zero or it will
     // encounter a pb edge condition of not writting any bytes into image
     do {
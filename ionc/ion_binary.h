@@ -51,6 +51,7 @@ extern "C" {
 #define UINT_64_IMAGE_LENGTH                    ((SIZE)(sizeof(uint64_t)))
 #define VAR_INT_64_IMAGE_LENGTH                 ((SIZE)(((sizeof(int64_t)*8) / 7) + 1)) /* same as var_uint */
 #define INT_64_IMAGE_LENGTH                     ((SIZE)(sizeof(int64_t) + 1)) /* needs 1 extra byte for sign bit overflow */
+#define TYPE_DESC_WITH_LENGTH_IMAGE_LENGTH      (ION_BINARY_TYPE_DESC_LENGTH + VAR_UINT_64_IMAGE_LENGTH)
 
 
 /** Calculate the length of binary encoded uint.
@@ -121,6 +122,12 @@ ION_API_EXPORT iERR ion_binary_write_string_with_td_byte   ( ION_STREAM *pstream
 
 ION_API_EXPORT iERR ion_binary_write_type_desc_with_length ( ION_STREAM *pstream, int tid, int32_t len );
 
+/** Encode the same bytes as ion_binary_write_type_desc_with_length into image,
+ *  which needs room for TYPE_DESC_WITH_LENGTH_IMAGE_LENGTH bytes.
+ *  Returns the number of bytes used.
+ */
+ION_API_EXPORT int ion_binary_encode_type_desc_with_length ( BYTE *image, int tid, int32_t len );
+
 /** Write out binary encoded uint.
  *
  */
@@ -142,7 +149,92 @@ ION_API_EXPORT iERR ion_binary_write_var_uint_64(ION_STREAM *pstream, uint64_t v
  *
  */
 ION_API_EXPORT iERR ion_binary_write_var_int_64(ION_STREAM *pstream, int64_t value);
-    
+
+//
+// word at a time kernels for VarUInt and UInt fields that are in memory.
+// They load (or store) 8 bytes at once, so the caller has to have 8 bytes
+// to read (or write) at pb even when the field is shorter, and handle the
+// fields they don't, VarUInts over 8 bytes (56 bits), itself.
+// A VarUInt is 7 bit groups, most significant first, with the high bit
+// set on the last byte: decoding finds that byte from the mask of high bits,
+// byte swaps the bytes before it into place and packs the groups together,
+// with pext where the compiler targets BMI2 and with 3 shift and mask steps
+// otherwise. Encoding spreads the value out the same way in reverse.
+//
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define ION_BINARY_HAS_WORD_KERNELS
+
+#include <string.h>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#define ION_BINARY_WORD_KERNEL_BYTES    (8)
+#define ION_BINARY_WORD_KERNEL_MAX      (((uint64_t)1 << 56) - 1) /* the largest VarUInt of 8 bytes */
+
+static inline uint64_t _ion_binary_load_word(const BYTE *pb)
+{
+    uint64_t word;
+    memcpy(&word, pb, sizeof(word));
+    return word;
+}
+
+/** Decodes the VarUInt at pb. Returns its length, or 0 if it's longer than 8 bytes.
+ */
+static inline int _ion_binary_decode_var_uint_word(const BYTE *pb, uint64_t *p_value)
+{
+    uint64_t word = _ion_binary_load_word(pb);
+    uint64_t ends = word & 0x8080808080808080ULL;
+    uint64_t value;
+    int      len;
+
+    if (!ends) return 0;
+    len = (__builtin_ctzll(ends) >> 3) + 1;
+
+    // the VarUInt's bytes, most significant at the bottom, then drop the stop bit
+    value = __builtin_bswap64(word) >> (64 - 8 * len);
+#if defined(__BMI2__)
+    value = _pext_u64(value, 0x7F7F7F7F7F7F7F7FULL);
+#else
+    value &= 0x7F7F7F7F7F7F7F7FULL;
+    value = ((value & 0x7F007F007F007F00ULL) >> 1) | (value & 0x007F007F007F007FULL);
+    value = ((value & 0x3FFF00003FFF0000ULL) >> 2) | (value & 0x00003FFF00003FFFULL);
+    value = ((value & 0x0FFFFFFF00000000ULL) >> 4) | (value & 0x000000000FFFFFFFULL);
+#endif
+    *p_value = value;
+    return len;
+}
+
+/** Decodes the len (0 to 8) byte UInt at pb.
+ */
+static inline uint64_t _ion_binary_decode_uint_word(const BYTE *pb, int len)
+{
+    if (len < 1) return 0;
+    return __builtin_bswap64(_ion_binary_load_word(pb)) >> (64 - 8 * len);
+}
+
+/** Encodes value, which can't be over ION_BINARY_WORD_KERNEL_MAX, as a VarUInt
+ *  at pb, writing all 8 bytes. Returns the VarUInt's length.
+ */
+static inline int _ion_binary_encode_var_uint_word(BYTE *pb, uint64_t value)
+{
+    int      len = (63 - __builtin_clzll(value | 1)) / 7 + 1;
+    uint64_t word;
+
+#if defined(__BMI2__)
+    word = _pdep_u64(value, 0x7F7F7F7F7F7F7F7FULL);
+#else
+    word = ((value & 0x00FFFFFFF0000000ULL) << 4) | (value & 0x000000000FFFFFFFULL);
+    word = ((word  & 0x0FFFC0000FFFC000ULL) << 2) | (word  & 0x00003FFF00003FFFULL);
+    word = ((word  & 0x3F803F803F803F80ULL) << 1) | (word  & 0x007F007F007F007FULL);
+#endif
+    // the least significant group goes last, with the stop bit
+    word = __builtin_bswap64(word | 0x80) >> (64 - 8 * len);
+    memcpy(pb, &word, sizeof(word));
+    return len;
+}
+#endif
+
 
 #ifdef __cplusplus
 }
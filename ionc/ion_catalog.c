@@ -56,6 +56,14 @@ iERR _ion_catalog_open_with_owner_helper(ION_CATALOG **p_pcatalog, hOWNER owner)
     iENTER;
     ION_CATALOG *catalog;
     ION_SYMBOL_TABLE *system;
+    ION_INDEX_OPTIONS index_options = {
+        NULL,                       // void          *_memory_owner;
+        _ion_catalog_compare_fn,    // II_COMPARE_FN  _compare_fn;
+        _ion_catalog_hash_fn,       // II_HASH_FN     _hash_fn;
+        NULL,                       // void          *_fn_context;
+        0,                          // int32_t        _initial_size;  /* number of actual keys */
+        0                           // uint8_t        _density_target_percent; /* whole percent for table size increases 200% is usual (and default) */
+    };
 
     ASSERT(p_pcatalog);
 
@@ -76,6 +84,10 @@ iERR _ion_catalog_open_with_owner_helper(ION_CATALOG **p_pcatalog, hOWNER owner)
     catalog->system_symbol_table = system;
 
     _ion_collection_initialize(owner, &catalog->table_list, sizeof(ION_SYMBOL_TABLE *)); // collection of ION_SYMBOL_TABLE *
+    _ion_collection_initialize(owner, &catalog->names, sizeof(ION_CATALOG_NAME)); // collection of ION_CATALOG_NAME
+
+    index_options._memory_owner = owner;
+    IONCHECK(_ion_index_initialize(&catalog->by_name, &index_options));
 
     *p_pcatalog = catalog;
 
@@ -132,6 +144,8 @@ iERR _ion_catalog_add_symbol_table_helper(ION_CATALOG *pcatalog, ION_SYMBOL_TABL
 {
     iENTER;
     ION_SYMBOL_TABLE **ppsymtab, *pclone, *ptest = NULL;
+    ION_CATALOG_NAME  *pname;
+    int32_t            ii, new_capacity;
 
     ASSERT(pcatalog != NULL);
     ASSERT(psymtab != NULL);
@@ -150,6 +164,12 @@ iERR _ion_catalog_add_symbol_table_helper(ION_CATALOG *pcatalog, ION_SYMBOL_TABL
         psymtab = pclone;
     }
 
+    // tables that import this one look up its symbols without changing
+    // it, which needs its index built before anyone gets to it
+    if (!psymtab->is_locked && !INDEX_IS_ACTIVE(psymtab)) {
+        IONCHECK(_ion_symbol_table_initialize_indices_helper(psymtab));
+    }
+
     // now we attach it
     ppsymtab = _ion_collection_append(&pcatalog->table_list);
     if (!ppsymtab) FAILWITH(IERR_NO_MEMORY);
@@ -157,6 +177,27 @@ iERR _ion_catalog_add_symbol_table_helper(ION_CATALOG *pcatalog, ION_SYMBOL_TABL
 
     psymtab->catalog = pcatalog;
 
+    // and file it under its name, in version order
+    if (ION_STRING_IS_NULL(&psymtab->name)) SUCCEED();
+    pname = _ion_catalog_find_name_helper(pcatalog, &psymtab->name);
+    if (pname == NULL) {
+        pname = (ION_CATALOG_NAME *)_ion_collection_append(&pcatalog->names);
+        if (!pname) FAILWITH(IERR_NO_MEMORY);
+        memset(pname, 0, sizeof(ION_CATALOG_NAME));
+        IONCHECK(ion_string_copy_to_owner(pcatalog->owner, &pname->name, &psymtab->name));
+        IONCHECK(_ion_index_insert(&pcatalog->by_name, pname, pname));
+    }
+    if (pname->table_count >= pname->table_capacity) {
+        new_capacity = pname->table_capacity * 2;
+        if (new_capacity < DEFAULT_CATALOG_VERSIONS) new_capacity = DEFAULT_CATALOG_VERSIONS;
+        IONCHECK(_ion_index_grow_array((void **)&pname->tables, pname->table_capacity, new_capacity, sizeof(pname->tables[0]), TRUE, pcatalog->owner));
+        pname->table_capacity = new_capacity;
+    }
+    ii = _ion_catalog_find_version_helper(pname, psymtab->version);
+    memmove(&pname->tables[ii + 1], &pname->tables[ii], (pname->table_count - ii) * sizeof(pname->tables[0]));
+    pname->tables[ii] = psymtab;
+    pname->table_count++;
+
     iRETURN;
 }
 
@@ -187,8 +228,9 @@ iERR ion_catalog_find_symbol_table(hCATALOG hcatalog, iSTRING name, long version
 iERR _ion_catalog_find_symbol_table_helper(ION_CATALOG *pcatalog, ION_STRING *name, int32_t version, ION_SYMBOL_TABLE **p_psymtab)
 {
     iENTER;
-    ION_SYMBOL_TABLE        *symtab;
-    ION_COLLECTION_CURSOR    symtab_cursor;
+    ION_SYMBOL_TABLE        *symtab = NULL;
+    ION_CATALOG_NAME        *pname;
+    int32_t                  ii;
 
     ASSERT(pcatalog != NULL);
     ASSERT(!ION_STRING_IS_NULL(name));
@@ -199,15 +241,11 @@ iERR _ion_catalog_find_symbol_table_helper(ION_CATALOG *pcatalog, ION_STRING *na
     ) {
         symtab = pcatalog->system_symbol_table;
     }
-    else {
-        ION_COLLECTION_OPEN(&pcatalog->table_list, symtab_cursor);
-        for (;;) {
-            ION_COLLECTION_NEXT(symtab_cursor, symtab);
-            if (!symtab) break;
-            if (symtab->version != version) continue;
-            if (ION_STRING_EQUALS(name, &symtab->name)) break;
+    else if ((pname = _ion_catalog_find_name_helper(pcatalog, name)) != NULL) {
+        ii = _ion_catalog_find_version_helper(pname, version);
+        if (ii < pname->table_count && pname->tables[ii]->version == version) {
+            symtab = pname->tables[ii];
         }
-        ION_COLLECTION_CLOSE(symtab_cursor);
     }
 
     *p_psymtab = symtab;
@@ -241,8 +279,9 @@ iERR ion_catalog_find_best_match(hCATALOG hcatalog, iSTRING name, long version,
 iERR _ion_catalog_find_best_match_helper(ION_CATALOG *pcatalog, ION_STRING *name, int32_t version, ION_SYMBOL_TABLE **p_psymtab)
 {
     iENTER;
-    ION_SYMBOL_TABLE      **ppsymtab, *psymtab, *best = NULL;
-    ION_COLLECTION_CURSOR    symtab_cursor;
+    ION_SYMBOL_TABLE        *best = NULL;
+    ION_CATALOG_NAME        *pname;
+    int32_t                  ii;
 
     ASSERT(pcatalog != NULL);
     ASSERT(!ION_STRING_IS_NULL(name));
@@ -255,29 +294,12 @@ iERR _ion_catalog_find_best_match_helper(ION_CATALOG *pcatalog, ION_STRING *name
     ) {
         best = pcatalog->system_symbol_table;
     }
-    else {
-        ION_COLLECTION_OPEN(&pcatalog->table_list, symtab_cursor);
-        for (;;) {
-            ION_COLLECTION_NEXT(symtab_cursor, ppsymtab);
-            if (!ppsymtab) break;
-            psymtab = *ppsymtab;
-            if (!ION_STRING_EQUALS(name, &psymtab->name)) continue;
-            if (!best) {
-                best = psymtab;
-            }
-            else {
-                if (version > 0 && psymtab->version >= version) {
-                    if (psymtab->version <= best->version) {
-                        best = psymtab;
-                    }
-                }
-                else if (psymtab->version > best->version) {
-                    best = psymtab;
-                }
-            }
-            if (best->version == version) break;
-        }
-        ION_COLLECTION_CLOSE(symtab_cursor);
+    else if ((pname = _ion_catalog_find_name_helper(pcatalog, name)) != NULL && pname->table_count > 0) {
+        // the version asked for, or else the first one after it, or else
+        // (or if any version will do) the latest there is
+        ii = (version > 0) ? _ion_catalog_find_version_helper(pname, version) : pname->table_count;
+        if (ii >= pname->table_count) ii = pname->table_count - 1;
+        best = pname->tables[ii];
     }
     *p_psymtab = best;
     SUCCEED();
@@ -302,16 +324,36 @@ iERR ion_catalog_release_symbol_table(hCATALOG hcatalog, hSYMTAB hsymtab)
     iRETURN;
 }
 
+iERR ion_catalog_get_alloc_stats(hCATALOG hcatalog, ION_ALLOC_STATS *p_stats)
+{
+    iENTER;
+    ION_CATALOG *catalog;
+
+    if (hcatalog == NULL) FAILWITH(IERR_INVALID_ARG);
+    if (p_stats == NULL)  FAILWITH(IERR_INVALID_ARG);
+
+    catalog = HANDLE_TO_PTR(hcatalog, ION_CATALOG);
+
+    memset(p_stats, 0, sizeof(*p_stats));
+    _ion_alloc_owner_add_stats(catalog->owner, p_stats);
+
+    iRETURN;
+}
+
 iERR _ion_catalog_release_symbol_table_helper(ION_CATALOG *pcatalog, ION_SYMBOL_TABLE *psymtab)
 {
     iENTER;
-    ION_SYMBOL_TABLE *test;
+    ION_SYMBOL_TABLE      *test, **ppsymtab;
+    ION_CATALOG_NAME      *pname;
+    ION_COLLECTION_CURSOR  symtab_cursor;
+    int32_t                ii;
 
     ASSERT(pcatalog != NULL);
     ASSERT(psymtab != NULL);
 
     // if this symbol table is "foriegn" get "our copy" of the table
     if (psymtab->owner != pcatalog->owner) {
+        if (ION_STRING_IS_NULL(&psymtab->name)) SUCCEED();
         IONCHECK(_ion_catalog_find_symbol_table_helper(pcatalog, &psymtab->name, psymtab->version, &test));
         if (!test) {
             // TODO: again - is this just fine (the table's already released)
@@ -319,9 +361,31 @@ iERR _ion_catalog_release_symbol_table_helper(ION_CATALOG *pcatalog, ION_SYMBOL_
             // FAILWITH(IERR_SYMBOL_TABLE_NOT_FOUND);
             SUCCEED();
         }
+        psymtab = test;
     }
 
-    _ion_collection_remove(&pcatalog->table_list, psymtab);
+    if (!ION_STRING_IS_NULL(&psymtab->name)) {
+        pname = _ion_catalog_find_name_helper(pcatalog, &psymtab->name);
+        if (pname) {
+            ii = _ion_catalog_find_version_helper(pname, psymtab->version);
+            if (ii < pname->table_count && pname->tables[ii] == psymtab) {
+                pname->table_count--;
+                memmove(&pname->tables[ii], &pname->tables[ii + 1], (pname->table_count - ii) * sizeof(pname->tables[0]));
+            }
+        }
+    }
+
+    ION_COLLECTION_OPEN(&pcatalog->table_list, symtab_cursor);
+    for (;;) {
+        ION_COLLECTION_NEXT(symtab_cursor, ppsymtab);
+        if (!ppsymtab) break;
+        if (*ppsymtab == psymtab) break;
+    }
+    ION_COLLECTION_CLOSE(symtab_cursor);
+
+    if (ppsymtab) {
+        _ion_collection_remove(&pcatalog->table_list, ppsymtab);
+    }
 
     iRETURN;
 }
@@ -351,3 +415,67 @@ iERR _ion_catalog_close_helper(ION_CATALOG *pcatalog)
     return IERR_OK;
 }
 
+ION_CATALOG_NAME *_ion_catalog_find_name_helper(ION_CATALOG *pcatalog, ION_STRING *name)
+{
+    ION_CATALOG_NAME key;
+
+    ASSERT(pcatalog != NULL);
+    ASSERT(!ION_STRING_IS_NULL(name));
+
+    // dummy up an entry with the right key
+    key.name.length = name->length;
+    key.name.value  = name->value;
+
+    return (ION_CATALOG_NAME *)_ion_index_find(&pcatalog->by_name, &key);
+}
+
+// the first of the name's tables whose version is at least version, which
+// is table_count if they're all older
+int32_t _ion_catalog_find_version_helper(ION_CATALOG_NAME *pname, int32_t version)
+{
+    int32_t low = 0, high = pname->table_count, mid;
+
+    while (low < high) {
+        mid = low + (high - low) / 2;
+        if (pname->tables[mid]->version < version) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+int_fast8_t _ion_catalog_compare_fn(void *key1, void *key2, void *context)
+{
+    int_fast8_t       cmp;
+    ION_CATALOG_NAME *name1 = (ION_CATALOG_NAME *)key1;
+    ION_CATALOG_NAME *name2 = (ION_CATALOG_NAME *)key2;
+
+    ASSERT(name1);
+    ASSERT(name2);
+
+    // this compare is for the purposes of the hash table only !
+    if (name1 == name2) {
+        cmp = 0;
+    }
+    else if ((cmp = (name1->name.length - name2->name.length)) != 0) {
+        cmp = (cmp > 0) ? 1 : -1; // normalize the value
+    }
+    else {
+        cmp = (memcmp(name1->name.value, name2->name.value, name1->name.length) != 0);
+    }
+    return cmp;
+}
+
+int_fast32_t _ion_catalog_hash_fn(void *key, void *context)
+{
+    ION_CATALOG_NAME *pname = (ION_CATALOG_NAME *)key;
+
+    ASSERT(pname);
+
+    // the same hash the symbol tables use for their names, kept positive
+    return (int_fast32_t)(_ion_index_hash_bytes(pname->name.value, pname->name.length) >> 33);
+}
@@ -19,14 +19,28 @@
 extern "C" {
 #endif
 
+// the tables a catalog holds with one name, lowest version first
+typedef struct _ion_catalog_name
+{
+    ION_STRING           name;
+    ION_SYMBOL_TABLE   **tables;
+    int32_t              table_count;
+    int32_t              table_capacity;
+
+} ION_CATALOG_NAME;
+
 struct _ion_catalog
 {
     void                *owner;
     ION_SYMBOL_TABLE    *system_symbol_table;
     ION_COLLECTION       table_list;    // collection of ION_SYMBOL_TABLE *
+    ION_COLLECTION       names;         // collection of ION_CATALOG_NAME
+    ION_INDEX            by_name;       // the names, so finding a table doesn't walk table_list
 
 };
 
+#define DEFAULT_CATALOG_VERSIONS     2
+
 // internal (pointer based helpers) functions for catalog (in ion_catalog.c)
 iERR _ion_catalog_open_with_owner_helper(ION_CATALOG **p_pcatalog, hOWNER owner);
 iERR _ion_catalog_get_symbol_table_count_helper(ION_CATALOG *pcatalog, int32_t *p_count);
@@ -36,6 +50,11 @@ iERR _ion_catalog_find_best_match_helper(ION_CATALOG *pcatalog, ION_STRING *name
 iERR _ion_catalog_release_symbol_table_helper(ION_CATALOG *pcatalog, ION_SYMBOL_TABLE *psymtab);
 iERR _ion_catalog_close_helper(ION_CATALOG *pcatalog);
 
+ION_CATALOG_NAME *_ion_catalog_find_name_helper(ION_CATALOG *pcatalog, ION_STRING *name);
+int32_t      _ion_catalog_find_version_helper(ION_CATALOG_NAME *pname, int32_t version);
+int_fast8_t  _ion_catalog_compare_fn(void *key1, void *key2, void *context);
+int_fast32_t _ion_catalog_hash_fn   (void *key, void *context);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,292 @@
+/*
+ * Copyright 2009-2016 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at:
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+//
+// the extractor walks a reader down the paths it's been given, calling
+// back for the values at their ends. At each depth the paths still being
+// followed are a bit set, so matching a value is a pass over the paths in
+// the set and nothing is stepped into unless one of them goes on into it
+//
+
+#include "ion_internal.h"
+
+#define ION_EXTRACTOR_PATH_BIT(id) (((ION_EXTRACTOR_PATH_SET)1) << (id))
+
+iERR ion_extractor_open(hEXTRACTOR *p_hextractor)
+{
+    iENTER;
+    ION_EXTRACTOR *extractor;
+
+    if (p_hextractor == NULL) FAILWITH(IERR_INVALID_ARG);
+
+    extractor = (ION_EXTRACTOR *)ion_alloc_owner(sizeof(*extractor));
+    if (extractor == NULL) FAILWITH(IERR_NO_MEMORY);
+    memset(extractor, 0, sizeof(*extractor));
+
+    *p_hextractor = PTR_TO_HANDLE(extractor);
+
+    iRETURN;
+}
+
+iERR ion_extractor_add_path(hEXTRACTOR hextractor, const char *path, ION_EXTRACTOR_CALLBACK fn_callback, void *context, int32_t *p_path_id)
+{
+    iENTER;
+    ION_EXTRACTOR      *extractor;
+    ION_EXTRACTOR_PATH *ppath;
+
+    if (hextractor == NULL)  FAILWITH(IERR_INVALID_ARG);
+    if (path == NULL)        FAILWITH(IERR_INVALID_ARG);
+    if (fn_callback == NULL) FAILWITH(IERR_INVALID_ARG);
+
+    extractor = HANDLE_TO_PTR(hextractor, ION_EXTRACTOR);
+    if (extractor->path_count >= ION_EXTRACTOR_MAX_PATHS) FAILWITH(IERR_TOO_MANY_PATHS);
+
+    ppath = &extractor->paths[extractor->path_count];
+    memset(ppath, 0, sizeof(*ppath));
+    IONCHECK(_ion_extractor_parse_path(extractor, path, ppath));
+    ppath->fn_callback = fn_callback;
+    ppath->context     = context;
+
+    if (p_path_id) *p_path_id = extractor->path_count;
+    extractor->path_count++;
+
+    iRETURN;
+}
+
+iERR _ion_extractor_parse_path(ION_EXTRACTOR *pextractor, const char *path, ION_EXTRACTOR_PATH *ppath)
+{
+    iENTER;
+    ION_EXTRACTOR_STEP *pstep;
+    ION_STRING          name;
+    const char         *pc, *start;
+    SIZE                max_steps;
+    int32_t             index, ii;
+
+    ASSERT(pextractor);
+    ASSERT(path);
+    ASSERT(ppath);
+
+    // every step takes at least one character
+    max_steps = (SIZE)strlen(path) + 1;
+    ppath->steps = (ION_EXTRACTOR_STEP *)ion_alloc_with_owner(pextractor, max_steps * sizeof(ION_EXTRACTOR_STEP));
+    ppath->projection = (ION_STRING *)ion_alloc_with_owner(pextractor, max_steps * sizeof(ION_STRING));
+    if (ppath->steps == NULL || ppath->projection == NULL) FAILWITH(IERR_NO_MEMORY);
+
+    for (pc = path; *pc; ppath->length++) {
+        pstep = &ppath->steps[ppath->length];
+        memset(pstep, 0, sizeof(*pstep));
+
+        if (*pc == '[') {
+            pc++;
+            if (*pc == '*') {
+                pstep->type = ION_EXTRACTOR_STEP_ANY_INDEX;
+                pc++;
+            }
+            else {
+                if (*pc < '0' || *pc > '9') FAILWITH(IERR_INVALID_SYNTAX);
+                for (index = 0; *pc >= '0' && *pc <= '9'; pc++) {
+                    if (index > (INT32_MAX - 9) / 10) FAILWITH(IERR_INVALID_SYNTAX);
+                    index = index * 10 + (*pc - '0');
+                }
+                pstep->type  = ION_EXTRACTOR_STEP_INDEX;
+                pstep->index = index;
+            }
+            if (*pc != ']') FAILWITH(IERR_INVALID_SYNTAX);
+            pc++;
+            continue;
+        }
+
+        if (ppath->length > 0) {
+            if (*pc != '.') FAILWITH(IERR_INVALID_SYNTAX);
+            pc++;
+        }
+        for (start = pc; *pc && *pc != '.' && *pc != '[' && *pc != ']'; pc++) {
+            // just looking for the end of the name
+        }
+        if (pc == start) FAILWITH(IERR_INVALID_SYNTAX);
+
+        if (pc - start == 1 && *start == '*') {
+            pstep->type = ION_EXTRACTOR_STEP_ANY_FIELD;
+        }
+        else {
+            pstep->type = ION_EXTRACTOR_STEP_FIELD;
+            ion_string_assign_cstr(&name, (char *)start, (SIZE)(pc - start));
+            IONCHECK(ion_string_copy_to_owner(pextractor, &pstep->name, &name));
+        }
+    }
+
+    // the reader only has to return the fields named on the way down to the
+    // first *, lists don't count as steps in a projection
+    for (ii = 0; ii < ppath->length; ii++) {
+        pstep = &ppath->steps[ii];
+        if (pstep->type == ION_EXTRACTOR_STEP_ANY_FIELD) break;
+        if (pstep->type == ION_EXTRACTOR_STEP_FIELD) {
+            ppath->projection[ppath->projection_length++] = pstep->name;
+        }
+    }
+
+    iRETURN;
+}
+
+iERR ion_extractor_match(hEXTRACTOR hextractor, hREADER hreader)
+{
+    iENTER;
+    ION_EXTRACTOR          *extractor;
+    ION_EXTRACTOR_PATH_SET  all;
+    SIZE                    depth;
+    int32_t                 ii;
+    BOOL                    projected = FALSE;
+
+    if (hextractor == NULL) FAILWITH(IERR_INVALID_ARG);
+    if (hreader == NULL)    FAILWITH(IERR_INVALID_ARG);
+
+    extractor = HANDLE_TO_PTR(hextractor, ION_EXTRACTOR);
+
+    IONCHECK(ion_reader_get_depth(hreader, &depth));
+    if (depth != 0) FAILWITH(IERR_INVALID_STATE);
+
+    // a path with no field names before a * needs every field read
+    IONCHECK(ion_reader_clear_projection(hreader));
+    projected = TRUE;
+    for (ii = 0; ii < extractor->path_count; ii++) {
+        if (extractor->paths[ii].projection_length < 1) break;
+    }
+    if (ii == extractor->path_count) {
+        for (ii = 0; ii < extractor->path_count; ii++) {
+            IONCHECK(ion_reader_add_projection_path(hreader, extractor->paths[ii].projection, extractor->paths[ii].projection_length));
+        }
+    }
+
+    all = (extractor->path_count == ION_EXTRACTOR_MAX_PATHS)
+        ? ~(ION_EXTRACTOR_PATH_SET)0
+        : ION_EXTRACTOR_PATH_BIT(extractor->path_count) - 1;
+    IONCHECK(_ion_extractor_match_values(extractor, hreader, -1, all, tid_DATAGRAM));
+
+    projected = FALSE;
+    IONCHECK(ion_reader_clear_projection(hreader));
+    SUCCEED();
+
+fail:
+    // don't leave the reader skipping fields when matching stops early
+    if (projected) {
+        _ion_reader_clear_projection_helper(HANDLE_TO_PTR(hreader, ION_READER));
+    }
+    RETURN(__location_name__, __line__, __count__++, err);
+}
+
+// matches the values in the container the reader is in against step of each
+// of paths, step -1 being the top level values themselves
+iERR _ion_extractor_match_values(ION_EXTRACTOR *pextractor, hREADER hreader, int32_t step, ION_EXTRACTOR_PATH_SET paths, ION_TYPE container_type)
+{
+    iENTER;
+    ION_EXTRACTOR_PATH     *ppath;
+    ION_EXTRACTOR_STEP     *pstep;
+    ION_EXTRACTOR_PATH_SET  matched, deeper;
+    ION_TYPE                type;
+    ION_STRING              field_name;
+    BOOL                    in_struct = (container_type == tid_STRUCT);
+    BOOL                    in_sequence = (container_type == tid_LIST || container_type == tid_SEXP);
+    BOOL                    any_index = FALSE, has_field_name, is_null;
+    int32_t                 index, max_index = -1, ii;
+
+    ASSERT(pextractor);
+
+    // past the last index the paths want the rest of a list can be skipped
+    if (in_sequence) {
+        for (ii = 0; ii < pextractor->path_count; ii++) {
+            if (!(paths & ION_EXTRACTOR_PATH_BIT(ii))) continue;
+            pstep = &pextractor->paths[ii].steps[step];
+            if (pstep->type == ION_EXTRACTOR_STEP_ANY_INDEX) any_index = TRUE;
+            if (pstep->type == ION_EXTRACTOR_STEP_INDEX && pstep->index > max_index) max_index = pstep->index;
+        }
+    }
+
+    for (index = 0; ; index++) {
+        if (in_sequence && !any_index && index > max_index) break;
+
+        IONCHECK(ion_reader_next(hreader, &type));
+        if (type == tid_EOF) break;
+
+        if (step < 0) {
+            matched = paths;
+        }
+        else {
+            matched = 0;
+            has_field_name = FALSE;
+            for (ii = 0; ii < pextractor->path_count; ii++) {
+                if (!(paths & ION_EXTRACTOR_PATH_BIT(ii))) continue;
+                pstep = &pextractor->paths[ii].steps[step];
+                switch (pstep->type) {
+                case ION_EXTRACTOR_STEP_FIELD:
+                    if (!in_struct) break;
+                    if (!has_field_name) {
+                        IONCHECK(ion_reader_get_field_name(hreader, &field_name));
+                        has_field_name = TRUE;
+                    }
+                    if (ION_STRING_EQUALS(&field_name, &pstep->name)) matched |= ION_EXTRACTOR_PATH_BIT(ii);
+                    break;
+                case ION_EXTRACTOR_STEP_ANY_FIELD:
+                    if (in_struct) matched |= ION_EXTRACTOR_PATH_BIT(ii);
+                    break;
+                case ION_EXTRACTOR_STEP_INDEX:
+                    if (in_sequence && index == pstep->index) matched |= ION_EXTRACTOR_PATH_BIT(ii);
+                    break;
+                case ION_EXTRACTOR_STEP_ANY_INDEX:
+                    if (in_sequence) matched |= ION_EXTRACTOR_PATH_BIT(ii);
+                    break;
+                default:
+                    FAILWITH(IERR_INVALID_STATE);
+                }
+            }
+        }
+        if (!matched) continue;
+
+        // the paths that end here get the value, the others go on into it
+        deeper = 0;
+        for (ii = 0; ii < pextractor->path_count; ii++) {
+            if (!(matched & ION_EXTRACTOR_PATH_BIT(ii))) continue;
+            ppath = &pextractor->paths[ii];
+            if (ppath->length == step + 1) {
+                IONCHECK((*ppath->fn_callback)(hreader, ii, ppath->context));
+            }
+            else {
+                deeper |= ION_EXTRACTOR_PATH_BIT(ii);
+            }
+        }
+        if (!deeper) continue;
+        if (type != tid_STRUCT && type != tid_LIST && type != tid_SEXP) continue;
+
+        IONCHECK(ion_reader_is_null(hreader, &is_null));
+        if (is_null) continue;
+
+        IONCHECK(ion_reader_step_in(hreader));
+        IONCHECK(_ion_extractor_match_values(pextractor, hreader, step + 1, deeper, type));
+        IONCHECK(ion_reader_step_out(hreader));
+    }
+
+    iRETURN;
+}
+
+iERR ion_extractor_close(hEXTRACTOR hextractor)
+{
+    iENTER;
+    ION_EXTRACTOR *extractor;
+
+    if (hextractor == NULL) FAILWITH(IERR_INVALID_ARG);
+
+    extractor = HANDLE_TO_PTR(hextractor, ION_EXTRACTOR);
+    ion_free_owner(extractor);
+
+    iRETURN;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2009-2016 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at:
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#ifndef ION_EXTRACTOR_IMPL_H_
+#define ION_EXTRACTOR_IMPL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum _ion_extractor_step_type
+{
+    ION_EXTRACTOR_STEP_FIELD     = 0,   // name
+    ION_EXTRACTOR_STEP_ANY_FIELD = 1,   // *
+    ION_EXTRACTOR_STEP_INDEX     = 2,   // [n]
+    ION_EXTRACTOR_STEP_ANY_INDEX = 3    // [*]
+} ION_EXTRACTOR_STEP_TYPE;
+
+typedef struct _ion_extractor_step
+{
+    ION_EXTRACTOR_STEP_TYPE type;
+    ION_STRING              name;       // for ION_EXTRACTOR_STEP_FIELD
+    int32_t                 index;      // for ION_EXTRACTOR_STEP_INDEX
+} ION_EXTRACTOR_STEP;
+
+typedef struct _ion_extractor_path
+{
+    ION_EXTRACTOR_STEP     *steps;
+    int32_t                 length;
+    ION_STRING             *projection;         // the field names before the first *, for the reader's projection
+    int32_t                 projection_length;
+    ION_EXTRACTOR_CALLBACK  fn_callback;
+    void                   *context;
+} ION_EXTRACTOR_PATH;
+
+// a set of paths, one bit per path id
+typedef uint64_t ION_EXTRACTOR_PATH_SET;
+
+struct _ion_extractor
+{
+    ION_EXTRACTOR_PATH      paths[ION_EXTRACTOR_MAX_PATHS];
+    int32_t                 path_count;
+};
+
+iERR _ion_extractor_parse_path(ION_EXTRACTOR *pextractor, const char *path, ION_EXTRACTOR_PATH *ppath);
+iERR _ion_extractor_match_values(ION_EXTRACTOR *pextractor, hREADER hreader, int32_t step, ION_EXTRACTOR_PATH_SET paths, ION_TYPE container_type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ION_EXTRACTOR_IMPL_H_ */
@@ -45,6 +45,8 @@
 #ifndef ION_INDEX_H_
 #define ION_INDEX_H_
 
+#include <string.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -136,6 +138,77 @@ void  _ion_index_release   (ION_INDEX *index);
 
 iERR _ion_index_grow_array(void **p_array, int32_t old_count, int32_t new_count, int32_t entry_size, BOOL with_copy, void *owner);
 
+// a 64 bit hash of a run of bytes for the symbol and catalog name lookups,
+// after wyhash: the bytes are read 8 at a time (as overlapping 4 byte reads
+// up to 16) and folded in with 64x64->128 bit multiplies, so a short
+// name costs a couple of multiplies instead of a step per byte. The value
+// only has to be stable within the process, so byte order doesn't matter.
+//
+#define II_HASH_SECRET_0    0xa0761d6478bd642fULL
+#define II_HASH_SECRET_1    0xe7037ed1a0b428dbULL
+#define II_HASH_SECRET_2    0x8ebc6af09c88c6e3ULL
+
+static inline uint64_t _ion_index_hash_mix(uint64_t a, uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+#else
+    uint64_t ha = a >> 32, la = (uint32_t)a, hb = b >> 32, lb = (uint32_t)b;
+    uint64_t hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+    uint64_t mid = hl + (ll >> 32) + (uint32_t)lh;
+    uint64_t lo = (mid << 32) | (uint32_t)ll;
+    uint64_t hi = hh + (mid >> 32) + (lh >> 32);
+    return lo ^ hi;
+#endif
+}
+
+static inline uint64_t _ion_index_hash_read_8(const BYTE *pb)
+{
+    uint64_t word;
+    memcpy(&word, pb, sizeof(word));
+    return word;
+}
+
+static inline uint64_t _ion_index_hash_read_4(const BYTE *pb)
+{
+    uint32_t word;
+    memcpy(&word, pb, sizeof(word));
+    return word;
+}
+
+static inline uint64_t _ion_index_hash_bytes(const BYTE *pb, SIZE len)
+{
+    uint64_t seed = II_HASH_SECRET_0;
+    uint64_t a, b;
+    SIZE     remaining = len;
+
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (_ion_index_hash_read_4(pb) << 32) | _ion_index_hash_read_4(pb + ((len >> 3) << 2));
+            b = (_ion_index_hash_read_4(pb + len - 4) << 32) | _ion_index_hash_read_4(pb + len - 4 - ((len >> 3) << 2));
+        }
+        else if (len > 0) {
+            a = ((uint64_t)pb[0] << 16) | ((uint64_t)pb[len >> 1] << 8) | pb[len - 1];
+            b = 0;
+        }
+        else {
+            a = b = 0;
+        }
+    }
+    else {
+        while (remaining > 16) {
+            seed = _ion_index_hash_mix(_ion_index_hash_read_8(pb) ^ II_HASH_SECRET_1, _ion_index_hash_read_8(pb + 8) ^ seed);
+            pb += 16;
+            remaining -= 16;
+        }
+        a = _ion_index_hash_read_8(pb + remaining - 16);
+        b = _ion_index_hash_read_8(pb + remaining - 8);
+    }
+
+    return _ion_index_hash_mix(II_HASH_SECRET_1 ^ (uint64_t)len, _ion_index_hash_mix(a ^ II_HASH_SECRET_1, b ^ seed) ^ II_HASH_SECRET_2);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -73,6 +73,8 @@ typedef struct _ion_header {
 #include "ion_symbol_table_impl.h"
 #include "ion_collection_impl.h"
 #include "ion_catalog_impl.h"
+#include "ion_extractor_impl.h"
+#include "ion_offset_index_impl.h"
 #include "ion_timestamp_impl.h"
 #include "ion_helpers.h"
 #include "decQuadHelpers.h"
@@ -111,6 +113,14 @@ GLOBAL BOOL _debug_on           INITTO(TRUE);
                                   IONCHECK(ion_stream_read_byte((xh), &(xb)));  \
                                 } while(FALSE)
 
+// macros for reading in place, the bytes from _curr up to _limit are in memory
+// (the current page or user buffer) so a value that lies entirely in that span
+// can be decoded directly, a value that straddles the limit has to go through
+// ION_GET (which fetches the next page) a byte at a time
+#define ION_SPAN_START(xh)      ((xh)->_curr)
+#define ION_SPAN_AVAILABLE(xh)  ((SIZE)((xh)->_limit - (xh)->_curr))
+#define ION_SPAN_CONSUME(xh,n)  ((xh)->_curr += (n))
+
 // macro for read_byte
 #define OLD__ION_PUT(xh, xb)   if (((xh)->_curr < ((xh)->_buffer + (xh)->_buffer_size) && ((xh)->_dirty_start != NULL) ))  {  \
                                  *((xh)->_curr) = (xb);                                             \
@@ -0,0 +1,558 @@
+/*
+ * Copyright 2009-2016 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at:
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+//
+// the offset index keeps the start of every top level value of a stream,
+// and which symbol table each one was read with. A symbol table is known
+// by the first value read with it, since the reader can get it back by
+// reading from the value before (or the start of the stream) up to there.
+//
+// written out the index is a single struct:
+//
+//    $ion_offset_index::{
+//        version: 1,
+//        text: false,
+//        symbol_tables: [ first value, ... ],
+//        values: [ gap, length, ... ]                 in binary
+//        values: [ delta, line delta, line offset, ... ]   in text
+//    }
+//
+// where gap is the bytes between the end of the previous value and the
+// start of this one and delta the bytes between their starts
+//
+
+#include "ion_internal.h"
+
+#define ION_OFFSET_INDEX_ANNOTATION     "$ion_offset_index"
+
+iERR ion_offset_index_open(hOFFSET_INDEX *p_hindex)
+{
+    iENTER;
+    ION_OFFSET_INDEX *index;
+
+    if (p_hindex == NULL) FAILWITH(IERR_INVALID_ARG);
+
+    index = (ION_OFFSET_INDEX *)ion_alloc_owner(sizeof(*index));
+    if (index == NULL) FAILWITH(IERR_NO_MEMORY);
+    memset(index, 0, sizeof(*index));
+
+    index->seek_symtab_id = -1;
+
+    *p_hindex = PTR_TO_HANDLE(index);
+
+    iRETURN;
+}
+
+iERR ion_offset_index_add_value(hOFFSET_INDEX hindex, hREADER hreader)
+{
+    iENTER;
+    ION_OFFSET_INDEX       *index;
+    ION_OFFSET_INDEX_VALUE *pvalue;
+    ION_READER             *preader;
+    ION_TYPE                type;
+    BOOL                    is_text;
+
+    if (hindex == NULL)  FAILWITH(IERR_INVALID_ARG);
+    if (hreader == NULL) FAILWITH(IERR_INVALID_ARG);
+
+    index   = HANDLE_TO_PTR(hindex, ION_OFFSET_INDEX);
+    preader = HANDLE_TO_PTR(hreader, ION_READER);
+
+    if (preader->_depth != 0) FAILWITH(IERR_INVALID_STATE);
+    IONCHECK(ion_reader_get_type(hreader, &type));
+    if (type == tid_EOF || type == tid_none) FAILWITH(IERR_INVALID_STATE);
+
+    is_text = (preader->type == ion_type_text_reader);
+    if (index->value_count == 0) {
+        index->is_text = is_text;
+    }
+    else if (index->is_text != is_text) {
+        FAILWITH(IERR_INVALID_ARG);
+    }
+
+    // a version marker or local symbol table since the last value means
+    // this one starts a new symbol table
+    if (index->value_count == 0 || preader->_symtab_generation != index->build_generation) {
+        IONCHECK(_ion_offset_index_add_symtab(index, index->value_count));
+        index->build_generation = preader->_symtab_generation;
+    }
+
+    IONCHECK(_ion_offset_index_append(index, &pvalue));
+    IONCHECK(ion_reader_get_value_offset(hreader, &pvalue->offset));
+    if (is_text) {
+        pvalue->length = -1;
+        IONCHECK(_ion_reader_text_get_value_line(preader, &pvalue->line, &pvalue->line_offset));
+    }
+    else {
+        IONCHECK(ion_reader_get_value_length(hreader, &pvalue->length));
+        pvalue->line        = 0;
+        pvalue->line_offset = 0;
+    }
+
+    iRETURN;
+}
+
+iERR ion_offset_index_build(hOFFSET_INDEX hindex, hREADER hreader)
+{
+    iENTER;
+    ION_TYPE type;
+
+    if (hindex == NULL)  FAILWITH(IERR_INVALID_ARG);
+    if (hreader == NULL) FAILWITH(IERR_INVALID_ARG);
+
+    for (;;) {
+        IONCHECK(ion_reader_next(hreader, &type));
+        if (type == tid_EOF) break;
+        IONCHECK(ion_offset_index_add_value(hindex, hreader));
+    }
+
+    iRETURN;
+}
+
+iERR ion_offset_index_get_count(hOFFSET_INDEX hindex, int64_t *p_count)
+{
+    iENTER;
+    ION_OFFSET_INDEX *index;
+
+    if (hindex == NULL)  FAILWITH(IERR_INVALID_ARG);
+    if (p_count == NULL) FAILWITH(IERR_INVALID_ARG);
+
+    index = HANDLE_TO_PTR(hindex, ION_OFFSET_INDEX);
+    *p_count = index->value_count;
+
+    iRETURN;
+}
+
+iERR ion_offset_index_get_entry(hOFFSET_INDEX hindex, int64_t value, ION_OFFSET_INDEX_ENTRY *p_entry)
+{
+    iENTER;
+    ION_OFFSET_INDEX       *index;
+    ION_OFFSET_INDEX_VALUE *pvalue;
+
+    if (hindex == NULL)  FAILWITH(IERR_INVALID_ARG);
+    if (p_entry == NULL) FAILWITH(IERR_INVALID_ARG);
+
+    index = HANDLE_TO_PTR(hindex, ION_OFFSET_INDEX);
+    if (value < 0 || value >= index->value_count) FAILWITH(IERR_NO_SUCH_ELEMENT);
+
+    pvalue = _ion_offset_index_get_value(index, value);
+    p_entry->offset      = pvalue->offset;
+    p_entry->length      = pvalue->length;
+    p_entry->symtab_id   = _ion_offset_index_find_symtab(index, value);
+    p_entry->line        = pvalue->line;
+    p_entry->line_offset = pvalue->line_offset;
+
+    iRETURN;
+}
+
+iERR ion_offset_index_seek(hOFFSET_INDEX hindex, hREADER hreader, int64_t value)
+{
+    iENTER;
+    ION_OFFSET_INDEX       *index;
+    ION_READER             *preader;
+    int32_t                 symtab_id;
+
+    if (hindex == NULL)  FAILWITH(IERR_INVALID_ARG);
+    if (hreader == NULL) FAILWITH(IERR_INVALID_ARG);
+
+    index   = HANDLE_TO_PTR(hindex, ION_OFFSET_INDEX);
+    preader = HANDLE_TO_PTR(hreader, ION_READER);
+
+    if (value < 0 || value >= index->value_count) FAILWITH(IERR_NO_SUCH_ELEMENT);
+    if (index->is_text != (preader->type == ion_type_text_reader)) FAILWITH(IERR_INVALID_ARG);
+
+    // the symbol table only has to be loaded again if something else has
+    // been put in its place since the last seek loaded it
+    symtab_id = _ion_offset_index_find_symtab(index, value);
+    if (index->seek_reader != preader
+     || index->seek_symtab_id != symtab_id
+     || index->seek_generation != preader->_symtab_generation
+    ) {
+        IONCHECK(_ion_offset_index_load_symtab(index, preader, symtab_id));
+        index->seek_reader     = preader;
+        index->seek_symtab_id  = symtab_id;
+        index->seek_generation = preader->_symtab_generation;
+    }
+
+    IONCHECK(_ion_offset_index_seek_value(index, preader, value));
+
+    iRETURN;
+}
+
+iERR ion_offset_index_write(hOFFSET_INDEX hindex, hWRITER hwriter)
+{
+    iENTER;
+    ION_OFFSET_INDEX       *index;
+    ION_OFFSET_INDEX_VALUE *pvalue;
+    ION_STRING              str;
+    POSITION                end = 0, start = 0;
+    int32_t                 line = 1, ii;
+    int64_t                 value;
+
+    if (hindex == NULL)  FAILWITH(IERR_INVALID_ARG);
+    if (hwriter == NULL) FAILWITH(IERR_INVALID_ARG);
+
+    index = HANDLE_TO_PTR(hindex, ION_OFFSET_INDEX);
+
+    IONCHECK(ion_writer_add_annotation(hwriter, ion_string_assign_cstr(&str, ION_OFFSET_INDEX_ANNOTATION, (SIZE)strlen(ION_OFFSET_INDEX_ANNOTATION))));
+    IONCHECK(ion_writer_start_container(hwriter, tid_STRUCT));
+
+    IONCHECK(ion_writer_write_field_name(hwriter, ion_string_assign_cstr(&str, "version", 7)));
+    IONCHECK(ion_writer_write_int(hwriter, ION_OFFSET_INDEX_VERSION));
+    IONCHECK(ion_writer_write_field_name(hwriter, ion_string_assign_cstr(&str, "text", 4)));
+    IONCHECK(ion_writer_write_bool(hwriter, index->is_text));
+
+    IONCHECK(ion_writer_write_field_name(hwriter, ion_string_assign_cstr(&str, "symbol_tables", 13)));
+    IONCHECK(ion_writer_start_container(hwriter, tid_LIST));
+    for (ii = 0; ii < index->symtab_count; ii++) {
+        IONCHECK(ion_writer_write_int64(hwriter, index->symtab_first_values[ii]));
+    }
+    IONCHECK(ion_writer_finish_container(hwriter));
+
+    IONCHECK(ion_writer_write_field_name(hwriter, ion_string_assign_cstr(&str, "values", 6)));
+    IONCHECK(ion_writer_start_container(hwriter, tid_LIST));
+    for (value = 0; value < index->value_count; value++) {
+        pvalue = _ion_offset_index_get_value(index, value);
+        if (index->is_text) {
+            IONCHECK(ion_writer_write_int64(hwriter, pvalue->offset - start));
+            IONCHECK(ion_writer_write_int64(hwriter, pvalue->line - line));
+            IONCHECK(ion_writer_write_int64(hwriter, pvalue->line_offset));
+            start = pvalue->offset;
+            line  = pvalue->line;
+        }
+        else {
+            IONCHECK(ion_writer_write_int64(hwriter, pvalue->offset - end));
+            IONCHECK(ion_writer_write_int64(hwriter, pvalue->length));
+            end = pvalue->offset + pvalue->length;
+        }
+    }
+    IONCHECK(ion_writer_finish_container(hwriter));
+
+    IONCHECK(ion_writer_finish_container(hwriter));
+
+    iRETURN;
+}
+
+iERR ion_offset_index_read(hREADER hreader, hOFFSET_INDEX *p_hindex)
+{
+    iENTER;
+    hOFFSET_INDEX           hindex = NULL;
+    ION_OFFSET_INDEX       *index;
+    ION_TYPE                type;
+    ION_STRING              str, field_name;
+    BOOL                    is_index, has_text = FALSE, has_values = FALSE;
+    int64_t                 ints[1], version;
+    int64_t                *numbers = NULL, *grown;
+    SIZE                    number_count = 0, number_capacity = 0, new_capacity;
+
+    if (hreader == NULL)  FAILWITH(IERR_INVALID_ARG);
+    if (p_hindex == NULL) FAILWITH(IERR_INVALID_ARG);
+
+    IONCHECK(ion_reader_next(hreader, &type));
+    if (type != tid_STRUCT) FAILWITH(IERR_NOT_AN_OFFSET_INDEX);
+    IONCHECK(ion_reader_has_annotation(hreader, ion_string_assign_cstr(&str, ION_OFFSET_INDEX_ANNOTATION, (SIZE)strlen(ION_OFFSET_INDEX_ANNOTATION)), &is_index));
+    if (!is_index) FAILWITH(IERR_NOT_AN_OFFSET_INDEX);
+
+    IONCHECK(ion_offset_index_open(&hindex));
+    index = HANDLE_TO_PTR(hindex, ION_OFFSET_INDEX);
+
+    IONCHECK(ion_reader_step_in(hreader));
+    for (;;) {
+        IONCHECK(ion_reader_next(hreader, &type));
+        if (type == tid_EOF) break;
+        IONCHECK(ion_reader_get_field_name(hreader, &field_name));
+
+        if (ION_STRING_EQUALS(&field_name, ion_string_assign_cstr(&str, "version", 7))) {
+            if (type != tid_INT) FAILWITH(IERR_NOT_AN_OFFSET_INDEX);
+            IONCHECK(ion_reader_read_int64(hreader, &version));
+            if (version != ION_OFFSET_INDEX_VERSION) FAILWITH(IERR_NOT_AN_OFFSET_INDEX);
+        }
+        else if (ION_STRING_EQUALS(&field_name, ion_string_assign_cstr(&str, "text", 4))) {
+            if (type != tid_BOOL) FAILWITH(IERR_NOT_AN_OFFSET_INDEX);
+            IONCHECK(ion_reader_read_bool(hreader, &index->is_text));
+            has_text = TRUE;
+        }
+        else if (ION_STRING_EQUALS(&field_name, ion_string_assign_cstr(&str, "symbol_tables", 13))) {
+            if (type != tid_LIST) FAILWITH(IERR_NOT_AN_OFFSET_INDEX);
+            IONCHECK(ion_reader_step_in(hreader));
+            for (;;) {
+                IONCHECK(ion_reader_next(hreader, &type));
+                if (type == tid_EOF) break;
+                IONCHECK(_ion_offset_index_read_ints(hreader, ints, 1));
+                IONCHECK(_ion_offset_index_add_symtab(index, ints[0]));
+            }
+            IONCHECK(ion_reader_step_out(hreader));
+        }
+        else if (ION_STRING_EQUALS(&field_name, ion_string_assign_cstr(&str, "values", 6))) {
+            // how many numbers make up a value depends on text, which may
+            // come after this, so they're only interpreted once the struct ends
+            if (type != tid_LIST) FAILWITH(IERR_NOT_AN_OFFSET_INDEX);
+            has_values = TRUE;
+            IONCHECK(ion_reader_step_in(hreader));
+            for (;;) {
+                IONCHECK(ion_reader_next(hreader, &type));
+                if (type == tid_EOF) break;
+                if (number_count >= number_capacity) {
+                    if (number_capacity > INT32_MAX / 2 / (SIZE)sizeof(int64_t)) FAILWITH(IERR_NUMERIC_OVERFLOW);
+                    new_capacity = number_capacity ? number_capacity * 2 : 64;
+                    grown = (int64_t *)ion_xrealloc(numbers, number_capacity * (SIZE)sizeof(int64_t), new_capacity * (SIZE)sizeof(int64_t));
+                    if (grown == NULL) FAILWITH(IERR_NO_MEMORY);
+                    numbers = grown;
+                    number_capacity = new_capacity;
+                }
+                IONCHECK(_ion_offset_index_read_ints(hreader, &numbers[number_count], 1));
+                number_count++;
+            }
+            IONCHECK(ion_reader_step_out(hreader));
+        }
+        // anything else is open content
+    }
+    IONCHECK(ion_reader_step_out(hreader));
+
+    if (has_values) {
+        if (!has_text) FAILWITH(IERR_NOT_AN_OFFSET_INDEX);
+        IONCHECK(_ion_offset_index_add_values(index, numbers, number_count));
+    }
+
+    // every value has to have a symbol table, starting with the first
+    if (index->value_count > 0) {
+        if (index->symtab_count < 1 || index->symtab_first_values[0] != 0) FAILWITH(IERR_NOT_AN_OFFSET_INDEX);
+        if (index->symtab_first_values[index->symtab_count - 1] >= index->value_count) FAILWITH(IERR_NOT_AN_OFFSET_INDEX);
+    }
+
+    *p_hindex = hindex;
+    hindex = NULL;
+
+fail:
+    if (numbers != NULL) {
+        ion_xfree(numbers);
+    }
+    if (hindex != NULL) {
+        ion_offset_index_close(hindex);
+    }
+    RETURN(__location_name__, __line__, __count__++, err);
+}
+
+iERR ion_offset_index_close(hOFFSET_INDEX hindex)
+{
+    iENTER;
+    ION_OFFSET_INDEX *index;
+
+    if (hindex == NULL) FAILWITH(IERR_INVALID_ARG);
+
+    index = HANDLE_TO_PTR(hindex, ION_OFFSET_INDEX);
+    ion_free_owner(index);
+
+    iRETURN;
+}
+
+iERR _ion_offset_index_append(ION_OFFSET_INDEX *pindex, ION_OFFSET_INDEX_VALUE **p_pvalue)
+{
+    iENTER;
+    int64_t page = pindex->value_count >> ION_OFFSET_INDEX_PAGE_SHIFT;
+    int32_t new_capacity;
+
+    ASSERT(pindex);
+    ASSERT(p_pvalue);
+
+    if (page >= INT32_MAX) FAILWITH(IERR_NUMERIC_OVERFLOW);
+
+    // the page table doubles, the pages themselves never move
+    if (page >= pindex->page_capacity) {
+        new_capacity = pindex->page_capacity ? pindex->page_capacity * 2 : 16;
+        IONCHECK(_ion_index_grow_array((void **)&pindex->pages, pindex->page_capacity, new_capacity, sizeof(ION_OFFSET_INDEX_VALUE *), TRUE, pindex));
+        pindex->page_capacity = new_capacity;
+    }
+    if (pindex->pages[page] == NULL) {
+        pindex->pages[page] = (ION_OFFSET_INDEX_VALUE *)ion_alloc_with_owner(pindex, ION_OFFSET_INDEX_PAGE_SIZE * sizeof(ION_OFFSET_INDEX_VALUE));
+        if (pindex->pages[page] == NULL) FAILWITH(IERR_NO_MEMORY);
+    }
+
+    *p_pvalue = &pindex->pages[page][pindex->value_count & ION_OFFSET_INDEX_PAGE_MASK];
+    pindex->value_count++;
+
+    iRETURN;
+}
+
+iERR _ion_offset_index_add_symtab(ION_OFFSET_INDEX *pindex, int64_t first_value)
+{
+    iENTER;
+    int32_t new_capacity;
+
+    ASSERT(pindex);
+
+    // they have to go up, find_symtab searches them
+    if (first_value < 0) FAILWITH(IERR_NOT_AN_OFFSET_INDEX);
+    if (pindex->symtab_count > 0 && first_value <= pindex->symtab_first_values[pindex->symtab_count - 1]) {
+        FAILWITH(IERR_NOT_AN_OFFSET_INDEX);
+    }
+
+    if (pindex->symtab_count >= pindex->symtab_capacity) {
+        new_capacity = pindex->symtab_capacity ? pindex->symtab_capacity * 2 : 8;
+        IONCHECK(_ion_index_grow_array((void **)&pindex->symtab_first_values, pindex->symtab_count, new_capacity, sizeof(int64_t), TRUE, pindex));
+        pindex->symtab_capacity = new_capacity;
+    }
+    pindex->symtab_first_values[pindex->symtab_count++] = first_value;
+
+    iRETURN;
+}
+
+ION_OFFSET_INDEX_VALUE *_ion_offset_index_get_value(ION_OFFSET_INDEX *pindex, int64_t value)
+{
+    ASSERT(pindex);
+    ASSERT(value >= 0 && value < pindex->value_count);
+
+    return &pindex->pages[value >> ION_OFFSET_INDEX_PAGE_SHIFT][value & ION_OFFSET_INDEX_PAGE_MASK];
+}
+
+// the last symbol table whose first value is at or before value
+int32_t _ion_offset_index_find_symtab(ION_OFFSET_INDEX *pindex, int64_t value)
+{
+    int32_t low = 0, high, mid;
+
+    ASSERT(pindex);
+    ASSERT(pindex->symtab_count > 0);
+
+    high = pindex->symtab_count - 1;
+    while (low < high) {
+        mid = low + (high - low + 1) / 2;
+        if (pindex->symtab_first_values[mid] <= value) {
+            low = mid;
+        }
+        else {
+            high = mid - 1;
+        }
+    }
+
+    return low;
+}
+
+iERR _ion_offset_index_load_symtab(ION_OFFSET_INDEX *pindex, ION_READER *preader, int32_t symtab_id)
+{
+    iENTER;
+    hREADER                 hreader = PTR_TO_HANDLE(preader);
+    ION_SYMBOL_TABLE       *system;
+    ION_OFFSET_INDEX_VALUE *pvalue;
+    ION_TYPE                type;
+    POSITION                offset;
+    int64_t                 first;
+
+    ASSERT(pindex);
+    ASSERT(preader);
+    ASSERT(symtab_id >= 0 && symtab_id < pindex->symtab_count);
+
+    // start from the system table, in case there's no version marker
+    // in front of the first value
+    IONCHECK(_ion_symbol_table_get_system_symbol_helper(&system, ION_SYSTEM_VERSION));
+    IONCHECK(ion_reader_set_symbol_table(hreader, PTR_TO_HANDLE(system)));
+
+    // read from the value before the first one with this table, or the
+    // start of the stream, up to the first one
+    first = pindex->symtab_first_values[symtab_id];
+    if (first == 0) {
+        IONCHECK(ion_reader_seek(hreader, 0, -1));
+    }
+    else {
+        pvalue = _ion_offset_index_get_value(pindex, first - 1);
+        IONCHECK(ion_reader_seek(hreader, pvalue->offset, -1));
+        IONCHECK(ion_reader_next(hreader, &type));
+        if (type == tid_EOF) FAILWITH(IERR_INVALID_STATE);
+    }
+    IONCHECK(ion_reader_next(hreader, &type));
+    if (type == tid_EOF) FAILWITH(IERR_INVALID_STATE);
+
+    IONCHECK(ion_reader_get_value_offset(hreader, &offset));
+    if (offset != _ion_offset_index_get_value(pindex, first)->offset) FAILWITH(IERR_INVALID_STATE);
+
+    iRETURN;
+}
+
+// moves the reader to value, which has to be read with the symbol table
+// the reader already has
+iERR _ion_offset_index_seek_value(ION_OFFSET_INDEX *pindex, ION_READER *preader, int64_t value)
+{
+    iENTER;
+    ION_OFFSET_INDEX_VALUE *pvalue;
+
+    ASSERT(pindex);
+    ASSERT(preader);
+
+    pvalue = _ion_offset_index_get_value(pindex, value);
+    IONCHECK(ion_reader_seek(PTR_TO_HANDLE(preader), pvalue->offset, -1));
+    if (pindex->is_text) {
+        IONCHECK(_ion_reader_text_set_line(preader, pvalue->line, pvalue->line_offset));
+    }
+
+    iRETURN;
+}
+
+// reads count ints, the first of which the reader is already on
+// appends the values written out as numbers, offset deltas and lengths for
+// binary, offset deltas, line deltas and line offsets for text
+iERR _ion_offset_index_add_values(ION_OFFSET_INDEX *pindex, int64_t *numbers, SIZE count)
+{
+    iENTER;
+    ION_OFFSET_INDEX_VALUE *pvalue;
+    POSITION                end = 0, start = 0;
+    int32_t                 line = 1;
+    SIZE                    per_value = pindex->is_text ? 3 : 2, ii;
+
+    ASSERT(pindex);
+    ASSERT(numbers || count == 0);
+
+    if (count % per_value != 0) FAILWITH(IERR_NOT_AN_OFFSET_INDEX);
+
+    for (ii = 0; ii < count; ii += per_value) {
+        IONCHECK(_ion_offset_index_append(pindex, &pvalue));
+        if (pindex->is_text) {
+            pvalue->offset      = start + numbers[ii];
+            pvalue->length      = -1;
+            pvalue->line        = line + (int32_t)numbers[ii + 1];
+            pvalue->line_offset = (int32_t)numbers[ii + 2];
+            start = pvalue->offset;
+            line  = pvalue->line;
+        }
+        else {
+            pvalue->offset      = end + numbers[ii];
+            pvalue->length      = (SIZE)numbers[ii + 1];
+            pvalue->line        = 0;
+            pvalue->line_offset = 0;
+            end = pvalue->offset + pvalue->length;
+        }
+    }
+
+    iRETURN;
+}
+
+iERR _ion_offset_index_read_ints(hREADER hreader, int64_t *p_values, SIZE count)
+{
+    iENTER;
+    ION_TYPE type;
+    SIZE     ii;
+
+    ASSERT(p_values);
+
+    for (ii = 0; ii < count; ii++) {
+        if (ii > 0) {
+            IONCHECK(ion_reader_next(hreader, &type));
+        }
+        else {
+            IONCHECK(ion_reader_get_type(hreader, &type));
+        }
+        if (type != tid_INT) FAILWITH(IERR_NOT_AN_OFFSET_INDEX);
+        IONCHECK(ion_reader_read_int64(hreader, &p_values[ii]));
+    }
+
+    iRETURN;
+}
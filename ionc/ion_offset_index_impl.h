@@ -0,0 +1,74 @@
+/*
+ * Copyright 2009-2016 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at:
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+#ifndef ION_OFFSET_INDEX_IMPL_H_
+#define ION_OFFSET_INDEX_IMPL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// values are kept in fixed size pages so value n is two array lookups
+// away, and adding a value never moves the ones already there
+#define ION_OFFSET_INDEX_PAGE_SHIFT     12
+#define ION_OFFSET_INDEX_PAGE_SIZE      (1 << ION_OFFSET_INDEX_PAGE_SHIFT)
+#define ION_OFFSET_INDEX_PAGE_MASK      (ION_OFFSET_INDEX_PAGE_SIZE - 1)
+
+#define ION_OFFSET_INDEX_VERSION        1
+
+typedef struct _ion_offset_index_value
+{
+    POSITION    offset;
+    SIZE        length;
+    int32_t     line;
+    int32_t     line_offset;
+
+} ION_OFFSET_INDEX_VALUE;
+
+struct _ion_offset_index
+{
+    BOOL                     is_text;
+    int64_t                  value_count;
+    ION_OFFSET_INDEX_VALUE **pages;
+    int32_t                  page_capacity;
+
+    // the first value read with each symbol table, in increasing order
+    int64_t                 *symtab_first_values;
+    int32_t                  symtab_count;
+    int32_t                  symtab_capacity;
+
+    // the _symtab_generation of the reader values are being added from
+    int64_t                  build_generation;
+
+    // the symbol table the last seek loaded, and the reader it loaded
+    // it into, so seeks within the same symbol table don't reload it
+    ION_READER              *seek_reader;
+    int32_t                  seek_symtab_id;
+    int64_t                  seek_generation;
+};
+
+iERR _ion_offset_index_append       (ION_OFFSET_INDEX *pindex, ION_OFFSET_INDEX_VALUE **p_pvalue);
+iERR _ion_offset_index_add_symtab   (ION_OFFSET_INDEX *pindex, int64_t first_value);
+ION_OFFSET_INDEX_VALUE *_ion_offset_index_get_value(ION_OFFSET_INDEX *pindex, int64_t value);
+int32_t _ion_offset_index_find_symtab(ION_OFFSET_INDEX *pindex, int64_t value);
+iERR _ion_offset_index_load_symtab  (ION_OFFSET_INDEX *pindex, ION_READER *preader, int32_t symtab_id);
+iERR _ion_offset_index_seek_value   (ION_OFFSET_INDEX *pindex, ION_READER *preader, int64_t value);
+iERR _ion_offset_index_add_values   (ION_OFFSET_INDEX *pindex, int64_t *numbers, SIZE count);
+iERR _ion_offset_index_read_ints    (hREADER hreader, int64_t *p_values, SIZE count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ION_OFFSET_INDEX_IMPL_H_ */
@@ -0,0 +1,300 @@
+/*
+ * Copyright 2009-2016 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at:
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+/*
+ * parallel reading of the top level values of one stream
+ *
+ * the offset index says where every value starts and which symbol table
+ * it's read with, so once there is one the values can be cut into runs
+ * and each run read by its own reader. Nothing is shared between the
+ * threads but the index, which they only read, the input bytes and the
+ * catalog.
+ *
+ * the calling thread reads the first run itself. If a thread can't be
+ * started its run is read on the calling thread once the others are done.
+ *
+ */
+
+#include "ion_internal.h"
+
+// the readers on each thread are only safe to use side by side when the
+// allocator has its per thread caches
+#ifdef ION_ALLOC_HAS_THREAD_CACHE
+  #define ION_PARALLEL_HAS_THREADS
+  #include <pthread.h>
+#endif
+
+typedef struct _ion_parallel_job
+{
+    ION_OFFSET_INDEX      *index;
+    BYTE                  *buffer;      // the input, or NULL for each run to map fd
+    SIZE                   length;
+    int                    fd;
+    ION_READER_OPTIONS    *p_options;
+    ION_PARALLEL_CALLBACK  fn_callback;
+    void                  *context;
+    int                    stop;        // set once any run fails
+
+} ION_PARALLEL_JOB;
+
+typedef struct _ion_parallel_run
+{
+    ION_PARALLEL_JOB      *job;
+    int64_t                first_value;
+    int64_t                end_value;   // one past the last value in the run
+    iERR                   err;
+#ifdef ION_PARALLEL_HAS_THREADS
+    pthread_t              thread;
+    BOOL                   has_thread;
+#endif
+
+} ION_PARALLEL_RUN;
+
+#ifdef ION_PARALLEL_HAS_THREADS
+  #define ION_PARALLEL_STOP(job)      __atomic_store_n(&(job)->stop, 1, __ATOMIC_RELAXED)
+  #define ION_PARALLEL_STOPPED(job)   __atomic_load_n(&(job)->stop, __ATOMIC_RELAXED)
+#else
+  #define ION_PARALLEL_STOP(job)      ((job)->stop = 1)
+  #define ION_PARALLEL_STOPPED(job)   ((job)->stop)
+#endif
+
+static iERR    _ion_parallel_run_all  (ION_PARALLEL_JOB *job, int32_t thread_count);
+static iERR    _ion_parallel_read_run (ION_PARALLEL_RUN *run);
+static int64_t _ion_parallel_split    (ION_OFFSET_INDEX *pindex, POSITION target);
+#ifdef ION_PARALLEL_HAS_THREADS
+static void   *_ion_parallel_thread   (void *arg);
+#endif
+
+iERR ion_parallel_for_each_value(BYTE *buffer, SIZE length, hOFFSET_INDEX hindex, ION_READER_OPTIONS *p_options, int32_t thread_count, ION_PARALLEL_CALLBACK fn_callback, void *context)
+{
+    iENTER;
+    ION_PARALLEL_JOB job;
+    hOFFSET_INDEX    built = NULL;
+    hREADER          reader = NULL;
+
+    if (buffer == NULL)      FAILWITH(IERR_INVALID_ARG);
+    if (length < 0)          FAILWITH(IERR_INVALID_ARG);
+    if (thread_count < 1)    FAILWITH(IERR_INVALID_ARG);
+    if (fn_callback == NULL) FAILWITH(IERR_INVALID_ARG);
+
+    if (hindex == NULL) {
+        IONCHECK(ion_reader_open_buffer(&reader, buffer, length, p_options));
+        IONCHECK(ion_offset_index_open(&built));
+        IONCHECK(ion_offset_index_build(built, reader));
+        hindex = built;
+    }
+
+    memset(&job, 0, sizeof(job));
+    job.index       = HANDLE_TO_PTR(hindex, ION_OFFSET_INDEX);
+    job.buffer      = buffer;
+    job.length      = length;
+    job.fd          = -1;
+    job.p_options   = p_options;
+    job.fn_callback = fn_callback;
+    job.context     = context;
+    IONCHECK(_ion_parallel_run_all(&job, thread_count));
+
+fail:
+    if (reader) ion_reader_close(reader);
+    if (built) ion_offset_index_close(built);
+    RETURN(__location_name__, __line__, __count__++, err);
+}
+
+iERR ion_parallel_for_each_value_in_fd(int fd_in, hOFFSET_INDEX hindex, ION_READER_OPTIONS *p_options, int32_t thread_count, ION_PARALLEL_CALLBACK fn_callback, void *context)
+{
+    iENTER;
+    ION_PARALLEL_JOB job;
+    hOFFSET_INDEX    built = NULL;
+    hREADER          reader = NULL;
+    ION_STREAM      *stream = NULL;
+    ION_TYPE         type;
+    int64_t          value;
+
+    if (fd_in == -1)         FAILWITH(IERR_INVALID_ARG);
+    if (thread_count < 1)    FAILWITH(IERR_INVALID_ARG);
+    if (fn_callback == NULL) FAILWITH(IERR_INVALID_ARG);
+
+    IONCHECK(ion_stream_open_mmap(fd_in, &stream));
+    IONCHECK(ion_reader_open(&reader, stream, p_options));
+
+    // if it couldn't be mapped the other threads can't get at it either
+    if (!_ion_stream_is_mapped(stream)) {
+        for (value = 0; ; value++) {
+            IONCHECK(ion_reader_next(reader, &type));
+            if (type == tid_EOF) break;
+            IONCHECK((*fn_callback)(reader, value, context));
+        }
+        SUCCEED();
+    }
+
+    if (hindex == NULL) {
+        IONCHECK(ion_offset_index_open(&built));
+        IONCHECK(ion_offset_index_build(built, reader));
+        hindex = built;
+    }
+    IONCHECK(ion_reader_close(reader));
+    reader = NULL;
+    IONCHECK(ion_stream_close(stream));
+    stream = NULL;
+
+    memset(&job, 0, sizeof(job));
+    job.index       = HANDLE_TO_PTR(hindex, ION_OFFSET_INDEX);
+    job.fd          = fd_in;
+    job.p_options   = p_options;
+    job.fn_callback = fn_callback;
+    job.context     = context;
+    IONCHECK(_ion_parallel_run_all(&job, thread_count));
+
+fail:
+    if (reader) ion_reader_close(reader);
+    if (stream) ion_stream_close(stream);
+    if (built) ion_offset_index_close(built);
+    RETURN(__location_name__, __line__, __count__++, err);
+}
+
+static iERR _ion_parallel_run_all(ION_PARALLEL_JOB *job, int32_t thread_count)
+{
+    iENTER;
+    ION_OFFSET_INDEX       *index = job->index;
+    ION_OFFSET_INDEX_VALUE *plast;
+    ION_PARALLEL_RUN       *runs;
+    POSITION                start, total;
+    int64_t                 first, end;
+    int32_t                 ii;
+
+    if (index->value_count == 0) SUCCEED();
+    if (thread_count > index->value_count) thread_count = (int32_t)index->value_count;
+
+    runs = (ION_PARALLEL_RUN *)ion_alloc_owner(thread_count * sizeof(ION_PARALLEL_RUN));
+    if (runs == NULL) FAILWITH(IERR_NO_MEMORY);
+    memset(runs, 0, thread_count * sizeof(ION_PARALLEL_RUN));
+
+    // runs of about the same number of bytes, text values have no length
+    // so there the last one is counted as empty
+    plast = _ion_offset_index_get_value(index, index->value_count - 1);
+    start = _ion_offset_index_get_value(index, 0)->offset;
+    total = plast->offset + (plast->length > 0 ? plast->length : 0) - start;
+    for (first = 0, ii = 0; ii < thread_count; ii++) {
+        if (ii == thread_count - 1) {
+            end = index->value_count;
+        }
+        else {
+            end = _ion_parallel_split(index, start + (POSITION)((total * (ii + 1)) / thread_count));
+            if (end < first) end = first;
+        }
+        runs[ii].job         = job;
+        runs[ii].first_value = first;
+        runs[ii].end_value   = end;
+        first = end;
+    }
+
+#ifdef ION_PARALLEL_HAS_THREADS
+    for (ii = 1; ii < thread_count; ii++) {
+        if (runs[ii].first_value >= runs[ii].end_value) continue;
+        runs[ii].has_thread = (pthread_create(&runs[ii].thread, NULL, _ion_parallel_thread, &runs[ii]) == 0);
+    }
+    _ion_parallel_read_run(&runs[0]);
+    for (ii = 1; ii < thread_count; ii++) {
+        if (runs[ii].has_thread) {
+            pthread_join(runs[ii].thread, NULL);
+        }
+        else {
+            _ion_parallel_read_run(&runs[ii]);
+        }
+    }
+#else
+    for (ii = 0; ii < thread_count; ii++) {
+        _ion_parallel_read_run(&runs[ii]);
+    }
+#endif
+
+    // the runs stopped by another's failure return IERR_OK
+    for (ii = 0; ii < thread_count; ii++) {
+        if (runs[ii].err != IERR_OK) {
+            err = runs[ii].err;
+            break;
+        }
+    }
+    ion_free_owner(runs);
+
+    iRETURN;
+}
+
+static iERR _ion_parallel_read_run(ION_PARALLEL_RUN *run)
+{
+    iENTER;
+    ION_PARALLEL_JOB *job = run->job;
+    hREADER           reader = NULL;
+    ION_STREAM       *stream = NULL;
+    ION_READER       *preader;
+    ION_TYPE          type;
+    int64_t           value;
+
+    if (run->first_value >= run->end_value) SUCCEED();
+    if (ION_PARALLEL_STOPPED(job)) SUCCEED();
+
+    if (job->buffer != NULL) {
+        IONCHECK(ion_reader_open_buffer(&reader, job->buffer, job->length, job->p_options));
+    }
+    else {
+        IONCHECK(ion_stream_open_mmap(job->fd, &stream));
+        IONCHECK(ion_reader_open(&reader, stream, job->p_options));
+    }
+    preader = HANDLE_TO_PTR(reader, ION_READER);
+
+    // the symbol table the run starts with, after that the reader picks up
+    // any others itself as it goes
+    IONCHECK(_ion_offset_index_load_symtab(job->index, preader, _ion_offset_index_find_symtab(job->index, run->first_value)));
+    IONCHECK(_ion_offset_index_seek_value(job->index, preader, run->first_value));
+
+    for (value = run->first_value; value < run->end_value; value++) {
+        if (ION_PARALLEL_STOPPED(job)) break;
+        IONCHECK(ion_reader_next(reader, &type));
+        if (type == tid_EOF) FAILWITH(IERR_UNEXPECTED_EOF);
+        IONCHECK((*job->fn_callback)(reader, value, job->context));
+    }
+
+fail:
+    if (err != IERR_OK) ION_PARALLEL_STOP(job);
+    if (reader) ion_reader_close(reader);
+    if (stream) ion_stream_close(stream);
+    run->err = err;
+    RETURN(__location_name__, __line__, __count__++, err);
+}
+
+// the first value that starts at or after target
+static int64_t _ion_parallel_split(ION_OFFSET_INDEX *pindex, POSITION target)
+{
+    int64_t low = 0, high = pindex->value_count, mid;
+
+    while (low < high) {
+        mid = low + (high - low) / 2;
+        if (_ion_offset_index_get_value(pindex, mid)->offset < target) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+#ifdef ION_PARALLEL_HAS_THREADS
+static void *_ion_parallel_thread(void *arg)
+{
+    _ion_parallel_read_run((ION_PARALLEL_RUN *)arg);
+    return NULL;
+}
+#endif
@@ -20,6 +20,9 @@
                                 }                                               \
                             }
 
+static iERR _ion_reader_projection_step_in(ION_READER *preader, ION_TYPE type);
+static void _ion_reader_projection_step_out(ION_READER *preader);
+
 iERR ion_reader_open_buffer(hREADER *p_hreader, BYTE *buffer, SIZE buf_length, ION_READER_OPTIONS *p_options)
 {
     iENTER;
@@ -78,6 +81,7 @@ iERR ion_reader_reset_stream_with_length(hREADER   *p_hreader
     iENTER;
     POSITION local_end;
     ION_STREAM    *pstream = NULL;
+    ION_STREAM_OPTIONS stream_options;
 
     if(!p_hreader)        FAILWITH(IERR_INVALID_ARG);
     if(!fn_input_handler) FAILWITH(IERR_INVALID_ARG);	
@@ -95,7 +99,8 @@ iERR ion_reader_reset_stream_with_length(hREADER   *p_hreader
     }
 
     // initialize given stream with handler
-    ion_stream_open_handler_in(fn_input_handler, handler_state, &pstream);
+    _ion_reader_stream_options(&(*p_hreader)->options, &stream_options);
+    ion_stream_open_handler_in_with_options(fn_input_handler, handler_state, &stream_options, &pstream);
     (*p_hreader)->istream = pstream;
 
     memset(&((*p_hreader)->_int_helper), 0, sizeof((*p_hreader)->_int_helper));
@@ -133,6 +138,7 @@ iERR ion_reader_reset_stream(hREADER *p_hreader, void *handler_state, ION_STREAM
 {
     iENTER;
     ION_STREAM *pstream;
+    ION_STREAM_OPTIONS stream_options;
     BYTE  ivm_buffer[ION_VERSION_MARKER_LENGTH];
     BOOL is_binary_stream;
     int  b, pos, ii;
@@ -151,7 +157,8 @@ iERR ion_reader_reset_stream(hREADER *p_hreader, void *handler_state, ION_STREAM
     }
 
     // initialize given stream with handler
-    ion_stream_open_handler_in(fn_input_handler, handler_state, &pstream);
+    _ion_reader_stream_options(&(*p_hreader)->options, &stream_options);
+    ion_stream_open_handler_in_with_options(fn_input_handler, handler_state, &stream_options, &pstream);
     (*p_hreader)->istream = pstream;
     (*p_hreader)->_reader_owns_stream = TRUE;
     
@@ -189,6 +196,7 @@ iERR ion_reader_reset_stream(hREADER *p_hreader, void *handler_state, ION_STREAM
     }
     // Mark the eof flag to false, since reader is provided with new stream
     (*p_hreader)->_eof = FALSE;
+    _ion_reader_projection_reset(*p_hreader);
     iRETURN;
 }
 
@@ -200,11 +208,13 @@ iERR ion_reader_open_stream(hREADER *p_hreader
     iENTER;
     ION_READER    *preader = NULL;
     ION_STREAM    *pstream = NULL;
+    ION_STREAM_OPTIONS stream_options;
 
     if(!p_hreader) FAILWITH(IERR_INVALID_ARG);
     if(!p_hreader) FAILWITH(IERR_INVALID_ARG);
 
-    IONCHECK(ion_stream_open_handler_in( fn_input_handler, handler_state, &pstream ));
+    _ion_reader_stream_options(p_options, &stream_options);
+    IONCHECK(ion_stream_open_handler_in_with_options( fn_input_handler, handler_state, &stream_options, &pstream ));
     IONCHECK(_ion_reader_open_stream_helper( &preader, pstream, p_options ));
     preader->_reader_owns_stream = TRUE;
 
@@ -298,7 +308,7 @@ iERR _ion_reader_make_new_reader(ION_READER_OPTIONS *p_options, ION_READER **p_r
     // the stream.  Later we'll initialize typed portion of the reader
     // once we know what format we're going to be processing
     len = sizeof(ION_READER);
-    preader = (ION_READER *)ion_alloc_owner(len);
+    preader = (ION_READER *)ion_alloc_owner_with_allocator(len, p_options ? p_options->allocator : NULL);
     *p_reader = preader;
     if (!preader) {
         FAILWITH(IERR_NO_MEMORY);
@@ -306,6 +316,7 @@ iERR _ion_reader_make_new_reader(ION_READER_OPTIONS *p_options, ION_READER **p_r
     memset(preader, 0, len);
 
     preader->type = ion_type_unknown_reader;
+    _ion_collection_initialize(preader, &preader->_projection.stack, sizeof(ION_READER_PROJECTION_STATE)); // array of ION_READER_PROJECTION_STATE
     IONCHECK(_ion_reader_set_options(preader, p_options));
 
 
@@ -336,6 +347,20 @@ iERR _ion_reader_set_options(ION_READER *preader, ION_READER_OPTIONS* p_options)
     iRETURN;
 }
 
+// the options for a stream the reader opens for itself, a 0 page
+// size (or no reader options at all) leaves the stream's defaults
+void _ion_reader_stream_options(ION_READER_OPTIONS *p_options, ION_STREAM_OPTIONS *p_stream_options)
+{
+    ASSERT(p_stream_options);
+
+    memset(p_stream_options, 0, sizeof(*p_stream_options));
+    if (p_options) {
+        p_stream_options->page_size     = p_options->stream_page_size;
+        p_stream_options->max_page_size = p_options->stream_max_page_size;
+        p_stream_options->allocator     = p_options->allocator;
+    }
+}
+
 void _ion_reader_initialize_option_defaults(ION_READER_OPTIONS* p_options)
 {
     ASSERT(p_options != NULL);
@@ -477,6 +502,7 @@ iERR _ion_reader_initialize(ION_READER *preader, BYTE *version_buffer, SIZE vers
 
     // keep the readers copy of depth up to date
     preader->_depth = 0;
+    _ion_reader_projection_reset(preader);
 
     // now we can check the binary Ion Version Marker
     // we'll have to "unread" these bytes 
@@ -549,6 +575,7 @@ iERR ion_reader_next(hREADER hreader, ION_TYPE *p_value_type)
 iERR _ion_reader_next_helper(ION_READER *preader, ION_TYPE *p_value_type)
 {
     iENTER;
+    BOOL is_selected;
     
     ASSERT(preader);
     ASSERT(p_value_type);
@@ -560,9 +587,16 @@ iERR _ion_reader_next_helper(ION_READER *preader, ION_TYPE *p_value_type)
 
     switch(preader->type) {
     case ion_type_text_reader:
-        IONCHECK(_ion_reader_text_next(preader, p_value_type));
+        for (;;) {
+            IONCHECK(_ion_reader_text_next(preader, p_value_type));
+            if (*p_value_type == tid_EOF || !ION_READER_PROJECTS_FIELDS(preader)) break;
+            // a field outside the projection is skipped by the scanner on the next call
+            IONCHECK(_ion_reader_projection_select_field(preader, UNKNOWN_SID, &preader->typed_reader.text._field_name, &is_selected));
+            if (is_selected) break;
+        }
         break;
     case ion_type_binary_reader:
+        // this skips fields outside the projection itself
         IONCHECK(_ion_reader_binary_next(preader, p_value_type));
         break;
     case ion_type_unknown_reader:
@@ -570,6 +604,10 @@ iERR _ion_reader_next_helper(ION_READER *preader, ION_TYPE *p_value_type)
         FAILWITH(IERR_INVALID_STATE);
     }
 
+    if (!ION_READER_PROJECTS_FIELDS(preader)) {
+        preader->_projection.value = preader->_projection.current.node;
+    }
+
     iRETURN;
 }
 
@@ -577,11 +615,17 @@ iERR ion_reader_step_in(hREADER hreader)
 {
     iENTER;
     ION_READER *preader;
+    ION_TYPE    type = tid_none;
 
     if (!hreader) FAILWITH(IERR_INVALID_ARG);
     preader = HANDLE_TO_PTR(hreader, ION_READER);
 
+    // what the projection reads in the container depends on its type
+    if (preader->_projection.root) {
+        IONCHECK(_ion_reader_get_type_helper(preader, &type));
+    }
     IONCHECK(_ion_reader_step_in_helper(preader));
+    IONCHECK(_ion_reader_projection_step_in(preader, type));
 
     iRETURN;
 }
@@ -621,6 +665,7 @@ iERR ion_reader_step_out(hREADER hreader)
     preader = HANDLE_TO_PTR(hreader, ION_READER);
 
     IONCHECK(_ion_reader_step_out_helper(preader));
+    _ion_reader_projection_step_out(preader);
 
     iRETURN;
 }
@@ -650,6 +695,166 @@ iERR _ion_reader_step_out_helper(ION_READER *preader)
     iRETURN;
 }
 
+iERR ion_reader_add_projection_path(hREADER hreader, ION_STRING *p_fields, SIZE count)
+{
+    iENTER;
+    ION_READER                  *preader;
+    ION_READER_PROJECTION_NODE **pnext, *node = NULL;
+    SIZE                         ii;
+
+    if (!hreader) FAILWITH(IERR_INVALID_ARG);
+    preader = HANDLE_TO_PTR(hreader, ION_READER);
+    if (!p_fields || count < 1) FAILWITH(IERR_INVALID_ARG);
+    for (ii = 0; ii < count; ii++) {
+        if (ION_STRING_IS_NULL(&p_fields[ii]) || p_fields[ii].length < 1) FAILWITH(IERR_INVALID_ARG);
+    }
+    if (preader->_depth != 0) FAILWITH(IERR_INVALID_STATE);
+
+    if (preader->_projection.pool == NULL) {
+        preader->_projection.pool = ion_alloc_dependent_owner(preader, sizeof(ION_READER_PROJECTION_NODE));  // the root is the pool
+        if (preader->_projection.pool == NULL) FAILWITH(IERR_NO_MEMORY);
+        memset(preader->_projection.pool, 0, sizeof(ION_READER_PROJECTION_NODE));
+        preader->_projection.root = (ION_READER_PROJECTION_NODE *)preader->_projection.pool;
+    }
+
+    // find or add each field name along the path
+    node = preader->_projection.root;
+    for (ii = 0; ii < count && !node->is_selected; ii++) {
+        for (pnext = &node->children; *pnext; pnext = &(*pnext)->next) {
+            if (ION_STRING_EQUALS(&(*pnext)->name, &p_fields[ii])) break;
+        }
+        if (*pnext == NULL) {
+            *pnext = (ION_READER_PROJECTION_NODE *)ion_alloc_with_owner(preader->_projection.pool, sizeof(ION_READER_PROJECTION_NODE));
+            if (*pnext == NULL) FAILWITH(IERR_NO_MEMORY);
+            memset(*pnext, 0, sizeof(ION_READER_PROJECTION_NODE));
+            IONCHECK(ion_string_copy_to_owner(preader->_projection.pool, &(*pnext)->name, &p_fields[ii]));
+            (*pnext)->sid = UNKNOWN_SID;
+        }
+        node = *pnext;
+    }
+    // a shorter path reads all of a longer one
+    node->is_selected = TRUE;
+    node->children = NULL;
+
+    preader->_projection.symtab = NULL;
+    _ion_reader_projection_reset(preader);
+
+    iRETURN;
+}
+
+iERR ion_reader_clear_projection(hREADER hreader)
+{
+    iENTER;
+    ION_READER *preader;
+
+    if (!hreader) FAILWITH(IERR_INVALID_ARG);
+    preader = HANDLE_TO_PTR(hreader, ION_READER);
+    if (preader->_depth != 0) FAILWITH(IERR_INVALID_STATE);
+
+    _ion_reader_clear_projection_helper(preader);
+
+    iRETURN;
+}
+
+// drops the projection wherever the reader is, the reader reads every
+// field from here on (used to clean up after a failed extraction)
+void _ion_reader_clear_projection_helper(ION_READER *preader)
+{
+    ASSERT(preader);
+
+    if (preader->_projection.pool != NULL) {
+        ion_free_owner(preader->_projection.pool);
+        preader->_projection.pool = NULL;
+    }
+    preader->_projection.root = NULL;
+    preader->_projection.symtab = NULL;
+    _ion_reader_projection_reset(preader);
+}
+
+void _ion_reader_projection_reset(ION_READER *preader)
+{
+    ASSERT(preader);
+
+    preader->_projection.current.node = preader->_projection.root;
+    preader->_projection.current.in_struct = FALSE;
+    preader->_projection.value = preader->_projection.root;
+    preader->_projection.depth = 0;
+    _ion_collection_reset(&preader->_projection.stack);
+}
+
+static iERR _ion_reader_projection_resolve(ION_SYMBOL_TABLE *symtab, ION_READER_PROJECTION_NODE *node)
+{
+    iENTER;
+
+    for (; node; node = node->next) {
+        IONCHECK(_ion_symbol_table_local_find_by_name(symtab, &node->name, &node->sid, NULL));
+        IONCHECK(_ion_reader_projection_resolve(symtab, node->children));
+    }
+
+    iRETURN;
+}
+
+// looks the field up among those the projection reads in the current struct,
+// by sid for the binary reader and by name (field_name not NULL) for text.
+// If it's there this sets what stepping into its value reads
+iERR _ion_reader_projection_select_field(ION_READER *preader, SID field_sid, ION_STRING *field_name, BOOL *p_is_selected)
+{
+    iENTER;
+    ION_READER_PROJECTION_NODE *node;
+
+    ASSERT(ION_READER_PROJECTS_FIELDS(preader));
+    ASSERT(p_is_selected);
+
+    if (field_name == NULL && preader->_projection.symtab != preader->_current_symtab) {
+        IONCHECK(_ion_reader_projection_resolve(preader->_current_symtab, preader->_projection.root->children));
+        preader->_projection.symtab = preader->_current_symtab;
+    }
+
+    for (node = preader->_projection.current.node->children; node; node = node->next) {
+        if (field_name ? ION_STRING_EQUALS(field_name, &node->name) : (field_sid == node->sid)) break;
+    }
+    if (node) {
+        preader->_projection.value = node->is_selected ? NULL : node;
+    }
+    *p_is_selected = (node != NULL);
+
+    iRETURN;
+}
+
+static iERR _ion_reader_projection_step_in(ION_READER *preader, ION_TYPE type)
+{
+    iENTER;
+    ION_READER_PROJECTION_STATE *pstate;
+
+    // only the containers the user steps into count, the reader steps into
+    // symbol tables (and the like) on its own
+    if (preader->_projection.root == NULL || preader->_projection.depth != preader->_depth - 1) SUCCEED();
+
+    pstate = (ION_READER_PROJECTION_STATE *)_ion_collection_push(&preader->_projection.stack);
+    if (!pstate) FAILWITH(IERR_NO_MEMORY);
+    *pstate = preader->_projection.current;
+
+    preader->_projection.current.node = preader->_projection.value;
+    preader->_projection.current.in_struct = (type == tid_STRUCT);
+    preader->_projection.depth++;
+
+    iRETURN;
+}
+
+static void _ion_reader_projection_step_out(ION_READER *preader)
+{
+    ION_READER_PROJECTION_STATE *pstate;
+
+    if (preader->_projection.root == NULL || preader->_projection.depth != preader->_depth + 1) return;
+
+    pstate = (ION_READER_PROJECTION_STATE *)_ion_collection_head(&preader->_projection.stack);
+    ASSERT(pstate);
+    preader->_projection.current = *pstate;
+    preader->_projection.value = pstate->node;
+    preader->_projection.depth--;
+    _ion_collection_pop_head(&preader->_projection.stack);
+}
+
 iERR ion_reader_get_depth(hREADER hreader, SIZE *p_depth)
 {
     iENTER;
@@ -1687,6 +1892,11 @@ iERR _ion_reader_close_helper(ION_READER *preader)
         preader->_local_symtab_pool = NULL;
     }
 
+    if (preader->_projection.pool != NULL) {
+        ion_free_owner( preader->_projection.pool );
+        preader->_projection.pool = NULL;
+    }
+
     ion_free_owner(preader);
     SUCCEED();
 
@@ -1705,7 +1915,7 @@ iERR _ion_reader_reset_temp_pool( ION_READER *preader )
     }
 
     // alloc _temp_entity_pool here
-    preader->_temp_entity_pool = ion_alloc_owner(sizeof(int));  // this is a fake allocation to hold the pool
+    preader->_temp_entity_pool = ion_alloc_dependent_owner(preader, sizeof(int));  // this is a fake allocation to hold the pool
     if (preader->_temp_entity_pool == NULL) {
         FAILWITH(IERR_NO_MEMORY);
     }
@@ -1721,8 +1931,11 @@ iERR _ion_reader_get_new_local_symbol_table_owner(ION_READER *preader, void **p_
     // recycle the old symtab if there is one
     IONCHECK(_ion_reader_reset_local_symbol_table(preader));
 
+    // the projection's sids are for the table being replaced
+    preader->_projection.symtab = NULL;
+
     // allocate a pool, save it as our local symbol table pool and return it
-    owner = ion_alloc_owner(sizeof(int));  // this is a fake allocation to hold the pool
+    owner = ion_alloc_dependent_owner(preader, sizeof(int));  // this is a fake allocation to hold the pool
     if (owner == NULL) {
         FAILWITH(IERR_NO_MEMORY);
     }
@@ -1741,6 +1954,7 @@ iERR _ion_reader_reset_local_symbol_table(ION_READER *preader )
         ion_free_owner( preader->_local_symtab_pool );
         preader->_local_symtab_pool = NULL;
     }
+    preader->_symtab_generation++;
     SUCCEED();
 
     iRETURN;
@@ -1860,7 +2074,7 @@ iERR ion_reader_seek(hREADER hreader, POSITION offset, SIZE length)
         IONCHECK(_ion_reader_text_reset(preader, tid_DATAGRAM, local_end));
         break;
     case ion_type_binary_reader:
-        IONCHECK(_ion_reader_text_reset(preader, tid_DATAGRAM, local_end));
+        IONCHECK(_ion_reader_binary_reset(preader, TID_DATAGRAM, local_end));
         break;
     case ion_type_unknown_reader:
     default:
@@ -1869,6 +2083,7 @@ iERR ion_reader_seek(hREADER hreader, POSITION offset, SIZE length)
 
     // keep the readers copy of depth up to date
     preader->_depth = 0;
+    _ion_reader_projection_reset(preader);
 
 
     // the parser reset will set the local terminator (at least it will
@@ -1907,6 +2122,7 @@ iERR ion_reader_set_symbol_table(hREADER hreader, hSYMTAB hsymtab)
     default:
         FAILWITH(IERR_INVALID_STATE);
     }
+    preader->_symtab_generation++;
 
     iRETURN;
 }
@@ -2002,6 +2218,25 @@ iERR ion_reader_get_symbol_table(hREADER hreader, hSYMTAB *p_hsymtab)
     iRETURN;
 }
 
+iERR ion_reader_get_alloc_stats(hREADER hreader, ION_ALLOC_STATS *p_stats)
+{
+    iENTER;
+    ION_READER *preader;
+
+    if (!hreader) FAILWITH(IERR_BAD_HANDLE);
+    preader = HANDLE_TO_PTR(hreader, ION_READER);
+    if (!p_stats) FAILWITH(IERR_INVALID_ARG);
+
+    // the temp and symbol table pools are counted with the reader
+    memset(p_stats, 0, sizeof(*p_stats));
+    _ion_alloc_owner_add_stats(preader, p_stats);
+    if (preader->_reader_owns_stream) {
+        _ion_alloc_owner_add_stats(preader->istream, p_stats);
+    }
+
+    iRETURN;
+}
+
 iERR _ion_reader_get_symbol_table_helper(ION_READER *preader, ION_SYMBOL_TABLE **p_psymtab)
 {
     iENTER;
@@ -28,6 +28,9 @@ iERR _ion_reader_binary_local_load_symbol_table(ION_READER *preader, int annotat
 iERR _ion_reader_binary_local_load_symbol_table_import_list(ION_READER *preader, ION_SYMBOL_TABLE *local);
 iERR _ion_reader_binary_local_load_symbol_table_import(ION_READER *preader, ION_SYMBOL_TABLE *local);
 iERR _ion_reader_binary_local_reset_symbol_table(ION_READER *preader);
+static BOOL _ion_reader_binary_next_in_memory(ION_READER *preader, POSITION value_start);
+static iERR _ion_reader_binary_skip_field_value(ION_READER *preader);
+static iERR _ion_reader_binary_validate_utf8_bytes(BYTE *buf, SIZE len, SIZE expected_remaining, SIZE *p_expected_remaining);
 
 //      EXPECT_SYMBOL_TABLE(BINARY(preader))
 #define EXPECT_SYMBOL_TABLE(pbinary) \
@@ -61,6 +64,11 @@ iERR _ion_reader_binary_open(ION_READER *preader)
     binary->_local_end = ION_STREAM_MAX_LENGTH;
     binary->_state = S_BEFORE_TID;
 
+    // a user buffer (see _ion_reader_open_buffer_helper), a memory mapped
+    // file or any other stream that holds all its input has the value
+    // headers decoded in place rather than a byte at a time from the stream
+    binary->_in_memory = _ion_stream_is_fully_buffered(preader->istream);
+
     // the original Java reader was intended to allow opening an iterator
     // over an internal buffer so the parent might be different, this
     // reader could be adapted fairly easily to do this, but not until
@@ -92,7 +100,8 @@ iERR _ion_reader_binary_reset(ION_READER *preader, int parent_tid, POSITION loca
     // there's an actual use case
     binary->_parent_tid = parent_tid;
 
-    binary->_local_end = local_end;
+    binary->_local_end = (local_end < 0) ? ION_STREAM_MAX_LENGTH : local_end; // -1 for no limit
+    binary->_in_memory = _ion_stream_is_fully_buffered(preader->istream);
 
     SUCCEED();
 
@@ -124,7 +133,7 @@ iERR _ion_reader_binary_next(ION_READER *preader, ION_TYPE *p_value_type)
     uint32_t           field_sid, annotation_len;
     SIZE               skipped;
     SID               *psid;
-    BOOL               is_system_value = FALSE;
+    BOOL               is_system_value = FALSE, is_selected;
     POSITION           annotation_content_start, value_content_start;
 
     ASSERT(preader && preader->type == ion_type_binary_reader);
@@ -140,10 +149,16 @@ iERR _ion_reader_binary_next(ION_READER *preader, ION_TYPE *p_value_type)
     // decided never read the value itself we have to skip
     // over the value contents here
     if (binary->_state == S_BEFORE_CONTENTS && binary->_value_len) {
-        IONCHECK(ion_stream_skip(preader->istream, binary->_value_len, &skipped));
-        if (binary->_value_len != skipped) FAILWITH(IERR_UNEXPECTED_EOF);
+        if (binary->_in_memory && binary->_value_len <= ION_SPAN_AVAILABLE(preader->istream)) {
+            ION_SPAN_CONSUME(preader->istream, binary->_value_len);
+        }
+        else {
+            IONCHECK(ion_stream_skip(preader->istream, binary->_value_len, &skipped));
+            if (binary->_value_len != skipped) FAILWITH(IERR_UNEXPECTED_EOF);
+        }
     }
 
+next_value:
     value_start = ion_stream_get_position(preader->istream);
     if (value_start >= binary->_local_end) {
         goto at_eof;
@@ -156,10 +171,28 @@ iERR _ion_reader_binary_next(ION_READER *preader, ION_TYPE *p_value_type)
     // if we're at the top level we can reset the temp buffer
     depth = ION_COLLECTION_SIZE(&preader->typed_reader.binary._parent_stack);
 
+    if (binary->_in_memory) {
+        if (_ion_reader_binary_next_in_memory(preader, value_start)) {
+            *p_value_type = binary->_value_type;
+            SUCCEED();
+        }
+        // it may have read annotations before it left the value to us
+        _ion_collection_reset(&binary->_annotation_sids);
+        // or skipped a field outside the projection
+        if (ion_stream_get_position(preader->istream) != value_start) goto next_value;
+    }
+
     // read the field sid if we are in a structure
     if (binary->_in_struct) {
         IONCHECK(ion_binary_read_var_uint_32(preader->istream, &field_sid));
         binary->_value_field_id = field_sid;
+        if (ION_READER_PROJECTS_FIELDS(preader)) {
+            IONCHECK(_ion_reader_projection_select_field(preader, (SID)field_sid, NULL, &is_selected));
+            if (!is_selected) {
+                IONCHECK(_ion_reader_binary_skip_field_value(preader));
+                goto next_value;
+            }
+        }
     }
     else {
         binary->_value_field_id = -1;
@@ -279,6 +312,170 @@ at_eof:
     iRETURN;
 }
 
+// skips the value of a field outside the projection by its length, including
+// any annotations on it which are never looked at
+static iERR _ion_reader_binary_skip_field_value(ION_READER *preader)
+{
+    iENTER;
+    ION_BINARY_READER *binary = &preader->typed_reader.binary;
+    int                tid, length;
+    SIZE               skipped;
+
+    ION_GET(preader->istream, tid);
+    if (tid == EOF) FAILWITH(IERR_UNEXPECTED_EOF);
+    IONCHECK(_ion_reader_binary_local_read_length(preader, tid, &length));
+    if (ion_stream_get_position(preader->istream) + length > binary->_local_end) FAILWITH(IERR_INVALID_BINARY);
+
+    IONCHECK(ion_stream_skip(preader->istream, length, &skipped));
+    if (skipped != length) FAILWITH(IERR_UNEXPECTED_EOF);
+
+    iRETURN;
+}
+
+// decodes a VarUInt from *ppb, returning FALSE (with *ppb unchanged) if it
+// runs into limit or is over 32 bits, to leave it to ion_binary_read_var_uint_32
+static inline BOOL _ion_reader_binary_decode_var_uint_32(BYTE **ppb, BYTE *limit, uint32_t *p_value)
+{
+    BYTE     *pb = *ppb;
+    uint64_t  value = 0;
+    int       b;
+
+#ifdef ION_BINARY_HAS_WORD_KERNELS
+    if (limit - pb >= ION_BINARY_WORD_KERNEL_BYTES) {
+        b = _ion_binary_decode_var_uint_word(pb, &value);
+        if (b < 1 || value > UINT32_MAX) return FALSE;
+        *ppb = pb + b;
+        *p_value = (uint32_t)value;
+        return TRUE;
+    }
+#endif
+    if (limit - pb > 5) limit = pb + 5;
+    do {
+        if (pb >= limit) return FALSE;
+        b = *pb++;
+        value = (value << 7) | (b & 0x7F);
+    } while ((b & 0x80) == 0);
+    if (value > UINT32_MAX) return FALSE;
+
+    *ppb = pb;
+    *p_value = (uint32_t)value;
+    return TRUE;
+}
+
+// the in place version of _ion_reader_binary_local_read_length
+static inline BOOL _ion_reader_binary_decode_length(int tid, BYTE **ppb, BYTE *limit, uint32_t *p_length)
+{
+    uint32_t len = getLowNibble(tid);
+
+    switch (getTypeCode(tid)) {
+    case TID_NULL:
+        if (len != ION_lnIsNull) return FALSE;
+        // fall through
+    case TID_BOOL:
+        *p_length = 0;
+        return TRUE;
+    case TID_STRUCT:
+        if (len == 1) len = ION_lnIsVarLen; // ordered struct
+        // fall through
+    case TID_POS_INT:
+    case TID_NEG_INT:
+    case TID_FLOAT:
+    case TID_DECIMAL:
+    case TID_TIMESTAMP:
+    case TID_SYMBOL:
+    case TID_STRING:
+    case TID_CLOB:
+    case TID_BLOB:
+    case TID_LIST:
+    case TID_SEXP:
+    case TID_UTA:
+        if (len == ION_lnIsVarLen) return _ion_reader_binary_decode_var_uint_32(ppb, limit, p_length);
+        *p_length = (len == ION_lnIsNull) ? 0 : len;
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
+// next() for input that's all in memory (see _in_memory): decodes the field
+// sid, annotations, type descriptor and length of the value at value_start
+// straight from the stream's buffer and consumes them in one step.
+// Returns FALSE, having consumed nothing, for whatever it leaves to the
+// byte at a time path: a header that runs past the end of the buffer, a
+// VarUInt over 32 bits, a possible system value at the top level, and
+// anything invalid, which that path reports. It also returns FALSE after
+// consuming a field outside the projection, which is skipped by length
+static BOOL _ion_reader_binary_next_in_memory(ION_READER *preader, POSITION value_start)
+{
+    ION_BINARY_READER *binary = &preader->typed_reader.binary;
+    ION_STREAM        *stream = preader->istream;
+    BYTE              *start  = ION_SPAN_START(stream);
+    BYTE              *limit  = start + ION_SPAN_AVAILABLE(stream);
+    BYTE              *pb = start, *tid_start, *annotation_start = NULL, *annotated_start = NULL, *annotation_end;
+    uint32_t           field_sid = 0, annotated_len = 0, annotation_len, length;
+    int                tid;
+    SID               *psid;
+    BOOL               is_selected;
+
+    if (binary->_in_struct) {
+        if (!_ion_reader_binary_decode_var_uint_32(&pb, limit, &field_sid)) return FALSE;
+        if (ION_READER_PROJECTS_FIELDS(preader)) {
+            if (_ion_reader_projection_select_field(preader, (SID)field_sid, NULL, &is_selected) != IERR_OK) return FALSE;
+            if (!is_selected) {
+                if (pb >= limit) return FALSE;
+                tid = *pb++;
+                if (!_ion_reader_binary_decode_length(tid, &pb, limit, &length)) return FALSE;
+                if (length > (uint32_t)(limit - pb)) return FALSE;
+                if (value_start + (pb - start) + (int64_t)length > binary->_local_end) return FALSE;
+                ION_SPAN_CONSUME(stream, (SIZE)(pb - start) + (SIZE)length);
+                return FALSE;
+            }
+        }
+    }
+
+    tid_start = pb;
+    if (pb >= limit) return FALSE;
+    tid = *pb++;
+
+    if (getTypeCode(tid) == TID_UTA) {
+        // the version marker and symbol tables are both 0xE_ at the top level
+        if (EXPECT_SYMBOL_TABLE(binary)) return FALSE;
+
+        annotation_start = tid_start;
+        if (!_ion_reader_binary_decode_length(tid, &pb, limit, &annotated_len)) return FALSE;
+        annotated_start = pb;
+        if (!_ion_reader_binary_decode_var_uint_32(&pb, limit, &annotation_len)) return FALSE;
+        if (annotation_len < 1 || annotation_len > (uint32_t)(limit - pb)) return FALSE;
+        annotation_end = pb + annotation_len;
+        while (pb < annotation_end) {
+            psid = (SID *)_ion_collection_push(&binary->_annotation_sids);
+            if (!psid) return FALSE;
+            if (!_ion_reader_binary_decode_var_uint_32(&pb, limit, (uint32_t *)psid)) return FALSE;
+            if (pb > annotation_end) return FALSE;
+        }
+
+        tid_start = pb;
+        if (pb >= limit) return FALSE;
+        tid = *pb++;
+        if (getTypeCode(tid) == TID_UTA) return FALSE;
+    }
+
+    if (!_ion_reader_binary_decode_length(tid, &pb, limit, &length)) return FALSE;
+    if (annotation_start && (annotated_start - start) + (int64_t)annotated_len != (pb - start) + (int64_t)length) {
+        return FALSE;
+    }
+
+    binary->_value_field_id   = binary->_in_struct ? (SID)field_sid : -1;
+    binary->_annotation_start = annotation_start ? value_start + (annotation_start - start) : -1;
+    binary->_value_tid        = tid;
+    binary->_value_len        = (int32_t)length;
+    binary->_value_start      = value_start + (tid_start - start);
+    binary->_value_type       = ion_helper_get_iontype_from_tid(getTypeCode(tid));
+    binary->_state            = S_BEFORE_CONTENTS;
+    ION_SPAN_CONSUME(stream, (SIZE)(pb - start));
+
+    return TRUE;
+}
 
 iERR _ion_reader_binary_step_in(ION_READER *preader)
 {
@@ -599,7 +796,7 @@ iERR _ion_reader_binary_get_an_annotation(ION_READER *preader, int32_t idx, ION_
         
         
     IONCHECK(_ion_symbol_table_find_by_sid_helper(preader->_current_symtab, sid, &pstr));
-    IONCHECK(ion_string_copy_to_owner(preader->_temp_entity_pool, p_str, pstr));
+    ION_STRING_ASSIGN(p_str, pstr);
 
     iRETURN;
 }
@@ -630,7 +827,7 @@ iERR _ion_reader_binary_get_annotations(ION_READER *preader, ION_STRING *p_annot
         if (!psid) break;
         if ((*psid) <= UNKNOWN_SID) FAILWITH(IERR_INVALID_SYMBOL);
         IONCHECK(_ion_symbol_table_find_by_sid_helper(preader->_current_symtab, *psid, &pstr));
-        IONCHECK(ion_string_copy_to_owner(preader->_temp_entity_pool, &p_annotations[ii], pstr));
+        ION_STRING_ASSIGN(&p_annotations[ii], pstr);
     }
 
     ION_COLLECTION_CLOSE(cursor);
@@ -1157,15 +1354,19 @@ iERR _ion_reader_binary_get_string_length(ION_READER *preader, SIZE *p_length)
 }
 
 // This reads the entire contents of the string (or string of a symbol id)
-// in a single go, returning the value in an ION_STRING
+// in a single go, returning the value in an ION_STRING. Nothing is copied
+// if we can help it: a symbol's text is the symbol table's, and a string
+// that's all in the stream's current page (or buffer) is returned where it
+// lies. Either way it's only good until the reader moves on
 iERR _ion_reader_binary_read_string(ION_READER *preader, ION_STRING *p_str)
 {
     iENTER;
     ION_BINARY_READER *binary;
     ION_STRING        *pstr;
     int                tid;
-    SIZE               str_len, bytes_read;
+    SIZE               str_len, bytes_read, available;
     SID                sid;
+    BYTE              *span;
 
     ASSERT(preader && preader->type == ion_type_binary_reader);
     ASSERT(p_str != NULL);
@@ -1185,20 +1386,33 @@ iERR _ion_reader_binary_read_string(ION_READER *preader, ION_STRING *p_str)
     }
     else {
         if (tid == TID_STRING) {
-			str_len = binary->_value_len;
-            if (p_str->length < str_len || !p_str->value) {
-				p_str->value = ion_alloc_with_owner(preader->_temp_entity_pool, str_len);
-				if (!p_str->value) FAILWITH(IERR_NO_MEMORY);
+            str_len = binary->_value_len;
+            IONCHECK(_ion_binary_reader_fits_container(preader, str_len));
+            IONCHECK(ion_stream_peek_span(preader->istream, &span, &available));
+            if (str_len > 0 && available >= str_len) {
+                if (preader->options.skip_character_validation == FALSE) {
+                    IONCHECK(_ion_reader_binary_validate_utf8(span, str_len, preader->_expected_remaining_utf8_bytes, &preader->_expected_remaining_utf8_bytes));
+                }
+                IONCHECK(ion_stream_consume(preader->istream, str_len));
+                p_str->value  = span;
+                p_str->length = str_len;
+            }
+            else {
+                // it crosses into the next page, so it has to be put together
+                // in the temp pool. The caller's buffer (which may well be one
+                // we handed out before) is never reused for this
+                p_str->value = ion_alloc_with_owner(preader->_temp_entity_pool, str_len);
+                if (!p_str->value) FAILWITH(IERR_NO_MEMORY);
+                IONCHECK(_ion_reader_binary_read_string_bytes(preader, FALSE, p_str->value, str_len, &bytes_read));
+                if (bytes_read != str_len) FAILWITH(IERR_UNEXPECTED_EOF);
+                p_str->length = str_len;
             }
-			IONCHECK(_ion_reader_binary_read_string_bytes(preader, FALSE, p_str->value, str_len, &bytes_read));
-            if (bytes_read != str_len) FAILWITH(IERR_UNEXPECTED_EOF);
-			p_str->length = str_len;
         }
         else if (tid == TID_SYMBOL) {
             IONCHECK(_ion_reader_binary_read_symbol_sid(preader, &sid));
             if (sid <= UNKNOWN_SID) FAILWITH(IERR_INVALID_SYMBOL);
             IONCHECK(_ion_symbol_table_find_by_sid_helper(preader->_current_symtab, sid, &pstr));
-            IONCHECK(ion_string_copy_to_owner(preader->_temp_entity_pool, p_str, pstr));
+            ION_STRING_ASSIGN(p_str, pstr);
         }
         else {
             FAILWITH(IERR_INVALID_STATE);
@@ -1268,9 +1482,156 @@ iERR _ion_reader_binary_read_string_bytes(ION_READER *preader, BOOL accept_parti
     iRETURN;
 }
 
+//
+// vector utf8 validation. These check exactly what the byte at a time loop
+// below does, that every continuation byte (10xx xxxx) follows a header that
+// expects it and every header is followed by as many as it expects, and that
+// there are no 1111 1xxx bytes, 16 or 32 bytes at a time: a byte has to be a
+// continuation byte if and only if the byte 1 before it is 11xx xxxx, the one
+// 2 before is 111x xxxx or the one 3 before is 1111 0xxx.
+// Each returns how many bytes it validated, which is up to the start of the
+// character the last whole block cuts off (the byte loop does the rest) or
+// -1 if the bytes aren't valid
+//
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ION_HAS_SIMD_UTF8
+#include <immintrin.h>
+
+typedef SIZE (*ION_UTF8_SPAN_VALIDATOR)(BYTE *buf, SIZE len);
+
+// backs up from the end of the validated bytes to the start of a character
+// that isn't finished there
+static SIZE _ion_reader_binary_utf8_character_start(BYTE *buf, SIZE validated)
+{
+    if (validated < 3)                   return validated;
+    if (buf[validated - 1] >= 0xC0)      return validated - 1;
+    if (buf[validated - 2] >= 0xE0)      return validated - 2;
+    if (buf[validated - 3] >= 0xF0)      return validated - 3;
+    return validated;
+}
+
+__attribute__((target("sse4.1")))
+static SIZE _ion_reader_binary_validate_utf8_sse(BYTE *buf, SIZE len)
+{
+    const __m128i high_bit  = _mm_set1_epi8((char)0x80);
+    const __m128i cont_mask = _mm_set1_epi8((char)0xC0);
+    const __m128i max_cont  = _mm_set1_epi8((char)0xBF);
+    const __m128i max_2byte = _mm_set1_epi8((char)0xDF);
+    const __m128i max_3byte = _mm_set1_epi8((char)0xEF);
+    const __m128i max_4byte = _mm_set1_epi8((char)0xF7);
+    __m128i prev = _mm_setzero_si128(), error = _mm_setzero_si128();
+    __m128i in, needed, is_cont;
+    SIZE    pos;
+
+    for (pos = 0; pos + 16 <= len; pos += 16) {
+        in = _mm_loadu_si128((const __m128i *)(buf + pos));
+        if (!_mm_testz_si128(_mm_or_si128(in, prev), high_bit)) {
+            needed  = _mm_or_si128(_mm_or_si128(_mm_subs_epu8(_mm_alignr_epi8(in, prev, 15), max_cont)
+                                               ,_mm_subs_epu8(_mm_alignr_epi8(in, prev, 14), max_2byte))
+                                  ,_mm_subs_epu8(_mm_alignr_epi8(in, prev, 13), max_3byte));
+            needed  = _mm_cmpeq_epi8(needed, _mm_setzero_si128());      // 0xFF where it's not needed
+            is_cont = _mm_cmpeq_epi8(_mm_and_si128(in, cont_mask), high_bit);
+            error   = _mm_or_si128(error, _mm_andnot_si128(_mm_xor_si128(needed, is_cont), _mm_set1_epi8((char)0xFF)));
+            error   = _mm_or_si128(error, _mm_subs_epu8(in, max_4byte));
+            if (!_mm_testz_si128(error, error)) return -1;
+        }
+        prev = in;
+    }
+
+    return _ion_reader_binary_utf8_character_start(buf, pos);
+}
+
+__attribute__((target("avx2")))
+static SIZE _ion_reader_binary_validate_utf8_avx2(BYTE *buf, SIZE len)
+{
+    const __m256i high_bit  = _mm256_set1_epi8((char)0x80);
+    const __m256i cont_mask = _mm256_set1_epi8((char)0xC0);
+    const __m256i max_cont  = _mm256_set1_epi8((char)0xBF);
+    const __m256i max_2byte = _mm256_set1_epi8((char)0xDF);
+    const __m256i max_3byte = _mm256_set1_epi8((char)0xEF);
+    const __m256i max_4byte = _mm256_set1_epi8((char)0xF7);
+    __m256i prev = _mm256_setzero_si256(), error = _mm256_setzero_si256();
+    __m256i in, before, needed, is_cont;
+    SIZE    pos;
+
+    for (pos = 0; pos + 32 <= len; pos += 32) {
+        in = _mm256_loadu_si256((const __m256i *)(buf + pos));
+        if (!_mm256_testz_si256(_mm256_or_si256(in, prev), high_bit)) {
+            // alignr works within each 128 bit lane, so it's given the 16 bytes before each lane
+            before  = _mm256_permute2x128_si256(prev, in, 0x21);
+            needed  = _mm256_or_si256(_mm256_or_si256(_mm256_subs_epu8(_mm256_alignr_epi8(in, before, 15), max_cont)
+                                                     ,_mm256_subs_epu8(_mm256_alignr_epi8(in, before, 14), max_2byte))
+                                     ,_mm256_subs_epu8(_mm256_alignr_epi8(in, before, 13), max_3byte));
+            needed  = _mm256_cmpeq_epi8(needed, _mm256_setzero_si256());
+            is_cont = _mm256_cmpeq_epi8(_mm256_and_si256(in, cont_mask), high_bit);
+            error   = _mm256_or_si256(error, _mm256_andnot_si256(_mm256_xor_si256(needed, is_cont), _mm256_set1_epi8((char)0xFF)));
+            error   = _mm256_or_si256(error, _mm256_subs_epu8(in, max_4byte));
+            if (!_mm256_testz_si256(error, error)) return -1;
+        }
+        prev = in;
+    }
+
+    return _ion_reader_binary_utf8_character_start(buf, pos);
+}
+
+static SIZE _ion_reader_binary_validate_utf8_resolve(BYTE *buf, SIZE len);
+
+static ION_UTF8_SPAN_VALIDATOR _ion_reader_binary_utf8_span_validator = _ion_reader_binary_validate_utf8_resolve;
+
+// picks the widest validator the cpu supports the first time it's needed
+static SIZE _ion_reader_binary_validate_utf8_resolve(BYTE *buf, SIZE len)
+{
+    ION_UTF8_SPAN_VALIDATOR validator = NULL;
+
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        validator = _ion_reader_binary_validate_utf8_avx2;
+    }
+    else if (__builtin_cpu_supports("sse4.1")) {
+        validator = _ion_reader_binary_validate_utf8_sse;
+    }
+    if (validator == NULL) {
+        __atomic_store_n(&_ion_reader_binary_utf8_span_validator, NULL, __ATOMIC_RELAXED);
+        return 0;
+    }
+    __atomic_store_n(&_ion_reader_binary_utf8_span_validator, validator, __ATOMIC_RELAXED);
+    return (*validator)(buf, len);
+}
+#endif
+
+// throws error if the buffer (buf) contains an invalid utf8 sequence
+iERR _ion_reader_binary_validate_utf8(BYTE *buf, SIZE len, SIZE expected_remaining, SIZE *p_expected_remaining)
+{
+    iENTER;
+#ifdef ION_HAS_SIMD_UTF8
+    ION_UTF8_SPAN_VALIDATOR validator;
+    SIZE                    validated;
+
+    // finish the character the last partial read cut off, then hand
+    // the rest to the vector validator if there's enough for it
+    while (expected_remaining > 0 && len > 0) {
+        if (!ION_is_utf8_trailing_char_header(*buf)) FAILWITH(IERR_INVALID_UTF8);
+        expected_remaining--;
+        buf++;
+        len--;
+    }
+    if (len >= 16) {
+        validator = __atomic_load_n(&_ion_reader_binary_utf8_span_validator, __ATOMIC_RELAXED);
+        if (validator) {
+            validated = (*validator)(buf, len);
+            if (validated < 0) FAILWITH(IERR_INVALID_UTF8);
+            buf += validated;
+            len -= validated;
+        }
+    }
+#endif
+    IONCHECK(_ion_reader_binary_validate_utf8_bytes(buf, len, expected_remaining, p_expected_remaining));
+    iRETURN;
+}
+
 // throws error if the buffer (buf) contains an invalid utf8 sequence
 // (I hate to do this, but it's for validation)
-iERR _ion_reader_binary_validate_utf8(BYTE *buf, SIZE len, SIZE expected_remaining, SIZE *p_expected_remaining)
+static iERR _ion_reader_binary_validate_utf8_bytes(BYTE *buf, SIZE len, SIZE expected_remaining, SIZE *p_expected_remaining)
 {
     iENTER;
     uint32_t c;
@@ -1720,7 +2081,7 @@ iERR _ion_reader_binary_local_load_symbol_table(ION_READER *preader
                 case (intptr_t)tid_LIST:
                     manual_sid = 2;
                     IONCHECK( _ion_reader_binary_get_local_symbol_table_helper(preader, &plocal ));
-                    sid = plocal->symbols._count;
+                    sid = plocal->max_id;
                     break;
                 default:
                     // we'll just skip this one
@@ -1837,10 +2198,12 @@ iERR _ion_reader_binary_local_load_symbol_table_import(ION_READER *preader, ION_
     SID                      field_sid;
     int                      version = -1;
     int                      maxid = -1;
-    ION_STRING               name;
+    ION_STRING               name, str;
     
     ASSERT(preader && preader->type == ion_type_binary_reader);
     ASSERT(preader->typed_reader.binary._value_type == tid_STRUCT);
+
+    ION_STRING_INIT(&name);
     
     IONCHECK(_ion_reader_step_in_helper(preader));
     for (;;) {
@@ -1851,8 +2214,11 @@ iERR _ion_reader_binary_local_load_symbol_table_import(ION_READER *preader, ION_
         switch(field_sid) {
         case ION_SYS_SID_NAME:
             if (type == tid_STRING || type == tid_SYMBOL) {
-                ION_STRING_INIT(&name);
-                IONCHECK(_ion_reader_read_string_helper(preader, &name));
+                // the string may be the input's own bytes, which need not
+                // outlast the reads of the rest of the import
+                ION_STRING_INIT(&str);
+                IONCHECK(_ion_reader_read_string_helper(preader, &str));
+                IONCHECK(ion_string_copy_to_owner(preader->_temp_entity_pool, &name, &str));
             }
             break;
         case ION_SYS_SID_VERSION:
@@ -1900,7 +2266,9 @@ iERR _ion_reader_binary_local_load_symbol_table_import(ION_READER *preader, ION_
     
     IONCHECK(ion_string_copy_to_owner(preader, &pimport->name, &name));
     pimport->version = version;
-    if (maxid != -1 && itab != NULL) {
+    // the import's own max_id says how many sids it takes, whatever the
+    // version we found has
+    if (maxid == -1 && itab != NULL) {
         IONCHECK(_ion_symbol_table_get_max_sid_helper(itab, &maxid));
     }
     pimport->max_id = maxid;
@@ -1921,6 +2289,7 @@ iERR _ion_reader_binary_local_reset_symbol_table(ION_READER *preader)
 
     IONCHECK(_ion_symbol_table_get_system_symbol_helper(&system, ION_SYSTEM_VERSION));
     preader->_current_symtab = system;
+    preader->_symtab_generation++;
 
     iRETURN;
 }
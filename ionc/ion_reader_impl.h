@@ -54,6 +54,16 @@ typedef struct _ion_reader_text
     POSITION              _value_end;
     POSITION              _annotation_start;
 
+    /** the scanner's line and offset in the line at _value_start and
+     *  _annotation_start, so a reader that seeks back to the value can
+     *  go on counting lines from where it was
+     *
+     */
+    int                   _value_start_line;
+    int                   _value_start_offset;
+    int                   _annotation_start_line;
+    int                   _annotation_start_offset;
+
     /** space for the field name. The string value always points to the field name buffer and the length of the string is the
      *  number of bytes in the current field name. The actual characters are in the field name buffer and we limit field names
      *  to field name buffer length.
@@ -141,6 +151,7 @@ typedef struct _ion_reader_binary
     SID             _value_field_id;
     int             _value_tid;
     int32_t         _value_len;
+    BOOL            _in_memory;   // the input is all in memory, next() decodes value headers in place (see _ion_reader_binary_next_in_memory)
 
     ION_COLLECTION _annotation_sids; // ~ 6 ints array of ION_STRING+
 
@@ -151,6 +162,42 @@ typedef struct _ion_reader_binary
 
 #define BINARY(preader) (&((preader)->typed_reader.binary))
 
+// the field paths ion_reader_next is limited to (see ion_reader_add_projection_path)
+// as a tree of field names: each node's children are the fields read in the
+// values it names
+typedef struct _ion_reader_projection_node ION_READER_PROJECTION_NODE;
+struct _ion_reader_projection_node
+{
+    ION_STRING                  name;
+    SID                         sid;          // name in the projection's symtab, for the binary reader
+    BOOL                        is_selected;  // the end of a path, all of the value is read
+    ION_READER_PROJECTION_NODE *children;
+    ION_READER_PROJECTION_NODE *next;         // sibling
+};
+
+typedef struct _ion_reader_projection_state
+{
+    ION_READER_PROJECTION_NODE *node;
+    BOOL                        in_struct;
+} ION_READER_PROJECTION_STATE;
+
+typedef struct _ion_reader_projection
+{
+    ION_READER_PROJECTION_NODE  *root;        // NULL if there's no projection
+    ION_SYMBOL_TABLE            *symtab;      // the table the node sids were looked up in
+    ION_READER_PROJECTION_STATE  current;     // the container the reader is in, node NULL when it reads every field
+    ION_READER_PROJECTION_NODE  *value;       // what stepping into the current value would make current
+    int                          depth;       // the depth current is for, as stepped into by the user
+    ION_COLLECTION               stack;       // ION_READER_PROJECTION_STATE of the containers stepped out to
+    void                        *pool;        // owner of the nodes
+} ION_READER_PROJECTION;
+
+// TRUE if the reader is in a struct that only some fields are read in
+#define ION_READER_PROJECTS_FIELDS(preader) \
+    ((preader)->_projection.current.node != NULL \
+  && (preader)->_projection.current.in_struct \
+  && (preader)->_projection.depth == (preader)->_depth)
+
 /** Read both text ion and binary ion data.
  *
  */
@@ -173,6 +220,7 @@ struct _ion_reader
 
     ION_SYMBOL_TABLE   *_current_symtab;
     ION_SYMBOL_TABLE   *_local_symtab_pool;         // memory pool for local symbol table we recycle
+    int64_t             _symtab_generation;         // changes whenever a version marker, local symbol table or the user replaces _current_symtab
     ION_READER        **_temp_entity_pool;          // memory pool for top level objects that we'll throw away
     
     struct {
@@ -181,6 +229,8 @@ struct _ion_reader
         ION_INT         _as_ion_int;
     } _int_helper;
 
+    ION_READER_PROJECTION _projection;
+
     union {
         ION_TEXT_READER   text;
         ION_BINARY_READER binary;
@@ -194,6 +244,7 @@ struct _ion_reader
 iERR _ion_reader_open_buffer_helper(ION_READER **p_preader, BYTE *buffer, SIZE buf_length, ION_READER_OPTIONS *p_options);
 iERR _ion_reader_open_stream_helper(ION_READER **p_preader, ION_STREAM *p_stream, ION_READER_OPTIONS *p_options);
 iERR _ion_reader_make_new_reader(ION_READER_OPTIONS *p_options, ION_READER **p_reader);
+void _ion_reader_stream_options(ION_READER_OPTIONS *p_options, ION_STREAM_OPTIONS *p_stream_options);
 iERR _ion_reader_set_options(ION_READER *preader, ION_READER_OPTIONS* p_options);
 void _ion_reader_initialize_option_defaults(ION_READER_OPTIONS *p_options);
 iERR _ion_reader_validate_options(ION_READER_OPTIONS* p_options);
@@ -202,6 +253,9 @@ iERR _ion_reader_initialize(ION_READER *preader, BYTE *version_buffer, SIZE vers
 iERR _ion_reader_get_catalog_helper(ION_READER *preader, ION_CATALOG **p_pcatalog);
 iERR _ion_reader_get_symbol_table_helper(ION_READER *preader, ION_SYMBOL_TABLE **p_psymtab);
 iERR _ion_reader_next_helper(ION_READER *preader, ION_TYPE *p_value_type);
+iERR _ion_reader_projection_select_field(ION_READER *preader, SID field_sid, ION_STRING *field_name, BOOL *p_is_selected);
+void _ion_reader_projection_reset(ION_READER *preader);
+void _ion_reader_clear_projection_helper(ION_READER *preader);
 iERR _ion_reader_step_in_helper(ION_READER *preader);
 iERR _ion_reader_step_out_helper(ION_READER *preader);
 iERR _ion_reader_get_depth_helper(ION_READER *preader, SIZE *p_depth);
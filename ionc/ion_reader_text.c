@@ -306,6 +306,8 @@ iERR _ion_reader_text_next(ION_READER *preader, ION_TYPE *p_value_type)
     // it's ready for the caller - save off the state we'll
     // need for later processing
     text->_value_start    = text->_scanner._value_start;
+    text->_value_start_line   = text->_scanner._value_start_line;
+    text->_value_start_offset = text->_scanner._value_start_offset;
     text->_value_sub_type = ist;
     text->_value_type     = IST_BASE_TYPE( ist );
     text->_state          = IST_FOLLOW_STATE( ist );
@@ -445,6 +447,8 @@ iERR _ion_reader_text_load_utas(ION_READER *preader, ION_SUB_TYPE *p_ist)
             // if this is our first annotation, remember where the first annotation started.
             if (text->_annotation_start == -1) {
                 text->_annotation_start = text->_scanner._value_start;
+                text->_annotation_start_line   = text->_scanner._value_start_line;
+                text->_annotation_start_offset = text->_scanner._value_start_offset;
             }
 
             // now we append the annotation ...
@@ -816,7 +820,12 @@ iERR _ion_reader_text_step_out(ION_READER *preader)
         FAILWITH(IERR_STACK_UNDERFLOW);
     }
 
-    if (text->_state != IPS_AFTER_VALUE) {
+    // straight after step in nothing has been recognized, and _value_sub_type
+    // is still the container we're in rather than a value inside it
+    if (text->_state != IPS_AFTER_VALUE
+     && text->_state != IPS_BEFORE_UTA
+     && text->_state != IPS_BEFORE_FIELDNAME
+    ) {
         uint16_t flags = text->_value_sub_type->flags;
         uint16_t looking_at_container = flags & FCF_IS_CONTAINER;
         if (looking_at_container) {
@@ -1232,6 +1241,48 @@ iERR _ion_reader_text_get_value_length(ION_READER *preader, SIZE *p_length)
     iRETURN;
 }
 
+iERR _ion_reader_text_get_value_line(ION_READER *preader, int32_t *p_line, int32_t *p_offset)
+{
+    iENTER;
+    ION_TEXT_READER  *text = &preader->typed_reader.text;
+
+    ASSERT(preader && preader->type == ion_type_text_reader);
+    ASSERT(p_line);
+    ASSERT(p_offset);
+
+    if (preader->_eof) {
+        FAILWITH(IERR_INVALID_STATE);
+    }
+
+    // the same start get_value_offset returns
+    if (text->_annotation_start >= 0) {
+        *p_line   = text->_annotation_start_line;
+        *p_offset = text->_annotation_start_offset;
+    }
+    else {
+        *p_line   = text->_value_start_line;
+        *p_offset = text->_value_start_offset;
+    }
+
+    iRETURN;
+}
+
+iERR _ion_reader_text_set_line(ION_READER *preader, int32_t line, int32_t offset)
+{
+    iENTER;
+    ION_TEXT_READER  *text = &preader->typed_reader.text;
+
+    ASSERT(preader && preader->type == ion_type_text_reader);
+
+    if (line < 1 || offset < 0) FAILWITH(IERR_INVALID_ARG);
+
+    text->_scanner._line         = line;
+    text->_scanner._offset       = offset;
+    text->_scanner._saved_offset = 0;
+
+    iRETURN;
+}
+
 iERR _ion_reader_text_read_null(ION_READER *preader, ION_TYPE *p_value)
 {
     iENTER;
@@ -309,6 +309,8 @@ iERR _ion_reader_text_get_annotations           (ION_READER *preader, ION_STRING
 iERR _ion_reader_text_get_annotation_sids       (ION_READER *preader, SID *p_sids, SIZE max_count, SIZE *p_count);
 iERR _ion_reader_text_get_value_offset          (ION_READER *preader, POSITION *p_offset);
 iERR _ion_reader_text_get_value_length          (ION_READER *preader, SIZE *p_length);
+iERR _ion_reader_text_get_value_line            (ION_READER *preader, int32_t *p_line, int32_t *p_offset);
+iERR _ion_reader_text_set_line                  (ION_READER *preader, int32_t line, int32_t offset);
 
 // value getting functions
 iERR _ion_reader_text_read_null                 (ION_READER *preader, ION_TYPE *p_value);
@@ -148,6 +148,9 @@ iERR _ion_scanner_next(ION_SCANNER *scanner, ION_SUB_TYPE *p_ist)
             scanner->_value_image.value = scanner->_value_buffer;
             scanner->_value_image.length = scanner->_unread_value_length;
         }
+        scanner->_value_start        = scanner->_unread_value_start;
+        scanner->_value_start_line   = scanner->_unread_value_start_line;
+        scanner->_value_start_offset = scanner->_unread_value_start_offset;
         scanner->_unread_sub_type = IST_NONE;
     }
     else {
@@ -165,6 +168,9 @@ iERR _ion_scanner_un_next(ION_SCANNER *scanner, ION_SUB_TYPE ist)
     scanner->_unread_sub_type = ist;
     scanner->_unread_value_location = scanner->_value_location;
     scanner->_unread_value_length = scanner->_value_image.length;
+    scanner->_unread_value_start = scanner->_value_start;
+    scanner->_unread_value_start_line = scanner->_value_start_line;
+    scanner->_unread_value_start_offset = scanner->_value_start_offset;
 
     SUCCEED();
 
@@ -203,6 +209,8 @@ iERR _ion_scanner_next_actual(ION_SCANNER *scanner, ION_SUB_TYPE *p_ist)
     // but the common case is not, so we'll set this to "in string" when we know
     scanner->_value_location = SVL_NONE;
     scanner->_value_start  = ion_stream_get_position( scanner->_stream ) - 1; // -1 because we read past the byte
+    scanner->_value_start_line   = scanner->_line;
+    scanner->_value_start_offset = scanner->_offset - 1;
     
     switch (c) {
     case EOF:
@@ -509,6 +517,7 @@ iERR _ion_scanner_read_past_whitespace(ION_SCANNER *scanner, int *p_char)
     int c;
 
     for (;;) {
+        IONCHECK(_ion_scanner_read_past_blanks_in_span(scanner));
         IONCHECK(_ion_scanner_read_char(scanner, &c));
         switch (c) {
         case ION_unicode_byte_order_mark_utf8_start:
@@ -622,6 +631,7 @@ iERR _ion_scanner_read_to_one_line_comment(ION_SCANNER *scanner)
     int c;
 
     for (;;) {
+        IONCHECK(_ion_scanner_read_to_end_of_line_in_span(scanner));
         IONCHECK(_ion_scanner_read_char(scanner, &c));
         switch (c) {
         // these are escaped new lines, they act as nothing which
@@ -658,6 +668,48 @@ end_of_comment:
     iRETURN;
 }
 
+// skips runs of spaces and tabs directly in the stream's buffer, these
+// are the bulk of most whitespace and they don't affect the line count
+iERR _ion_scanner_read_past_blanks_in_span(ION_SCANNER *scanner)
+{
+    iENTER;
+    BYTE *span, *pb, *end;
+    SIZE  available;
+
+    for (;;) {
+        IONCHECK(ion_stream_peek_span(scanner->_stream, &span, &available));
+        for (pb = span, end = span + available; pb < end; pb++) {
+            if (*pb != ' ' && *pb != '\t') break;
+        }
+        IONCHECK(ion_stream_consume(scanner->_stream, (SIZE)(pb - span)));
+        scanner->_offset += (int)(pb - span);
+        if (pb < end || available < 1) break;
+    }
+
+    iRETURN;
+}
+
+// skips the body of a single line comment directly in the stream's buffer,
+// leaving the new line (or eof) for _ion_scanner_read_char to consume
+iERR _ion_scanner_read_to_end_of_line_in_span(ION_SCANNER *scanner)
+{
+    iENTER;
+    BYTE *span, *pb, *end;
+    SIZE  available;
+
+    for (;;) {
+        IONCHECK(ion_stream_peek_span(scanner->_stream, &span, &available));
+        for (pb = span, end = span + available; pb < end; pb++) {
+            if (*pb == '\n' || *pb == '\r') break;
+        }
+        IONCHECK(ion_stream_consume(scanner->_stream, (SIZE)(pb - span)));
+        scanner->_offset += (int)(pb - span);
+        if (pb < end || available < 1) break;
+    }
+
+    iRETURN;
+}
+
 iERR _ion_scanner_unread_char(ION_SCANNER *scanner, int c)
 {
     iENTER;
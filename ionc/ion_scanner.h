@@ -81,6 +81,13 @@ typedef struct _ion_scanner
      */
     POSITION        _value_start;
 
+    /** _line and _offset as they were just before the first character
+     *  of the value at _value_start was read.
+     *
+     */
+    int             _value_start_line;
+    int             _value_start_offset;
+
     /** This small buffer is used to hold bytes used during base64 decoding. It is typically used
      *  when a base64 value cross an input page buffer.
      *
@@ -102,6 +109,9 @@ typedef struct _ion_scanner
     ION_SUB_TYPE    _unread_sub_type;
     int             _unread_value_location; // when we unread we need to 
     SIZE            _unread_value_length;
+    POSITION        _unread_value_start;    // and where it started
+    int             _unread_value_start_line;
+    int             _unread_value_start_offset;
 
     /** Used to keep track of the location (line number) of the current token. It's for debugging and error reporting.
      * @see _offset
@@ -374,6 +384,8 @@ iERR _ion_scanner_read_past_unicode_byte_order_mark (ION_SCANNER *scanner, int *
 iERR _ion_scanner_read_past_comment                 (ION_SCANNER *scanner, int *p_char);
 iERR _ion_scanner_read_to_one_line_comment          (ION_SCANNER *scanner);
 iERR _ion_scanner_read_to_end_of_long_comment       (ION_SCANNER *scanner);
+iERR _ion_scanner_read_past_blanks_in_span          (ION_SCANNER *scanner);
+iERR _ion_scanner_read_to_end_of_line_in_span       (ION_SCANNER *scanner);
 iERR _ion_scanner_unread_char                       (ION_SCANNER *scanner, int c);
 void _ion_scanner_unread_char_uncount_line          (ION_SCANNER *scanner);
 
@@ -123,11 +123,13 @@
   #include <io.h>
   // deal with Win32/64 lameness with respect to setting modes
   #define SET_MODE_BINARY(x) (_setmode(_fileno(x),_O_BINARY))
+  #define FILENO _fileno
   #define FSEEK _fseeki64
   // in windows we'll let the is tty fn handle this otherwise a rw file isn't likely to be a tty
   #define FD_IS_TTY(fd)           _isatty(fd) /* TODO */
 #else
   #define SET_MODE_BINARY(x) 1
+  #define FILENO fileno
   // We use the fseeko incase of MAC or iOS to support file size >2GB
   #define FSEEK fseeko
   #define FD_IS_TTY(fd)           FALSE /* TODO */
@@ -145,6 +147,10 @@
   #define LSEEK lseek
 #endif
 
+// pipes, sockets and the like can only be read or written front to back
+#define FD_CAN_SEEK(fd)         (LSEEK((fd), 0, SEEK_CUR) >= 0)
+#define FILE_CAN_SEEK(fp)       (FSEEK((fp), 0, SEEK_CUR) == 0)
+
 #ifdef ION_PLATFORM_WINDOWS
   #define WRITE _write
 #else
@@ -159,6 +165,24 @@
   #define READ read
 #endif
 
+// memory mapped input is only supported on posix systems, elsewhere
+// ion_stream_open_mmap simply opens a paged fd stream
+#ifndef ION_PLATFORM_WINDOWS
+  #include <sys/types.h>
+  #include <sys/stat.h>
+  #include <sys/mman.h>
+  #define ION_STREAM_HAS_MMAP
+#endif
+
+// gathered writes (one writev for a list of buffers) are also posix only,
+// elsewhere ion_stream_write_segments writes each segment through the page
+#ifndef ION_PLATFORM_WINDOWS
+  #include <sys/uio.h>
+  #include <errno.h>
+  #define ION_STREAM_HAS_WRITEV
+  #define IH_WRITEV_COUNT 64
+#endif
+
 
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -190,7 +214,7 @@ iERR ion_stream_open_buffer( BYTE *buffer       // pointer to memory to stream o
   }
  
   
-  IONCHECK(_ion_stream_open_helper(flags, buf_length, &stream));
+  IONCHECK(_ion_stream_open_helper(flags, buf_length, NULL, &stream));
 
   // here we manualy set up the state to mimic a paged stream
   // see _ion_stream_page_make_current
@@ -208,6 +232,13 @@ iERR ion_stream_open_buffer( BYTE *buffer       // pointer to memory to stream o
 }
 
 iERR ion_stream_open_stdin( ION_STREAM **pp_stream )
+{
+  iENTER;
+  IONCHECK(ion_stream_open_stdin_with_options(NULL, pp_stream));
+  iRETURN;
+}
+
+iERR ion_stream_open_stdin_with_options( ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream )
 {
   iENTER;
   ION_STREAM       *stream;
@@ -215,7 +246,7 @@ iERR ion_stream_open_stdin( ION_STREAM **pp_stream )
   
   if (!pp_stream) FAILWITH(IERR_INVALID_ARG);
 
-  IONCHECK(_ion_stream_open_helper(flags, g_Ion_Stream_Default_Page_Size, &stream));
+  IONCHECK(_ion_stream_open_options_helper(flags, p_options, &stream));
 
   SET_MODE_BINARY(stdin);
   stream->_fp = stdin;
@@ -233,6 +264,13 @@ iERR ion_stream_open_stdin( ION_STREAM **pp_stream )
 }
 
 iERR ion_stream_open_stdout( ION_STREAM **pp_stream )
+{
+  iENTER;
+  IONCHECK(ion_stream_open_stdout_with_options(NULL, pp_stream));
+  iRETURN;
+}
+
+iERR ion_stream_open_stdout_with_options( ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream )
 {
   iENTER;
   ION_STREAM       *stream;
@@ -240,7 +278,7 @@ iERR ion_stream_open_stdout( ION_STREAM **pp_stream )
 
   if (!pp_stream) FAILWITH(IERR_INVALID_ARG);
 
-  IONCHECK(_ion_stream_open_helper(flags, g_Ion_Stream_Default_Page_Size, &stream));
+  IONCHECK(_ion_stream_open_options_helper(flags, p_options, &stream));
   SET_MODE_BINARY(stdout);
   stream->_fp = stdout;
   IONCHECK(_ion_stream_fetch_position(stream, 0));
@@ -252,6 +290,13 @@ iERR ion_stream_open_stdout( ION_STREAM **pp_stream )
 }
 
 iERR ion_stream_open_file_in( FILE *in, ION_STREAM **pp_stream )
+{
+  iENTER;
+  IONCHECK(ion_stream_open_file_in_with_options(in, NULL, pp_stream));
+  iRETURN;
+}
+
+iERR ion_stream_open_file_in_with_options( FILE *in, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream )
 {
   iENTER;
   ION_STREAM       *stream;
@@ -259,8 +304,11 @@ iERR ion_stream_open_file_in( FILE *in, ION_STREAM **pp_stream )
 
   if (!pp_stream) FAILWITH(IERR_INVALID_ARG);
   if (!in) FAILWITH(IERR_INVALID_ARG);
+  if (!FILE_CAN_SEEK(in)) {
+    SET_FLAG_OFF(flags, FLAG_RANDOM_ACCESS);
+  }
 
-  IONCHECK(_ion_stream_open_helper(flags, g_Ion_Stream_Default_Page_Size, &stream));
+  IONCHECK(_ion_stream_open_options_helper(flags, p_options, &stream));
 
   stream->_fp = in;
   IONCHECK(_ion_stream_fetch_position(stream, 0));
@@ -271,7 +319,31 @@ iERR ion_stream_open_file_in( FILE *in, ION_STREAM **pp_stream )
   iRETURN;
 }
 
+iERR ion_stream_open_file_in_read_ahead( FILE *in, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream )
+{
+  iENTER;
+  ION_STREAM_FLAG   flags = ION_STREAM_FILE_IN;
+
+  if (!pp_stream) FAILWITH(IERR_INVALID_ARG);
+  if (!in) FAILWITH(IERR_INVALID_ARG);
+  if (!FILE_CAN_SEEK(in)) {
+    SET_FLAG_OFF(flags, FLAG_RANDOM_ACCESS);
+  }
+
+  IONCHECK(_ion_stream_open_read_ahead_helper(flags, (FILE *)in, FILENO(in), p_options, pp_stream));
+  SUCCEED();
+
+  iRETURN;
+}
+
 iERR ion_stream_open_file_out( FILE *out, ION_STREAM **pp_stream )
+{
+  iENTER;
+  IONCHECK(ion_stream_open_file_out_with_options(out, NULL, pp_stream));
+  iRETURN;
+}
+
+iERR ion_stream_open_file_out_with_options( FILE *out, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream )
 {
   iENTER;
   ION_STREAM       *stream;
@@ -279,8 +351,11 @@ iERR ion_stream_open_file_out( FILE *out, ION_STREAM **pp_stream )
    
   if (!pp_stream) FAILWITH(IERR_INVALID_ARG);
   if (!out) FAILWITH(IERR_INVALID_ARG);
+  if (!FILE_CAN_SEEK(out)) {
+    SET_FLAG_OFF(flags, FLAG_RANDOM_ACCESS);
+  }
    
-  IONCHECK(_ion_stream_open_helper(flags, g_Ion_Stream_Default_Page_Size, &stream));
+  IONCHECK(_ion_stream_open_options_helper(flags, p_options, &stream));
   stream->_fp = out;
   IONCHECK(_ion_stream_fetch_position(stream, 0));
    
@@ -291,6 +366,13 @@ iERR ion_stream_open_file_out( FILE *out, ION_STREAM **pp_stream )
 }
 
 iERR ion_stream_open_file_rw( FILE *fp, BOOL cache_all, ION_STREAM **pp_stream )
+{
+  iENTER;
+  IONCHECK(ion_stream_open_file_rw_with_options(fp, cache_all, NULL, pp_stream));
+  iRETURN;
+}
+
+iERR ion_stream_open_file_rw_with_options( FILE *fp, BOOL cache_all, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream )
 {
   iENTER;
   ION_STREAM       *stream;
@@ -298,8 +380,11 @@ iERR ion_stream_open_file_rw( FILE *fp, BOOL cache_all, ION_STREAM **pp_stream )
    
   if (!pp_stream) FAILWITH(IERR_INVALID_ARG);
   if (!fp) FAILWITH(IERR_INVALID_ARG);
+  if (!FILE_CAN_SEEK(fp)) {
+    SET_FLAG_OFF(flags, FLAG_RANDOM_ACCESS);
+  }
 
-  IONCHECK(_ion_stream_open_helper(flags, g_Ion_Stream_Default_Page_Size, &stream));
+  IONCHECK(_ion_stream_open_options_helper(flags, p_options, &stream));
 
   stream->_fp = fp;
   IONCHECK(_ion_stream_fetch_position(stream, 0));
@@ -311,6 +396,13 @@ iERR ion_stream_open_file_rw( FILE *fp, BOOL cache_all, ION_STREAM **pp_stream )
 }
 
 iERR ion_stream_open_fd_in( int fd_in, ION_STREAM **pp_stream )
+{
+  iENTER;
+  IONCHECK(ion_stream_open_fd_in_with_options(fd_in, NULL, pp_stream));
+  iRETURN;
+}
+
+iERR ion_stream_open_fd_in_with_options( int fd_in, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream )
 {
   iENTER;
   ION_STREAM       *stream;
@@ -322,8 +414,11 @@ iERR ion_stream_open_fd_in( int fd_in, ION_STREAM **pp_stream )
   if ( FD_IS_TTY(fd_in) ) {
 	  flags |= FLAG_IS_TTY;  // or should we throw an error ?
   }
+  else if ( !FD_CAN_SEEK(fd_in) ) {
+	  SET_FLAG_OFF(flags, FLAG_RANDOM_ACCESS);
+  }
 
-  IONCHECK(_ion_stream_open_helper(flags, g_Ion_Stream_Default_Page_Size, &stream));
+  IONCHECK(_ion_stream_open_options_helper(flags, p_options, &stream));
   stream->_fp = (FILE *)fd_in;
   IONCHECK(_ion_stream_fetch_position(stream, 0));
   
@@ -333,7 +428,35 @@ iERR ion_stream_open_fd_in( int fd_in, ION_STREAM **pp_stream )
   iRETURN;
 }
 
+iERR ion_stream_open_fd_in_read_ahead( int fd_in, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream )
+{
+  iENTER;
+  ION_STREAM_FLAG   flags = ION_STREAM_FD_IN;
+
+  if (!pp_stream)  FAILWITH(IERR_INVALID_ARG);
+  if (fd_in == -1) FAILWITH(IERR_INVALID_ARG);
+
+  if ( FD_IS_TTY(fd_in) ) {
+	  flags |= FLAG_IS_TTY;
+  }
+  else if ( !FD_CAN_SEEK(fd_in) ) {
+	  SET_FLAG_OFF(flags, FLAG_RANDOM_ACCESS);
+  }
+
+  IONCHECK(_ion_stream_open_read_ahead_helper(flags, (FILE *)fd_in, fd_in, p_options, pp_stream));
+  SUCCEED();
+
+  iRETURN;
+}
+
 iERR ion_stream_open_fd_out( int fd_out, ION_STREAM **pp_stream )
+{
+  iENTER;
+  IONCHECK(ion_stream_open_fd_out_with_options(fd_out, NULL, pp_stream));
+  iRETURN;
+}
+
+iERR ion_stream_open_fd_out_with_options( int fd_out, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream )
 {
   iENTER;
   ION_STREAM       *stream;
@@ -345,8 +468,11 @@ iERR ion_stream_open_fd_out( int fd_out, ION_STREAM **pp_stream )
   if ( FD_IS_TTY(fd_out) ) {
 	  flags |= FLAG_IS_TTY;
   }
+  else if ( !FD_CAN_SEEK(fd_out) ) {
+	  SET_FLAG_OFF(flags, FLAG_RANDOM_ACCESS);
+  }
 
-  IONCHECK(_ion_stream_open_helper(flags, g_Ion_Stream_Default_Page_Size, &stream));
+  IONCHECK(_ion_stream_open_options_helper(flags, p_options, &stream));
   stream->_fp = (FILE *)fd_out;
   IONCHECK(_ion_stream_fetch_position(stream, 0));
   
@@ -357,6 +483,13 @@ iERR ion_stream_open_fd_out( int fd_out, ION_STREAM **pp_stream )
 }
 
 iERR ion_stream_open_fd_rw( int fd, BOOL cache_all, ION_STREAM **pp_stream )
+{
+  iENTER;
+  IONCHECK(ion_stream_open_fd_rw_with_options(fd, cache_all, NULL, pp_stream));
+  iRETURN;
+}
+
+iERR ion_stream_open_fd_rw_with_options( int fd, BOOL cache_all, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream )
 {
   iENTER;
   ION_STREAM       *stream;
@@ -368,8 +501,11 @@ iERR ion_stream_open_fd_rw( int fd, BOOL cache_all, ION_STREAM **pp_stream )
   if ( FD_IS_TTY(fd) ) {
 	  flags |= FLAG_IS_TTY;  // or should we throw an error ?
   }
+  else if ( !FD_CAN_SEEK(fd) ) {
+	  SET_FLAG_OFF(flags, FLAG_RANDOM_ACCESS);
+  }
 
-  IONCHECK(_ion_stream_open_helper(flags, g_Ion_Stream_Default_Page_Size, &stream));
+  IONCHECK(_ion_stream_open_options_helper(flags, p_options, &stream));
   stream->_fp = (FILE *)fd;
   IONCHECK(_ion_stream_fetch_position(stream, 0));
   
@@ -379,7 +515,229 @@ iERR ion_stream_open_fd_rw( int fd, BOOL cache_all, ION_STREAM **pp_stream )
   iRETURN;
 }
 
+iERR ion_stream_open_mmap( int fd_in, ION_STREAM **pp_stream )
+{
+  iENTER;
+#ifdef ION_STREAM_HAS_MMAP
+  ION_STREAM        *stream = NULL;
+  ION_STREAM_MAPPED *mapped;
+  struct stat        file_stat;
+  void              *map_base;
+#endif
+
+  if (!pp_stream)  FAILWITH(IERR_INVALID_ARG);
+  if (fd_in == -1) FAILWITH(IERR_INVALID_ARG);
+
+#ifdef ION_STREAM_HAS_MMAP
+  // only a non-empty regular file can be mapped, anything else (pipes,
+  // sockets, tty's) is read through the normal paged fd stream
+  if (fstat(fd_in, &file_stat) != 0
+   || !S_ISREG(file_stat.st_mode)
+   || file_stat.st_size <= 0
+   || (uint64_t)file_stat.st_size > (uint64_t)SIZE_MAX
+  ) {
+    IONCHECK(ion_stream_open_fd_in(fd_in, pp_stream));
+    SUCCEED();
+  }
+
+  map_base = mmap(NULL, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, fd_in, 0);
+  if (map_base == MAP_FAILED) {
+    IONCHECK(ion_stream_open_fd_in(fd_in, pp_stream));
+    SUCCEED();
+  }
+
+  // we read front to back, so let the kernel read ahead aggressively. These
+  // are only hints, so a failure here is not an error
+#ifdef MADV_SEQUENTIAL
+  madvise(map_base, (size_t)file_stat.st_size, MADV_SEQUENTIAL);
+#endif
+#ifdef MADV_WILLNEED
+  madvise(map_base, (size_t)file_stat.st_size, MADV_WILLNEED);
+#endif
+
+  err = _ion_stream_open_helper(ION_STREAM_MMAP_IN, IH_MMAP_WINDOW_SIZE, NULL, &stream);
+  if (err) {
+    munmap(map_base, (size_t)file_stat.st_size);
+    FAILWITH(err);
+  }
+
+  mapped = MAPPED_STREAM(stream);
+  mapped->_map_base   = (BYTE *)map_base;
+  mapped->_map_length = (POSITION)file_stat.st_size;
+
+  // this sets up the first window onto the mapping, much
+  // like the user buffer set up in ion_stream_open_buffer
+  IONCHECK(_ion_stream_mapped_fetch_position(stream, 0));
+
+  *pp_stream = stream;
+  stream = NULL;
+#else
+  IONCHECK(ion_stream_open_fd_in(fd_in, pp_stream));
+#endif
+  SUCCEED();
+
+fail:
+#ifdef ION_STREAM_HAS_MMAP
+  // closing the stream unmaps the file as well
+  if (stream) {
+    ion_stream_close(stream);
+  }
+#endif
+  RETURN(__location_name__, __line__, __count__++, err);
+}
+
+iERR ion_stream_open_segments( ION_STREAM_SEGMENT *segments, int32_t count, ION_STREAM **pp_stream )
+{
+  iENTER;
+  ION_STREAM           *stream = NULL;
+  ION_STREAM_SEGMENTED *segmented;
+  POSITION              length = 0;
+  int32_t               ii;
+
+  if (!pp_stream) FAILWITH(IERR_INVALID_ARG);
+  if (count < 0)  FAILWITH(IERR_INVALID_ARG);
+  if (count > 0 && !segments) FAILWITH(IERR_INVALID_ARG);
+  for (ii = 0; ii < count; ii++) {
+    if (segments[ii].length < 0) FAILWITH(IERR_INVALID_ARG);
+    if (segments[ii].length > 0 && !segments[ii].data) FAILWITH(IERR_INVALID_ARG);
+  }
+
+  IONCHECK(_ion_stream_open_helper(ION_STREAM_SEGMENTS_IN, 0, NULL, &stream));
+  segmented = SEGMENTED_STREAM(stream);
+
+  if (count > 0) {
+    segmented->_segments = (ION_STREAM_SEGMENT *)ion_alloc_with_owner(stream, count * sizeof(ION_STREAM_SEGMENT));
+    segmented->_starts = (POSITION *)ion_alloc_with_owner(stream, count * sizeof(POSITION));
+    if (!segmented->_segments || !segmented->_starts) {
+      ion_free_owner(stream);
+      FAILWITH(IERR_NO_MEMORY);
+    }
+    for (ii = 0; ii < count; ii++) {
+      segmented->_segments[ii] = segments[ii];
+      segmented->_starts[ii] = length;
+      length += segments[ii].length;
+    }
+  }
+  segmented->_count   = count;
+  segmented->_current = 0;
+  segmented->_length  = length;
+
+  // this puts the window on the first segment with data in it, an
+  // empty stream is just at eof
+  err = _ion_stream_segments_fetch_position(stream, 0);
+  if (err && err != IERR_EOF) {
+    ion_free_owner(stream);
+    FAILWITH(err);
+  }
+
+  *pp_stream = stream;
+  SUCCEED();
+
+  iRETURN;
+}
+
+iERR ion_stream_open_segments_out( ION_STREAM_SEGMENT *segments, int32_t count, ION_STREAM_SEGMENT_HANDLER fn_handler, void *handler_state, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream )
+{
+  iENTER;
+  ION_STREAM           *stream = NULL;
+  ION_STREAM_SEGMENTED *segmented;
+  SIZE                  size = g_Ion_Stream_Default_Page_Size, max_size = 0;
+  ION_ALLOCATOR        *allocator = NULL;
+  int32_t               ii;
+
+  if (!pp_stream) FAILWITH(IERR_INVALID_ARG);
+  if (count < 0)  FAILWITH(IERR_INVALID_ARG);
+  if (count > 0 && !segments) FAILWITH(IERR_INVALID_ARG);
+  for (ii = 0; ii < count; ii++) {
+    if (segments[ii].length < 0) FAILWITH(IERR_INVALID_ARG);
+    if (segments[ii].length > 0 && !segments[ii].data) FAILWITH(IERR_INVALID_ARG);
+  }
+  if (p_options) {
+    if (p_options->page_size < 0 || p_options->page_size > IH_MAX_PAGE_SIZE)         FAILWITH(IERR_INVALID_ARG);
+    if (p_options->max_page_size < 0 || p_options->max_page_size > IH_MAX_PAGE_SIZE) FAILWITH(IERR_INVALID_ARG);
+    if (p_options->page_size > 0) size = p_options->page_size;
+    max_size = p_options->max_page_size;
+    allocator = p_options->allocator;
+  }
+
+  IONCHECK(_ion_stream_open_helper(ION_STREAM_SEGMENTS_OUT, 0, allocator, &stream));
+  segmented = SEGMENTED_STREAM(stream);
+
+  if (count > 0) {
+    // the segment list grows as we write, so it comes from the allocator
+    // rather than the owner, and close frees it
+    segmented->_segments = (ION_STREAM_SEGMENT *)_ion_allocator_alloc(allocator, count * sizeof(ION_STREAM_SEGMENT));
+    if (!segmented->_segments) {
+      ion_free_owner(stream);
+      FAILWITH(IERR_NO_MEMORY);
+    }
+    memcpy(segmented->_segments, segments, count * sizeof(ION_STREAM_SEGMENT));
+  }
+  segmented->_count         = count;
+  segmented->_capacity      = count;
+  segmented->_user_count    = count;
+  segmented->_current       = -1;  // the first write moves us onto the first segment
+  segmented->_next_size     = size;
+  segmented->_max_size      = max_size;
+  segmented->_handler       = fn_handler;
+  segmented->_handler_state = handler_state;
+
+  *pp_stream = stream;
+  SUCCEED();
+
+  iRETURN;
+}
+
+iERR ion_stream_get_segments( ION_STREAM *stream, ION_STREAM_SEGMENT **p_segments, int32_t *p_count )
+{
+  iENTER;
+  ION_STREAM_SEGMENTED *segmented;
+  int32_t               ii, filled = 0;
+  SIZE                  length;
+
+  if (!stream)     FAILWITH(IERR_INVALID_ARG);
+  if (!p_segments) FAILWITH(IERR_INVALID_ARG);
+  if (!p_count)    FAILWITH(IERR_INVALID_ARG);
+  if (!_ion_stream_is_segmented(stream) || !_ion_stream_can_write(stream)) FAILWITH(IERR_INVALID_ARG);
+  segmented = SEGMENTED_STREAM(stream);
+  if (segmented->_handler) FAILWITH(IERR_INVALID_STATE);
+
+  if (segmented->_current >= 0) {
+    // the list is never longer than the segment list itself, so we only
+    // need a new one when the segment list has grown past the last one
+    if (segmented->_filled_capacity < segmented->_capacity) {
+      _ion_allocator_free(stream->_allocator, segmented->_filled);
+      segmented->_filled_capacity = 0;
+      segmented->_filled = (ION_STREAM_SEGMENT *)_ion_allocator_alloc(stream->_allocator, segmented->_capacity * sizeof(ION_STREAM_SEGMENT));
+      if (!segmented->_filled) FAILWITH(IERR_NO_MEMORY);
+      segmented->_filled_capacity = segmented->_capacity;
+    }
+
+    // every segment before the current one was filled
+    for (ii = 0; ii <= segmented->_current; ii++) {
+      length = (ii < segmented->_current) ? segmented->_segments[ii].length : (SIZE)(stream->_curr - stream->_buffer);
+      if (length < 1) continue;
+      segmented->_filled[filled].data   = segmented->_segments[ii].data;
+      segmented->_filled[filled].length = length;
+      filled++;
+    }
+  }
+
+  *p_segments = segmented->_filled;
+  *p_count    = filled;
+  SUCCEED();
+
+  iRETURN;
+}
+
 iERR ion_stream_open_memory_only( ION_STREAM **pp_stream )
+{
+  iENTER;
+  IONCHECK(ion_stream_open_memory_only_with_options(NULL, pp_stream));
+  iRETURN;
+}
+
+iERR ion_stream_open_memory_only_with_options( ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream )
 {
   iENTER;
   ION_STREAM       *stream;
@@ -389,7 +747,7 @@ iERR ion_stream_open_memory_only( ION_STREAM **pp_stream )
 
   if (!pp_stream) FAILWITH(IERR_INVALID_ARG);
 
-  IONCHECK(_ion_stream_open_helper(flags, g_Ion_Stream_Default_Page_Size, &stream));
+  IONCHECK(_ion_stream_open_options_helper(flags, p_options, &stream));
 
   // for the all in memory case 
   paged = PAGED_STREAM( stream );
@@ -403,7 +761,47 @@ iERR ion_stream_open_memory_only( ION_STREAM **pp_stream )
   iRETURN;
 }
 
+iERR _ion_stream_open_growable( SIZE initial_size, ION_ALLOCATOR *allocator, ION_STREAM **pp_stream )
+{
+  iENTER;
+  ION_STREAM *stream;
+  BYTE       *buffer;
+
+  ASSERT(pp_stream);
+
+  if (initial_size < 1) initial_size = g_Ion_Stream_Default_Page_Size;
+  if (initial_size > IH_MAX_PAGE_SIZE) FAILWITH(IERR_INVALID_ARG);
+
+  IONCHECK(_ion_stream_open_helper(ION_STREAM_GROWABLE, initial_size, allocator, &stream));
+
+  // the buffer is replaced as it grows, so it comes from the allocator
+  // rather than the owner, which could only free it at close
+  buffer = (BYTE *)_ion_allocator_alloc(stream->_allocator, initial_size);
+  if (!buffer) {
+    ion_free_owner(stream);
+    FAILWITH(IERR_NO_MEMORY);
+  }
+
+  // set up like the user buffer in ion_stream_open_buffer
+  stream->_buffer = buffer;
+  stream->_offset = 0;
+  stream->_limit  = buffer;
+  stream->_curr   = buffer;
+
+  *pp_stream = stream;
+  SUCCEED();
+
+  iRETURN;
+}
+
 iERR ion_stream_open_handler_in( ION_STREAM_HANDLER fn_input_handler, void *handler_state, ION_STREAM **pp_stream )
+{
+  iENTER;
+  IONCHECK(ion_stream_open_handler_in_with_options(fn_input_handler, handler_state, NULL, pp_stream));
+  iRETURN;
+}
+
+iERR ion_stream_open_handler_in_with_options( ION_STREAM_HANDLER fn_input_handler, void *handler_state, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream )
 {
   iENTER;
   ION_STREAM              *stream = NULL;
@@ -413,7 +811,7 @@ iERR ion_stream_open_handler_in( ION_STREAM_HANDLER fn_input_handler, void *hand
   if (!pp_stream) FAILWITH(IERR_INVALID_ARG);
   if (!fn_input_handler) FAILWITH(IERR_INVALID_ARG);
 
-  IONCHECK(_ion_stream_open_helper(flags, g_Ion_Stream_Default_Page_Size, &stream));
+  IONCHECK(_ion_stream_open_options_helper(flags, p_options, &stream));
 
   user_stream = &(((ION_STREAM_USER_PAGED *)stream)->_user_stream);
 
@@ -428,6 +826,13 @@ iERR ion_stream_open_handler_in( ION_STREAM_HANDLER fn_input_handler, void *hand
 }
 
 iERR ion_stream_open_handler_out( ION_STREAM_HANDLER fn_output_handler, void *handler_state, ION_STREAM **pp_stream )
+{
+  iENTER;
+  IONCHECK(ion_stream_open_handler_out_with_options(fn_output_handler, handler_state, NULL, pp_stream));
+  iRETURN;
+}
+
+iERR ion_stream_open_handler_out_with_options( ION_STREAM_HANDLER fn_output_handler, void *handler_state, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream )
 {
   iENTER;
   ION_STREAM              *stream = NULL;
@@ -437,7 +842,7 @@ iERR ion_stream_open_handler_out( ION_STREAM_HANDLER fn_output_handler, void *ha
   if (!pp_stream) FAILWITH(IERR_INVALID_ARG);
   if (!fn_output_handler) FAILWITH(IERR_INVALID_ARG);
 
-  IONCHECK(_ion_stream_open_helper(flags, g_Ion_Stream_Default_Page_Size, &stream));
+  IONCHECK(_ion_stream_open_options_helper(flags, p_options, &stream));
 
   user_stream = &(((ION_STREAM_USER_PAGED *)stream)->_user_stream);
   user_stream->handler_state = handler_state;
@@ -451,6 +856,40 @@ iERR ion_stream_open_handler_out( ION_STREAM_HANDLER fn_output_handler, void *ha
 }
 
 
+iERR ion_stream_set_cache_budget(ION_STREAM *stream, int64_t max_bytes)
+{
+  iENTER;
+  ION_STREAM_PAGED *paged;
+  int64_t           pages;
+
+  if (!stream) FAILWITH(IERR_INVALID_ARG);
+  if (max_bytes < 0) FAILWITH(IERR_INVALID_ARG);
+  // a dropped page has to be read back from the file, so this
+  // only works for file backed streams we can read and seek
+  if (!_ion_stream_is_paged(stream)) FAILWITH(IERR_INVALID_ARG);
+  if (!_ion_stream_is_file_backed(stream)) FAILWITH(IERR_INVALID_ARG);
+  if (!_ion_stream_can_read(stream)) FAILWITH(IERR_INVALID_ARG);
+  if (!_ion_stream_can_random_seek(stream)) FAILWITH(IERR_INVALID_ARG);
+  if (_ion_stream_is_user_controlled(stream)) FAILWITH(IERR_INVALID_ARG);
+
+  paged = PAGED_STREAM(stream);
+  if (max_bytes == 0) {
+    paged->_page_budget = 0;
+    SUCCEED();
+  }
+
+  // we need room for the current page and one we're moving to
+  pages = max_bytes / paged->_page_size;
+  if (pages < 2) pages = 2;
+  if (pages > INT32_MAX) pages = INT32_MAX;
+  paged->_page_budget = (int32_t)pages;
+
+  _ion_stream_page_evict(paged);
+  SUCCEED();
+
+  iRETURN;
+}
+
 iERR ion_stream_flush(ION_STREAM *stream)
 {
   iENTER;
@@ -474,6 +913,30 @@ iERR ion_stream_close(ION_STREAM *stream)
     IONCHECK(_ion_stream_flush_helper(stream));
   }
 
+  if (_ion_stream_is_paged(stream)) {
+    // the read ahead thread has to be gone before its buffers are freed
+    _ion_stream_read_ahead_stop(PAGED_STREAM(stream));
+    if (PAGED_STREAM(stream)->_page_pool) {
+      ion_free_owner(PAGED_STREAM(stream)->_page_pool);
+    }
+  }
+
+#ifdef ION_STREAM_HAS_MMAP
+  if (_ion_stream_is_mapped(stream)) {
+    munmap(MAPPED_STREAM(stream)->_map_base, (size_t)MAPPED_STREAM(stream)->_map_length);
+  }
+#endif
+
+  if (_ion_stream_is_growable(stream)) {
+    // the one buffer the owner doesn't free
+    _ion_allocator_free(stream->_allocator, stream->_buffer);
+  }
+  else if (_ion_stream_is_segmented(stream) && _ion_stream_can_write(stream)) {
+    // the segment lists are resized as the stream grows, so they aren't the owner's
+    _ion_allocator_free(stream->_allocator, SEGMENTED_STREAM(stream)->_segments);
+    _ion_allocator_free(stream->_allocator, SEGMENTED_STREAM(stream)->_filled);
+  }
+
   // clear the stream out so that it is invalid in case
   // someone tries to use it after they have freed it
   stream->_buffer = NULL;
@@ -573,6 +1036,25 @@ POSITION ion_stream_get_marked_length( ION_STREAM *stream )
   return marked_length;
 }
 
+// a hit is a page fill the read ahead thread had already read, a miss
+// is one the reader had to wait for. Both are 0 without read ahead.
+iERR ion_stream_get_read_ahead_stats( ION_STREAM *stream, int64_t *p_hits, int64_t *p_misses )
+{
+  iENTER;
+
+  if (!stream)   FAILWITH(IERR_INVALID_ARG);
+  if (!p_hits)   FAILWITH(IERR_INVALID_ARG);
+  if (!p_misses) FAILWITH(IERR_INVALID_ARG);
+
+  *p_hits = *p_misses = 0;
+  if (_ion_stream_is_paged(stream)) {
+    _ion_stream_read_ahead_stats(PAGED_STREAM(stream), p_hits, p_misses);
+  }
+  SUCCEED();
+
+  iRETURN;
+}
+
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -594,7 +1076,7 @@ iERR ion_stream_read_byte(ION_STREAM *stream, int *p_c)
   if (!p_c) FAILWITH(IERR_INVALID_ARG);
 
   if (stream->_curr >= stream->_limit) {
-    if (_ion_stream_is_paged(stream)) {
+    if (_ion_stream_is_paged(stream) || _ion_stream_is_windowed(stream)) {
 		position = _ion_stream_position(stream);
 
 		// note that position is the next (unavailable) byte
@@ -665,56 +1147,108 @@ iERR ion_stream_read(ION_STREAM *stream, BYTE *buf, SIZE len, SIZE *p_bytes_read
   iRETURN;
 }
 
-// unreads last read byte, you can only unread what was actually read
-iERR ion_stream_unread_byte(ION_STREAM *stream, int c)
+// returns the bytes that can be read without leaving the current page (or
+// user buffer), fetching the next page if the current one is used up. The
+// span is only valid until the next call that moves the stream, and a span
+// of 0 bytes means we're at eof. Callers decode in place and then move past
+// what they used with ion_stream_consume.
+iERR ion_stream_peek_span(ION_STREAM *stream, BYTE **p_span, SIZE *p_available)
 {
   iENTER;
-  ION_STREAM_PAGED *paged;
-  POSITION          position;
-  PAGE_ID           target_page_id;
-  ION_PAGE         *page = NULL;
-  
-  if (!stream)           FAILWITH(IERR_INVALID_ARG);
-  if (c < 0 && c != EOF) FAILWITH(IERR_INVALID_ARG);
-  if (_ion_stream_can_read(stream) == FALSE) FAILWITH(IERR_INVALID_ARG);
 
-  // do we need to fetch a previous page?
-  if (stream->_curr <= stream->_buffer) 
-  {
-    if (stream->_offset == 0) {
-      // you can unread past the beginning of the file
-      if (c != EOF) {
-          // but only when we're unreading an EOF
-          FAILWITH(IERR_UNEXPECTED_EOF);
-      }
-      SUCCEED();
+  if (!stream)      FAILWITH(IERR_INVALID_ARG);
+  if (!p_span)      FAILWITH(IERR_INVALID_ARG);
+  if (!p_available) FAILWITH(IERR_INVALID_ARG);
+  if (!_ion_stream_can_read(stream)) FAILWITH(IERR_INVALID_ARG);
+
+  if (stream->_curr >= stream->_limit) {
+    if (_ion_stream_is_paged(stream) || _ion_stream_is_windowed(stream)) {
+      // note that position is the next (unavailable) byte
+      // since it is past the limit of this page
+      err = _ion_stream_fetch_position(stream, _ion_stream_position(stream));
+      if (err != IERR_OK && err != IERR_EOF) FAILWITH(err);
     }
+  }
 
-    // note that if the offset is not 0 then this stream has to be paged
-    ASSERT(_ion_stream_is_paged(stream));
-    paged = PAGED_STREAM(stream);
+  *p_span = stream->_curr;
+  *p_available = (stream->_curr < stream->_limit) ? (SIZE)(stream->_limit - stream->_curr) : 0;
+  SUCCEED();
 
-    position = _ion_stream_position(stream) - 1;  // -1 because we're backing up to unread onto the previous read char and position is the next-to-read char
-    target_page_id = _ion_stream_page_id_from_offset(stream, position);
-    IONCHECK(_ion_stream_page_find(paged, target_page_id, &page));
-    if (!page) {
-      if (_ion_stream_can_seek_to(stream, position)) {
-        IONCHECK(_ion_stream_fetch_position(stream, position));
-        page = paged->_curr_page;
-        ASSERT(page);
-        ASSERT(target_page_id == page->_page_id);
+  iRETURN;
+}
+
+// moves past len bytes of the span returned by ion_stream_peek_span
+iERR ion_stream_consume(ION_STREAM *stream, SIZE len)
+{
+  iENTER;
+
+  if (!stream) FAILWITH(IERR_INVALID_ARG);
+  if (len < 0) FAILWITH(IERR_INVALID_ARG);
+  if (len > (SIZE)(stream->_limit - stream->_curr)) FAILWITH(IERR_INVALID_ARG);
+
+  stream->_curr += len;
+  SUCCEED();
+
+  iRETURN;
+}
+
+// unreads last read byte, you can only unread what was actually read
+iERR ion_stream_unread_byte(ION_STREAM *stream, int c)
+{
+  iENTER;
+  ION_STREAM_PAGED *paged;
+  POSITION          position;
+  PAGE_ID           target_page_id;
+  ION_PAGE         *page = NULL;
+  
+  if (!stream)           FAILWITH(IERR_INVALID_ARG);
+  if (c < 0 && c != EOF) FAILWITH(IERR_INVALID_ARG);
+  if (_ion_stream_can_read(stream) == FALSE) FAILWITH(IERR_INVALID_ARG);
+
+  // do we need to fetch a previous page?
+  if (stream->_curr <= stream->_buffer) 
+  {
+    if (stream->_offset == 0) {
+      // you can unread past the beginning of the file
+      if (c != EOF) {
+          // but only when we're unreading an EOF
+          FAILWITH(IERR_UNEXPECTED_EOF);
       }
+      SUCCEED();
+    }
+
+    position = _ion_stream_position(stream) - 1;  // -1 because we're backing up to unread onto the previous read char and position is the next-to-read char
+
+    if (_ion_stream_is_windowed(stream)) {
+      // the previous byte is still in memory, we just need to move the window back
+      IONCHECK(_ion_stream_window_fetch_position(stream, position));
+    }
+    else {
+      // note that if the offset is not 0 then this stream has to be paged
+      ASSERT(_ion_stream_is_paged(stream));
+      paged = PAGED_STREAM(stream);
+
+      target_page_id = _ion_stream_page_id_from_offset(stream, position);
+      IONCHECK(_ion_stream_page_find(paged, target_page_id, &page));
       if (!page) {
-        // we can't back up into saved pages so we have to make a fake page
-        IONCHECK(_ion_stream_page_allocate(paged, target_page_id, &page));
-        page->_page_start = stream->_buffer_size;
+        if (_ion_stream_can_seek_to(stream, position)) {
+          IONCHECK(_ion_stream_fetch_position(stream, position));
+          page = paged->_curr_page;
+          ASSERT(page);
+          ASSERT(target_page_id == page->_page_id);
+        }
+        if (!page) {
+          // we can't back up into saved pages so we have to make a fake page
+          IONCHECK(_ion_stream_page_allocate(paged, target_page_id, &page));
+          page->_page_start = stream->_buffer_size;
+        }
       }
+      IONCHECK(_ion_stream_page_make_current(paged, page));
     }
-    IONCHECK(_ion_stream_page_make_current(paged, page));
     ASSERT((position - stream->_offset) < (POSITION)stream->_buffer_size); // check for overflow
     stream->_curr = IH_CURR_OF(position) + 1; // +1 since we offset the position due to backing up
   }
-  
+
   // at this point we have to have room to back up
   if (c != EOF) {
       ASSERT(stream->_curr > stream->_buffer);
@@ -835,6 +1369,120 @@ iERR ion_stream_write_byte_no_checks(ION_STREAM *stream, int byte)
 }
 
 
+// returns a pointer to len contiguous writable bytes at the current position,
+// so the caller can format directly into the output instead of writing a
+// byte at a time. Normally this is the page buffer itself, but if the rest
+// of the page is too short the bytes are staged in the stream and copied
+// out by ion_stream_commit. The caller must call ion_stream_commit, with the
+// number of bytes actually used, before any other call on the stream.
+iERR ion_stream_reserve(ION_STREAM *stream, SIZE len, BYTE **p_buf)
+{
+  iENTER;
+  SIZE room;
+
+  if (!stream) FAILWITH(IERR_INVALID_ARG);
+  if (!p_buf) FAILWITH(IERR_INVALID_ARG);
+  if (len < 0 || len > ION_STREAM_MAX_RESERVE) FAILWITH(IERR_INVALID_ARG);
+  if (_ion_stream_can_write(stream) == FALSE) FAILWITH(IERR_INVALID_ARG);
+  if (stream->_reserved != NULL) FAILWITH(IERR_INVALID_STATE);
+
+  room = stream->_buffer_size - (SIZE)(stream->_curr - stream->_buffer);
+  if (room < 1 && len > 0) {
+    // if there's no room get the next page
+    IONCHECK(_ion_stream_fetch_position( stream, _ion_stream_position(stream)));
+    room = stream->_buffer_size - (SIZE)(stream->_curr - stream->_buffer);
+  }
+
+  if (room >= len) {
+    stream->_reserved = stream->_curr;
+  }
+  else {
+    stream->_reserved = stream->_reserve_buffer;
+  }
+  *p_buf = stream->_reserved;
+  SUCCEED();
+
+  iRETURN;
+}
+
+// marks the first used bytes of the last reservation as written, updating
+// the dirty range once for the whole span
+iERR ion_stream_commit(ION_STREAM *stream, SIZE used)
+{
+  iENTER;
+  BYTE *reserved;
+  SIZE  written;
+
+  if (!stream) FAILWITH(IERR_INVALID_ARG);
+  if (stream->_reserved == NULL) FAILWITH(IERR_INVALID_STATE);
+  if (used < 0 || used > ION_STREAM_MAX_RESERVE) FAILWITH(IERR_INVALID_ARG);
+
+  reserved = stream->_reserved;
+  stream->_reserved = NULL;
+
+  if (used == 0) SUCCEED();
+
+  if (reserved == stream->_reserve_buffer) {
+    // the reservation straddled a page, the regular write
+    // will split it across the pages for us
+    IONCHECK(ion_stream_write(stream, reserved, used, &written));
+    if (written != used) FAILWITH(IERR_WRITE_ERROR);
+  }
+  else {
+    ASSERT(reserved == stream->_curr);
+    if (used > stream->_buffer_size - (SIZE)(stream->_curr - stream->_buffer)) FAILWITH(IERR_INVALID_ARG);
+    if (stream->_dirty_start == NULL) {
+      stream->_dirty_start = stream->_curr;
+    }
+    stream->_dirty_length += used;
+    stream->_curr += used;
+    if (stream->_curr > stream->_limit) {
+      stream->_limit = stream->_curr;
+    }
+  }
+  SUCCEED();
+
+  iRETURN;
+}
+
+
+// writes the bytes of count segments, in order. When the stream writes to an
+// fd the stream's pending bytes and the segments go out together in a single
+// writev (for every IH_WRITEV_COUNT segments), without being copied into the
+// stream's page. Other streams copy each segment in as ion_stream_write does
+iERR ion_stream_write_segments(ION_STREAM *stream, ION_STREAM_SEGMENT *segments, int32_t count, SIZE *p_written)
+{
+  iENTER;
+  SIZE    written = 0, segment_written;
+  int32_t ii;
+
+  if (!stream) FAILWITH(IERR_INVALID_ARG);
+  if (count < 0) FAILWITH(IERR_INVALID_ARG);
+  if (count > 0 && !segments) FAILWITH(IERR_INVALID_ARG);
+  if (!p_written) FAILWITH(IERR_INVALID_ARG);
+  if (_ion_stream_can_write(stream) == FALSE) FAILWITH(IERR_INVALID_ARG);
+  for (ii = 0; ii < count; ii++) {
+    if (segments[ii].length < 0) FAILWITH(IERR_INVALID_ARG);
+    if (segments[ii].length > 0 && !segments[ii].data) FAILWITH(IERR_INVALID_ARG);
+  }
+
+  if (_ion_stream_can_gather(stream)) {
+    IONCHECK(_ion_stream_writev(stream, segments, count, &written));
+  }
+  else {
+    for (ii = 0; ii < count; ii++) {
+      if (segments[ii].length < 1) continue;
+      IONCHECK(ion_stream_write(stream, segments[ii].data, segments[ii].length, &segment_written));
+      written += segment_written;
+      if (segment_written != segments[ii].length) break;
+    }
+  }
+  *p_written = written;
+  SUCCEED();
+
+  iRETURN;
+}
+
 #define TEMP_BUFFER_LEN (8096)
 
 // this writes some number of bytes from an input stream
@@ -924,7 +1572,7 @@ iERR ion_stream_seek( ION_STREAM *stream, POSITION target_pos)
       stream->_curr = IH_CURR_OF( target_pos );
   } 
   else {
-	if (_ion_stream_is_paged(stream) == FALSE) {
+	if (_ion_stream_is_paged(stream) == FALSE && _ion_stream_is_windowed(stream) == FALSE) {
 		if (target_pos != _ion_stream_position(stream)) {
 			FAILWITH(IERR_SEEK_ERROR);
 		}
@@ -952,9 +1600,32 @@ iERR ion_stream_skip( ION_STREAM *stream, SIZE distance, SIZE *p_skipped)
   if (!stream) FAILWITH(IERR_INVALID_ARG);
   if (!p_skipped) FAILWITH(IERR_INVALID_ARG);
 
+  if (distance >= 0 && distance <= (SIZE)(stream->_limit - stream->_curr)) {
+    // the bytes are already in the buffer, just step over them
+    stream->_curr += distance;
+    *p_skipped = distance;
+    SUCCEED();
+  }
+  if (!_ion_stream_is_paged(stream) && !_ion_stream_is_windowed(stream)) {
+    // a user buffer ends where its data does
+    *p_skipped = (SIZE)(stream->_limit - stream->_curr);
+    stream->_curr = stream->_limit;
+    SUCCEED();
+  }
+  if (_ion_stream_is_sequential_skip(stream)) {
+    IONCHECK(_ion_stream_skip_sequential(stream, distance, p_skipped));
+    SUCCEED();
+  }
+
   original_pos = target_pos = _ion_stream_position(stream);
   target_pos += distance;
-  IONCHECK(_ion_stream_fetch_position(stream, target_pos));
+  err = _ion_stream_fetch_position(stream, target_pos);
+  if (err != IERR_OK) {
+    // a window (segments or a mapped file) positioned at its very end
+    // reports eof, the caller checks how far we actually got
+    if (err != IERR_EOF) FAILWITH(err);
+    err = IERR_OK;
+  }
   actual_pos = _ion_stream_position(stream);
    
   ASSERT((actual_pos - original_pos) <= (POSITION)distance); // we should never overshoot
@@ -964,6 +1635,40 @@ iERR ion_stream_skip( ION_STREAM *stream, SIZE distance, SIZE *p_skipped)
   iRETURN;
 }
 
+// a stream we can't seek in, that isn't keeping the pages it reads, can skip
+// without paging in the bytes it's skipping over at all
+BOOL _ion_stream_is_sequential_skip( ION_STREAM *stream )
+{
+  return _ion_stream_is_paged(stream)
+      && _ion_stream_can_read(stream)
+      && !_ion_stream_can_random_seek(stream)
+      && !_ion_stream_is_caching(stream)
+      && PAGED_STREAM(stream)->_curr_page != NULL
+      && PAGED_STREAM(stream)->_curr_page == PAGED_STREAM(stream)->_last_page;
+}
+
+// skips the rest of the current page, throws away the input up to the target
+// and leaves the stream on an empty page there (or at the eof if that's first)
+iERR _ion_stream_skip_sequential( ION_STREAM *stream, SIZE distance, SIZE *p_skipped )
+{
+  iENTER;
+  POSITION skipped, discarded;
+
+  ASSERT(_ion_stream_is_sequential_skip(stream));
+  ASSERT(distance > (SIZE)(stream->_limit - stream->_curr));
+
+  skipped = (SIZE)(stream->_limit - stream->_curr);
+  stream->_curr = stream->_limit;
+  IONCHECK(_ion_stream_discard(stream, distance - skipped, &discarded));
+  skipped += discarded;
+  IONCHECK(_ion_stream_page_park(PAGED_STREAM(stream), _ion_stream_position(stream) + discarded));
+
+  *p_skipped = (SIZE)skipped;
+  SUCCEED();
+
+  iRETURN;
+}
+
 iERR ion_stream_mark( ION_STREAM *stream )
 {
   iENTER;
@@ -1019,7 +1724,7 @@ iERR ion_stream_mark_rewind( ION_STREAM *stream )
       stream->_curr = IH_CURR_OF( stream->_mark );
   } 
   else {
-      if (_ion_stream_is_paged(stream) == FALSE) {
+      if (_ion_stream_is_paged(stream) == FALSE && _ion_stream_is_windowed(stream) == FALSE) {
           FAILWITH(IERR_SEEK_ERROR);
       }
       IONCHECK(_ion_stream_fetch_position(stream, stream->_mark));
@@ -1099,7 +1804,7 @@ iERR _ion_stream_mark_clear_helper( ION_STREAM_PAGED *paged, POSITION position )
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-iERR _ion_stream_open_helper(ION_STREAM_FLAG flags, SIZE page_size, ION_STREAM **pp_stream)
+iERR _ion_stream_open_helper(ION_STREAM_FLAG flags, SIZE page_size, ION_ALLOCATOR *allocator, ION_STREAM **pp_stream)
 {
   iENTER;
   BOOL              user_buffer, user_managed;
@@ -1113,7 +1818,15 @@ iERR _ion_stream_open_helper(ION_STREAM_FLAG flags, SIZE page_size, ION_STREAM *
 
   user_buffer = IS_FLAG_ON(flags, FLAG_IS_USER_BUFFER);
   if (user_buffer) {
-    len = sizeof(ION_STREAM);
+    if (IS_FLAG_ON(flags, FLAG_IS_MEMORY_MAPPED)) {
+        len = sizeof(ION_STREAM_MAPPED);
+    }
+    else if (IS_FLAG_ON(flags, FLAG_IS_SEGMENTED)) {
+        len = sizeof(ION_STREAM_SEGMENTED);
+    }
+    else {
+        len = sizeof(ION_STREAM);
+    }
   }
   else {
     user_managed = IS_FLAG_ON(flags, FLAG_USER_HANDLING);
@@ -1125,7 +1838,7 @@ iERR _ion_stream_open_helper(ION_STREAM_FLAG flags, SIZE page_size, ION_STREAM *
 	}
   }
 
-  stream = ion_alloc_owner(len);
+  stream = ion_alloc_owner_with_allocator(len, allocator);
   if (!stream) FAILWITH(IERR_NO_MEMORY);
    
   memset(stream, 0, len);
@@ -1135,6 +1848,7 @@ iERR _ion_stream_open_helper(ION_STREAM_FLAG flags, SIZE page_size, ION_STREAM *
   stream->_dirty_start = NULL;
   stream->_dirty_length = 0;
   stream->_buffer_size = page_size;
+  stream->_allocator = allocator ? allocator : ion_allocator_get_default();
 
   if (!user_buffer) {
     paged = PAGED_STREAM(stream);
@@ -1161,12 +1875,79 @@ iERR _ion_stream_open_helper(ION_STREAM_FLAG flags, SIZE page_size, ION_STREAM *
  iRETURN;
 }
 
+// opens a paged stream with the page size (and page growth) asked
+// for in p_options, which may be NULL to take the defaults
+iERR _ion_stream_open_options_helper(ION_STREAM_FLAG flags, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream)
+{
+  iENTER;
+  ION_STREAM *stream = NULL;
+  SIZE        page_size = g_Ion_Stream_Default_Page_Size;
+  SIZE        max_page_size = 0;
+
+  ASSERT(pp_stream);
+
+  if (p_options) {
+    if (p_options->page_size < 0 || p_options->page_size > IH_MAX_PAGE_SIZE)         FAILWITH(IERR_INVALID_ARG);
+    if (p_options->max_page_size < 0 || p_options->max_page_size > IH_MAX_PAGE_SIZE) FAILWITH(IERR_INVALID_ARG);
+    if (p_options->read_ahead_depth < 0)                                              FAILWITH(IERR_INVALID_ARG);
+    if (p_options->page_size > 0) page_size = p_options->page_size;
+    max_page_size = p_options->max_page_size;
+  }
+
+  IONCHECK(_ion_stream_open_helper(flags, page_size, p_options ? p_options->allocator : NULL, &stream));
+  if (max_page_size > page_size) {
+    PAGED_STREAM(stream)->_max_page_size = max_page_size;
+  }
+
+  *pp_stream = stream;
+  SUCCEED();
+
+  iRETURN;
+}
+
+// opens a file or fd input stream and starts its read ahead thread before
+// the first page is read, fp is the stream's _fp (the FILE* or the fd)
+iERR _ion_stream_open_read_ahead_helper(ION_STREAM_FLAG flags, FILE *fp, int fd, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream)
+{
+  iENTER;
+  ION_STREAM *stream = NULL;
+  int32_t     depth = IH_DEFAULT_READ_AHEAD_DEPTH;
+
+  ASSERT(pp_stream);
+
+  if (p_options && p_options->read_ahead_depth > 0) {
+    depth = p_options->read_ahead_depth;
+  }
+
+  IONCHECK(_ion_stream_open_options_helper(flags, p_options, &stream));
+  stream->_fp = fp;
+  // the read ahead slots are all one page size, so these pages don't grow
+  PAGED_STREAM(stream)->_max_page_size = 0;
+
+  // the thread reads with pread, which needs a file it can seek in
+  if (!IS_FLAG_ON(flags, FLAG_IS_TTY) && IS_FLAG_ON(flags, FLAG_RANDOM_ACCESS) && fd >= 0) {
+    IONCHECK(_ion_stream_read_ahead_start(PAGED_STREAM(stream), fd, depth));
+  }
+  IONCHECK(_ion_stream_fetch_position(stream, 0));
+
+  *pp_stream = stream;
+  stream = NULL;
+  SUCCEED();
+
+fail:
+  if (stream) {
+    ion_stream_close(stream);
+  }
+  RETURN(__location_name__, __line__, __count__++, err);
+}
+
 iERR _ion_stream_flush_helper(ION_STREAM *stream)
 {
   iENTER;
   POSITION position;
   SIZE     written, available;
   struct _ion_user_stream  *user_stream;
+  ION_STREAM_SEGMENTED     *segmented;
 
   ASSERT(stream);
   ASSERT(_ion_stream_can_write(stream));
@@ -1175,36 +1956,20 @@ iERR _ion_stream_flush_helper(ION_STREAM *stream)
   if (_ion_stream_is_dirty(stream)) {
     if (_ion_stream_is_file_backed(stream)) {
       if (_ion_stream_can_random_seek(stream)) {
-        position = _ion_stream_position(stream);
+        // the dirty bytes belong at their own position in the file, which
+        // is not necessarily where the stream's cursor currently is
+        position = stream->_offset + (stream->_dirty_start - stream->_buffer);
 		if (_ion_stream_is_fd_backed(stream)) {
-		   if (LSEEK((int)stream->_fp, (long)position, SEEK_SET)) {
+		   if (LSEEK((int)stream->_fp, (long)position, SEEK_SET) < 0) {
 			  FAILWITH(IERR_WRITE_ERROR);
 			}
 		}
 		else {
 			ASSERT(_ion_stream_is_file_backed(stream));
-        if (fseek(stream->_fp, (long)position, SEEK_SET)) {
-
-          FAILWITH(IERR_WRITE_ERROR);
-
-        }
-      }
-      // now we either write through the user handler, or directly to the file
-      if (_ion_stream_is_user_controlled(stream)) {
-        user_stream = &(((ION_STREAM_USER_PAGED *)stream)->_user_stream);
-        while (stream->_dirty_length > 0) {
-            available = (SIZE)(user_stream->limit - user_stream->curr);
-            if (available > stream->_dirty_length) {
-                available = stream->_dirty_length;
-        }
-
-            memcpy(user_stream->curr, stream->_dirty_start, available);
-            user_stream->curr += available;
-            IONCHECK((*(user_stream->handler))(user_stream));
-            stream->_dirty_length -= available;
-            stream->_dirty_start += available;
-        }
-      }
+			if (FSEEK(stream->_fp, position, SEEK_SET)) {
+				FAILWITH(IERR_WRITE_ERROR);
+			}
+		}
       }
       // now we either write through the user handler, or directly to the file
       if (_ion_stream_is_user_controlled(stream)) {
@@ -1239,6 +2004,14 @@ iERR _ion_stream_flush_helper(ION_STREAM *stream)
 
 	  }
     }
+    else if (_ion_stream_is_segmented(stream)) {
+      // the dirty bytes never span segments, since we flush
+      // before moving on to the next segment
+      segmented = SEGMENTED_STREAM(stream);
+      if (segmented->_handler) {
+        IONCHECK((*(segmented->_handler))(segmented->_handler_state, stream->_dirty_start, stream->_dirty_length));
+      }
+    }
     stream->_dirty_start = NULL;
     stream->_dirty_length = 0;
   }  
@@ -1333,6 +2106,44 @@ BOOL _ion_stream_is_paged( ION_STREAM *stream)
   BOOL   is_paged = (IS_FLAG_ON(STREAM_FLAGS(stream), FLAG_IS_USER_BUFFER) == FALSE);
   return is_paged;
 }
+BOOL _ion_stream_is_mapped( ION_STREAM *stream)
+{
+  BOOL   is_mapped = IS_FLAG_ON(STREAM_FLAGS(stream), FLAG_IS_MEMORY_MAPPED);
+  return is_mapped;
+}
+BOOL _ion_stream_is_segmented( ION_STREAM *stream)
+{
+  BOOL   is_segmented = IS_FLAG_ON(STREAM_FLAGS(stream), FLAG_IS_SEGMENTED);
+  return is_segmented;
+}
+BOOL _ion_stream_is_windowed( ION_STREAM *stream)
+{
+  // the user buffer is a window onto data that is all in memory
+  BOOL   is_windowed = _ion_stream_is_mapped(stream) || _ion_stream_is_segmented(stream);
+  return is_windowed;
+}
+BOOL _ion_stream_is_growable( ION_STREAM *stream)
+{
+  BOOL   is_growable = IS_FLAG_ON(STREAM_FLAGS(stream), FLAG_IS_GROWABLE);
+  return is_growable;
+}
+BOOL _ion_stream_can_gather( ION_STREAM *stream)
+{
+  // we write around the page, so the stream can't be keeping pages that
+  // would go stale (or reading them back), and the pending bytes have to
+  // end at the cursor so they can simply go out in front of the segments
+#ifdef ION_STREAM_HAS_WRITEV
+  BOOL   can_gather = _ion_stream_is_fd_backed(stream)
+                   && _ion_stream_is_paged(stream)
+                   && !_ion_stream_is_user_controlled(stream)
+                   && !_ion_stream_can_read(stream)
+                   && !_ion_stream_is_caching(stream)
+                   && (!_ion_stream_is_dirty(stream) || stream->_dirty_start + stream->_dirty_length == stream->_curr);
+#else
+  BOOL   can_gather = FALSE;
+#endif
+  return can_gather;
+}
 BOOL _ion_stream_is_fully_buffered(ION_STREAM *stream)
 {
   BOOL   is_fully_buffered = IS_FLAG_ON(STREAM_FLAGS(stream),FLAG_BUFFER_ALL);
@@ -1422,120 +2233,451 @@ POSITION _ion_stream_position( ION_STREAM *stream )
  
   pos = IH_POSITION_OF( stream->_curr );
 
-  return pos;
+  return pos;
+}
+
+BOOL _ion_stream_current_page_contains_position( ION_STREAM *stream, POSITION position )
+{
+    ASSERT(stream);
+    ASSERT(position >= 0);
+
+    if (position < stream->_offset) {
+        return FALSE;
+    }
+    if (position >= IH_POSITION_OF(stream->_limit)) {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//            internal instance functions
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+iERR _ion_stream_fetch_position( ION_STREAM *stream, POSITION target_position )
+{
+    iENTER;
+    ION_STREAM_PAGED *paged = PAGED_STREAM(stream);
+    PAGE_ID           current_page_id, target_page_id;
+    ION_PAGE         *page;
+    POSITION          page_end;
+    BOOL              new_page = FALSE;
+
+    ASSERT(stream);
+    ASSERT(target_position >= 0);
+
+    if (_ion_stream_is_windowed(stream)) {
+        // all the data is in memory, but we may have to move our window
+        IONCHECK(_ion_stream_window_fetch_position(stream, target_position));
+        SUCCEED();
+    }
+
+    if (_ion_stream_is_growable(stream)) {
+        // this is one large page, like a user buffer, except that
+        // a write past the end of it gets a bigger buffer. Reads
+        // stop at the limit, just as they do on a user buffer
+        if (target_position >= stream->_offset + stream->_buffer_size) {
+            IONCHECK(_ion_stream_grow(stream, target_position));
+        }
+        SUCCEED();
+    }
+
+    if (!_ion_stream_is_paged(stream) && _ion_stream_is_fully_buffered(stream)) {
+        // if we have a user buffer, this is one large page and thus we can position within it
+        page_end = IH_POSITION_OF(stream->_limit);
+        if (target_position >= page_end) {
+            FAILWITH(IERR_EOF);
+        }
+        SUCCEED();
+    }
+
+    ASSERT(_ion_stream_is_paged(stream)); // we should never get here unless we're in a paged stream
+    
+    // never mind, it's ok to call this even if the new position is on the current page: ASSERT(IH_CURR_OF( target_position ) < stream->_buffer || IH_CURR_OF( target_position ) >= stream->_limit);
+
+    if (paged->_max_page_size > paged->_page_size) {
+        IONCHECK( _ion_stream_page_grow( paged, target_position ) );
+    }
+
+    // where are we? and where do we want to go?
+    page = paged->_curr_page;
+    current_page_id = page ? page->_page_id : -1; // if we don't have a current page pick an invalid page id
+    target_page_id = _ion_stream_page_id_from_offset( stream, target_position );
+
+    // if we are switching pages see if we have the page cached already
+    if ( current_page_id != target_page_id ) {
+        IONCHECK( _ion_stream_page_find( paged, target_page_id, &page ) );
+        if (page == NULL) {            // we don't have the page we want. So we have to create the target page so
+            // we can fill this page shortly
+            IONCHECK( _ion_stream_page_allocate( paged, target_page_id, &page ) );
+            new_page = TRUE;
+        }
+    }
+
+    ASSERT( page );
+    ASSERT( page->_page_id == target_page_id );
+
+    // if the page hasn't been filled, then we need to fill it
+    page_end  = _ion_stream_offset_from_page_id( stream, page->_page_id );
+    page_end +=  page->_page_start;
+    page_end +=  page->_page_limit;
+
+    if ( page_end <= target_position ) {
+        //
+        //  This calls fetch and fill page to do the actual read
+        //
+        err = _ion_stream_fetch_fill_page( stream, page, target_position );
+        if (err != IERR_OK) {
+            // if we were not able to read the needed bytes, we *may* need to
+            // free this page (to avoid leaking pages at EOF, for example)
+            // so - if there are no bytes on page, and it's not the current page ...
+            if (page->_page_limit < 1 && page != paged->_curr_page) {
+                _ion_stream_page_release(paged, page);
+            }
+            if (err == IERR_EOF) {
+                DONTFAILWITH( err );
+            }
+            else {
+                FAILWITH(err);
+            }
+        }
+        // in leiu of the "page make current" (below) which sets stream->_limit
+        if ( current_page_id == target_page_id ) {
+            stream->_limit = page->_buf + page->_page_limit;
+        }
+    }
+    else {
+        ASSERT(page->_page_start == 0); // TODO: BUGBUG: What is we backed up onto this page through "unread" and the choose to seek back to it ??
+    }
+    ASSERT( page );
+    ASSERT( page->_page_id == target_page_id );
+    
+    // page is filled and allocated - make it current (if it isn't already)
+    if (new_page) {
+        IONCHECK( _ion_stream_page_register( paged, page ) );
+    }
+    if ( current_page_id != target_page_id ) {
+        IONCHECK( _ion_stream_page_make_current( paged, page ) );
+    }
+    stream->_curr = IH_CURR_OF( target_position );
+    ASSERT(
+             (_ion_stream_current_page_contains_position( stream, target_position ) == TRUE)
+           ||   
+             ( target_position ==(page_end = IH_POSITION_OF( stream->_curr )) )
+          );
+    SUCCEED();
+
+    iRETURN;
+}
+
+// a memory mapped stream is a user buffer stream whose "buffer" is a window
+// onto the file mapping. Moving to a position outside the window just points
+// the window somewhere else in the mapping, no bytes are copied or read
+iERR _ion_stream_mapped_fetch_position( ION_STREAM *stream, POSITION target_position )
+{
+    iENTER;
+    ION_STREAM_MAPPED *mapped = MAPPED_STREAM(stream);
+    POSITION           window_start, window_end;
+
+    ASSERT(stream);
+    ASSERT(_ion_stream_is_mapped(stream));
+    ASSERT(target_position >= 0);
+
+    // we allow positioning at the very end (where the next read sees eof)
+    if (target_position > mapped->_map_length) {
+        FAILWITH(IERR_EOF);
+    }
+
+    window_start = _ion_stream_page_start_offset(stream, target_position);
+    if (window_start == target_position && window_start == mapped->_map_length && window_start > 0) {
+        // at the end of the mapping stay on the last window so we
+        // don't set up an empty window past the end of the data
+        window_start = _ion_stream_page_start_offset(stream, target_position - 1);
+    }
+    window_end = window_start + stream->_buffer_size;
+    if (window_end > mapped->_map_length) {
+        window_end = mapped->_map_length;
+    }
+
+    stream->_buffer = mapped->_map_base + window_start;
+    stream->_offset = window_start;
+    stream->_limit  = mapped->_map_base + window_end;
+    stream->_curr   = IH_CURR_OF(target_position);
+
+    if (target_position >= window_end) {
+        DONTFAILWITH(IERR_EOF);
+    }
+    SUCCEED();
+
+    iRETURN;
+}
+
+// a segmented stream is a user buffer stream whose "buffer" is the segment
+// holding the current position. Reads are mostly front to back so we look
+// at the current and the next segment before searching the whole list.
+// Empty segments are never made current.
+iERR _ion_stream_segments_fetch_position( ION_STREAM *stream, POSITION target_position )
+{
+    iENTER;
+    ION_STREAM_SEGMENTED *segmented = SEGMENTED_STREAM(stream);
+    ION_STREAM_SEGMENT   *segment;
+    POSITION              window_end;
+    int32_t               ii, lo, hi, mid;
+
+    ASSERT(stream);
+    ASSERT(_ion_stream_is_segmented(stream));
+    ASSERT(target_position >= 0);
+
+    // we allow positioning at the very end (where the next read sees eof)
+    if (target_position > segmented->_length) {
+        FAILWITH(IERR_EOF);
+    }
+    if (segmented->_count < 1) {
+        // no segments, no data, leave the empty window alone
+        DONTFAILWITH(IERR_EOF);
+    }
+
+    ii = segmented->_current;
+    if (target_position >= segmented->_starts[ii]
+     && target_position <  segmented->_starts[ii] + segmented->_segments[ii].length
+    ) {
+        // still in the current segment
+    }
+    else if (ii + 1 < segmented->_count
+          && target_position >= segmented->_starts[ii + 1]
+          && target_position <  segmented->_starts[ii + 1] + segmented->_segments[ii + 1].length
+    ) {
+        ii++;
+    }
+    else {
+        // the last segment starting at or before the target, since an empty
+        // segment starts where the next one does this lands on the non-empty one
+        lo = 0;
+        hi = segmented->_count - 1;
+        while (lo < hi) {
+            mid = lo + (hi - lo + 1) / 2;
+            if (segmented->_starts[mid] <= target_position) {
+                lo = mid;
+            }
+            else {
+                hi = mid - 1;
+            }
+        }
+        ii = lo;
+        // at the very end (or in trailing empty segments) back up to
+        // the last segment that has data, like the mapped window does
+        while (ii > 0 && segmented->_segments[ii].length == 0) {
+            ii--;
+        }
+    }
+
+    segment = &segmented->_segments[ii];
+    segmented->_current = ii;
+    window_end = segmented->_starts[ii] + segment->length;
+
+    stream->_buffer      = segment->data;
+    stream->_buffer_size = segment->length;
+    stream->_offset      = segmented->_starts[ii];
+    stream->_limit       = segment->data + segment->length;
+    stream->_curr        = IH_CURR_OF(target_position);
+
+    if (target_position >= window_end) {
+        DONTFAILWITH(IERR_EOF);
+    }
+    SUCCEED();
+
+    iRETURN;
+}
+
+// a segmented output stream only moves forward. When the current segment is
+// full its bytes are handed off and the window moves on to the next segment,
+// which is the caller's next segment, one we add, or (when the handler has
+// already consumed it) our current segment again
+iERR _ion_stream_segments_out_fetch_position( ION_STREAM *stream, POSITION target_position )
+{
+    iENTER;
+    ION_STREAM_SEGMENTED *segmented = SEGMENTED_STREAM(stream);
+    ION_STREAM_SEGMENT   *segment;
+    POSITION              position;
+    int32_t               ii;
+
+    ASSERT(stream);
+    ASSERT(_ion_stream_is_segmented(stream));
+
+    // the writers ask for the position of the next byte, except for
+    // ion_stream_write_byte which asks for the one after it
+    position = IH_POSITION_OF(stream->_curr);
+    if (target_position < position || target_position > position + 1) {
+        FAILWITH(IERR_SEEK_ERROR);
+    }
+    if (stream->_curr < stream->_buffer + stream->_buffer_size) {
+        // there's still room in this segment
+        SUCCEED();
+    }
+
+    IONCHECK(_ion_stream_flush_helper(stream));
+
+    ii = segmented->_current;
+    if (ii < segmented->_user_count || segmented->_handler == NULL) {
+        do {
+            ii++;
+        } while (ii < segmented->_count && segmented->_segments[ii].length < 1);
+        if (ii >= segmented->_count) {
+            IONCHECK(_ion_stream_segments_out_add(segmented));
+            ii = segmented->_count - 1;
+        }
+    }
+
+    segment = &segmented->_segments[ii];
+    segmented->_current  = ii;
+    stream->_buffer      = segment->data;
+    stream->_buffer_size = segment->length;
+    stream->_offset      = position;
+    stream->_limit       = segment->data;
+    stream->_curr        = segment->data;
+    SUCCEED();
+
+    iRETURN;
+}
+
+iERR _ion_stream_segments_out_add( ION_STREAM_SEGMENTED *segmented )
+{
+    iENTER;
+    ION_STREAM         *stream = &segmented->_base;
+    ION_STREAM_SEGMENT *segments;
+    BYTE               *data;
+    int32_t             capacity;
+
+    ASSERT(segmented->_next_size > 0);
+
+    if (segmented->_count >= segmented->_capacity) {
+        capacity = segmented->_capacity > 0 ? segmented->_capacity * 2 : 8;
+        segments = (ION_STREAM_SEGMENT *)_ion_allocator_realloc(stream->_allocator, segmented->_segments
+                                                               , segmented->_capacity * sizeof(ION_STREAM_SEGMENT)
+                                                               , capacity * sizeof(ION_STREAM_SEGMENT));
+        if (!segments) FAILWITH(IERR_NO_MEMORY);
+        segmented->_segments = segments;
+        segmented->_capacity = capacity;
+    }
+
+    data = (BYTE *)ion_alloc_with_owner(stream, segmented->_next_size);
+    if (!data) FAILWITH(IERR_NO_MEMORY);
+    segmented->_segments[segmented->_count].data   = data;
+    segmented->_segments[segmented->_count].length = segmented->_next_size;
+    segmented->_count++;
+
+    // each segment we add is twice the size of the last, up to the max
+    if (segmented->_next_size < segmented->_max_size) {
+        if (segmented->_next_size > segmented->_max_size / 2) {
+            segmented->_next_size = segmented->_max_size;
+        }
+        else {
+            segmented->_next_size *= 2;
+        }
+    }
+    SUCCEED();
+
+    iRETURN;
+}
+
+iERR _ion_stream_window_fetch_position( ION_STREAM *stream, POSITION target_position )
+{
+    iENTER;
+
+    ASSERT(_ion_stream_is_windowed(stream));
+
+    if (_ion_stream_is_segmented(stream) && _ion_stream_can_write(stream)) {
+        IONCHECK(_ion_stream_segments_out_fetch_position(stream, target_position));
+    }
+    else if (_ion_stream_is_segmented(stream)) {
+        IONCHECK(_ion_stream_segments_fetch_position(stream, target_position));
+    }
+    else {
+        IONCHECK(_ion_stream_mapped_fetch_position(stream, target_position));
+    }
+    SUCCEED();
+
+    iRETURN;
 }
 
-BOOL _ion_stream_current_page_contains_position( ION_STREAM *stream, POSITION position )
+// resizes a growable stream's buffer to twice the size, or large enough to
+// hold target_position if that's more, through its allocator's realloc
+iERR _ion_stream_grow( ION_STREAM *stream, POSITION target_position )
 {
-    ASSERT(stream);
-    ASSERT(position >= 0);
+    iENTER;
+    BYTE    *buffer;
+    SIZE     used, curr, new_size;
+    POSITION needed;
 
-    if (position < stream->_offset) {
-        return FALSE;
-    }
-    if (position >= IH_POSITION_OF(stream->_limit)) {
-        return FALSE;
+    ASSERT(_ion_stream_is_growable(stream));
+    ASSERT(!_ion_stream_is_mark_open(stream));
+
+    needed = target_position - stream->_offset + 1;
+    if (needed > IH_MAX_PAGE_SIZE) FAILWITH(IERR_NO_MEMORY);
+
+    new_size = stream->_buffer_size;
+    while (new_size < needed) {
+        new_size = (new_size > IH_MAX_PAGE_SIZE / 2) ? IH_MAX_PAGE_SIZE : new_size * 2;
     }
-    return TRUE;
-}
 
-//////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // the allocator's realloc, if it has one, may be able to grow it in place
+    used = (SIZE)(stream->_limit - stream->_buffer);
+    curr = (SIZE)(stream->_curr - stream->_buffer);
+    buffer = (BYTE *)_ion_allocator_realloc(stream->_allocator, stream->_buffer, stream->_buffer_size, new_size);
+    if (!buffer) FAILWITH(IERR_NO_MEMORY);
 
-//            internal instance functions
+    // there's nothing behind the buffer to flush the dirty bytes to
+    stream->_dirty_start  = NULL;
+    stream->_dirty_length = 0;
+    stream->_curr         = buffer + curr;
+    stream->_limit        = buffer + used;
+    stream->_buffer       = buffer;
+    stream->_buffer_size  = new_size;
+    SUCCEED();
 
-//////////////////////////////////////////////////////////////////////////////////////////////////////////
+    iRETURN;
+}
 
-iERR _ion_stream_fetch_position( ION_STREAM *stream, POSITION target_position )
+// replaces the remove bytes at position in a growable stream with the
+// insert_length bytes of insert, moving the bytes after them up or down.
+// The cursor, if it was past the replaced bytes, moves with them
+iERR _ion_stream_splice( ION_STREAM *stream, POSITION position, SIZE remove, BYTE *insert, SIZE insert_length )
 {
     iENTER;
-    ION_STREAM_PAGED *paged = PAGED_STREAM(stream);
-    PAGE_ID           current_page_id, target_page_id;
-    ION_PAGE         *page;
-    POSITION          page_end;
-    BOOL              new_page = FALSE;
+    BYTE *start, *tail;
+    SIZE  delta, tail_length;
 
     ASSERT(stream);
-    ASSERT(target_position >= 0);
+    ASSERT(_ion_stream_is_growable(stream));
+    ASSERT(remove >= 0 && insert_length >= 0);
 
-    if (!_ion_stream_is_paged(stream) && _ion_stream_is_fully_buffered(stream)) {
-        // if we have a user buffer, this is one large page and thus we can position within it
-        page_end = IH_POSITION_OF(stream->_limit);
-        if (target_position >= page_end) {
-            FAILWITH(IERR_EOF);
-        }
-        SUCCEED();
+    if (position < stream->_offset || position + remove > IH_POSITION_OF(stream->_limit)) {
+        FAILWITH(IERR_INVALID_ARG);
     }
 
-    ASSERT(_ion_stream_is_paged(stream)); // we should never get here unless we're in a paged stream
-    
-    // never mind, it's ok to call this even if the new position is on the current page: ASSERT(IH_CURR_OF( target_position ) < stream->_buffer || IH_CURR_OF( target_position ) >= stream->_limit);
-
-    // where are we? and where do we want to go?
-    page = paged->_curr_page;
-    current_page_id = page ? page->_page_id : -1; // if we don't have a current page pick an invalid page id
-    target_page_id = _ion_stream_page_id_from_offset( stream, target_position );
-
-    // if we are switching pages see if we have the page cached already
-    if ( current_page_id != target_page_id ) {
-        IONCHECK( _ion_stream_page_find( paged, target_page_id, &page ) );
-        if (page == NULL) {            // we don't have the page we want. So we have to create the target page so
-            // we can fill this page shortly
-            IONCHECK( _ion_stream_page_allocate( paged, target_page_id, &page ) );
-            new_page = TRUE;
-        }
+    delta = insert_length - remove;
+    if (delta > 0 && stream->_limit + delta > stream->_buffer + stream->_buffer_size) {
+        IONCHECK(_ion_stream_grow(stream, IH_POSITION_OF(stream->_limit) + delta));
     }
 
-    ASSERT( page );
-    ASSERT( page->_page_id == target_page_id );
-
-    // if the page hasn't been filled, then we need to fill it
-    page_end  = _ion_stream_offset_from_page_id( stream, page->_page_id );
-    page_end +=  page->_page_start;
-    page_end +=  page->_page_limit;
-
-    if ( page_end <= target_position ) {
-        //
-        //  This calls fetch and fill page to do the actual read
-        //
-        err = _ion_stream_fetch_fill_page( stream, page, target_position );
-        if (err != IERR_OK) {
-            // if we were not able to read the needed bytes, we *may* need to
-            // free this page (to avoid leaking pages at EOF, for example)
-            // so - if there are no bytes on page, and it's not the current page ...
-            if (page->_page_limit < 1 && page != paged->_curr_page) {
-                _ion_stream_page_release(paged, page);
-            }
-            if (err == IERR_EOF) {
-                DONTFAILWITH( err );
-            }
-            else {
-                FAILWITH(err);
-            }
-        }
-        // in leiu of the "page make current" (below) which sets stream->_limit
-        if ( current_page_id == target_page_id ) {
-            stream->_limit = page->_buf + page->_page_limit;
-        }
-    }
-    else {
-        ASSERT(page->_page_start == 0); // TODO: BUGBUG: What is we backed up onto this page through "unread" and the choose to seek back to it ??
+    start       = IH_CURR_OF(position);
+    tail        = start + remove;
+    tail_length = (SIZE)(stream->_limit - tail);
+    if (delta != 0 && tail_length > 0) {
+        memmove(tail + delta, tail, tail_length);
     }
-    ASSERT( page );
-    ASSERT( page->_page_id == target_page_id );
-    
-    // page is filled and allocated - make it current (if it isn't already)
-    if (new_page) {
-        IONCHECK( _ion_stream_page_register( paged, page ) );
+    if (insert_length > 0) {
+        memcpy(start, insert, insert_length);
     }
-    if ( current_page_id != target_page_id ) {
-        IONCHECK( _ion_stream_page_make_current( paged, page ) );
+
+    if (stream->_curr >= tail) {
+        stream->_curr += delta;
     }
-    stream->_curr = IH_CURR_OF( target_position );
-    ASSERT(
-             (_ion_stream_current_page_contains_position( stream, target_position ) == TRUE)
-           ||   
-             ( target_position ==(page_end = IH_POSITION_OF( stream->_curr )) )
-          );
+    stream->_limit += delta;
+    stream->_dirty_start  = NULL;
+    stream->_dirty_length = 0;
     SUCCEED();
 
     iRETURN;
@@ -1547,7 +2689,7 @@ iERR _ion_stream_fetch_fill_page( ION_STREAM *stream, ION_PAGE *page, POSITION t
     ION_STREAM_PAGED *paged = PAGED_STREAM(stream);
     POSITION          page_read_position;
     BYTE             *dst, *end;
-    SIZE              end_buf_offset, bytes_needed_user, bytes_needed_buffer, local_bytes_read;
+    SIZE              end_buf_offset, bytes_needed_user, bytes_needed_buffer, local_bytes_read, more_bytes_read;
     
     ASSERT(stream);
     ASSERT(_ion_stream_is_paged(stream));
@@ -1568,13 +2710,26 @@ iERR _ion_stream_fetch_fill_page( ION_STREAM *stream, ION_PAGE *page, POSITION t
 
     if (_ion_stream_is_file_backed(stream) && _ion_stream_can_read(stream)) {
 
-        // first position ourselves for the read
-        IONCHECK( _ion_stream_fseek( stream, page_read_position ) );
-
         // we will read directly into the page buffer between these two pointers
         dst = &(page->_buf[end_buf_offset]);
         end = dst + bytes_needed_buffer;
-        IONCHECK(_ion_stream_fread( stream, dst, end, &local_bytes_read ));
+
+        if (paged->_read_ahead) {
+            // the read ahead thread reads by position, there's nothing to seek
+            IONCHECK(_ion_stream_read_ahead_read( paged, page_read_position, dst, end, &local_bytes_read ));
+        }
+        else {
+            // first position ourselves for the read
+            IONCHECK( _ion_stream_fseek( stream, page_read_position ) );
+            IONCHECK(_ion_stream_fread( stream, dst, end, &local_bytes_read ));
+            // pipes and user handlers hand over what they have at the moment,
+            // which after a skip may not reach the target position yet
+            while (local_bytes_read > 0 && local_bytes_read < bytes_needed_user) {
+                IONCHECK(_ion_stream_fread( stream, dst + local_bytes_read, end, &more_bytes_read ));
+                if (more_bytes_read <= 0) break;
+                local_bytes_read += more_bytes_read;
+            }
+        }
         if (local_bytes_read < 0) {
             // the read functions return negative lengths for unusual read conditions
             if (local_bytes_read == READ_EOF_LENGTH) {
@@ -1613,7 +2768,7 @@ iERR _ion_stream_fseek( ION_STREAM *stream, POSITION target_position )
         // short cut when we have a random access file backing the stream
 		if (_ion_stream_is_fd_backed(stream)) {
 			// TODO : should we validate this cast to long somehow?
-	        if (LSEEK((int)stream->_fp, (long)target_position, SEEK_SET)) {
+	        if (LSEEK((int)stream->_fp, (long)target_position, SEEK_SET) < 0) {
 		        FAILWITH(IERR_SEEK_ERROR);
 			}
 		}
@@ -1635,25 +2790,18 @@ iERR _ion_stream_fseek( ION_STREAM *stream, POSITION target_position )
     iRETURN;
 }
 
-// the "stream read for seek" uses a stack variable to hold 1 fake
-// page. this fake page is used when calling console read since
-// console read always assumes it has a buffer to read into
-// these defines specify set up the correct size for the local
-// so it can hold the ion_page overhead and some bytes of input
-// (console input is generally a slower operation so there's
-// no optimization for this case ... yet)
-
-#define LOCAL_BUFFER_SIZE 512
-#define LOCAL_FAKE_PAGE_SIZE (sizeof(ION_PAGE) + LOCAL_BUFFER_SIZE)
+// the "stream read for seek" moves a sequential input source forward to
+// the target position. When the stream is caching, the bytes read on the
+// way are kept in pages, otherwise they're simply thrown away in bulk
 
 iERR _ion_stream_read_for_seek( ION_STREAM *stream, POSITION target_position )
 {
     iENTER;
     ION_STREAM_PAGED *paged = PAGED_STREAM(stream);
-    ION_PAGE         *page, *local_fake_page;
-    BYTE              local_fake_buffer[LOCAL_FAKE_PAGE_SIZE], *dst, *end;
+    ION_PAGE         *page;
+    BYTE             *dst, *end;
     PAGE_ID           current_page_id;
-    POSITION          current_position;
+    POSITION          current_position, discarded;
     SIZE              bytes_read;
 
     ASSERT(stream);
@@ -1682,73 +2830,70 @@ iERR _ion_stream_read_for_seek( ION_STREAM *stream, POSITION target_position )
         current_position +=  page->_page_limit;
     }
 
-    // if we aren't caching we'll need somewhere to put the
-    // bytes we read - just to throw them away
-    // note that since this is a stack allocated value the cost 
-    // of setting up the buffer is very small (so we don't bother 
-    // to bail out here even when there's nothing to read)
     if (_ion_stream_is_caching(stream) == FALSE) {
-        local_fake_page = (ION_PAGE *)local_fake_buffer;
-        local_fake_page->_page_start = 0;
-        local_fake_page->_page_limit = 0;
-        local_fake_page->_next_free = NULL;
-    }
-
-    // read input source until we get to the desired target position
-    while (current_position < target_position) {
-        // see if we need to set up a page to read data into
-        if (!page || page->_page_id != current_page_id) {
-            // we don't have the right page to put data into (either a
-            // real for a fake page)
-            if (_ion_stream_is_caching(stream)) {
-                // if we are caching the data we need a real page
+        // nobody will want the bytes in between, so don't page them in
+        if (current_position < target_position) {
+            IONCHECK(_ion_stream_discard( stream, target_position - current_position, &discarded ));
+            current_position += discarded;
+            if (current_position < target_position) {
+                // we ran out of input, so the stream ends up at the eof
+                IONCHECK(_ion_stream_page_park( paged, current_position ));
+            }
+        }
+    }
+    else {
+        // read input source until we get to the desired target position
+        while (current_position < target_position) {
+            // see if we need to set up a page to read data into
+            if (!page || page->_page_id != current_page_id) {
+                // we are caching the data so we need a real page
                 IONCHECK( _ion_stream_page_find( paged, current_page_id, &page ) );
                 if (page == NULL) {
                     // we don't have the page we want. So we have to create the target page so
                     IONCHECK( _ion_stream_page_allocate( paged, current_page_id, &page ) );
+                    IONCHECK( _ion_stream_page_register( paged, page ) );
+                }
+                if (paged->_last_page == NULL || paged->_last_page->_page_id < page->_page_id) {
+                    paged->_last_page = page;
                 }
             }
-            else {
-                // since we're not caching we will read into our local fake page so here we
-                // reset to a clean local fake page (we're going to throw it out anyway)
-                page = local_fake_page;
-                page->_page_id = current_page_id;
-                page->_page_limit = 0;
-            }
-        }
-        // set the dst to write to - we write to the unused area of the pages buffer
-        dst = page->_buf + page->_page_start + page->_page_limit;
-        if (page == local_fake_page) {
-            end = local_fake_page->_buf + (sizeof(local_fake_buffer) - sizeof(ION_PAGE));
-        }
-        else {
+            // set the dst to write to - we write to the unused area of the pages buffer
+            dst = page->_buf + page->_page_start + page->_page_limit;
             end = page->_buf + paged->_page_size;
-        }
 
-        // we shorten end if our target position is inside the current page
-        if ((SIZE)(end - dst) > (SIZE)(target_position - current_position)) {
-            end = dst + (SIZE)(target_position - current_position);
-        }
+            // we shorten end if our target position is inside the current page
+            if ((SIZE)(end - dst) > (SIZE)(target_position - current_position)) {
+                end = dst + (SIZE)(target_position - current_position);
+            }
 
-        if (dst < end) {
-            // read the bytes (this will check for the type of input as necessary)
-            IONCHECK(_ion_stream_fread( stream, dst, end, &bytes_read ));
-            if (bytes_read < 0) {
-                if (bytes_read == READ_EOF_LENGTH) {
-                    FAILWITH(IERR_EOF);
+            if (dst < end) {
+                // read the bytes (this will check for the type of input as necessary)
+                IONCHECK(_ion_stream_fread( stream, dst, end, &bytes_read ));
+                if (bytes_read < 0) {
+                    if (bytes_read == READ_EOF_LENGTH) {
+                        FAILWITH(IERR_EOF);
+                    }
+                    FAILWITH(IERR_SEEK_ERROR);
+                }
+                if (bytes_read == 0) {
+                    // a file or pipe simply stops at eof
+                    break;
                 }
-                FAILWITH(IERR_SEEK_ERROR);
-            }
 
-            // update our two positions (buffer and file position)
-            current_position += bytes_read;
-            dst += bytes_read;
-        }
+                // update our two positions (buffer and file position)
+                current_position += bytes_read;
+                dst += bytes_read;
+                page->_page_limit += bytes_read;
+                if (page == paged->_curr_page) {
+                    stream->_limit = dst;
+                }
+            }
 
-        // we test again since we fall through
-        if (dst >= end) {
-            // we'll need a new page if we have not finished
-            current_page_id++;
+            // we test again since we fall through
+            if (dst >= end) {
+                // we'll need a new page if we have not finished
+                current_page_id++;
+            }
         }
     }
 
@@ -1767,6 +2912,78 @@ iERR _ion_stream_read_for_seek( ION_STREAM *stream, POSITION target_position )
     iRETURN;
 }
 
+// reads and throws away up to count bytes of a sequential input source,
+// p_discarded is short only at eof. A user handler's buffers are stepped
+// over in place, anything else is read a page at a time into a scratch
+// page, which goes back on the free list when we're done
+iERR _ion_stream_discard( ION_STREAM *stream, POSITION count, POSITION *p_discarded )
+{
+    iENTER;
+    ION_STREAM_PAGED        *paged = PAGED_STREAM(stream);
+    struct _ion_user_stream *user_stream;
+    ION_PAGE                *scratch = NULL;
+    POSITION                 discarded = 0;
+    SIZE                     available, bytes_read;
+
+    ASSERT(stream);
+    ASSERT(_ion_stream_is_paged(stream));
+    ASSERT(count >= 0);
+    ASSERT(p_discarded);
+
+    if (_ion_stream_is_user_controlled(stream)) {
+        user_stream = &(((ION_STREAM_USER_PAGED *)stream)->_user_stream);
+        while (discarded < count) {
+            if (user_stream->curr == NULL
+             || user_stream->limit == NULL
+             || user_stream->curr >= user_stream->limit
+            ) {
+                err = (*(user_stream->handler))(user_stream);
+                if (err == IERR_EOF) break;
+                IONCHECK(err);
+                if (user_stream->curr >= user_stream->limit) break;
+            }
+            available = (SIZE)(user_stream->limit - user_stream->curr);
+            if ((POSITION)available > count - discarded) {
+                available = (SIZE)(count - discarded);
+            }
+            user_stream->curr += available;
+            discarded += available;
+        }
+        err = IERR_OK;
+    }
+    else {
+        // the scratch page is never registered, so its page id doesn't matter
+        IONCHECK(_ion_stream_page_allocate(paged, 0, &scratch));
+        while (discarded < count) {
+            bytes_read = paged->_page_size;
+            if ((POSITION)bytes_read > count - discarded) {
+                bytes_read = (SIZE)(count - discarded);
+            }
+            if (_ion_stream_is_tty(stream)) {
+                // the console reader stops at each new line, here there's no reason to
+                bytes_read = (SIZE)fread(scratch->_buf, sizeof(BYTE), bytes_read, stream->_fp);
+                if (ferror(stream->_fp)) FAILWITH(IERR_READ_ERROR);
+            }
+            else {
+                IONCHECK(_ion_stream_fread( stream, scratch->_buf, scratch->_buf + bytes_read, &bytes_read ));
+                if (bytes_read == READ_EOF_LENGTH) break;
+                if (bytes_read < 0) FAILWITH(IERR_READ_ERROR);
+            }
+            if (bytes_read == 0) break;
+            discarded += bytes_read;
+        }
+    }
+
+    *p_discarded = discarded;
+    SUCCEED();
+
+fail:
+    if (scratch) {
+        _ion_stream_page_release(paged, scratch);
+    }
+    RETURN(__location_name__, __line__, __count__++, err);
+}
+
 iERR _ion_stream_fread( ION_STREAM *stream, BYTE *dst, BYTE *end, SIZE *p_bytes_read)
 {
     iENTER;
@@ -1844,9 +3061,7 @@ iERR _ion_stream_fread( ION_STREAM *stream, BYTE *dst, BYTE *end, SIZE *p_bytes_
 		    if (bytes_read < 0) {
 			    bytes_read = READ_ERROR_LENGTH;
 			}	
-		    else if (bytes_read == 0) {
-			    bytes_read = READ_EOF_LENGTH;
-			}	
+			// like fread, a read at end of file simply returns 0 bytes
 		}
 		else {
 			bytes_read = (SIZE)fread(dst, sizeof(BYTE), local_bytes_read, stream->_fp);
@@ -1863,6 +3078,91 @@ iERR _ion_stream_fread( ION_STREAM *stream, BYTE *dst, BYTE *end, SIZE *p_bytes_
 }
 
 
+// writes the dirty bytes, followed by the segments, straight to the stream's
+// fd and then moves the stream (onto a fresh page) past everything written
+iERR _ion_stream_writev(ION_STREAM *stream, ION_STREAM_SEGMENT *segments, int32_t count, SIZE *p_written)
+{
+  iENTER;
+#ifdef ION_STREAM_HAS_WRITEV
+  struct iovec  iov[IH_WRITEV_COUNT], *next;
+  int           fd = (int)stream->_fp, used, remaining;
+  int32_t       ii = 0;
+  POSITION      position;
+  SIZE          written = 0;
+  ssize_t       n;
+  BOOL          has_pending;
+
+  ASSERT(_ion_stream_can_gather(stream));
+
+  // the first byte we write: the oldest pending byte, if there are any
+  position = _ion_stream_position(stream);
+  if (_ion_stream_is_dirty(stream)) {
+    position -= stream->_dirty_length;
+  }
+  if (_ion_stream_can_random_seek(stream)) {
+    if (LSEEK(fd, (long)position, SEEK_SET) < 0) {
+      FAILWITH(IERR_WRITE_ERROR);
+    }
+  }
+
+  do {
+    used = 0;
+    has_pending = _ion_stream_is_dirty(stream);
+    if (has_pending) {
+      iov[used].iov_base = stream->_dirty_start;
+      iov[used].iov_len  = (size_t)stream->_dirty_length;
+      used++;
+    }
+    for (; ii < count && used < IH_WRITEV_COUNT; ii++) {
+      if (segments[ii].length < 1) continue;
+      iov[used].iov_base = segments[ii].data;
+      iov[used].iov_len  = (size_t)segments[ii].length;
+      used++;
+    }
+
+    // writev may stop short (a pipe or socket that's full), so we
+    // carry on from wherever it stopped until the batch is out
+    next = iov;
+    remaining = used;
+    while (remaining > 0) {
+      n = writev(fd, next, remaining);
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        FAILWITH(IERR_WRITE_ERROR);
+      }
+      if (n == 0) FAILWITH(IERR_WRITE_ERROR);  // no progress, and none coming
+      position += n;
+      while (remaining > 0 && (size_t)n >= next->iov_len) {
+        n -= next->iov_len;
+        next++;
+        remaining--;
+      }
+      if (remaining > 0) {
+        next->iov_base = (BYTE *)next->iov_base + n;
+        next->iov_len -= (size_t)n;
+      }
+    }
+
+    // the pending bytes are only out once their whole batch is, a failed
+    // write leaves them dirty for the next flush
+    if (has_pending) {
+      stream->_dirty_start  = NULL;
+      stream->_dirty_length = 0;
+    }
+  } while (ii < count);
+
+  // the segment bytes are counted, the pending bytes were already
+  written = (SIZE)(position - _ion_stream_position(stream));
+  IONCHECK(_ion_stream_page_park(PAGED_STREAM(stream), position));
+  *p_written = written;
+  SUCCEED();
+#else
+  FAILWITH(IERR_INVALID_STATE);
+#endif
+
+  iRETURN;
+}
+
 iERR _ion_stream_console_read( ION_STREAM *stream, BYTE *buf, BYTE *end, SIZE *p_bytes_read)
 {
     iENTER;
@@ -1948,7 +3248,7 @@ int_fast32_t _ion_stream_page_hash_page_id(void *key, void *context)
    
   ASSERT(key);
    
-  hash = *((int_fast32_t *)key);
+  hash = (int_fast32_t)*((PAGE_ID *)key);
   return hash;
 }
 
@@ -1971,7 +3271,11 @@ iERR _ion_stream_page_allocate(ION_STREAM_PAGED *paged, PAGE_ID page_id, ION_PAG
   else {
     // if there isn't any free page in the queue - allocate a new page
     size = paged->_page_size + sizeof(ION_PAGE); // we'll allocate the struct and it's buffer in one piece
-    page = _ion_alloc_with_owner(paged, size);
+    if (!paged->_page_pool) {
+      paged->_page_pool = ion_alloc_dependent_owner(paged, sizeof(int));  // this is a fake allocation to hold the pool
+      if (!paged->_page_pool) FAILWITH(IERR_NO_MEMORY);
+    }
+    page = _ion_alloc_with_owner(paged->_page_pool, size);
     if (!page) FAILWITH(IERR_NO_MEMORY);
   }
 
@@ -2002,6 +3306,7 @@ void _ion_stream_page_release(ION_STREAM_PAGED *paged, ION_PAGE *page )
   if (test_page == page) {
     _ion_index_delete(&(paged->_index), &page_id, &test_page);
     ASSERT(test_page == page);
+    _ion_stream_page_lru_unlink(paged, page);
   }
 
   // if we are releasing the last page we need to patch back in the previous last page
@@ -2039,7 +3344,152 @@ void _ion_stream_page_clear(ION_PAGE *page)
     page->_page_id    = -1;
     page->_page_start = 0;
     page->_page_limit = 0;
+    page->_lru_prev   = NULL;
+    page->_lru_next   = NULL;
+  }
+}
+
+// puts the page at the head (the most recently used end) of the lru list
+void _ion_stream_page_lru_link(ION_STREAM_PAGED *paged, ION_PAGE *page)
+{
+  ASSERT(paged);
+  ASSERT(page);
+
+  page->_lru_prev = NULL;
+  page->_lru_next = paged->_lru_head;
+  if (paged->_lru_head) {
+    paged->_lru_head->_lru_prev = page;
+  }
+  else {
+    paged->_lru_tail = page;
+  }
+  paged->_lru_head = page;
+  paged->_page_count++;
+}
+
+void _ion_stream_page_lru_unlink(ION_STREAM_PAGED *paged, ION_PAGE *page)
+{
+  ASSERT(paged);
+  ASSERT(page);
+
+  if (page->_lru_prev) {
+    page->_lru_prev->_lru_next = page->_lru_next;
+  }
+  else {
+    ASSERT(paged->_lru_head == page);
+    paged->_lru_head = page->_lru_next;
+  }
+  if (page->_lru_next) {
+    page->_lru_next->_lru_prev = page->_lru_prev;
+  }
+  else {
+    ASSERT(paged->_lru_tail == page);
+    paged->_lru_tail = page->_lru_prev;
+  }
+  page->_lru_prev = NULL;
+  page->_lru_next = NULL;
+  paged->_page_count--;
+}
+
+// drops the least recently used pages until we're within the page budget.
+// Pages are only dirty while they're current (the dirty bytes are flushed
+// when the stream moves to another page) and the current page is never
+// dropped, so there is nothing to write back here. The released pages go
+// onto the free list to be reused for the next page we read.
+void _ion_stream_page_evict(ION_STREAM_PAGED *paged)
+{
+  ION_PAGE *page, *prev;
+
+  ASSERT(paged);
+
+  if (paged->_page_budget < 1) return;
+
+  page = paged->_lru_tail;
+  while (page && paged->_page_count > paged->_page_budget) {
+    prev = page->_lru_prev;
+    if (page != paged->_curr_page) {
+      _ion_stream_page_release(paged, page);
+    }
+    page = prev;
+  }
+  if (!paged->_last_page) {
+    paged->_last_page = paged->_curr_page;
+  }
+}
+
+// a sequential stream moving on to the next page doubles its page size (up
+// to _max_page_size) so long reads and writes take fewer, larger reads and
+// writes. Page ids are the offset divided by the page size, so this is only
+// done when the current page is the one page the stream holds, and when the
+// next page starts on a boundary of the new size. The stream's buffer still
+// points at the released page until the caller makes the new page current.
+iERR _ion_stream_page_grow(ION_STREAM_PAGED *paged, POSITION target_position)
+{
+  iENTER;
+  ION_STREAM *stream = UNPAGED_STREAM(paged);
+  ION_PAGE   *page = paged->_curr_page;
+  POSITION    next_page_start;
+  SIZE        new_size;
+
+  ASSERT(paged);
+
+  if (!page || paged->_page_count != 1 || paged->_curr_page != paged->_last_page) SUCCEED();
+  if (_ion_stream_is_caching(stream) || paged->_read_ahead || paged->_page_budget > 0) SUCCEED();
+
+  next_page_start = stream->_offset + paged->_page_size;
+  if (target_position < next_page_start || target_position >= next_page_start + paged->_page_size) SUCCEED();
+
+  new_size = paged->_page_size * 2;
+  if (paged->_page_size > paged->_max_page_size / 2) {
+    new_size = paged->_max_page_size;
+  }
+  if (next_page_start % new_size != 0) SUCCEED();
+
+  if (_ion_stream_is_dirty(stream)) {
+    IONCHECK(_ion_stream_flush_helper(stream));
+  }
+  _ion_stream_page_release(paged, page);
+  paged->_curr_page = NULL;
+
+  // every page is free now, and too small, so they all go back with their pool
+  ASSERT(paged->_page_count == 0);
+  ion_free_owner(paged->_page_pool);
+  paged->_page_pool    = NULL;
+  paged->_free_pages   = NULL;
+  paged->_page_size    = new_size;
+  stream->_buffer_size = new_size;
+  SUCCEED();
+
+  iRETURN;
+}
+
+// leaves a sequential stream that has thrown away its input up to position
+// sitting there, on an empty page that starts at position. The bytes in
+// between are gone, so the old current page is of no more use
+iERR _ion_stream_page_park(ION_STREAM_PAGED *paged, POSITION position)
+{
+  iENTER;
+  ION_STREAM *stream = UNPAGED_STREAM(paged);
+  ION_PAGE   *page;
+  PAGE_ID     page_id;
+
+  ASSERT(paged);
+
+  if (_ion_stream_is_dirty(stream)) {
+    IONCHECK(_ion_stream_flush_helper(stream));
+  }
+  if (paged->_curr_page) {
+    _ion_stream_page_release(paged, paged->_curr_page);
+    paged->_curr_page = NULL;
   }
+
+  page_id = _ion_stream_page_id_from_offset(stream, position);
+  IONCHECK(_ion_stream_page_allocate(paged, page_id, &page));
+  page->_page_start = (SIZE)(position - _ion_stream_offset_from_page_id(stream, page_id));
+  IONCHECK(_ion_stream_page_register(paged, page));
+  IONCHECK(_ion_stream_page_make_current(paged, page));
+
+  iRETURN;
 }
 
 iERR _ion_stream_page_register( ION_STREAM_PAGED *paged, ION_PAGE *page )
@@ -2061,6 +3511,7 @@ iERR _ion_stream_page_register( ION_STREAM_PAGED *paged, ION_PAGE *page )
     FAILWITH(IERR_INTERNAL_ERROR);
   }
   IONCHECK(_ion_index_insert(&(paged->_index), &(page->_page_id), page));
+  _ion_stream_page_lru_link(paged, page);
  
   // keep our "last page read" up to date (aka furthest page read)
   if (!paged->_last_page || (page->_page_id > paged->_last_page->_page_id)) {
@@ -2129,6 +3580,13 @@ iERR _ion_stream_page_make_current(ION_STREAM_PAGED *paged, ION_PAGE *page)
   if (!paged->_last_page || paged->_last_page->_page_id < page->_page_id) {
       paged->_last_page = page;
   }
+
+  // the new current page is now the most recently used
+  if (page->_lru_prev) { // (it's registered, and not already at the head)
+      _ion_stream_page_lru_unlink(paged, page);
+      _ion_stream_page_lru_link(paged, page);
+  }
+  _ion_stream_page_evict(paged);
   SUCCEED();
   
   iRETURN;
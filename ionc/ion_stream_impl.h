@@ -132,6 +132,9 @@ typedef uint32_t  ION_STREAM_FLAG;
 #define FLAG_IS_FD_BACKED       0x04000
 #define FLAG_BUFFER_ALL         0x08000
 #define FLAG_IS_USER_BUFFER     0x10000
+#define FLAG_IS_MEMORY_MAPPED   0x20000
+#define FLAG_IS_SEGMENTED       0x40000
+#define FLAG_IS_GROWABLE        0x80000
 
 // the low order bits are "operational" flags that
 // may be turned on or off during runtime
@@ -149,9 +152,14 @@ typedef uint32_t  ION_STREAM_FLAG;
 #define ION_STREAM_USER_BUF     (FLAG_BUFFER_ALL     | FLAG_CAN_READ  | FLAG_CAN_WRITE | FLAG_RANDOM_ACCESS | FLAG_IS_USER_BUFFER)
 #define ION_STREAM_MEMORY_ONLY  (FLAG_BUFFER_ALL     | FLAG_CAN_READ  | FLAG_CAN_WRITE | FLAG_RANDOM_ACCESS )
 
-#define ION_STREAM_FD_IN        (FLAG_IS_FD_BACKED   | FLAG_CAN_READ                   | FLAG_RANDOM_ACCESS )
-#define ION_STREAM_FD_OUT       (FLAG_IS_FD_BACKED   |                  FLAG_CAN_WRITE | FLAG_RANDOM_ACCESS )
-#define ION_STREAM_FD_RW        (FLAG_IS_FD_BACKED   | FLAG_CAN_READ  | FLAG_CAN_WRITE | FLAG_RANDOM_ACCESS )
+#define ION_STREAM_FD_IN        (FLAG_IS_FILE_BACKED | FLAG_IS_FD_BACKED | FLAG_CAN_READ                   | FLAG_RANDOM_ACCESS )
+#define ION_STREAM_FD_OUT       (FLAG_IS_FILE_BACKED | FLAG_IS_FD_BACKED |                  FLAG_CAN_WRITE | FLAG_RANDOM_ACCESS )
+#define ION_STREAM_FD_RW        (FLAG_IS_FILE_BACKED | FLAG_IS_FD_BACKED | FLAG_CAN_READ  | FLAG_CAN_WRITE | FLAG_RANDOM_ACCESS )
+
+#define ION_STREAM_MMAP_IN      (FLAG_BUFFER_ALL     | FLAG_CAN_READ                   | FLAG_RANDOM_ACCESS | FLAG_IS_USER_BUFFER | FLAG_IS_MEMORY_MAPPED)
+#define ION_STREAM_SEGMENTS_IN  (FLAG_BUFFER_ALL     | FLAG_CAN_READ                   | FLAG_RANDOM_ACCESS | FLAG_IS_USER_BUFFER | FLAG_IS_SEGMENTED)
+#define ION_STREAM_SEGMENTS_OUT (                                       FLAG_CAN_WRITE                      | FLAG_IS_USER_BUFFER | FLAG_IS_SEGMENTED)
+#define ION_STREAM_GROWABLE     (FLAG_BUFFER_ALL     | FLAG_CAN_READ  | FLAG_CAN_WRITE | FLAG_RANDOM_ACCESS | FLAG_IS_USER_BUFFER | FLAG_IS_GROWABLE)
 
 #define ION_STREAM_USER_IN      (FLAG_IS_FILE_BACKED | FLAG_CAN_READ                                        | FLAG_USER_HANDLING)
 #define ION_STREAM_USER_OUT     (FLAG_IS_FILE_BACKED |                  FLAG_CAN_WRITE                      | FLAG_USER_HANDLING)
@@ -165,6 +173,17 @@ typedef uint32_t  ION_STREAM_FLAG;
 
 #define IH_DEFAULT_PAGE_SIZE    (1024*8)
 
+// the largest page a stream may use (or grow to), this keeps the page
+// header plus its buffer, and the offsets within it, inside a SIZE
+#define IH_MAX_PAGE_SIZE        (1024*1024*1024)
+
+#define IH_DEFAULT_READ_AHEAD_DEPTH 4
+
+// a memory mapped stream exposes the mapping through windows of at most this
+// many bytes, since the stream's buffer size (and the buffer arithmetic in
+// its callers) is limited to a SIZE. Files smaller than this are one window.
+#define IH_MMAP_WINDOW_SIZE     (1024*1024*1024)
+
 GLOBAL SIZE g_Ion_Stream_Default_Page_Size INITTO(IH_DEFAULT_PAGE_SIZE);  // a global so we could choose to change a runtime with effort
 
 struct _ion_stream
@@ -183,6 +202,10 @@ struct _ion_stream
 
   BYTE            *_dirty_start;  // pointer to first dirty byte in current buffer
   SIZE             _dirty_length; // number of dirty bytes (only contiguous bytes in the current buffer are allowed to be dirty)
+
+  ION_ALLOCATOR   *_allocator;    // where buffers the stream may resize or free on its own come from, NULL for malloc
+  BYTE            *_reserved;     // bytes handed out by ion_stream_reserve, either _curr or _reserve_buffer, NULL if none
+  BYTE             _reserve_buffer[ION_STREAM_MAX_RESERVE]; // used when a reservation doesn't fit in the rest of the page
 };
 
 struct _ion_stream_paged // extends _ion_stream
@@ -191,10 +214,17 @@ struct _ion_stream_paged // extends _ion_stream
   ION_PAGE         *_curr_page;   // the current page we're on (may be NULL) TODO - should this be an idx?
   ION_PAGE         *_last_page;   // this is really the furthest page read, used for sequential reads
   SIZE              _page_size;   // size of buffers in all pages
+  SIZE              _max_page_size; // sequential streams double _page_size up to this, 0 (or not above _page_size) for a fixed size
   ION_PAGE         *_free_pages;  // list of allocated pages but unused pages 
+  void             *_page_pool;   // dependent owner the pages are allocated on, so they can be freed when the page size changes
   // the ION_INDEX is a hashed index which requires pages to all be the same 
   // size so that locations can be converted to page numbers functionally
   ION_INDEX         _index;       // index into current pages by page_offset (9 ptrs, 6 int32's, 1 byte == 61 or 97 bytes)
+  ION_READ_AHEAD   *_read_ahead;  // background reader filling the following pages, NULL unless opened with read ahead
+  ION_PAGE         *_lru_head;    // registered pages, most recently made current first
+  ION_PAGE         *_lru_tail;    // least recently used page, the first to be evicted
+  int32_t           _page_count;  // number of pages registered in _index
+  int32_t           _page_budget; // most pages to keep registered, 0 for no limit (see ion_stream_set_cache_budget)
 }; // ( 15 ptrs, 9 int32's, 1 byte = 97 - 157 bytes) which means it's probably still worth having the two structs
 
 struct _ion_stream_user_paged // extends _ion_stream_paged
@@ -203,12 +233,41 @@ struct _ion_stream_user_paged // extends _ion_stream_paged
   struct _ion_user_stream  _user_stream;
 }; // (157 bytes + 4 ptrs) 
 
+struct _ion_stream_mapped // extends _ion_stream
+{
+  ION_STREAM        _base;
+  BYTE             *_map_base;    // start of the file mapping, _buffer is a window into this
+  POSITION          _map_length;  // length of the file mapping (the file length when it was opened)
+};
+
+struct _ion_stream_segmented // extends _ion_stream
+{
+  ION_STREAM          _base;
+  ION_STREAM_SEGMENT *_segments;  // copy of the caller's segment list, _buffer is always one of these segments
+  POSITION           *_starts;    // stream position of the first byte of each segment
+  int32_t             _count;
+  int32_t             _current;   // index of the segment _buffer is on
+  POSITION            _length;    // total length of all the segments
+
+  // the rest is only used by output streams, where the list grows as we write
+  int32_t             _capacity;    // slots allocated in _segments
+  int32_t             _user_count;  // the first _user_count segments are the caller's, the rest are ours
+  SIZE                _next_size;   // size of the next segment we allocate
+  SIZE                _max_size;    // and how large they may grow
+  ION_STREAM_SEGMENT_HANDLER _handler;
+  void               *_handler_state;
+  ION_STREAM_SEGMENT *_filled;      // the list returned by ion_stream_get_segments
+  int32_t             _filled_capacity;
+};
+
 struct _ion_page
 {
   ION_PAGE         *_next_free;
   PAGE_ID           _page_id;     // which page in the file is this (this equals position modulo page size)
   SIZE              _page_start;  // offset of the first byte of filled data, this is 0 unless the page has been filled via unread
   SIZE              _page_limit;  // number of bytes filled in the current page buf
+  ION_PAGE         *_lru_prev;    // neighbours in the paged stream's lru list while registered
+  ION_PAGE         *_lru_next;
   BYTE              _buf[0];      // buffer of bytes, the size is _ion_stream_paged->_page_size
 };
 
@@ -219,6 +278,8 @@ struct _ion_page
 #define STREAM_FLAGS(stream) ((stream)->_flags)
 
 #define PAGED_STREAM( stream )  ((ION_STREAM_PAGED *)(stream))
+#define MAPPED_STREAM( stream ) ((ION_STREAM_MAPPED *)(stream))
+#define SEGMENTED_STREAM( stream ) ((ION_STREAM_SEGMENTED *)(stream))
 #define UNPAGED_STREAM( paged ) ((ION_STREAM *)(&(paged->_base)))
 #define IH_POSITION_OF( ptr )   (stream->_offset + ((ptr) - stream->_buffer))
 #define IH_CURR_OF( pos )       (stream->_buffer + ((pos) - stream->_offset))  /* WARNING: this might need a cast of the pos-offset to SIZE */
@@ -232,9 +293,16 @@ struct _ion_page
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-iERR _ion_stream_open_helper( ION_STREAM_FLAG flags, SIZE page_size, ION_STREAM **pp_stream );
+iERR _ion_stream_open_helper( ION_STREAM_FLAG flags, SIZE page_size, ION_ALLOCATOR *allocator, ION_STREAM **pp_stream );
+iERR _ion_stream_open_options_helper( ION_STREAM_FLAG flags, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream );
+iERR _ion_stream_open_read_ahead_helper( ION_STREAM_FLAG flags, FILE *fp, int fd, ION_STREAM_OPTIONS *p_options, ION_STREAM **pp_stream );
 iERR _ion_stream_flush_helper( ION_STREAM *stream );
 
+// an in memory stream over one contiguous buffer, which the stream reallocates
+// (twice the size) when a write runs off its end. The bytes can be replaced in
+// place with _ion_stream_splice, see the single pass binary writer
+iERR _ion_stream_open_growable( SIZE initial_size, ION_ALLOCATOR *allocator, ION_STREAM **pp_stream );
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //  internal getters and other informational functions
@@ -253,6 +321,11 @@ BOOL      _ion_stream_is_fd_backed        ( ION_STREAM *stream );
 BOOL      _ion_stream_is_tty              ( ION_STREAM *stream );
 BOOL      _ion_stream_is_user_controlled  ( ION_STREAM *stream );
 BOOL      _ion_stream_is_paged            ( ION_STREAM *stream );
+BOOL      _ion_stream_is_mapped           ( ION_STREAM *stream );
+BOOL      _ion_stream_is_segmented        ( ION_STREAM *stream );
+BOOL      _ion_stream_is_windowed         ( ION_STREAM *stream );
+BOOL      _ion_stream_is_growable         ( ION_STREAM *stream );
+BOOL      _ion_stream_can_gather          ( ION_STREAM *stream );
 BOOL      _ion_stream_is_fully_buffered   ( ION_STREAM *stream );
 BOOL      _ion_stream_is_caching          ( ION_STREAM *stream );
 
@@ -275,12 +348,29 @@ BOOL      _ion_stream_current_page_contains_position( ION_STREAM *stream, POSITI
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 iERR _ion_stream_fetch_position           ( ION_STREAM *stream, POSITION position );
+iERR _ion_stream_mapped_fetch_position    ( ION_STREAM *stream, POSITION position );
+iERR _ion_stream_segments_fetch_position  ( ION_STREAM *stream, POSITION position );
+iERR _ion_stream_segments_out_fetch_position( ION_STREAM *stream, POSITION position );
+iERR _ion_stream_segments_out_add         ( ION_STREAM_SEGMENTED *segmented );
+iERR _ion_stream_window_fetch_position    ( ION_STREAM *stream, POSITION position );
+iERR _ion_stream_grow                     ( ION_STREAM *stream, POSITION target_position );
+iERR _ion_stream_splice                   ( ION_STREAM *stream, POSITION position, SIZE remove, BYTE *insert, SIZE insert_length );
 iERR _ion_stream_fetch_fill_page          ( ION_STREAM *stream, ION_PAGE *page, POSITION target_position );
 iERR _ion_stream_fseek                    ( ION_STREAM *stream, POSITION target_position );
 iERR _ion_stream_read_for_seek            ( ION_STREAM *stream, POSITION target_position );
+iERR _ion_stream_discard                  ( ION_STREAM *stream, POSITION count, POSITION *p_discarded );
+BOOL _ion_stream_is_sequential_skip       ( ION_STREAM *stream );
+iERR _ion_stream_skip_sequential          ( ION_STREAM *stream, SIZE distance, SIZE *p_skipped );
 iERR _ion_stream_fread                    ( ION_STREAM *stream, BYTE *dst, BYTE *end, SIZE *p_bytes_read);
+iERR _ion_stream_writev                   ( ION_STREAM *stream, ION_STREAM_SEGMENT *segments, int32_t count, SIZE *p_written);
 iERR _ion_stream_console_read             ( ION_STREAM *stream, BYTE *dst, BYTE *end, SIZE *p_bytes_read);
 
+// read ahead for file and fd input streams, see ion_stream_read_ahead.c
+iERR _ion_stream_read_ahead_start         ( ION_STREAM_PAGED *paged, int fd, int32_t depth );
+iERR _ion_stream_read_ahead_read          ( ION_STREAM_PAGED *paged, POSITION position, BYTE *dst, BYTE *end, SIZE *p_bytes_read);
+void _ion_stream_read_ahead_stop          ( ION_STREAM_PAGED *paged );
+void _ion_stream_read_ahead_stats         ( ION_STREAM_PAGED *paged, int64_t *p_hits, int64_t *p_misses );
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //            PAGE ROUTINES - these manage pages for the paged streams
@@ -297,6 +387,11 @@ iERR _ion_stream_page_register      ( ION_STREAM_PAGED *paged, ION_PAGE *page );
 iERR _ion_stream_page_find          ( ION_STREAM_PAGED *paged, PAGE_ID page_id, ION_PAGE **pp_page );
 iERR _ion_stream_page_make_current  ( ION_STREAM_PAGED *paged, ION_PAGE *page );
 iERR _ion_stream_page_get_last_read ( ION_STREAM *stream, ION_PAGE **pp_page );
+void _ion_stream_page_lru_link      ( ION_STREAM_PAGED *paged, ION_PAGE *page );
+void _ion_stream_page_lru_unlink    ( ION_STREAM_PAGED *paged, ION_PAGE *page );
+void _ion_stream_page_evict         ( ION_STREAM_PAGED *paged );
+iERR _ion_stream_page_grow          ( ION_STREAM_PAGED *paged, POSITION target_position );
+iERR _ion_stream_page_park          ( ION_STREAM_PAGED *paged, POSITION position );
 
 
 #ifdef __cplusplus
@@ -0,0 +1,355 @@
+/*
+ * Copyright 2009-2016 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at:
+ *
+ *     http://aws.amazon.com/apache2.0/
+ *
+ * or in the "license" file accompanying this file. This file is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the License for the specific
+ * language governing permissions and limitations under the License.
+ */
+
+/*
+ * read ahead for file and fd backed input streams
+ *
+ * a background thread reads the pages following the one the reader is
+ * on into a small ring of slots, using pread so it never disturbs the
+ * file position. When the stream needs to fill a page it copies the
+ * bytes out of a ready slot instead of blocking on the read itself, and
+ * frees the slot so the thread can move on to the next page.
+ *
+ * If the stream asks for a position that isn't in (or being read into)
+ * any slot, the reader has jumped (a seek, a skip, a mark rewind past
+ * the pages we still have) and the thread is sent there instead. The
+ * slots it had already read are dropped, and any read that is in flight
+ * is thrown away when it finishes (the generation tells them apart).
+ *
+ *   slot states
+ *     EMPTY   - free for the thread to read into
+ *     LOADING - the thread is reading into it (outside the lock)
+ *     READY   - holds the bytes at position, length is short at eof
+ *               (or READ_ERROR_LENGTH if the read failed)
+ *
+ */
+
+#include "ion_internal.h"
+
+#ifndef ION_PLATFORM_WINDOWS
+  #define ION_STREAM_HAS_READ_AHEAD
+  #include <errno.h>
+  #include <pthread.h>
+  #include <sys/types.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#ifdef ION_STREAM_HAS_READ_AHEAD
+
+#define RA_SLOT_EMPTY       0
+#define RA_SLOT_LOADING     1
+#define RA_SLOT_READY       2
+
+typedef struct _ion_read_ahead_slot
+{
+    int               _state;       // RA_SLOT_EMPTY, RA_SLOT_LOADING or RA_SLOT_READY
+    int32_t           _generation;  // the generation the read was started in
+    POSITION          _position;    // file offset of the first byte in _buf
+    SIZE              _length;      // number of bytes read, or READ_ERROR_LENGTH
+    BYTE             *_buf;         // page size bytes
+} ION_READ_AHEAD_SLOT;
+
+struct _ion_read_ahead
+{
+    int               _fd;
+    SIZE              _page_size;
+    int32_t           _depth;         // number of slots
+    ION_READ_AHEAD_SLOT *_slots;
+
+    pthread_t         _thread;
+    pthread_mutex_t   _lock;          // protects everything below and the slot states
+    pthread_cond_t    _changed;       // signalled when a slot changes state or the reader moves
+
+    BOOL              _stop;
+    BOOL              _at_eof;        // the thread read a short page, it waits until the reader moves
+    int32_t           _generation;    // bumped each time the reader jumps away from the thread
+    POSITION          _next_position; // where the thread will read next
+
+    int64_t           _hits;          // fills satisfied from a ready slot
+    int64_t           _misses;        // fills that had to wait for the read
+};
+
+static ION_READ_AHEAD_SLOT *_ion_stream_read_ahead_find_slot(ION_READ_AHEAD *ra, POSITION position)
+{
+    ION_READ_AHEAD_SLOT *slot;
+    int32_t              ii;
+
+    for (ii = 0; ii < ra->_depth; ii++) {
+        slot = &ra->_slots[ii];
+        if (slot->_state == RA_SLOT_EMPTY) continue;
+        if (slot->_generation != ra->_generation) continue;
+        if (position < slot->_position) continue;
+        if (position >= slot->_position + ra->_page_size) continue;
+        return slot;
+    }
+    return NULL;
+}
+
+static ION_READ_AHEAD_SLOT *_ion_stream_read_ahead_free_slot(ION_READ_AHEAD *ra)
+{
+    int32_t ii;
+
+    for (ii = 0; ii < ra->_depth; ii++) {
+        if (ra->_slots[ii]._state == RA_SLOT_EMPTY) {
+            return &ra->_slots[ii];
+        }
+    }
+    return NULL;
+}
+
+static void _ion_stream_read_ahead_drop_ready(ION_READ_AHEAD *ra)
+{
+    int32_t ii;
+
+    // slots that are still loading are dropped by the thread when
+    // their read finishes, since their generation will be out of date
+    for (ii = 0; ii < ra->_depth; ii++) {
+        if (ra->_slots[ii]._state == RA_SLOT_READY) {
+            ra->_slots[ii]._state = RA_SLOT_EMPTY;
+        }
+    }
+}
+
+static void *_ion_stream_read_ahead_thread(void *context)
+{
+    ION_READ_AHEAD      *ra = (ION_READ_AHEAD *)context;
+    ION_READ_AHEAD_SLOT *slot;
+    ssize_t              bytes_read;
+
+    pthread_mutex_lock(&ra->_lock);
+    for (;;) {
+        slot = NULL;
+        while (!ra->_stop && (ra->_at_eof || (slot = _ion_stream_read_ahead_free_slot(ra)) == NULL)) {
+            pthread_cond_wait(&ra->_changed, &ra->_lock);
+        }
+        if (ra->_stop) break;
+
+        slot->_state      = RA_SLOT_LOADING;
+        slot->_generation = ra->_generation;
+        slot->_position   = ra->_next_position;
+        ra->_next_position += ra->_page_size;
+
+        // the read itself is done without the lock so the reader can keep
+        // copying out of the other slots while we wait on the disk
+        pthread_mutex_unlock(&ra->_lock);
+        do {
+            bytes_read = pread(ra->_fd, slot->_buf, (size_t)ra->_page_size, (off_t)slot->_position);
+        } while (bytes_read < 0 && errno == EINTR);
+        pthread_mutex_lock(&ra->_lock);
+
+        if (slot->_generation != ra->_generation) {
+            // the reader went somewhere else while we were reading
+            slot->_state = RA_SLOT_EMPTY;
+        }
+        else {
+            slot->_length = (bytes_read < 0) ? READ_ERROR_LENGTH : (SIZE)bytes_read;
+            slot->_state  = RA_SLOT_READY;
+            if (slot->_length < ra->_page_size) {
+                ra->_at_eof = TRUE;
+            }
+        }
+        pthread_cond_broadcast(&ra->_changed);
+    }
+    pthread_mutex_unlock(&ra->_lock);
+
+    return NULL;
+}
+
+iERR _ion_stream_read_ahead_start(ION_STREAM_PAGED *paged, int fd, int32_t depth)
+{
+    iENTER;
+    ION_STREAM     *stream = (ION_STREAM *)paged;
+    ION_READ_AHEAD *ra;
+    BYTE           *bufs;
+    struct stat     st;
+    int32_t         ii;
+    BOOL            lock_ready = FALSE, cond_ready = FALSE;
+
+    ASSERT(paged);
+    ASSERT(paged->_read_ahead == NULL);
+    ASSERT(depth > 0);
+
+    // pread only makes sense on regular files, anything else (a pipe, a
+    // socket, a tty) just keeps reading synchronously
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        SUCCEED();
+    }
+
+    ra = (ION_READ_AHEAD *)ion_alloc_with_owner(stream, sizeof(ION_READ_AHEAD) + depth * sizeof(ION_READ_AHEAD_SLOT));
+    if (!ra) FAILWITH(IERR_NO_MEMORY);
+    memset(ra, 0, sizeof(ION_READ_AHEAD) + depth * sizeof(ION_READ_AHEAD_SLOT));
+
+    bufs = (BYTE *)ion_alloc_with_owner(stream, depth * paged->_page_size);
+    if (!bufs) FAILWITH(IERR_NO_MEMORY);
+
+    ra->_fd        = fd;
+    ra->_page_size = paged->_page_size;
+    ra->_depth     = depth;
+    ra->_slots     = (ION_READ_AHEAD_SLOT *)(ra + 1);
+    for (ii = 0; ii < depth; ii++) {
+        ra->_slots[ii]._state = RA_SLOT_EMPTY;
+        ra->_slots[ii]._buf   = bufs + ii * paged->_page_size;
+    }
+
+    if (pthread_mutex_init(&ra->_lock, NULL) != 0) FAILWITH(IERR_INTERNAL_ERROR);
+    lock_ready = TRUE;
+    if (pthread_cond_init(&ra->_changed, NULL) != 0) FAILWITH(IERR_INTERNAL_ERROR);
+    cond_ready = TRUE;
+    if (pthread_create(&ra->_thread, NULL, _ion_stream_read_ahead_thread, ra) != 0) FAILWITH(IERR_INTERNAL_ERROR);
+
+    paged->_read_ahead = ra;
+    SUCCEED();
+
+fail:
+    if (err != IERR_OK) {
+        // the memory belongs to the stream and goes when it does
+        if (cond_ready) pthread_cond_destroy(&ra->_changed);
+        if (lock_ready) pthread_mutex_destroy(&ra->_lock);
+    }
+    RETURN(__location_name__, __line__, __count__++, err);
+}
+
+iERR _ion_stream_read_ahead_read(ION_STREAM_PAGED *paged, POSITION position, BYTE *dst, BYTE *end, SIZE *p_bytes_read)
+{
+    iENTER;
+    ION_READ_AHEAD      *ra = paged->_read_ahead;
+    ION_READ_AHEAD_SLOT *slot;
+    POSITION             pos, page_position;
+    SIZE                 wanted, got = 0, available;
+    BOOL                 waited = FALSE;
+
+    ASSERT(ra);
+    ASSERT(dst && end && end >= dst);
+    ASSERT(p_bytes_read);
+
+    wanted = (SIZE)(end - dst);
+
+    pthread_mutex_lock(&ra->_lock);
+    while (got < wanted) {
+        pos = position + got;
+        slot = _ion_stream_read_ahead_find_slot(ra, pos);
+        if (!slot) {
+            page_position = pos - (pos % ra->_page_size);
+            if (!(page_position == ra->_next_position && !ra->_at_eof
+                  && _ion_stream_read_ahead_free_slot(ra) != NULL)
+            ) {
+                // the thread isn't headed where we are, drop what it
+                // has and send it to the page we want
+                _ion_stream_read_ahead_drop_ready(ra);
+                ra->_generation++;
+                ra->_next_position = page_position;
+                ra->_at_eof = FALSE;
+                pthread_cond_broadcast(&ra->_changed);
+            }
+            // otherwise it's about to start on our page
+            waited = TRUE;
+            pthread_cond_wait(&ra->_changed, &ra->_lock);
+            continue;
+        }
+        if (slot->_state == RA_SLOT_LOADING) {
+            waited = TRUE;
+            pthread_cond_wait(&ra->_changed, &ra->_lock);
+            continue;
+        }
+
+        ASSERT(slot->_state == RA_SLOT_READY);
+        if (slot->_length < 0) {
+            if (got == 0) got = READ_ERROR_LENGTH;
+            break;
+        }
+        available = (SIZE)(slot->_position + slot->_length - pos);
+        if (available <= 0) break; // eof
+        if (available > wanted - got) {
+            available = wanted - got;
+        }
+        memcpy(dst + got, slot->_buf + (pos - slot->_position), available);
+        got += available;
+
+        // once we've used the whole page the slot can be reused, a short
+        // page (eof) is kept so asking again at eof doesn't read it again
+        if (pos + available == slot->_position + ra->_page_size) {
+            slot->_state = RA_SLOT_EMPTY;
+            pthread_cond_broadcast(&ra->_changed);
+        }
+    }
+    if (waited) {
+        ra->_misses++;
+    }
+    else {
+        ra->_hits++;
+    }
+    pthread_mutex_unlock(&ra->_lock);
+
+    *p_bytes_read = got;
+    SUCCEED();
+
+    iRETURN;
+}
+
+void _ion_stream_read_ahead_stop(ION_STREAM_PAGED *paged)
+{
+    ION_READ_AHEAD *ra = paged->_read_ahead;
+
+    if (!ra) return;
+
+    pthread_mutex_lock(&ra->_lock);
+    ra->_stop = TRUE;
+    pthread_cond_broadcast(&ra->_changed);
+    pthread_mutex_unlock(&ra->_lock);
+
+    pthread_join(ra->_thread, NULL);
+    pthread_cond_destroy(&ra->_changed);
+    pthread_mutex_destroy(&ra->_lock);
+
+    paged->_read_ahead = NULL;
+}
+
+void _ion_stream_read_ahead_stats(ION_STREAM_PAGED *paged, int64_t *p_hits, int64_t *p_misses)
+{
+    ION_READ_AHEAD *ra = paged->_read_ahead;
+
+    *p_hits = *p_misses = 0;
+    if (!ra) return;
+
+    pthread_mutex_lock(&ra->_lock);
+    *p_hits   = ra->_hits;
+    *p_misses = ra->_misses;
+    pthread_mutex_unlock(&ra->_lock);
+}
+
+#else
+
+// without threads the stream simply reads synchronously
+
+iERR _ion_stream_read_ahead_start(ION_STREAM_PAGED *paged, int fd, int32_t depth)
+{
+    return IERR_OK;
+}
+
+iERR _ion_stream_read_ahead_read(ION_STREAM_PAGED *paged, POSITION position, BYTE *dst, BYTE *end, SIZE *p_bytes_read)
+{
+    return IERR_INVALID_STATE;
+}
+
+void _ion_stream_read_ahead_stop(ION_STREAM_PAGED *paged)
+{
+}
+
+void _ion_stream_read_ahead_stats(ION_STREAM_PAGED *paged, int64_t *p_hits, int64_t *p_misses)
+{
+    *p_hits = *p_misses = 0;
+}
+
+#endif
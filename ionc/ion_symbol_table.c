@@ -20,7 +20,9 @@
 #include "ion_internal.h"
 #include <ctype.h>
 #include <string.h>
-//#include "hashfn.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 iERR _ion_symbol_table_local_find_by_sid(ION_SYMBOL_TABLE *symtab, SID sid, ION_SYMBOL **p_sym);
 
@@ -64,10 +66,9 @@ iERR _ion_symbol_table_open_helper(ION_SYMBOL_TABLE **p_psymtab, hOWNER owner, I
     _ion_collection_initialize(owner, &symtab->symbols, sizeof(ION_SYMBOL)); // collection of ION_SYMBOL
 
     // if there is a system table to work from (there isn't when we
-    // create the system symbol table) we need to copy the system
-    // symbols to seed our symbol list
+    // create the system symbol table) its symbols are the first layer
     if (system) {
-        IONCHECK(_ion_symbol_table_local_incorporate_symbols(symtab, system, system->max_id));
+        IONCHECK(_ion_symbol_table_local_add_layer(symtab, system, system->max_id));
     }
     *p_psymtab = symtab;
 
@@ -129,20 +130,29 @@ iERR _ion_symbol_table_clone_with_owner_helper(ION_SYMBOL_TABLE **p_pclone, ION_
     case ist_EMPTY:
         FAILWITH(IERR_INVALID_STATE);
     case ist_LOCAL:
-        IONCHECK(_ion_symbol_table_open_helper(&clone, owner, system));
         is_shared = FALSE;
         break;
     case ist_SYSTEM:  // system symbol tables are considered shared tables
     case ist_SHARED:
-        // we don't copy the system symbols into shared tables
-        IONCHECK(_ion_symbol_table_open_helper(&clone, owner, NULL));
         is_shared = TRUE;
         break;
     }   
+    // the clone gets the original's layers, not ones of its own
+    IONCHECK(_ion_symbol_table_open_helper(&clone, owner, NULL));
 
     clone->max_id = orig->max_id;
     clone->system_symbol_table = orig->system_symbol_table;
 
+    // the imported tables are immutable, so the clone can look through the
+    // same ones
+    if (orig->layer_count > 0) {
+        IONCHECK(_ion_index_grow_array((void **)&clone->layers, 0, orig->layer_count, sizeof(clone->layers[0]), FALSE, owner));
+        memcpy(clone->layers, orig->layers, orig->layer_count * sizeof(clone->layers[0]));
+        clone->layer_count = orig->layer_count;
+        clone->layer_capacity = orig->layer_count;
+    }
+    clone->import_max_id = orig->import_max_id;
+
     // since these value should be immutable if the owner
     // has NOT changed we can use cheaper copies
     new_owner = (orig->owner != owner);
@@ -190,7 +200,7 @@ iERR ion_symbol_table_get_system_table(hSYMTAB *p_hsystem_table, int32_t version
     iENTER;
     ION_SYMBOL_TABLE *system;
 
-    if (p_hsystem_table != NULL) FAILWITH(IERR_INVALID_ARG);
+    if (p_hsystem_table == NULL) FAILWITH(IERR_INVALID_ARG);
     if (version != 1)            FAILWITH(IERR_INVALID_ION_VERSION);
 
     IONCHECK(_ion_symbol_table_get_system_symbol_helper(&system, version));
@@ -201,6 +211,14 @@ iERR ion_symbol_table_get_system_table(hSYMTAB *p_hsystem_table, int32_t version
 
 // HACK - TODO - hate this, needs to be fixed up for thread safety issues
 static ION_SYMBOL_TABLE *p_system_symbol_table_version_1 = NULL;
+
+#ifdef ION_ALLOC_HAS_THREAD_CACHE
+// where the allocator can be used from several threads the first readers and
+// writers may race to build the system table, so only one of them gets to
+#include <pthread.h>
+static pthread_mutex_t g_system_symbol_table_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 iERR _ion_symbol_table_get_system_symbol_helper(ION_SYMBOL_TABLE **pp_system_table, int32_t version)
 {
     iENTER;
@@ -208,9 +226,20 @@ iERR _ion_symbol_table_get_system_symbol_helper(ION_SYMBOL_TABLE **pp_system_tab
     ASSERT( pp_system_table != NULL );
     ASSERT( version == 1 ); // only one we understand at this point
 
+#ifdef ION_ALLOC_HAS_THREAD_CACHE
+    if (!__atomic_load_n(&p_system_symbol_table_version_1, __ATOMIC_ACQUIRE)) {
+        pthread_mutex_lock(&g_system_symbol_table_lock);
+        if (!p_system_symbol_table_version_1) {
+            err = _ion_symbol_table_local_make_system_symbol_table_helper(version);
+        }
+        pthread_mutex_unlock(&g_system_symbol_table_lock);
+        IONCHECK(err);
+    }
+#else
     if (!p_system_symbol_table_version_1) {
         IONCHECK(_ion_symbol_table_local_make_system_symbol_table_helper(version));
     }
+#endif
     *pp_system_table = p_system_symbol_table_version_1;
 
     iRETURN;
@@ -231,6 +260,8 @@ void* smallLocalAllocationBlock()
     
     new_block->next     = NULL;
     new_block->head     = NULL;
+    new_block->allocator = NULL;
+    new_block->stats     = NULL;
     
     new_block->position = ION_ALLOC_BLOCK_TO_USER_PTR(new_block);
     new_block->limit    = ((BYTE*)new_block) + alloc_size;
@@ -270,9 +301,13 @@ iERR _ion_symbol_table_local_make_system_symbol_table_helper(int32_t version)
 
     IONCHECK(_ion_symbol_table_lock_helper(psymtab));
 
-    // TODO: THREADING - THIS ASSIGNMENT NEEDS TO BE MAKE THREAD SAFE !!
-    // but we only need 1 copy of each system symbol table (the system symbol table)
+    // we only need 1 copy of each system symbol table (the system symbol table),
+    // and it's only published once it's complete
+#ifdef ION_ALLOC_HAS_THREAD_CACHE
+    __atomic_store_n(&p_system_symbol_table_version_1, psymtab, __ATOMIC_RELEASE);
+#else
     p_system_symbol_table_version_1 = psymtab;
+#endif
 
     iRETURN;
 }
@@ -791,6 +826,22 @@ iERR ion_symbol_table_get_type(hSYMTAB hsymtab, ION_SYMBOL_TABLE_TYPE *p_type)
     iRETURN;
 }
 
+iERR ion_symbol_table_get_alloc_stats(hSYMTAB hsymtab, ION_ALLOC_STATS *p_stats)
+{
+    iENTER;
+    ION_SYMBOL_TABLE *symtab;
+
+    if (hsymtab == NULL) FAILWITH(IERR_INVALID_ARG);
+    if (p_stats == NULL) FAILWITH(IERR_INVALID_ARG);
+
+    symtab = HANDLE_TO_PTR(hsymtab, ION_SYMBOL_TABLE);
+
+    memset(p_stats, 0, sizeof(*p_stats));
+    _ion_alloc_owner_add_stats(symtab->owner, p_stats);
+
+    iRETURN;
+}
+
 iERR _ion_symbol_table_get_type_helper(ION_SYMBOL_TABLE *symtab, ION_SYMBOL_TABLE_TYPE *p_type)
 {
     ION_SYMBOL_TABLE_TYPE type = ist_EMPTY;
@@ -1046,7 +1097,7 @@ iERR _ion_symbol_table_import_symbol_table_helper(ION_SYMBOL_TABLE *symtab, ION_
     import->version = import_symtab->version;
     IONCHECK(ion_string_copy_to_owner(symtab->owner, &import->name, &import_symtab->name));
 
-    IONCHECK(_ion_symbol_table_local_incorporate_symbols(symtab, import_symtab, import_symtab->max_id));
+    IONCHECK(_ion_symbol_table_local_add_layer(symtab, import_symtab, import_symtab->max_id));
 
     iRETURN;
 }
@@ -1087,73 +1138,78 @@ iERR _ion_symbol_table_add_import_helper(ION_SYMBOL_TABLE        *symtab
         IONCHECK(_ion_symbol_table_create_substitute(p_import, pcatalog, &import_symbol_table));
     }
 
-    IONCHECK(_ion_symbol_table_local_incorporate_symbols(symtab, import_symbol_table, p_import->max_id));
+    IONCHECK(_ion_symbol_table_local_add_layer(symtab, import_symbol_table, p_import->max_id));
 
     iRETURN;
 }
 
-iERR _ion_symbol_table_local_incorporate_symbols(ION_SYMBOL_TABLE *symtab, ION_SYMBOL_TABLE *import, int32_t import_max_id)
+iERR _ion_symbol_table_local_add_layer(ION_SYMBOL_TABLE *symtab, ION_SYMBOL_TABLE *import, int32_t import_max_id)
 {
     iENTER;
-    ION_COLLECTION_CURSOR cursor;
-    int32_t               base_max, duplicates;
-    ION_SYMBOL           *sym;
-    SID                   sid;
-    iERR               addErr;
+    ION_SYMBOL_TABLE_LAYER *layer;
+    int32_t                 new_capacity;
 
     ASSERT(symtab != NULL);
     ASSERT(import != NULL);
     ASSERT(!symtab->is_locked);
     ASSERT(!symtab->has_local_symbols);
+    ASSERT(!INDEX_IS_ACTIVE(symtab));
 
-    // we're adding to what already there, so we have to offset the sid's
-    base_max = symtab->symbols._count;//symtab->max_id;
-    duplicates = 0;
+    // the import says how many sids it takes up, which needn't be how many
+    // the table we found for it has, if it doesn't say we use the table's
+    if (import_max_id <= 0) import_max_id = import->max_id;
+    if (import_max_id < 0)  import_max_id = 0;
 
-    if (!ION_COLLECTION_IS_EMPTY(&import->symbols)) {
+    if (symtab->layer_count >= symtab->layer_capacity) {
+        new_capacity = symtab->layer_capacity * DEFAULT_SYMBOL_TABLE_SID_MULTIPLIER;
+        if (new_capacity < DEFAULT_SYMBOL_TABLE_LAYERS) new_capacity = DEFAULT_SYMBOL_TABLE_LAYERS;
+        IONCHECK(_ion_index_grow_array((void **)&symtab->layers, symtab->layer_capacity, new_capacity, sizeof(symtab->layers[0]), TRUE, symtab->owner));
+        symtab->layer_capacity = new_capacity;
+    }
 
-        ION_COLLECTION_OPEN(&import->symbols, cursor);
-        for (;;) {
-            ION_COLLECTION_NEXT(cursor, sym);
-            if (sym == NULL) break;
-            if (sym->sid > import->max_id) continue;
-            sid = sym->sid + base_max - duplicates;
-            
-            addErr = _ion_symbol_table_add_symbol_and_sid_helper(symtab, &sym->value, sid, sym->psymtab);
-            if (addErr == IERR_DUPLICATE_SYMBOL)
-            {
-                ++duplicates;
-            }
-            else
-            {
-                IONCHECK(addErr);
-            }
-        }
-        ION_COLLECTION_CLOSE( cursor );
+    // lookups through a layer have to leave the imported table alone, as
+    // other tables (and other threads) may be looking through it too, so
+    // if it's going to need an index it gets it now
+    if (!import->is_locked && !INDEX_IS_ACTIVE(import) && import->symbols._count > DEFAULT_INDEX_BUILD_THRESHOLD) {
+        IONCHECK(_ion_symbol_table_initialize_indices_helper(import));
     }
 
-    // the symbol tables max id should have bumped up to match this:
-//    ASSERT(symtab->max_id == base_max + import_max_id - duplicates);
+    layer = &symtab->layers[symtab->layer_count++];
+    layer->table  = import;
+    layer->base   = symtab->import_max_id;
+    layer->max_id = import_max_id;
+
+    symtab->import_max_id += import_max_id;
+    if (symtab->max_id < symtab->import_max_id) {
+        symtab->max_id = symtab->import_max_id;
+    }
 
     iRETURN;
 }
 
-iERR _ion_symbol_table_local_find_by_name(ION_SYMBOL_TABLE *symtab, ION_STRING *name, SID *p_sid, ION_SYMBOL **p_sym)
+// finds name in the layers, then among the table's own symbols, the sid
+// is the table's sid for it even when the symbol comes from a layer
+static iERR _ion_symbol_table_local_find_symbol_by_name(ION_SYMBOL_TABLE *symtab, ION_STRING *name, SID *p_sid, ION_SYMBOL **p_sym)
 {
     iENTER;
     ION_COLLECTION_CURSOR   symbol_cursor;
+    ION_SYMBOL_TABLE_LAYER *layer;
     ION_SYMBOL             *sym;
-    int                     ii, c;
     SID                     sid;
-
-    if(ION_STRING_IS_NULL(name)) {
-        FAILWITH(IERR_NULL_VALUE);
+    int32_t                 ii;
+
+    // the lowest sid wins, so the layers go first
+    for (ii = 0; ii < symtab->layer_count; ii++) {
+        layer = &symtab->layers[ii];
+        IONCHECK(_ion_symbol_table_local_find_symbol_by_name(layer->table, name, &sid, &sym));
+        if (sym && sid <= layer->max_id) {
+            *p_sid = layer->base + sid;
+            *p_sym = sym;
+            SUCCEED();
+        }
     }
-    
-    ASSERT(symtab);
-    ASSERT(p_sid != NULL);
 
-    if (!INDEX_IS_ACTIVE(symtab) && symtab->max_id > DEFAULT_INDEX_BUILD_THRESHOLD) {
+    if (!INDEX_IS_ACTIVE(symtab) && symtab->symbols._count > DEFAULT_INDEX_BUILD_THRESHOLD) {
         IONCHECK(_ion_symbol_table_initialize_indices_helper(symtab));
     }
 
@@ -1171,14 +1227,33 @@ iERR _ion_symbol_table_local_find_by_name(ION_SYMBOL_TABLE *symtab, ION_STRING *
             }
         }
         ION_COLLECTION_CLOSE(symbol_cursor);
+    }
+
+    *p_sid = sym ? sym->sid : UNKNOWN_SID;
+    *p_sym = sym;
+
+    iRETURN;
+}
+
+iERR _ion_symbol_table_local_find_by_name(ION_SYMBOL_TABLE *symtab, ION_STRING *name, SID *p_sid, ION_SYMBOL **p_sym)
+{
+    iENTER;
+    ION_SYMBOL             *sym;
+    int                     ii, c;
+    SID                     sid;
 
+    if(ION_STRING_IS_NULL(name)) {
+        FAILWITH(IERR_NULL_VALUE);
     }
+    
+    ASSERT(symtab);
+    ASSERT(p_sid != NULL);
+
+    IONCHECK(_ion_symbol_table_local_find_symbol_by_name(symtab, name, &sid, &sym));
+
     // if we didn't find it when we tried to look it up, see if it's one
     // of the "$<int> symbols
-    if (sym) {
-        sid = sym->sid;
-    }
-    else if (name->value[0] == '$' && name->length > 1) {
+    if (!sym && name->value[0] == '$' && name->length > 1) {
         sid = 0;
         for (ii=1; ii<name->length; ii++) {
             c = name->value[ii];
@@ -1191,9 +1266,6 @@ iERR _ion_symbol_table_local_find_by_name(ION_SYMBOL_TABLE *symtab, ION_STRING *
         }
         IONCHECK(_ion_symbol_table_local_find_by_sid(symtab, sid, &sym));
     }
-    else {
-        sid = UNKNOWN_SID;
-    }
     if (p_sid) *p_sid = sid;
     if (p_sym) *p_sym = sym;
 
@@ -1285,12 +1357,25 @@ iERR _ion_symbol_table_local_find_by_sid(ION_SYMBOL_TABLE *symtab, SID sid, ION_
 {
     iENTER;
     ION_SYMBOL              *sym;
+    ION_SYMBOL_TABLE_LAYER  *layer;
     ION_COLLECTION_CURSOR    symbol_cursor;
+    int32_t                  ii;
 
     ASSERT(symtab != NULL);
     ASSERT(p_sym != NULL);
 
-    if (!INDEX_IS_ACTIVE(symtab) && symtab->max_id > DEFAULT_INDEX_BUILD_THRESHOLD) {
+    // the imported sids come from the layer that covers them
+    if (sid > UNKNOWN_SID && sid <= symtab->import_max_id) {
+        for (ii = 0; ii < symtab->layer_count; ii++) {
+            layer = &symtab->layers[ii];
+            if (sid <= layer->base + layer->max_id) {
+                IONCHECK(_ion_symbol_table_local_find_by_sid(layer->table, sid - layer->base, p_sym));
+                SUCCEED();
+            }
+        }
+    }
+
+    if (!INDEX_IS_ACTIVE(symtab) && symtab->symbols._count > DEFAULT_INDEX_BUILD_THRESHOLD) {
         IONCHECK(_ion_symbol_table_initialize_indices_helper(symtab));
     }
     if (INDEX_IS_ACTIVE(symtab)) {
@@ -1401,6 +1486,7 @@ iERR _ion_symbol_table_is_symbol_known_helper(ION_SYMBOL_TABLE *symtab, SID sid,
 }
 
 // get symbols by sid, iterate from 1 to max_sid - returns all symbol
+// imported symbols belong to the imported table, and carry the sid they have there
 iERR ion_symbol_table_get_symbol(hSYMTAB hsymtab, SID sid, ION_SYMBOL **p_sym)
 {
     iENTER;
@@ -1476,7 +1562,8 @@ iERR _ion_symbol_table_add_symbol_helper(ION_SYMBOL_TABLE *symtab, ION_STRING *n
         IONCHECK(_ion_symbol_table_local_add_symbol_helper(symtab, name, sid, symtab, &sym));
     }
 
-    if (sym) sym->add_count++;
+    // the imported tables are shared, so only our own symbols are counted
+    if (sym && sid > symtab->import_max_id) sym->add_count++;
     if (p_sid) *p_sid = sid;
 
     iRETURN;
@@ -1761,26 +1848,15 @@ iERR _ion_symbol_table_initialize_indices_helper(ION_SYMBOL_TABLE *symtab)
     int32_t                initial_size;
     ION_COLLECTION_CURSOR  symbol_cursor;
     ION_SYMBOL            *sym;
-    ION_INDEX_OPTIONS      index_options = {
-        NULL,                           // void          *_memory_owner;
-        _ion_symbol_table_compare_fn,   // II_COMPARE_FN  _compare_fn;
-        _ion_symbol_table_hash_fn,      // II_HASH_FN     _hash_fn;
-        NULL,                           // void          *_fn_context;
-        0,                              // int32_t        _initial_size;  /* number of actual keys */
-        0                               // uint8_t        _density_target_percent; /* whole percent for table size increases 200% is usual (and default) */
-    };
 
     ASSERT(symtab->is_locked == FALSE);
 
     if (INDEX_IS_ACTIVE(symtab)) SUCCEED(); // it's been done before
 
-    initial_size = symtab->max_id + 1;  // size is 0, id's are 1 based
+    initial_size = symtab->max_id - symtab->import_max_id + 1;  // size is 0, id's are 1 based
     if (initial_size < DEFAULT_SYMBOL_TABLE_SIZE) initial_size = DEFAULT_SYMBOL_TABLE_SIZE;
-    
-    index_options._initial_size = initial_size;
-    index_options._memory_owner = symtab->owner;
 
-    IONCHECK(_ion_index_initialize(&symtab->by_name, &index_options));
+    IONCHECK(_ion_symbol_index_initialize(&symtab->by_name, initial_size, symtab->owner));
 
     // copy is false --- this time
     IONCHECK(_ion_index_grow_array((void **)&symtab->by_id, 0, initial_size, sizeof(symtab->by_id[0]), FALSE, symtab->owner));
@@ -1792,8 +1868,7 @@ iERR _ion_symbol_table_initialize_indices_helper(ION_SYMBOL_TABLE *symtab)
         for (;;) {
             ION_COLLECTION_NEXT(symbol_cursor, sym);
             if (!sym) break;
-            symtab->by_id[sym->sid] = sym;
-            IONCHECK(_ion_index_insert(&symtab->by_name, sym, sym));
+            IONCHECK(_ion_symbol_table_index_insert_helper(symtab, sym));
         }
         ION_COLLECTION_CLOSE(symbol_cursor);
     }
@@ -1801,69 +1876,196 @@ iERR _ion_symbol_table_initialize_indices_helper(ION_SYMBOL_TABLE *symtab)
     iRETURN;
 }
 
-int_fast8_t  _ion_symbol_table_compare_fn(void *key1, void *key2, void *context)
+// the slots in the group at group whose control byte is control, as a bit mask
+static inline uint32_t _ion_symbol_index_match(const uint8_t *group, uint8_t control)
 {
-    int_fast8_t cmp;
-    ION_SYMBOL *sym1 = (ION_SYMBOL *)key1;
-    ION_SYMBOL *sym2 = (ION_SYMBOL *)key2;
+#if defined(__SSE2__)
+    __m128i bytes = _mm_loadu_si128((const __m128i *)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)control)));
+#else
+    uint32_t mask = 0;
+    int      ii;
 
-    ASSERT(sym1);
-    ASSERT(sym2);
-#ifdef DEBUG
-    ASSERT(!ION_STRING_IS_NULL(&sym1->value));
-    ASSERT(!ION_STRING_IS_NULL(&sym2->value));
+    for (ii = 0; ii < ION_SYMBOL_INDEX_GROUP; ii++) {
+        if (group[ii] == control) mask |= (uint32_t)1 << ii;
+    }
+    return mask;
 #endif
+}
 
-    // this compare is for the purposes of the hash table only !
-    if (sym1 == sym2) {
-        cmp = 0;
+static inline int _ion_symbol_index_first(uint32_t mask)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(mask);
+#else
+    int ii = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        ii++;
     }
-    else if ((cmp = (sym1->value.length - sym2->value.length)) != 0) {
-        cmp = (cmp > 0) ? 1 : -1; // normalize the value
+    return ii;
+#endif
+}
+
+// the high bits of the hash pick the first group, the low 7 go in the
+// control byte. Groups are then probed 1, 2, 3 ... groups further on, which
+// visits every group since there are a power of 2 of them
+#define ION_SYMBOL_INDEX_CONTROL(hash)      ((uint8_t)((hash) & 0x7F))
+#define ION_SYMBOL_INDEX_FIRST_GROUP(hash)  ((int32_t)((hash) >> 7))
+
+static ION_SYMBOL **_ion_symbol_index_find_slot(ION_SYMBOL_INDEX *pindex, BYTE *name, SIZE length, uint64_t hash)
+{
+    int32_t      group_mask = pindex->capacity / ION_SYMBOL_INDEX_GROUP - 1;
+    int32_t      group = ION_SYMBOL_INDEX_FIRST_GROUP(hash) & group_mask;
+    int32_t      step = 0, slot;
+    uint8_t      control = ION_SYMBOL_INDEX_CONTROL(hash);
+    uint8_t     *pgroup;
+    uint32_t     match;
+    ION_SYMBOL  *sym;
+
+    for (;;) {
+        pgroup = pindex->control + group * ION_SYMBOL_INDEX_GROUP;
+        for (match = _ion_symbol_index_match(pgroup, control); match; match &= match - 1) {
+            slot = group * ION_SYMBOL_INDEX_GROUP + _ion_symbol_index_first(match);
+            sym = pindex->slots[slot];
+            if (sym->value.length == length && memcmp(sym->value.value, name, length) == 0) {
+                return &pindex->slots[slot];
+            }
+        }
+        // an empty slot ends the probe, the name would have gone there
+        if (_ion_symbol_index_match(pgroup, ION_SYMBOL_INDEX_EMPTY)) return NULL;
+        step++;
+        group = (group + step) & group_mask;
     }
-    else {
-        cmp = memcmp(sym1->value.value, sym2->value.value, sym1->value.length);
+}
+
+// the first empty or deleted slot on the probe for hash, there always is one
+static int32_t _ion_symbol_index_free_slot(ION_SYMBOL_INDEX *pindex, uint64_t hash)
+{
+    int32_t      group_mask = pindex->capacity / ION_SYMBOL_INDEX_GROUP - 1;
+    int32_t      group = ION_SYMBOL_INDEX_FIRST_GROUP(hash) & group_mask;
+    int32_t      step = 0;
+    uint8_t     *pgroup;
+    uint32_t     match;
+
+    for (;;) {
+        pgroup = pindex->control + group * ION_SYMBOL_INDEX_GROUP;
+        match = _ion_symbol_index_match(pgroup, ION_SYMBOL_INDEX_EMPTY)
+              | _ion_symbol_index_match(pgroup, ION_SYMBOL_INDEX_DELETED);
+        if (match) return group * ION_SYMBOL_INDEX_GROUP + _ion_symbol_index_first(match);
+        step++;
+        group = (group + step) & group_mask;
     }
-    return cmp;
 }
 
-int_fast32_t _ion_symbol_table_hash_fn(void *key, void *context)
+// allocates capacity empty slots and puts the symbols already in the index into them
+static iERR _ion_symbol_index_resize(ION_SYMBOL_INDEX *pindex, int32_t capacity, void *owner)
 {
-    ION_SYMBOL  *sym = (ION_SYMBOL *)key;
-    int_fast32_t hash;
-    int len;
-    BYTE *cb;
-    
-    ASSERT(sym);
-    
-#if 0
-    hash = hashfn_mem(sym->value.value, sym->value.length);
-    return hash;
-#else
-    hash = 0;
-    len = sym->value.length;
-    cb = sym->value.value;
-    
-    while (len)
-    {
-        hash = *cb + (hash << 6) + (hash << 16) - hash;
-        ++cb;
-        --len;
+    iENTER;
+    uint8_t     *old_control = pindex->control;
+    ION_SYMBOL **old_slots = pindex->slots;
+    int32_t      old_capacity = pindex->capacity;
+    int32_t      ii, slot;
+    ION_SYMBOL  *sym;
+    uint64_t     hash;
+
+    pindex->control = (uint8_t *)ion_alloc_with_owner(owner, capacity);
+    pindex->slots = (ION_SYMBOL **)ion_alloc_with_owner(owner, capacity * sizeof(ION_SYMBOL *));
+    if (!pindex->control || !pindex->slots) FAILWITH(IERR_NO_MEMORY);
+    memset(pindex->control, ION_SYMBOL_INDEX_EMPTY, capacity);
+    pindex->capacity = capacity;
+    pindex->growth_left = capacity - capacity / 8 - pindex->count;
+
+    // the old arrays stay with the owner until it's freed, as by_id's do
+    for (ii = 0; ii < old_capacity; ii++) {
+        if (old_control[ii] & ION_SYMBOL_INDEX_EMPTY) continue; // empty or deleted
+        sym = old_slots[ii];
+        hash = _ion_index_hash_bytes(sym->value.value, sym->value.length);
+        slot = _ion_symbol_index_free_slot(pindex, hash);
+        pindex->control[slot] = ION_SYMBOL_INDEX_CONTROL(hash);
+        pindex->slots[slot] = sym;
     }
-    // the previous hash function was only returning 24 bits.
-    return hash & 0x00FFFFFF;
-#endif
+
+    iRETURN;
+}
+
+iERR _ion_symbol_index_initialize(ION_SYMBOL_INDEX *pindex, int32_t expected_count, void *owner)
+{
+    iENTER;
+    int32_t capacity = ION_SYMBOL_INDEX_GROUP;
+
+    while (capacity - capacity / 8 < expected_count) capacity *= 2;
+
+    memset(pindex, 0, sizeof(ION_SYMBOL_INDEX));
+    IONCHECK(_ion_symbol_index_resize(pindex, capacity, owner));
+
+    iRETURN;
+}
+
+iERR _ion_symbol_index_insert(ION_SYMBOL_INDEX *pindex, ION_SYMBOL *sym, void *owner)
+{
+    iENTER;
+    uint64_t hash = _ion_index_hash_bytes(sym->value.value, sym->value.length);
+    int32_t  slot, capacity;
+
+    if (_ion_symbol_index_find_slot(pindex, sym->value.value, sym->value.length, hash)) {
+        DONTFAILWITH(IERR_KEY_ALREADY_EXISTS);
+    }
+
+    slot = _ion_symbol_index_free_slot(pindex, hash);
+    if (pindex->control[slot] == ION_SYMBOL_INDEX_EMPTY && pindex->growth_left == 0) {
+        // out of empty slots, double it unless it's mostly tombstones
+        capacity = pindex->capacity;
+        if (pindex->count >= (capacity - capacity / 8) / 2) capacity *= 2;
+        IONCHECK(_ion_symbol_index_resize(pindex, capacity, owner));
+        slot = _ion_symbol_index_free_slot(pindex, hash);
+    }
+
+    if (pindex->control[slot] == ION_SYMBOL_INDEX_EMPTY) pindex->growth_left--;
+    pindex->control[slot] = ION_SYMBOL_INDEX_CONTROL(hash);
+    pindex->slots[slot] = sym;
+    pindex->count++;
+
+    iRETURN;
+}
+
+ION_SYMBOL *_ion_symbol_index_find(ION_SYMBOL_INDEX *pindex, ION_STRING *name)
+{
+    ION_SYMBOL **pslot;
+
+    pslot = _ion_symbol_index_find_slot(pindex, name->value, name->length, _ion_index_hash_bytes(name->value, name->length));
+
+    return pslot ? *pslot : NULL;
+}
+
+void _ion_symbol_index_remove(ION_SYMBOL_INDEX *pindex, ION_SYMBOL *sym)
+{
+    ION_SYMBOL **pslot;
+
+    pslot = _ion_symbol_index_find_slot(pindex, sym->value.value, sym->value.length, _ion_index_hash_bytes(sym->value.value, sym->value.length));
+    ASSERT(pslot && *pslot == sym);
+    if (!pslot || *pslot != sym) return;
+
+    pindex->control[pslot - pindex->slots] = ION_SYMBOL_INDEX_DELETED;
+    pindex->count--;
 }
 
 iERR _ion_symbol_table_index_insert_helper(ION_SYMBOL_TABLE *symtab, ION_SYMBOL *sym) 
 {
     iENTER;
     int32_t new_count, old_count;
+    SID     slot;
 
     ASSERT(symtab->is_locked == FALSE);
     ASSERT(INDEX_IS_ACTIVE(symtab));
 
-    if (sym->sid >= symtab->by_id_max) {
+    IONCHECK(_ion_symbol_index_insert(&symtab->by_name, sym, symtab->owner));
+
+    // a sid the imports already cover is always looked up in them
+    slot = sym->sid - symtab->import_max_id;
+    if (slot < 1) SUCCEED();
+
+    if (slot >= symtab->by_id_max) {
         // the +1 is because sid's are 1 based (so we're losing the 0th slot, and need 1 extra entry)
         old_count = (symtab->by_id_max + 1);
         new_count =  old_count * DEFAULT_SYMBOL_TABLE_SID_MULTIPLIER;
@@ -1871,9 +2073,7 @@ iERR _ion_symbol_table_index_insert_helper(ION_SYMBOL_TABLE *symtab, ION_SYMBOL
         IONCHECK(_ion_index_grow_array((void **)&symtab->by_id, old_count, new_count, sizeof(symtab->by_id[0]), TRUE, symtab->owner));
         symtab->by_id_max = new_count - 1; // adjust for 1 vs 0 based value (count is 0 based, id is 1 based)
     }
-    symtab->by_id[sym->sid] = sym;
-
-    IONCHECK(_ion_index_insert(&symtab->by_name, sym, sym));
+    symtab->by_id[slot] = sym;
 
     iRETURN;
 }
@@ -1881,16 +2081,17 @@ iERR _ion_symbol_table_index_insert_helper(ION_SYMBOL_TABLE *symtab, ION_SYMBOL
 iERR _ion_symbol_table_index_remove_helper(ION_SYMBOL_TABLE *symtab, ION_SYMBOL *sym) 
 {
     iENTER;
-    ION_SYMBOL *old_sym;
+    SID         slot;
 
     ASSERT(symtab->is_locked == FALSE);
     ASSERT(INDEX_IS_ACTIVE(symtab));
 
-    _ion_index_delete(&symtab->by_name, &sym->value, (void**)&old_sym);
-    ASSERT( old_sym == sym );
+    _ion_symbol_index_remove(&symtab->by_name, sym);
 
-    if (sym->sid > symtab->by_id_max) FAILWITH(IERR_INVALID_STATE);
-    symtab->by_id[sym->sid] = NULL;
+    slot = sym->sid - symtab->import_max_id;
+    if (slot < 1) SUCCEED();
+    if (slot > symtab->by_id_max) FAILWITH(IERR_INVALID_STATE);
+    symtab->by_id[slot] = NULL;
     SUCCEED();
 
     iRETURN;
@@ -1898,35 +2099,27 @@ iERR _ion_symbol_table_index_remove_helper(ION_SYMBOL_TABLE *symtab, ION_SYMBOL
 
 ION_SYMBOL *_ion_symbol_table_index_find_by_name_helper(ION_SYMBOL_TABLE *symtab, ION_STRING *str)
 {
-//  iENTER;
-    ION_SYMBOL *found_sym;
-    ION_SYMBOL  key_sym;
-
     ASSERT(symtab);
     ASSERT(!ION_STRING_IS_NULL(str));
     ASSERT(INDEX_IS_ACTIVE(symtab));
 
-    // dummy up a symbol with the right key
-    key_sym.value.length = str->length;
-    key_sym.value.value = str->value;
-
-    found_sym = _ion_index_find(&symtab->by_name, &key_sym);
-
-    return found_sym;
+    return _ion_symbol_index_find(&symtab->by_name, str);
 }
 
 ION_SYMBOL *_ion_symbol_table_index_find_by_sid_helper(ION_SYMBOL_TABLE *symtab, SID sid)
 {
     ION_SYMBOL *found_sym;
+    SID         slot;
 
     ASSERT(symtab);
     ASSERT(INDEX_IS_ACTIVE(symtab));
 
-    if (sid < 1 || sid > symtab->by_id_max) {
+    slot = sid - symtab->import_max_id;
+    if (slot < 1 || slot > symtab->by_id_max) {
         found_sym = NULL;
     }
     else {        
-        found_sym = symtab->by_id[sid];
+        found_sym = symtab->by_id[slot];
     }
 
     return found_sym;
@@ -1948,7 +2141,8 @@ iERR _ion_symbol_table_create_substitute(ION_SYMBOL_TABLE_IMPORT* import, ION_CA
 {
     iENTER;
     ION_SYMBOL_TABLE* symbol_table;
-    _ion_symbol_table_open_helper(&symbol_table, NULL, catalog->system_symbol_table);
+    // a substitute has no symbols at all, not even the system symbols
+    IONCHECK(_ion_symbol_table_open_helper(&symbol_table, NULL, NULL));
 
     symbol_table->version = import->version;
     ION_STRING_ASSIGN(&symbol_table->name, &import->name);
@@ -25,6 +25,35 @@ extern "C" {
 // the character encoding is utf-8 and both comparisons
 // and collation is only done as memcmp
 
+// an imported table, seen through the table that imports it: sid n of
+// the imported table is sid base + n of the importer, for n up to max_id
+typedef struct _ion_symbol_table_layer
+{
+    ION_SYMBOL_TABLE   *table;
+    SID                 base;
+    SID                 max_id;
+
+} ION_SYMBOL_TABLE_LAYER;
+
+// the name index is an open addressed table in the style of the swiss
+// tables: slots come in groups of 16, and each slot has a control byte
+// holding 7 bits of its symbol's name hash, so a probe tests a whole group
+// with one SSE2 compare and only looks at the names whose bits match.
+// Removed symbols leave a tombstone so the probes past them still work.
+#define ION_SYMBOL_INDEX_GROUP      16
+#define ION_SYMBOL_INDEX_EMPTY      ((uint8_t)0x80)
+#define ION_SYMBOL_INDEX_DELETED    ((uint8_t)0xFE)
+
+typedef struct _ion_symbol_index
+{
+    uint8_t            *control;        // per slot the low 7 bits of the hash, or EMPTY or DELETED
+    ION_SYMBOL        **slots;
+    int32_t             capacity;       // number of slots, a power of 2 and at least 1 group
+    int32_t             count;
+    int32_t             growth_left;    // EMPTY slots that can still be used before it has to grow
+
+} ION_SYMBOL_INDEX;
+
 struct _ion_symbol_table
 {
     void               *owner;          // this may be a reader, writer, catalog or itself
@@ -35,12 +64,19 @@ struct _ion_symbol_table
     int32_t             version;
     int32_t             max_id;
     ION_COLLECTION      import_list;    // collection of ION_SYMBOL_TABLE_IMPORT
-    ION_COLLECTION      symbols;        // collection of ION_SYMBOL
+    ION_COLLECTION      symbols;        // collection of ION_SYMBOL, only the ones defined by this table
     ION_SYMBOL_TABLE   *system_symbol_table;
 
-    int32_t             by_id_max;      // largest sid that can be stored, this is 1 less than the number of entries allocated since sids are 1 based and we don't use the 0-th array element
-    ION_SYMBOL        **by_id;
-    ION_INDEX           by_name;
+    // the system table and the imports, in sid order. Their symbols aren't
+    // copied in, sids up to import_max_id are looked up in them instead
+    ION_SYMBOL_TABLE_LAYER *layers;
+    int32_t             layer_count;
+    int32_t             layer_capacity;
+    SID                 import_max_id;
+
+    int32_t             by_id_max;      // largest sid (less import_max_id) that can be stored, this is 1 less than the number of entries allocated since sids are 1 based and we don't use the 0-th array element
+    ION_SYMBOL        **by_id;          // by sid less import_max_id, so imported sids take no room
+    ION_SYMBOL_INDEX    by_name;
 
 };
 
@@ -88,6 +124,7 @@ iERR _ion_symbol_table_close_helper(ION_SYMBOL_TABLE *symtab);
 #define DEFAULT_SYMBOL_TABLE_SID_MULTIPLIER  2
 #define DEFAULT_INDEX_BUILD_THRESHOLD       15
 #define DEFAULT_SYMBOL_TABLE_SIZE           15
+#define DEFAULT_SYMBOL_TABLE_LAYERS          4
 
 // local function forward reference declarations
 iERR _ion_symbol_table_local_make_system_symbol_table_helper(int32_t version);
@@ -98,7 +135,7 @@ iERR _ion_symbol_table_local_load_symbol_list   (ION_READER *preader, hOWNER own
 
 iERR _ion_symbol_table_import_symbol_table_helper(ION_SYMBOL_TABLE *symtab, ION_SYMBOL_TABLE *import_symtab);
 // iERR _ion_symbol_table_local_incorporate_import (ION_SYMBOL_TABLE *symtab, ION_SYMBOL_TABLE_IMPORT *import, ION_CATALOG *pcatalog);
-iERR _ion_symbol_table_local_incorporate_symbols(ION_SYMBOL_TABLE *symtab, ION_SYMBOL_TABLE *import, int32_t import_max_id);
+iERR _ion_symbol_table_local_add_layer(ION_SYMBOL_TABLE *symtab, ION_SYMBOL_TABLE *import, int32_t import_max_id);
 iERR _ion_symbol_table_local_add_symbol_helper(ION_SYMBOL_TABLE *symtab, ION_STRING *name, SID sid, ION_SYMBOL_TABLE *symbol_owning_table, ION_SYMBOL **p_psym);
 
 iERR _ion_symbol_local_copy_same_owner(void *context, void *dst, void *src, int32_t data_size);
@@ -109,8 +146,10 @@ iERR _ion_symbol_table_create_substitute(ION_SYMBOL_TABLE_IMPORT* import, ION_CA
 
 #define INDEX_IS_ACTIVE(symtab) ((symtab)->by_id_max > 0)
 iERR         _ion_symbol_table_initialize_indices_helper(ION_SYMBOL_TABLE *symtab);
-int_fast8_t  _ion_symbol_table_compare_fn               (void *key1, void *key2, void *context);
-int_fast32_t _ion_symbol_table_hash_fn                  (void *key, void *context);
+iERR         _ion_symbol_index_initialize               (ION_SYMBOL_INDEX *pindex, int32_t expected_count, void *owner);
+iERR         _ion_symbol_index_insert                   (ION_SYMBOL_INDEX *pindex, ION_SYMBOL *sym, void *owner);
+ION_SYMBOL  *_ion_symbol_index_find                     (ION_SYMBOL_INDEX *pindex, ION_STRING *name);
+void         _ion_symbol_index_remove                   (ION_SYMBOL_INDEX *pindex, ION_SYMBOL *sym);
 iERR         _ion_symbol_table_index_insert_helper      (ION_SYMBOL_TABLE *symtab, ION_SYMBOL *sym);
 iERR         _ion_symbol_table_index_remove_helper      (ION_SYMBOL_TABLE *symtab, ION_SYMBOL *sym);
 ION_SYMBOL  *_ion_symbol_table_index_find_by_name_helper(ION_SYMBOL_TABLE *symtab, ION_STRING *str);
@@ -78,12 +78,55 @@ iERR ion_writer_open_stream(hWRITER *p_hwriter
     iENTER;
     ION_WRITER *pwriter = NULL;
     ION_STREAM *pstream = NULL;
+    ION_STREAM_OPTIONS stream_options;
     if (!p_hwriter) FAILWITH(IERR_INVALID_ARG);
-    IONCHECK(ion_stream_open_handler_out( fn_output_handler, handler_state, &pstream ));
+    _ion_writer_stream_options(p_options, &stream_options);
+    IONCHECK(ion_stream_open_handler_out_with_options( fn_output_handler, handler_state, &stream_options, &pstream ));
     IONCHECK(_ion_writer_open_helper(&pwriter, pstream, p_options));
     *p_hwriter = PTR_TO_HANDLE(pwriter);
     iRETURN;
 }
+iERR ion_writer_open_segments(hWRITER *p_hwriter
+                                ,ION_STREAM_SEGMENT *segments
+                                ,int32_t count
+                                ,ION_STREAM_SEGMENT_HANDLER fn_segment_handler
+                                ,void *handler_state
+                                ,ION_WRITER_OPTIONS *p_options
+) {
+    iENTER;
+    ION_WRITER *pwriter = NULL;
+    ION_STREAM *pstream = NULL;
+    ION_STREAM_OPTIONS stream_options;
+
+    if (!p_hwriter) FAILWITH(IERR_INVALID_ARG);
+
+    _ion_writer_stream_options(p_options, &stream_options);
+    IONCHECK(ion_stream_open_segments_out(segments, count, fn_segment_handler, handler_state, &stream_options, &pstream));
+    err = _ion_writer_open_helper(&pwriter, pstream, p_options);
+    if (err) {
+        ion_stream_close(pstream);
+        FAILWITH(err);
+    }
+    pwriter->writer_owns_stream = TRUE;
+
+    *p_hwriter = PTR_TO_HANDLE(pwriter);
+
+    iRETURN;
+}
+
+iERR ion_writer_get_segments(hWRITER hwriter, ION_STREAM_SEGMENT **p_segments, int32_t *p_count)
+{
+    iENTER;
+    ION_WRITER *pwriter;
+
+    if (!hwriter) FAILWITH(IERR_BAD_HANDLE);
+    pwriter = HANDLE_TO_PTR(hwriter, ION_WRITER);
+
+    IONCHECK(ion_stream_get_segments(pwriter->output, p_segments, p_count));
+
+    iRETURN;
+}
+
 iERR ion_writer_open(
         hWRITER *p_hwriter
         ,ION_STREAM *stream
@@ -107,7 +150,7 @@ iERR _ion_writer_open_helper(ION_WRITER **p_pwriter, ION_STREAM *stream, ION_WRI
     ION_OBJ_TYPE        writer_type = ion_type_unknown_writer;
     ION_SYMBOL_TABLE   *psymtab, *system;
 
-    pwriter = ion_alloc_owner(sizeof(ION_WRITER));
+    pwriter = ion_alloc_owner_with_allocator(sizeof(ION_WRITER), p_options ? p_options->allocator : NULL);
     if (!pwriter) FAILWITH(IERR_NO_MEMORY);
     *p_pwriter = pwriter;
 
@@ -181,6 +224,20 @@ fail:
     return err;
 }
 
+// the options for a stream the writer opens for itself, a 0 page
+// size (or no writer options at all) leaves the stream's defaults
+void _ion_writer_stream_options(ION_WRITER_OPTIONS *p_options, ION_STREAM_OPTIONS *p_stream_options)
+{
+    ASSERT(p_stream_options);
+
+    memset(p_stream_options, 0, sizeof(*p_stream_options));
+    if (p_options) {
+        p_stream_options->page_size     = p_options->stream_page_size;
+        p_stream_options->max_page_size = p_options->stream_max_page_size;
+        p_stream_options->allocator     = p_options->allocator;
+    }
+}
+
 void _ion_writer_initialize_option_defaults(ION_WRITER_OPTIONS *p_options)
 {
     ASSERT(p_options);
@@ -455,6 +512,28 @@ iERR ion_writer_get_symbol_table(hWRITER hwriter, hSYMTAB *p_hsymtab)
     iRETURN;
 }
 
+iERR ion_writer_get_alloc_stats(hWRITER hwriter, ION_ALLOC_STATS *p_stats)
+{
+    iENTER;
+    ION_WRITER *pwriter;
+
+    if (!hwriter) FAILWITH(IERR_BAD_HANDLE);
+    pwriter = HANDLE_TO_PTR(hwriter, ION_WRITER);
+    if (!p_stats) FAILWITH(IERR_INVALID_ARG);
+
+    // the temp pool is counted with the writer
+    memset(p_stats, 0, sizeof(*p_stats));
+    _ion_alloc_owner_add_stats(pwriter, p_stats);
+    if (pwriter->type == ion_type_binary_writer) {
+        _ion_alloc_owner_add_stats(pwriter->_typed_writer.binary._value_stream, p_stats);
+    }
+    if (pwriter->writer_owns_stream) {
+        _ion_alloc_owner_add_stats(pwriter->output, p_stats);
+    }
+
+    iRETURN;
+}
+
 iERR _ion_writer_get_symbol_table_helper(ION_WRITER *pwriter, ION_SYMBOL_TABLE **p_psymtab)
 {
     iENTER;
@@ -2120,7 +2199,7 @@ iERR _ion_writer_allocate_temp_pool( ION_WRITER *pwriter )
     iENTER;
     void *temp_owner;
 
-    temp_owner = ion_alloc_owner(sizeof(ION_WRITER *));
+    temp_owner = ion_alloc_dependent_owner(pwriter, sizeof(ION_WRITER *));
     if (temp_owner == NULL) {
         FAILWITH(IERR_NO_MEMORY);
     }
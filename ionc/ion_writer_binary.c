@@ -74,6 +74,7 @@ iERR _ion_writer_binary_initialize(ION_WRITER *pwriter)
     iENTER;
 
     ION_BINARY_WRITER *bwriter = &pwriter->_typed_writer.binary;
+    ION_STREAM_OPTIONS stream_options;
 
     pwriter->_in_struct              = FALSE;
     pwriter->_has_local_symbols      = FALSE;
@@ -90,7 +91,15 @@ iERR _ion_writer_binary_initialize(ION_WRITER *pwriter)
     //IONCHECK( ion_output_stream_initialize_with_handler( bwriter->_value_stream, 
     //    _ion_writer_binary_output_stream_handler, pwriter ));
 
-    IONCHECK(ion_stream_open_memory_only( &bwriter->_value_stream ));
+    _ion_writer_stream_options(&pwriter->options, &stream_options);
+    if (pwriter->options.binary_single_pass) {
+        // in a single pass the headers are filled in where they belong, so
+        // the values have to be in one piece we can move bytes around in
+        IONCHECK(_ion_stream_open_growable( stream_options.page_size, stream_options.allocator, &bwriter->_value_stream ));
+    }
+    else {
+        IONCHECK(ion_stream_open_memory_only_with_options( &stream_options, &bwriter->_value_stream ));
+    }
 
     iRETURN;
 }
@@ -101,16 +110,25 @@ iERR _ion_writer_binary_push_position(ION_WRITER *pwriter, int type_id)
     iENTER;
     ION_BINARY_WRITER *bwriter = &pwriter->_typed_writer.binary;
     ION_BINARY_PATCH  *patch, **ppatch;
+    BYTE               reserved[ION_BINARY_SINGLE_PASS_HEADER_LENGTH];
+    SIZE               written;
 
     // first we create a new patch at the end of the patch list
     patch = (ION_BINARY_PATCH *)_ion_collection_append(&bwriter->_patch_list);
     patch->_length = 0;
-    patch->_offset = (int)ion_stream_get_position(bwriter->_value_stream);   // TODO - this needs 64bit care
+    patch->_offset = ion_stream_get_position(bwriter->_value_stream);
     patch->_type   = type_id;
     
     // then we push a pointer to the patch onto our active stack
     ppatch = (ION_BINARY_PATCH **)_ion_collection_push(&bwriter->_patch_stack);
     *ppatch = patch;
+
+    if (pwriter->options.binary_single_pass) {
+        // hold the header's place, we'll know what goes here when it's popped
+        memset(reserved, 0, sizeof(reserved));
+        IONCHECK( ion_stream_write( bwriter->_value_stream, reserved, ION_BINARY_SINGLE_PASS_HEADER_LENGTH, &written ));
+        if (written != ION_BINARY_SINGLE_PASS_HEADER_LENGTH) FAILWITH(IERR_WRITE_ERROR);
+    }
     SUCCEED();
 
     iRETURN;
@@ -123,6 +141,11 @@ iERR _ion_writer_binary_pop(ION_WRITER *pwriter)
     ION_BINARY_PATCH **ppatch;
     int patch_down;
 
+    if (pwriter->options.binary_single_pass) {
+        IONCHECK( _ion_writer_binary_single_pass_pop( pwriter ));
+        SUCCEED();
+    }
+
     // pop the top of the patch stack.  We need to patch the length
     // of the length onto the remainer of the stack.  So we do that
     // after we pop it off the stack, if there's anything to patch.
@@ -149,6 +172,37 @@ iERR _ion_writer_binary_pop(ION_WRITER *pwriter)
     iRETURN;
 }
 
+// pops a container (or annotation wrapper, or lob) written in a single pass
+// by writing its header over the place push_position held for it. Its length
+// is simply everything written since
+iERR _ion_writer_binary_single_pass_pop(ION_WRITER *pwriter)
+{
+    iENTER;
+    ION_BINARY_WRITER *bwriter = &pwriter->_typed_writer.binary;
+    ION_BINARY_PATCH  *patch;
+    BYTE               header[TYPE_DESC_WITH_LENGTH_IMAGE_LENGTH];
+    POSITION           content_start, length;
+    int                header_len;
+
+    patch = *(ION_BINARY_PATCH **)_ion_collection_head( &bwriter->_patch_stack );
+
+    // patches go on the end of the list as they're pushed and come off it
+    // again here, so the top of the stack is always the last one on the list
+    ASSERT(patch == _ion_collection_tail( &bwriter->_patch_list ));
+
+    content_start = patch->_offset + ION_BINARY_SINGLE_PASS_HEADER_LENGTH;
+    length = ion_stream_get_position( bwriter->_value_stream ) - content_start;
+    // the value stream can't grow past IH_MAX_PAGE_SIZE, so this always fits
+    ASSERT(length <= IH_MAX_PAGE_SIZE);
+    header_len = ion_binary_encode_type_desc_with_length( header, patch->_type, (int32_t)length );
+    IONCHECK( _ion_stream_splice( bwriter->_value_stream, patch->_offset, ION_BINARY_SINGLE_PASS_HEADER_LENGTH, header, header_len ));
+
+    _ion_collection_pop_head( &bwriter->_patch_stack );
+    _ion_collection_pop_tail( &bwriter->_patch_list );
+
+    iRETURN;
+}
+
 iERR _ion_writer_binary_patch_lengths(ION_WRITER *pwriter, int added_length)
 {
     iENTER;
@@ -156,6 +210,9 @@ iERR _ion_writer_binary_patch_lengths(ION_WRITER *pwriter, int added_length)
     ION_BINARY_PATCH **ppatch;
 //    ION_COLLECTION_CURSOR patch_cursor;
 
+    // in a single pass the lengths come from where the values end up
+    if (pwriter->options.binary_single_pass) SUCCEED();
+
     ppatch = _ion_collection_head(&bwriter->_patch_stack);
     if (ppatch) {
         // we only patch the top of the stack right now
@@ -193,7 +250,7 @@ iERR _ion_writer_binary_top_length(ION_WRITER *pwriter, int *plength)
     iRETURN;
 }
 
-iERR _ion_writer_binary_top_position(ION_WRITER *pwriter, int *poffset) 
+iERR _ion_writer_binary_top_position(ION_WRITER *pwriter, POSITION *poffset) 
 {
     iENTER;
     ION_BINARY_WRITER *bwriter = &pwriter->_typed_writer.binary;
@@ -265,14 +322,7 @@ iERR _ion_writer_binary_start_value(ION_WRITER *pwriter, int value_length)
 
             annotation_len_o_len = ion_binary_len_var_uint_64(annotations_len); // len(<annlen>)
             total_ann_value_len = annotation_len_o_len + annotations_len + value_length;
-            if (total_ann_value_len < ION_lnIsVarLen) {
-                ION_PUT(ostream, makeTypeDescriptor(TID_UTA, total_ann_value_len));
-            }
-            else {
-                ION_PUT(ostream, makeTypeDescriptor(TID_UTA, ION_lnIsVarLen));
-                // add the len of len to the patch total (since we just learned about it)
-                IONCHECK( ion_binary_write_var_uint_64(ostream, total_ann_value_len));
-            }
+            IONCHECK( ion_binary_write_type_desc_with_length(ostream, TID_UTA, total_ann_value_len));
         }
             
         IONCHECK( ion_binary_write_var_uint_64(ostream, annotations_len));
@@ -499,7 +549,7 @@ iERR _ion_writer_binary_write_int64(ION_WRITER *pwriter, int64_t value)
 iERR _ion_writer_binary_write_ion_int(ION_WRITER *pwriter, ION_INT *iint)
 {
     iENTER;
-    int  offset, ln, patch_len, len = 0, td = 0;
+    int  offset, patch_len, len = 0, td = 0;
     SIZE bytes_written, written;
     BYTE buffer[LOCAL_STACK_BUFFER_SIZE];
 
@@ -513,24 +563,16 @@ iERR _ion_writer_binary_write_ion_int(ION_WRITER *pwriter, ION_INT *iint)
     patch_len = ION_BINARY_TYPE_DESC_LENGTH;
     if (_ion_int_is_zero(iint)) {
         len = 0;
-        ln = 0;
     }
     else {
         len = _ion_int_abs_bytes_length_helper(iint);
-        if (len < ION_lnIsVarLen) {
-            ln = len;
-        }
-        else {
-            ln = ION_lnIsVarLen;
+        if (len >= ION_lnIsVarLen) {
             patch_len += ion_binary_len_var_uint_64(len);
         }
     }
 
     IONCHECK( _ion_writer_binary_start_value( pwriter, patch_len + len ));
-    ION_PUT( pwriter->_typed_writer.binary._value_stream, makeTypeDescriptor(td, ln) );
-    if (ln == ION_lnIsVarLen) {
-        IONCHECK( ion_binary_write_var_uint_64( pwriter->_typed_writer.binary._value_stream, len ));
-    }
+    IONCHECK( ion_binary_write_type_desc_with_length( pwriter->_typed_writer.binary._value_stream, td, len ));
 
     if (len > 0) {
         // here we write any values (other than 0)
@@ -569,7 +611,7 @@ iERR _ion_writer_binary_write_double(ION_WRITER *pwriter, double value)
 iERR _ion_writer_binary_write_decimal(ION_WRITER *pwriter, decQuad *value)
 {
     iENTER;
-    int len, ln;
+    int len;
     int patch_len;
 
     if (value == NULL) {
@@ -586,19 +628,12 @@ iERR _ion_writer_binary_write_decimal(ION_WRITER *pwriter, decQuad *value)
     patch_len = ION_BINARY_TYPE_DESC_LENGTH;
     len = ion_binary_len_ion_decimal(value, &pwriter->deccontext);
 
-    if (len < ION_lnIsVarLen) {
-        ln = len;
-    }
-    else {
-        ln = ION_lnIsVarLen;
+    if (len >= ION_lnIsVarLen) {
         patch_len += ion_binary_len_var_uint_64(len);
     }
 
     IONCHECK( _ion_writer_binary_start_value( pwriter, patch_len + len ));
-    ION_PUT( pwriter->_typed_writer.binary._value_stream, makeTypeDescriptor(TID_DECIMAL, ln) );
-    if (ln == ION_lnIsVarLen) {
-        IONCHECK( ion_binary_write_var_uint_64( pwriter->_typed_writer.binary._value_stream, len ));
-    }
+    IONCHECK( ion_binary_write_type_desc_with_length( pwriter->_typed_writer.binary._value_stream, TID_DECIMAL, len ));
     IONCHECK( ion_binary_write_decimal_value( pwriter->_typed_writer.binary._value_stream, value, &pwriter->deccontext ));
     IONCHECK( _ion_writer_binary_patch_lengths( pwriter, patch_len + len ));
 
@@ -608,7 +643,7 @@ iERR _ion_writer_binary_write_decimal(ION_WRITER *pwriter, decQuad *value)
 iERR _ion_writer_binary_write_timestamp(ION_WRITER *pwriter, iTIMESTAMP value)
 {
     iENTER;
-    int len, ln;
+    int len;
     int patch_len;
 
     if (value == NULL) {
@@ -619,19 +654,12 @@ iERR _ion_writer_binary_write_timestamp(ION_WRITER *pwriter, iTIMESTAMP value)
     patch_len = ION_BINARY_TYPE_DESC_LENGTH;
     len = ion_binary_len_ion_timestamp(value, &pwriter->deccontext);
 
-    if (len < ION_lnIsVarLen) {
-        ln = len;
-    }
-    else {
-        ln = ION_lnIsVarLen;
+    if (len >= ION_lnIsVarLen) {
         patch_len += ion_binary_len_var_uint_64(len);
     }
 
     IONCHECK( _ion_writer_binary_start_value( pwriter, patch_len + len ));
-    ION_PUT( pwriter->_typed_writer.binary._value_stream, makeTypeDescriptor(TID_TIMESTAMP, ln));
-    if (ln == ION_lnIsVarLen) {
-        IONCHECK( ion_binary_write_var_uint_64( pwriter->_typed_writer.binary._value_stream, len ));
-    }
+    IONCHECK( ion_binary_write_type_desc_with_length( pwriter->_typed_writer.binary._value_stream, TID_TIMESTAMP, len ));
     IONCHECK( ion_binary_write_timestamp_value( pwriter->_typed_writer.binary._value_stream, value, &pwriter->deccontext ));
     IONCHECK( _ion_writer_binary_patch_lengths( pwriter, patch_len + len ));
 
@@ -641,7 +669,7 @@ iERR _ion_writer_binary_write_timestamp(ION_WRITER *pwriter, iTIMESTAMP value)
 iERR _ion_writer_binary_write_string(ION_WRITER *pwriter, ION_STRING *pstr )
 {
     iENTER;
-    int  len, ln;
+    int  len;
     int  patch_len;
     SIZE written;
 
@@ -653,19 +681,12 @@ iERR _ion_writer_binary_write_string(ION_WRITER *pwriter, ION_STRING *pstr )
     patch_len = ION_BINARY_TYPE_DESC_LENGTH;
     len = pstr->length;
 
-    if (len < ION_lnIsVarLen) {
-        ln = len;
-    }
-    else {
-        ln = ION_lnIsVarLen;
+    if (len >= ION_lnIsVarLen) {
         patch_len += ion_binary_len_var_uint_64(len);
     }
 
     IONCHECK( _ion_writer_binary_start_value( pwriter, patch_len + len ));
-    ION_PUT( pwriter->_typed_writer.binary._value_stream, makeTypeDescriptor(TID_STRING, ln) );
-    if (ln == ION_lnIsVarLen) {
-        IONCHECK( ion_binary_write_var_uint_64( pwriter->_typed_writer.binary._value_stream, len ));
-    }
+    IONCHECK( ion_binary_write_type_desc_with_length( pwriter->_typed_writer.binary._value_stream, TID_STRING, len ));
     IONCHECK( ion_stream_write( pwriter->_typed_writer.binary._value_stream, pstr->value, len, &written ));
     if (written != len) FAILWITH(IERR_WRITE_ERROR);
     IONCHECK( _ion_writer_binary_patch_lengths( pwriter, patch_len + len ));
@@ -731,7 +752,6 @@ iERR _ion_writer_binary_write_clob(ION_WRITER *pwriter, BYTE *pbuf, SIZE len)
 {
     iENTER;
     int  patch_len = ION_BINARY_TYPE_DESC_LENGTH;
-    int  ln = len;
     SIZE written;
 
     if (pbuf == NULL) {
@@ -740,16 +760,11 @@ iERR _ion_writer_binary_write_clob(ION_WRITER *pwriter, BYTE *pbuf, SIZE len)
     }
  
     if (len >= ION_lnIsVarLen) {
-        ln = ION_lnIsVarLen;
         patch_len += ion_binary_len_var_uint_64(len);
     }
 
     IONCHECK( _ion_writer_binary_start_value( pwriter, patch_len + len ));
-    ION_PUT( pwriter->_typed_writer.binary._value_stream, makeTypeDescriptor(TID_CLOB, ln) );
-        
-    if (len >= ION_lnIsVarLen) {
-        IONCHECK( ion_binary_write_var_uint_64( pwriter->_typed_writer.binary._value_stream, len ));
-    }
+    IONCHECK( ion_binary_write_type_desc_with_length( pwriter->_typed_writer.binary._value_stream, TID_CLOB, len ));
     IONCHECK( ion_stream_write( pwriter->_typed_writer.binary._value_stream, pbuf, len, &written ));
     if (written != len) FAILWITH(IERR_WRITE_ERROR);
     IONCHECK( _ion_writer_binary_patch_lengths( pwriter, patch_len + len ));
@@ -761,7 +776,6 @@ iERR _ion_writer_binary_write_blob(ION_WRITER *pwriter, BYTE *pbuf, SIZE len)
 {
     iENTER;
     int  patch_len = ION_BINARY_TYPE_DESC_LENGTH;
-    int  ln = len;
     SIZE written;
 
     if (pbuf == NULL) {
@@ -770,16 +784,11 @@ iERR _ion_writer_binary_write_blob(ION_WRITER *pwriter, BYTE *pbuf, SIZE len)
     }
 
     if (len >= ION_lnIsVarLen) {
-        ln = ION_lnIsVarLen;
         patch_len += ion_binary_len_var_uint_64(len);
     }
 
     IONCHECK( _ion_writer_binary_start_value( pwriter, patch_len + len ));
-    ION_PUT( pwriter->_typed_writer.binary._value_stream, makeTypeDescriptor(TID_BLOB, ln) );
-        
-    if (len >= ION_lnIsVarLen) {
-        IONCHECK( ion_binary_write_var_uint_64( pwriter->_typed_writer.binary._value_stream, len ));
-    }
+    IONCHECK( ion_binary_write_type_desc_with_length( pwriter->_typed_writer.binary._value_stream, TID_BLOB, len ));
     IONCHECK( ion_stream_write( pwriter->_typed_writer.binary._value_stream, pbuf, len, &written ));
     if (written != len) FAILWITH(IERR_WRITE_ERROR);
     IONCHECK( _ion_writer_binary_patch_lengths( pwriter, patch_len + len ));
@@ -836,11 +845,14 @@ iERR _ion_writer_binary_flush_to_output(ION_WRITER *pwriter)
 {
     iENTER;
  
-    int                pos, buffer_length;
-    int                patch_pos;
+    POSITION           pos, buffer_length;
+    POSITION           patch_pos;
     int                len;
-    SIZE               written;
+    SIZE               written, available;
     BOOL               has_imports, needs_local_symbol_table;
+    BYTE              *span;
+    BYTE               header[TYPE_DESC_WITH_LENGTH_IMAGE_LENGTH];
+    ION_BINARY_GATHER  gather;
 
     ION_BINARY_PATCH  *ppatch;
     ION_STREAM        *out = pwriter->output;
@@ -882,7 +894,7 @@ iERR _ion_writer_binary_flush_to_output(ION_WRITER *pwriter)
 
     // 
     values_in = bwriter->_value_stream;
-    buffer_length = (int)ion_stream_get_position( values_in );  // TODO - this needs 64bit care
+    buffer_length = ion_stream_get_position( values_in );
 
     // rewind the value stream we have been writing into
     IONCHECK(ion_stream_seek(values_in, 0));
@@ -891,33 +903,40 @@ iERR _ion_writer_binary_flush_to_output(ION_WRITER *pwriter)
     ppatch = (ION_BINARY_PATCH *)_ion_collection_head( &bwriter->_patch_list );
     patch_pos = (ppatch != NULL) ? ppatch->_offset : buffer_length;
 
-    while (pos < buffer_length) {
-        // we write pending patches until the pending patch is further downstream
-        while (patch_pos <= pos) {
-            IONCHECK( ion_binary_write_type_desc_with_length( out, ppatch->_type, ppatch->_length ));
+    // rather than copying the patches and values into the output one at a
+    // time we gather them up and hand them to the output stream in batches,
+    // an fd output writes each batch with a single writev. The value stream
+    // keeps all its pages until it's truncated below, so the slices of it we
+    // gather stay valid. A single pass writer has no patches left by now and
+    // its values are one span, so this goes out as one piece
+    gather.out = out;
+    gather.count = 0;
+    gather.length = 0;
+    gather.staging = FALSE;
+    gather.staged = 0;
+    while (pos < buffer_length || ppatch) {
+        // we write pending patches until the pending patch is further
+        // downstream, and any patches left over once the values run out
+        if (ppatch && (patch_pos <= pos || pos >= buffer_length)) {
+            len = ion_binary_encode_type_desc_with_length( header, ppatch->_type, ppatch->_length );
+            IONCHECK( _ion_writer_binary_gather_add( &gather, header, len ));
 
             _ion_collection_pop_head( &bwriter->_patch_list );
             ppatch = (ION_BINARY_PATCH *)_ion_collection_head( &bwriter->_patch_list );
             patch_pos = (ppatch != NULL) ? ppatch->_offset : buffer_length;
+            continue;
         }
 
-        // the patch is in front of us so we write the value stream until we're
-        // at the next patch (or we finally run out of input values to write
-        // patches are always embedded in the stream, so we always finish with
-        // data values (not a patch). write_stream won't write more than the
-        // input stream holds so when patch_pos is past the end it simply writes
-        // everything that's left
-        len = patch_pos - pos;
-        IONCHECK( ion_stream_write_stream( out, values_in, len, &written ) );
-        if (written != len) FAILWITH(IERR_WRITE_ERROR);
-        pos += len;
-    }
-
-    while (ppatch) {
-        IONCHECK( ion_binary_write_type_desc_with_length( out, ppatch->_type, ppatch->_length ));
-        _ion_collection_pop_head( &bwriter->_patch_list );
-        ppatch = (ION_BINARY_PATCH *)_ion_collection_head( &bwriter->_patch_list );
+        // the patch is in front of us so we take the value stream up to the
+        // next patch, a page at a time
+        IONCHECK( ion_stream_peek_span( values_in, &span, &available ));
+        if (available < 1) FAILWITH(IERR_UNEXPECTED_EOF);
+        if (available > patch_pos - pos) available = (SIZE)(patch_pos - pos);
+        IONCHECK( _ion_writer_binary_gather_add( &gather, span, available ));
+        IONCHECK( ion_stream_consume( values_in, available ));
+        pos += available;
     }
+    IONCHECK( _ion_writer_binary_gather_write( &gather ));
 
     // reset the patches list and the value streams buffers (recycling them)
     _ion_collection_reset( &bwriter->_patch_list );
@@ -936,6 +955,69 @@ iERR _ion_writer_binary_flush_to_output(ION_WRITER *pwriter)
     iRETURN;
 }
 
+iERR _ion_writer_binary_gather_add(ION_BINARY_GATHER *gather, BYTE *data, SIZE length)
+{
+    iENTER;
+    ION_STREAM_SEGMENT *piece;
+
+    ASSERT(gather);
+    ASSERT(length >= 0);
+
+    if (length < 1) SUCCEED();
+
+    if (length < ION_BINARY_GATHER_COPY_LIMIT) {
+        if (gather->staged + length > ION_BINARY_GATHER_STAGE_SIZE) {
+            IONCHECK(_ion_writer_binary_gather_write(gather));
+        }
+        if (!gather->staging) {
+            if (gather->count >= ION_BINARY_GATHER_COUNT) {
+                IONCHECK(_ion_writer_binary_gather_write(gather));
+            }
+            piece = &gather->pieces[gather->count++];
+            piece->data = &gather->stage[gather->staged];
+            piece->length = 0;
+            gather->staging = TRUE;
+        }
+        piece = &gather->pieces[gather->count - 1];
+        memcpy(&gather->stage[gather->staged], data, length);
+        piece->length += length;
+        gather->staged += length;
+    }
+    else {
+        if (gather->count >= ION_BINARY_GATHER_COUNT) {
+            IONCHECK(_ion_writer_binary_gather_write(gather));
+        }
+        piece = &gather->pieces[gather->count++];
+        piece->data = data;
+        piece->length = length;
+        gather->staging = FALSE;
+    }
+    gather->length += length;
+    SUCCEED();
+
+    iRETURN;
+}
+
+iERR _ion_writer_binary_gather_write(ION_BINARY_GATHER *gather)
+{
+    iENTER;
+    SIZE written;
+
+    ASSERT(gather);
+
+    if (gather->count > 0) {
+        IONCHECK(ion_stream_write_segments(gather->out, gather->pieces, gather->count, &written));
+        if (written != gather->length) FAILWITH(IERR_WRITE_ERROR);
+    }
+    gather->count = 0;
+    gather->length = 0;
+    gather->staging = FALSE;
+    gather->staged = 0;
+    SUCCEED();
+
+    iRETURN;
+}
+
 //
 // these routines serialize a local symbol table out to an output stream
 // these are NOT the same as the routine in symbol table that does this
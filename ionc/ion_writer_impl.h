@@ -81,12 +81,37 @@ typedef struct _ion_text_writer
 } ION_TEXT_WRITER;
 
 typedef struct _ion_binary_patch {
-    int     _offset;
-    int     _type;
-    int     _length;
-    BOOL    _in_struct;
+    POSITION _offset;
+    int      _type;
+    int      _length;
+    BOOL     _in_struct;
 } ION_BINARY_PATCH;
 
+// with the binary_single_pass option a container (or annotation wrapper, or
+// lob) starts with room for its type descriptor and a 2 byte length, enough
+// for up to 16K of content. When it closes the real header is written there
+// and, if it's shorter or longer, the content is moved down or up to meet it
+#define ION_BINARY_SINGLE_PASS_HEADER_LENGTH 3
+
+// flush hands the output stream its pieces (patch headers and slices of the
+// value stream) in batches. Short pieces are copied together into the stage,
+// since an extra write vector entry costs more than copying a few bytes, the
+// rest are passed as they are
+#define ION_BINARY_GATHER_COUNT      128
+#define ION_BINARY_GATHER_STAGE_SIZE 8192
+#define ION_BINARY_GATHER_COPY_LIMIT 512
+
+typedef struct _ion_binary_gather
+{
+    ION_STREAM         *out;
+    ION_STREAM_SEGMENT  pieces[ION_BINARY_GATHER_COUNT];
+    int32_t             count;
+    SIZE                length;     // total bytes in pieces
+    BOOL                staging;    // the last piece is the run of bytes being copied into stage
+    SIZE                staged;
+    BYTE                stage[ION_BINARY_GATHER_STAGE_SIZE];
+} ION_BINARY_GATHER;
+
 typedef struct _ion_binary_writer
 {
     BOOL                _version_marker_written;
@@ -176,6 +201,7 @@ typedef struct _ion_obj_writer {
 iERR _ion_writer_open_buffer_helper(ION_WRITER **p_pwriter, BYTE *buffer, SIZE buf_length, ION_WRITER_OPTIONS *p_options);
 iERR _ion_writer_open_stream_helper(ION_WRITER **p_pwriter, ION_STREAM p_stream, void *handler_state, ION_WRITER_OPTIONS *p_options);
 iERR _ion_writer_open_helper(ION_WRITER **p_pwriter, ION_STREAM *stream, ION_WRITER_OPTIONS *p_options);
+void _ion_writer_stream_options(ION_WRITER_OPTIONS *p_options, ION_STREAM_OPTIONS *p_stream_options);
 void _ion_writer_initialize_option_defaults(ION_WRITER_OPTIONS *p_options);
 iERR _ion_writer_initialize(ION_WRITER *pwriter, ION_OBJ_TYPE writer_type);
 
@@ -307,13 +333,16 @@ iERR _ion_writer_binary_push_position(ION_WRITER *bwriter, int type_id);
 iERR _ion_writer_binary_pop(ION_WRITER *bwriter);
 iERR _ion_writer_binary_patch_lengths(ION_WRITER *bwriter, int added_length);
 iERR _ion_writer_binary_top_length(ION_WRITER *bwriter, int *plength);
-iERR _ion_writer_binary_top_position(ION_WRITER *bwriter, int *poffset);
+iERR _ion_writer_binary_top_position(ION_WRITER *bwriter, POSITION *poffset);
 #ifdef NOT_NEEDED
 iERR _ion_writer_binary_top_type(ION_WRITER *bwriter, ION_TYPE *ptype);
 #endif
 iERR _ion_writer_binary_top_in_struct(ION_WRITER *bwriter, BOOL *p_is_in_struct);
 
 iERR _ion_writer_binary_flush_to_output(ION_WRITER *pwriter);
+iERR _ion_writer_binary_gather_add(ION_BINARY_GATHER *gather, BYTE *data, SIZE length);
+iERR _ion_writer_binary_gather_write(ION_BINARY_GATHER *gather);
+iERR _ion_writer_binary_single_pass_pop(ION_WRITER *pwriter);
 iERR _ion_writer_binary_calc_serialized_symbol_table_length(ION_WRITER *pwriter, int *p_length);
 iERR _ion_writer_binary_serialize_symbol_table(ION_SYMBOL_TABLE *psymtab, ION_STREAM *out, int *p_length);
 int   ion_writer_binary_serialize_import_struct_length(ION_SYMBOL_TABLE_IMPORT *import);
@@ -323,8 +323,9 @@ iERR _ion_writer_text_write_bool(ION_WRITER *pwriter, BOOL value)
 iERR _ion_writer_text_write_int64(ION_WRITER *pwriter, int64_t value)
 {
     iENTER;
-    char int_image[MAX_INT64_LENGTH + 1], *cp;  // +1 for null terminator
-    int  is_negative = FALSE, digit;
+    BYTE   *image, *cp;
+    int     is_negative = FALSE, digit;
+    SIZE    len;
     int64_t next;
 
     IONCHECK(_ion_writer_text_start_value(pwriter));
@@ -335,40 +336,36 @@ iERR _ion_writer_text_write_int64(ION_WRITER *pwriter, int64_t value)
         is_negative = TRUE;
     }
 
-    // we'll be writing the digits backwards, so we first null
-    // terminate our output buffer
-    cp = int_image + MAX_INT64_LENGTH;
-    *cp = 0;
-    cp--;
-
-    if (!value) {
-        // just dodge the edge case with leading zeros
-        *cp = '0';
-        cp--;
+    // count the digits so we can format the value directly
+    // into the output, the sign takes up one more
+    for (len = 1, next = value / 10; next; next /= 10) {
+        len++;
     }
-    else {
-        // this isn't the most efficient but is should be right
-        while (value) {
-            next = value / 10;
-            digit = value % 10;
-            if (is_negative) {
-                digit = -digit;
-            }
-            *cp = (char)digit + '0';
-            cp--;
-            value = next;
-        }
+    if (is_negative) {
+        len++;
+    }
+    ASSERT(len <= MAX_INT64_LENGTH);
 
-        // only non-zero values can be negative
+    IONCHECK(ion_stream_reserve(pwriter->output, len, &image));
+
+    // we'll be writing the digits backwards, from the end of the image
+    cp = image + len - 1;
+    do {
+        next = value / 10;
+        digit = (int)(value % 10);
         if (is_negative) {
-            ION_TEXT_WRITER_APPEND_CHAR('-');
+            digit = -digit;
         }
-    }
+        *cp-- = (BYTE)(digit + '0');
+        value = next;
+    } while (value);
 
-    cp++;  // we always back up one too far
+    // only non-zero values can be negative
+    if (is_negative) {
+        *cp = '-';
+    }
 
-    // now write the chars out in the right order
-    IONCHECK(_ion_writer_text_append_ascii_cstr(pwriter->output, cp));
+    IONCHECK(ion_stream_commit(pwriter->output, len));
 
     IONCHECK(_ion_writer_text_close_value(pwriter));
 
@@ -731,24 +728,34 @@ iERR _ion_writer_text_write_clob(ION_WRITER *pwriter, BYTE *p_buf, SIZE length)
 iERR _ion_writer_text_append_clob_contents(ION_WRITER *pwriter, BYTE *p_buf, SIZE length)
 {
     iENTER;
-    int ii;
+    int  ii, run;
     char c, *image;
+    SIZE written;
 
     if (!pwriter) FAILWITH(IERR_BAD_HANDLE);
     if (!p_buf) FAILWITH(IERR_INVALID_ARG);     // this is append - don't call it will a null buffer
     if (length < 0) FAILWITH(IERR_INVALID_ARG);
 
      for (ii=0; ii<length; ii++) {
+        // copy the run of characters that don't need escaping in one write
+        for (run = ii; ii < length; ii++) {
+            c = p_buf[ii];
+            if (ION_WRITER_NEEDS_ESCAPE_ASCII(c) || c == '"') break;
+        }
+        if (ii > run) {
+            IONCHECK(ion_stream_write(pwriter->output, p_buf + run, ii - run, &written));
+            if (written != ii - run) FAILWITH(IERR_WRITE_ERROR);
+        }
+        if (ii >= length) break;
+
         c = p_buf[ii];
         if (ION_WRITER_NEEDS_ESCAPE_ASCII(c)) {
             image = _ion_writer_get_control_escape_string(c);
             IONCHECK(_ion_writer_text_append_ascii_cstr(pwriter->output, image));
         }
-        else if (c == '"') {
-            ION_PUT(pwriter->output, '\\');
-            ION_PUT(pwriter->output, c);
-        }
         else {
+            ASSERT(c == '"');
+            ION_PUT(pwriter->output, '\\');
             ION_PUT(pwriter->output, c);
         }
     }
@@ -783,8 +790,9 @@ iERR _ion_writer_text_write_blob(ION_WRITER *pwriter, BYTE *p_buf, SIZE length)
 iERR _ion_writer_text_append_blob_contents(ION_WRITER *pwriter, BYTE *p_buf, SIZE length)
 {
     iENTER;
-    char image[5];
-    int  triple;
+    char  image[5];
+    int   triple, ii, triples;
+    BYTE *dst;
 
     ASSERT(pwriter);
     ASSERT(p_buf);
@@ -830,16 +838,25 @@ iERR _ion_writer_text_append_blob_contents(ION_WRITER *pwriter, BYTE *p_buf, SIZ
         TEXTWRITER(pwriter)->_pending_blob_bytes = 0; // and, for the moment, nothings pending
     }
 
-    // output any whole triplets we can
+    // output any whole triplets we can, encoding them directly into the
+    // output as many as fit in one reservation at a time (the image helper
+    // null terminates, so each reservation has room for one extra byte)
     while (length > 2) {
-        triple = *p_buf++;
-        triple <<= 8;
-        triple |= *p_buf++;
-        triple <<= 8;
-        triple |= *p_buf++;
-        _ion_writer_text_write_blob_make_base64_image(triple, image);
-        IONCHECK(_ion_writer_text_append_ascii_cstr(pwriter->output, image));
-        length -= 3;
+        triples = length / 3;
+        if (triples > (ION_STREAM_MAX_RESERVE - 1) / 4) {
+            triples = (ION_STREAM_MAX_RESERVE - 1) / 4;
+        }
+        IONCHECK(ion_stream_reserve(pwriter->output, triples * 4 + 1, &dst));
+        for (ii = 0; ii < triples; ii++) {
+            triple = *p_buf++;
+            triple <<= 8;
+            triple |= *p_buf++;
+            triple <<= 8;
+            triple |= *p_buf++;
+            _ion_writer_text_write_blob_make_base64_image(triple, (char *)(dst + ii * 4));
+        }
+        IONCHECK(ion_stream_commit(pwriter->output, triples * 4));
+        length -= triples * 3;
     }
 
     // remember the tail, whatever that turns out to be - someone
@@ -1079,14 +1096,17 @@ iERR _ion_writer_text_append_symbol_string(ION_STREAM *poutput, ION_STRING *p_st
 iERR _ion_writer_text_append_ascii_cstr(ION_STREAM *poutput, char *cp)
 {
     iENTER;
+    SIZE len, written;
 
     if (!poutput) FAILWITH(IERR_BAD_HANDLE);
     if (!cp) SUCCEED();
 
-    while (*cp) {
-        if (*cp > 127) FAILWITH(IERR_INVALID_ARG);
-        ION_PUT(poutput, *cp);
-        cp++;
+    for (len = 0; cp[len]; len++) {
+        if (cp[len] > 127) FAILWITH(IERR_INVALID_ARG);
+    }
+    if (len > 0) {
+        IONCHECK(ion_stream_write(poutput, (BYTE *)cp, len, &written));
+        if (written != len) FAILWITH(IERR_WRITE_ERROR);
     }
 
     iRETURN;
@@ -1176,7 +1196,8 @@ iERR _ion_writer_text_append_escape_sequence_cstr(ION_STREAM *poutput, char *cp,
 iERR _ion_writer_text_append_escaped_string_utf8(ION_STREAM *poutput, ION_STRING *p_str, char quote_char)
 {
     iENTER;
-    BYTE *cp, *limit;
+    BYTE *cp, *limit, *run;
+    SIZE  written;
 
     if (!poutput) FAILWITH(IERR_BAD_HANDLE);
     if (!p_str) FAILWITH(IERR_INVALID_ARG);
@@ -1191,12 +1212,16 @@ iERR _ion_writer_text_append_escaped_string_utf8(ION_STREAM *poutput, ION_STRING
         // utf8 sequences have the high bit set and will simply be treated
         // as normal characters and pass through - at this point we don't
         // validate that the sequences are valid
-        if (ION_WRITER_NEEDS_ESCAPE_UTF8(*cp) || (*cp == quote_char)) {
-            IONCHECK(_ion_writer_text_append_escape_sequence_string(poutput, cp, limit, &cp));
+        // copy the run of characters that don't need escaping in one write
+        for (run = cp; cp < limit; cp++) {
+            if (ION_WRITER_NEEDS_ESCAPE_UTF8(*cp) || (*cp == quote_char)) break;
         }
-        else {
-            ION_PUT(poutput, *cp);
-            cp++;
+        if (cp > run) {
+            IONCHECK(ion_stream_write(poutput, run, (SIZE)(cp - run), &written));
+            if (written != (SIZE)(cp - run)) FAILWITH(IERR_WRITE_ERROR);
+        }
+        if (cp < limit) {
+            IONCHECK(_ion_writer_text_append_escape_sequence_string(poutput, cp, limit, &cp));
         }
     }
 
@@ -1206,7 +1231,8 @@ iERR _ion_writer_text_append_escaped_string_utf8(ION_STREAM *poutput, ION_STRING
 iERR _ion_writer_text_append_escaped_string(ION_STREAM *poutput, ION_STRING *p_str, char quote_char)
 {
     iENTER;
-    BYTE *cp, *limit;
+    BYTE *cp, *limit, *run;
+    SIZE  written;
 
     if (!poutput) FAILWITH(IERR_BAD_HANDLE);
     if (!p_str) FAILWITH(IERR_INVALID_ARG);
@@ -1218,12 +1244,16 @@ iERR _ion_writer_text_append_escaped_string(ION_STREAM *poutput, ION_STRING *p_s
 
     while (cp < limit) {
         // this escapes <32, slash, double quotes AND utf8 sequences
-        if (ION_WRITER_NEEDS_ESCAPE_ASCII(*cp) || *cp == quote_char) {
-            IONCHECK(_ion_writer_text_append_escape_sequence_string(poutput, cp, limit, &cp));
+        // copy the run of characters that don't need escaping in one write
+        for (run = cp; cp < limit; cp++) {
+            if (ION_WRITER_NEEDS_ESCAPE_ASCII(*cp) || *cp == quote_char) break;
         }
-        else {
-            ION_PUT(poutput, *cp);
-            cp++;
+        if (cp > run) {
+            IONCHECK(ion_stream_write(poutput, run, (SIZE)(cp - run), &written));
+            if (written != (SIZE)(cp - run)) FAILWITH(IERR_WRITE_ERROR);
+        }
+        if (cp < limit) {
+            IONCHECK(_ion_writer_text_append_escape_sequence_string(poutput, cp, limit, &cp));
         }
     }
 
@@ -1233,45 +1263,44 @@ iERR _ion_writer_text_append_escaped_string(ION_STREAM *poutput, ION_STRING *p_s
 iERR _ion_writer_text_append_unicode_scalar(ION_STREAM *poutput, int unicode_scalar)
 {
     iENTER;
+    BYTE *image, *dst;
+    int   shift;
 
-    if (unicode_scalar < 0) {
+    if (unicode_scalar < 0 || unicode_scalar > 0x10FFFF) {
         FAILWITH(IERR_INVALID_UNICODE_SEQUENCE);
     }
-    else if (unicode_scalar < 128) {
-        ION_PUT(poutput, (BYTE)unicode_scalar);
-    }
-    else if (unicode_scalar < 0x256) {\
-        // handle with \xXX
-        ION_PUT(poutput, '\\');
-        ION_PUT(poutput, 'x');
-        ION_PUT(poutput, _ion_hex_chars[((unicode_scalar >>  4) & 0xF)]);
-        ION_PUT(poutput, _ion_hex_chars[( unicode_scalar        & 0xF)]);
-    }
-    else if (unicode_scalar < 0x10000) {
-        // handle with \uXXXX
-        ION_PUT(poutput, '\\');
-        ION_PUT(poutput, 'u');
-        ION_PUT(poutput, _ion_hex_chars[((unicode_scalar >> 12) & 0xF)]);
-        ION_PUT(poutput, _ion_hex_chars[((unicode_scalar >>  8) & 0xF)]);
-        ION_PUT(poutput, _ion_hex_chars[((unicode_scalar >>  4) & 0xF)]);
-        ION_PUT(poutput, _ion_hex_chars[( unicode_scalar        & 0xF)]);
-    }
-    else if (unicode_scalar <= 0x10FFFF) {
-        ION_PUT(poutput, '\\');
-        ION_PUT(poutput, 'U');
-        ION_PUT(poutput, _ion_hex_chars[((unicode_scalar >> 28) & 0xF)]);  // should be 0
-        ION_PUT(poutput, _ion_hex_chars[((unicode_scalar >> 24) & 0xF)]);  // also should be 0
-        ION_PUT(poutput, _ion_hex_chars[((unicode_scalar >> 20) & 0xF)]);  // either 0 or 1
-        ION_PUT(poutput, _ion_hex_chars[((unicode_scalar >> 16) & 0xF)]);
-        ION_PUT(poutput, _ion_hex_chars[((unicode_scalar >> 12) & 0xF)]);
-        ION_PUT(poutput, _ion_hex_chars[((unicode_scalar >>  8) & 0xF)]);
-        ION_PUT(poutput, _ion_hex_chars[((unicode_scalar >>  4) & 0xF)]);
-        ION_PUT(poutput, _ion_hex_chars[( unicode_scalar        & 0xF)]);
+
+    // the longest image is \UXXXXXXXX
+    IONCHECK(ion_stream_reserve(poutput, 10, &image));
+    dst = image;
+
+    if (unicode_scalar < 128) {
+        *dst++ = (BYTE)unicode_scalar;
     }
     else {
-        FAILWITH(IERR_INVALID_UNICODE_SEQUENCE);
+        *dst++ = '\\';
+        if (unicode_scalar < 0x100) {
+            // handle with \xXX
+            *dst++ = 'x';
+            shift = 4;
+        }
+        else if (unicode_scalar < 0x10000) {
+            // handle with \uXXXX
+            *dst++ = 'u';
+            shift = 12;
+        }
+        else {
+            // handle with \UXXXXXXXX, the first 3 digits are 0 or 1
+            *dst++ = 'U';
+            shift = 28;
+        }
+        for (; shift >= 0; shift -= 4) {
+            *dst++ = _ion_hex_chars[((unicode_scalar >> shift) & 0xF)];
+        }
     }
 
+    IONCHECK(ion_stream_commit(poutput, (SIZE)(dst - image)));
+
     iRETURN;
 }
 
@@ -1,6 +1,7 @@
 #include "ion_binary_test.h"
 
 #include <ion_binary.h>
+#include <ion_internal.h>
 #include "ion_assert.h"
 #include "ion_unit_test.h"
 #include "tester.h"
@@ -10,6 +11,16 @@ iERR ion_binary_test() {
 
     run_unit_test(test_ion_binary_len_uint_64);
     run_unit_test(test_ion_binary_len_int_64);
+    run_unit_test(test_ion_binary_writer_single_pass);
+    run_unit_test(test_ion_binary_allocator);
+    run_unit_test(test_ion_binary_allocator_realloc);
+    run_unit_test(test_ion_binary_alloc_stats);
+    run_unit_test(test_ion_binary_reader_strings_in_place);
+    run_unit_test(test_ion_binary_validate_utf8);
+    run_unit_test(test_ion_binary_reader_in_memory);
+    run_unit_test(test_ion_binary_var_uint_kernels);
+    run_unit_test(test_ion_binary_write_over_existing_bytes);
+    run_unit_test(test_ion_binary_reader_projection);
 
     iRETURN;
 }
@@ -38,3 +49,885 @@ iERR test_ion_binary_len_int_64() {
 
     iRETURN;
 }
+
+iERR test_write_single_pass_values(hWRITER writer, int count) {
+    iENTER;
+    ION_STRING name, note, sym;
+    BYTE       lob[300];
+    int        ii;
+
+    ion_string_assign_cstr(&name, "name", 4);
+    ion_string_assign_cstr(&note, "note", 4);
+    ion_string_assign_cstr(&sym, "a_local_symbol", 14);
+    memset(lob, 'x', sizeof(lob));
+
+    // an annotated struct holding containers of every size class: empty,
+    // too short for a length, one byte of length, two, and (with a count
+    // in the thousands) three, which is more than the writer holds room for
+    IONCHECK(ion_writer_add_annotation(writer, &note));
+    IONCHECK(ion_writer_start_container(writer, tid_STRUCT));
+    IONCHECK(ion_writer_write_field_name(writer, &name));
+    IONCHECK(ion_writer_start_container(writer, tid_LIST));
+    IONCHECK(ion_writer_finish_container(writer));
+    IONCHECK(ion_writer_write_field_name(writer, &name));
+    IONCHECK(ion_writer_add_annotation(writer, &note));
+    IONCHECK(ion_writer_start_container(writer, tid_SEXP));
+    IONCHECK(ion_writer_write_int(writer, 7));
+    IONCHECK(ion_writer_write_symbol(writer, &sym));
+    IONCHECK(ion_writer_finish_container(writer));
+    IONCHECK(ion_writer_write_field_name(writer, &note));
+    IONCHECK(ion_writer_start_container(writer, tid_LIST));
+    for (ii = 0; ii < count; ii++) {
+        IONCHECK(ion_writer_start_container(writer, tid_LIST));
+        IONCHECK(ion_writer_write_int(writer, ii));
+        IONCHECK(ion_writer_write_string(writer, &note));
+        IONCHECK(ion_writer_finish_container(writer));
+    }
+    IONCHECK(ion_writer_finish_container(writer));
+    IONCHECK(ion_writer_write_field_name(writer, &name));
+    IONCHECK(ion_writer_add_annotation(writer, &name));
+    IONCHECK(ion_writer_start_lob(writer, tid_BLOB));
+    IONCHECK(ion_writer_append_lob(writer, lob, 10));
+    IONCHECK(ion_writer_append_lob(writer, lob, sizeof(lob)));
+    IONCHECK(ion_writer_finish_lob(writer));
+    IONCHECK(ion_writer_finish_container(writer));
+
+    IONCHECK(ion_writer_write_int(writer, count));
+    iRETURN;
+}
+
+iERR test_ion_binary_writer_single_pass() {
+    iENTER;
+    static BYTE        expected[200000], actual[200000];
+    SIZE               expected_length, actual_length;
+    ION_WRITER_OPTIONS options;
+    hWRITER            writer = NULL;
+    int                counts[] = { 0, 1, 3, 20, 3000 };
+    int                ii;
+
+    for (ii = 0; ii < (int)(sizeof(counts) / sizeof(counts[0])); ii++) {
+        memset(&options, 0, sizeof(options));
+        options.output_as_binary = TRUE;
+        IONCHECK(ion_writer_open_buffer(&writer, expected, sizeof(expected), &options));
+        IONCHECK(test_write_single_pass_values(writer, counts[ii]));
+        IONCHECK(ion_writer_flush(writer, &expected_length));
+        IONCHECK(ion_writer_close(writer));
+        writer = NULL;
+
+        // the single pass writer starts with a small buffer so it has to grow it too
+        options.binary_single_pass = TRUE;
+        options.stream_page_size = 64;
+        IONCHECK(ion_writer_open_buffer(&writer, actual, sizeof(actual), &options));
+        IONCHECK(test_write_single_pass_values(writer, counts[ii]));
+        IONCHECK(ion_writer_flush(writer, &actual_length));
+        IONCHECK(ion_writer_close(writer));
+        writer = NULL;
+
+        ASSERT_EQUALS_INT(expected_length, actual_length, "Wrong length written in a single pass");
+        ASSERT_EQUALS_INT(0, memcmp(expected, actual, expected_length), "Wrong bytes written in a single pass");
+    }
+
+fail:
+    if (writer) ion_writer_close(writer);
+    return err;
+}
+
+// an allocator that counts what it hands out, on top of malloc
+typedef struct _test_counting_allocator
+{
+    int allocs;
+    int frees;
+    int blocks;
+    int block_frees;
+    int owned_blocks;   // blocks allocated for an existing owner
+    int reallocs;
+} TEST_COUNTING_ALLOCATOR;
+
+void *test_counting_alloc(void *context, size_t size) {
+    ((TEST_COUNTING_ALLOCATOR *)context)->allocs++;
+    return malloc(size);
+}
+
+void test_counting_free(void *context, void *ptr) {
+    ((TEST_COUNTING_ALLOCATOR *)context)->frees++;
+    free(ptr);
+}
+
+void *test_counting_realloc(void *context, void *ptr, size_t old_size, size_t new_size) {
+    ((TEST_COUNTING_ALLOCATOR *)context)->reallocs++;
+    return realloc(ptr, new_size);
+}
+
+void *test_counting_alloc_block(void *context, void *owner, size_t size) {
+    TEST_COUNTING_ALLOCATOR *counts = (TEST_COUNTING_ALLOCATOR *)context;
+    counts->blocks++;
+    if (owner) counts->owned_blocks++;
+    return malloc(size);
+}
+
+void test_counting_free_block(void *context, void *owner, void *block) {
+    ((TEST_COUNTING_ALLOCATOR *)context)->block_frees++;
+    free(block);
+}
+
+iERR test_ion_binary_allocator() {
+    iENTER;
+    static BYTE             expected[100000], actual[100000];
+    SIZE                    expected_length, actual_length;
+    TEST_COUNTING_ALLOCATOR counts;
+    ION_ALLOCATOR           allocator;
+    ION_WRITER_OPTIONS      writer_options;
+    ION_READER_OPTIONS      reader_options;
+    hWRITER                 writer = NULL;
+    hREADER                 reader = NULL;
+    ION_STRING              sym;
+    char                    text[20];
+    int                     ii;
+
+    memset(&counts, 0, sizeof(counts));
+    memset(&allocator, 0, sizeof(allocator));
+    allocator.alloc   = test_counting_alloc;
+    allocator.free    = test_counting_free;
+    allocator.context = &counts;
+
+    // a writer, and the streams it opens, allocate from the given allocator
+    memset(&writer_options, 0, sizeof(writer_options));
+    writer_options.output_as_binary = TRUE;
+    writer_options.allocator = &allocator;
+    IONCHECK(ion_writer_open_buffer(&writer, expected, sizeof(expected), &writer_options));
+    IONCHECK(test_write_single_pass_values(writer, 300));
+    // and enough symbols that the reader's symbol table needs more than one block
+    for (ii = 0; ii < 2000; ii++) {
+        snprintf(text, sizeof(text), "symbol_%d", ii);
+        IONCHECK(ion_writer_write_symbol(writer, ion_string_assign_cstr(&sym, text, (SIZE)strlen(text))));
+    }
+    IONCHECK(ion_writer_flush(writer, &expected_length));
+    IONCHECK(ion_writer_close(writer));
+    writer = NULL;
+
+    ASSERT_EQUALS_INT(TRUE, counts.allocs > 0, "The writer didn't use its allocator");
+    ASSERT_EQUALS_INT(counts.allocs, counts.frees, "The writer didn't free everything it allocated");
+
+    // the reader gives its owners' blocks to alloc_block
+    allocator.alloc_block = test_counting_alloc_block;
+    allocator.free_block  = test_counting_free_block;
+    memset(&reader_options, 0, sizeof(reader_options));
+    reader_options.allocator = &allocator;
+    IONCHECK(ion_reader_open_buffer(&reader, expected, expected_length, &reader_options));
+
+    memset(&writer_options, 0, sizeof(writer_options));
+    writer_options.output_as_binary = TRUE;
+    IONCHECK(ion_writer_open_buffer(&writer, actual, sizeof(actual), &writer_options));
+    IONCHECK(ion_writer_write_all_values(writer, reader));
+    IONCHECK(ion_writer_flush(writer, &actual_length));
+    IONCHECK(ion_writer_close(writer));
+    writer = NULL;
+    IONCHECK(ion_reader_close(reader));
+    reader = NULL;
+
+    ASSERT_EQUALS_INT(TRUE, counts.blocks > 0, "The reader didn't use its allocator's blocks");
+    ASSERT_EQUALS_INT(TRUE, counts.owned_blocks > 0, "The reader's blocks weren't given their owner");
+    ASSERT_EQUALS_INT(counts.blocks, counts.block_frees, "The reader didn't free every block it allocated");
+    ASSERT_EQUALS_INT(counts.allocs, counts.frees, "The reader didn't free everything it allocated");
+
+    ASSERT_EQUALS_INT(expected_length, actual_length, "Wrong length copied through the reader");
+    ASSERT_EQUALS_INT(0, memcmp(expected, actual, expected_length), "Wrong bytes copied through the reader");
+
+fail:
+    if (writer) ion_writer_close(writer);
+    if (reader) ion_reader_close(reader);
+    return err;
+}
+
+iERR test_ion_binary_allocator_realloc() {
+    iENTER;
+    static BYTE             expected[100000], actual[100000];
+    SIZE                    expected_length, actual_length;
+    TEST_COUNTING_ALLOCATOR counts;
+    ION_ALLOCATOR           allocator;
+    ION_WRITER_OPTIONS      options;
+    hWRITER                 writer = NULL;
+
+    memset(&options, 0, sizeof(options));
+    options.output_as_binary = TRUE;
+    IONCHECK(ion_writer_open_buffer(&writer, expected, sizeof(expected), &options));
+    IONCHECK(test_write_single_pass_values(writer, 300));
+    IONCHECK(ion_writer_flush(writer, &expected_length));
+    IONCHECK(ion_writer_close(writer));
+    writer = NULL;
+
+    memset(&counts, 0, sizeof(counts));
+    memset(&allocator, 0, sizeof(allocator));
+    allocator.alloc   = test_counting_alloc;
+    allocator.free    = test_counting_free;
+    allocator.realloc = test_counting_realloc;
+    allocator.context = &counts;
+
+    // the single pass writer grows its small buffer through realloc
+    options.binary_single_pass = TRUE;
+    options.stream_page_size = 64;
+    options.allocator = &allocator;
+    IONCHECK(ion_writer_open_buffer(&writer, actual, sizeof(actual), &options));
+    IONCHECK(test_write_single_pass_values(writer, 300));
+    IONCHECK(ion_writer_flush(writer, &actual_length));
+    IONCHECK(ion_writer_close(writer));
+    writer = NULL;
+
+    ASSERT_EQUALS_INT(TRUE, counts.reallocs > 0, "The single pass writer didn't grow through realloc");
+    ASSERT_EQUALS_INT(counts.allocs, counts.frees, "The single pass writer didn't free everything it allocated");
+
+    ASSERT_EQUALS_INT(expected_length, actual_length, "Wrong length written through realloc");
+    ASSERT_EQUALS_INT(0, memcmp(expected, actual, expected_length), "Wrong bytes written through realloc");
+
+fail:
+    if (writer) ion_writer_close(writer);
+    return err;
+}
+
+iERR test_ion_binary_alloc_stats() {
+    iENTER;
+    static BYTE        buffer[100000];
+    SIZE               length;
+    ION_ALLOC_STATS    before, stats, after;
+    ION_WRITER_OPTIONS options;
+    hWRITER            writer = NULL;
+    hREADER            reader = NULL;
+    hSYMTAB            symtab;
+
+    ion_alloc_stats_enable(TRUE);
+    IONCHECK(ion_alloc_stats_get(&before));
+
+    memset(&options, 0, sizeof(options));
+    options.output_as_binary = TRUE;
+    IONCHECK(ion_writer_open_buffer(&writer, buffer, sizeof(buffer), &options));
+    IONCHECK(test_write_single_pass_values(writer, 300));
+    IONCHECK(ion_writer_get_alloc_stats(writer, &stats));
+
+    // the writer, its temp pool and the stream it holds values in
+    ASSERT_EQUALS_INT(TRUE, stats.owners >= 3, "Wrong owner count for the writer");
+    ASSERT_EQUALS_INT(TRUE, stats.blocks >= stats.owners, "Wrong block count for the writer");
+    ASSERT_EQUALS_INT(TRUE, stats.bytes > 0 && stats.peak_bytes >= stats.bytes, "Wrong byte counts for the writer");
+    ASSERT_EQUALS_INT(TRUE, stats.total_blocks >= stats.blocks, "Wrong total block count for the writer");
+
+    IONCHECK(ion_writer_flush(writer, &length));
+    IONCHECK(ion_writer_close(writer));
+    writer = NULL;
+
+    IONCHECK(ion_alloc_stats_get(&after));
+    ASSERT_EQUALS_INT(before.blocks, after.blocks, "The writer's blocks weren't all counted as freed");
+    ASSERT_EQUALS_INT(before.bytes, after.bytes, "The writer's bytes weren't all counted as freed");
+    ASSERT_EQUALS_INT(before.owners, after.owners, "The writer's owners weren't all counted as freed");
+    ASSERT_EQUALS_INT(TRUE, after.peak_bytes >= before.bytes + stats.bytes, "Wrong global peak");
+
+    // the reader gets the pages the writer gave back
+    IONCHECK(ion_reader_open_buffer(&reader, buffer, length, NULL));
+    IONCHECK(test_read_all_values(reader));
+    IONCHECK(ion_reader_get_alloc_stats(reader, &stats));
+    ASSERT_EQUALS_INT(TRUE, stats.pool_hits > 0, "The reader's blocks didn't come from the pool");
+    ASSERT_EQUALS_INT(stats.total_blocks, stats.pool_hits + stats.pool_misses, "Wrong pool counts for the reader");
+
+    // and its symbol table is counted with it
+    IONCHECK(ion_reader_get_symbol_table(reader, &symtab));
+    IONCHECK(ion_symbol_table_get_alloc_stats(symtab, &after));
+    ASSERT_EQUALS_INT(TRUE, after.blocks > 0 && after.blocks <= stats.blocks, "Wrong block count for the symbol table");
+
+    IONCHECK(ion_reader_close(reader));
+    reader = NULL;
+
+    IONCHECK(ion_alloc_stats_get(&after));
+    ASSERT_EQUALS_INT(before.blocks, after.blocks, "The reader's blocks weren't all counted as freed");
+    ASSERT_EQUALS_INT(TRUE, after.total_blocks > before.total_blocks, "Wrong global total block count");
+
+fail:
+    ion_alloc_stats_enable(FALSE);
+    if (writer) ion_writer_close(writer);
+    if (reader) ion_reader_close(reader);
+    return err;
+}
+
+iERR test_read_all_values(hREADER reader) {
+    iENTER;
+    ION_TYPE type;
+    SIZE     depth;
+
+    for (;;) {
+        IONCHECK(ion_reader_next(reader, &type));
+        if (type == tid_EOF) {
+            IONCHECK(ion_reader_get_depth(reader, &depth));
+            if (depth == 0) break;
+            IONCHECK(ion_reader_step_out(reader));
+        }
+        else if (type == tid_STRUCT || type == tid_LIST || type == tid_SEXP) {
+            IONCHECK(ion_reader_step_in(reader));
+        }
+    }
+
+    iRETURN;
+}
+
+iERR test_ion_binary_reader_strings_in_place() {
+    iENTER;
+    static BYTE        buffer[10000], original[10000], long_text[3000];
+    SIZE               length;
+    ION_WRITER_OPTIONS options;
+    ION_STRING         short_str, long_str, sym, value, annotation;
+    ION_STREAM_SEGMENT segments[100];
+    ION_STREAM        *stream = NULL;
+    hWRITER            writer = NULL;
+    hREADER            reader = NULL;
+    ION_TYPE           type;
+    SIZE               count;
+    int                ii, pass;
+
+    memset(long_text, 'y', sizeof(long_text));
+    ion_string_assign_cstr(&short_str, "a short string", 14);
+    ion_string_assign_cstr(&long_str, (char *)long_text, (SIZE)sizeof(long_text));
+    ion_string_assign_cstr(&sym, "a_symbol", 8);
+
+    memset(&options, 0, sizeof(options));
+    options.output_as_binary = TRUE;
+    IONCHECK(ion_writer_open_buffer(&writer, buffer, sizeof(buffer), &options));
+    IONCHECK(ion_writer_add_annotation(writer, &sym));
+    IONCHECK(ion_writer_write_string(writer, &short_str));
+    IONCHECK(ion_writer_write_string(writer, &long_str));
+    IONCHECK(ion_writer_write_symbol(writer, &sym));
+    IONCHECK(ion_writer_flush(writer, &length));
+    IONCHECK(ion_writer_close(writer));
+    writer = NULL;
+    memcpy(original, buffer, length);
+
+    // first over the buffer, where every string is handed out in place, then
+    // over 100 byte segments, where the long string has to be put together
+    for (pass = 0; pass < 2; pass++) {
+        if (pass == 0) {
+            IONCHECK(ion_reader_open_buffer(&reader, buffer, length, NULL));
+        }
+        else {
+            count = 0;
+            for (ii = 0; ii < length; ii += 100) {
+                segments[count].data = buffer + ii;
+                segments[count].length = (length - ii < 100) ? length - ii : 100;
+                count++;
+            }
+            IONCHECK(ion_stream_open_segments(segments, (int32_t)count, &stream));
+            IONCHECK(ion_reader_open(&reader, stream, NULL));
+        }
+
+        IONCHECK(ion_reader_next(reader, &type));
+        IONCHECK(expect_type(tid_STRING, type));
+        IONCHECK(ion_reader_get_an_annotation(reader, 0, &annotation));
+        ASSERT_EQUALS_INT(TRUE, ION_STRING_EQUALS(&sym, &annotation), "Wrong annotation");
+        ION_STRING_INIT(&value);
+        IONCHECK(ion_reader_read_string(reader, &value));
+        ASSERT_EQUALS_INT(TRUE, ION_STRING_EQUALS(&short_str, &value), "Wrong short string");
+        if (pass == 0) {
+            ASSERT_EQUALS_INT(TRUE, value.value > buffer && value.value < buffer + length, "The short string was copied");
+        }
+
+        // the value from before is passed back in, it mustn't be written over
+        IONCHECK(ion_reader_next(reader, &type));
+        IONCHECK(expect_type(tid_STRING, type));
+        IONCHECK(ion_reader_read_string(reader, &value));
+        ASSERT_EQUALS_INT(TRUE, ION_STRING_EQUALS(&long_str, &value), "Wrong long string");
+        if (pass == 0) {
+            ASSERT_EQUALS_INT(TRUE, value.value > buffer && value.value < buffer + length, "The long string was copied");
+        }
+        else {
+            ASSERT_EQUALS_INT(FALSE, value.value >= buffer && value.value < buffer + length, "The long string wasn't copied");
+        }
+
+        IONCHECK(ion_reader_next(reader, &type));
+        IONCHECK(expect_type(tid_SYMBOL, type));
+        IONCHECK(ion_reader_read_string(reader, &value));
+        ASSERT_EQUALS_INT(TRUE, ION_STRING_EQUALS(&sym, &value), "Wrong symbol");
+
+        IONCHECK(ion_reader_next(reader, &type));
+        IONCHECK(expect_type(tid_EOF, type));
+        IONCHECK(ion_reader_close(reader));
+        reader = NULL;
+        if (stream) {
+            IONCHECK(ion_stream_close(stream));
+            stream = NULL;
+        }
+    }
+
+    ASSERT_EQUALS_INT(0, memcmp(original, buffer, length), "The input was written over");
+
+fail:
+    if (writer) ion_writer_close(writer);
+    if (reader) ion_reader_close(reader);
+    if (stream) ion_stream_close(stream);
+    return err;
+}
+
+iERR test_ion_binary_validate_utf8() {
+    iENTER;
+    static const char *chars[] = { "a", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9D\x84\x9E", "bc" };
+    BYTE               text[300], bad[300], saved;
+    SIZE               length = 0, expected_remaining, ii, split;
+    const char        *c;
+
+    // enough mixed width characters to go through the vector validators,
+    // if there are any, with characters across each of their blocks
+    for (ii = 0; length < (SIZE)sizeof(text) - 4; ii++) {
+        for (c = chars[ii % 5]; *c; c++) text[length++] = (BYTE)*c;
+    }
+
+    IONCHECK(_ion_reader_binary_validate_utf8(text, length, 0, &expected_remaining));
+    ASSERT_EQUALS_INT(0, expected_remaining, "Valid text left a character unfinished");
+
+    // read in two parts, split anywhere, the character cut off is finished by the second
+    for (split = 0; split <= length; split++) {
+        IONCHECK(_ion_reader_binary_validate_utf8(text, split, 0, &expected_remaining));
+        IONCHECK(_ion_reader_binary_validate_utf8(text + split, length - split, expected_remaining, &expected_remaining));
+        ASSERT_EQUALS_INT(0, expected_remaining, "Valid text read in two parts left a character unfinished");
+    }
+
+    // a 4 byte character cut off after a whole block of ascii
+    memset(bad, 'x', 64);
+    bad[64] = 0xF0;
+    IONCHECK(_ion_reader_binary_validate_utf8(bad, 65, 0, &expected_remaining));
+    ASSERT_EQUALS_INT(3, expected_remaining, "Wrong count of bytes needed to finish the last character");
+
+    // any one byte broken, a stray continuation byte, a header
+    // without its continuation bytes or a byte that's never valid
+    memcpy(bad, text, length);
+    for (ii = 0; ii < length; ii++) {
+        saved = bad[ii];
+        bad[ii] = (saved < 0x80) ? 0x80 : (saved >= 0xC0) ? 0xFF : 'a';
+        ASSERT_EQUALS_INT(IERR_INVALID_UTF8, _ion_reader_binary_validate_utf8(bad, length, 0, &expected_remaining), "Invalid text was accepted");
+        split = length / 3;
+        err = _ion_reader_binary_validate_utf8(bad, split, 0, &expected_remaining);
+        if (err == IERR_OK) {
+            err = _ion_reader_binary_validate_utf8(bad + split, length - split, expected_remaining, &expected_remaining);
+        }
+        ASSERT_EQUALS_INT(IERR_INVALID_UTF8, err, "Invalid text read in two parts was accepted");
+        err = IERR_OK;
+        bad[ii] = saved;
+    }
+
+    iRETURN;
+}
+
+typedef struct _test_value_header
+{
+    ION_TYPE type;
+    SID      field_sid;
+    SIZE     annotations;
+    POSITION offset;
+    SIZE     length;
+} TEST_VALUE_HEADER;
+
+iERR test_read_value_headers(hREADER reader, BOOL in_struct, TEST_VALUE_HEADER *headers, int max, int *p_count) {
+    iENTER;
+    TEST_VALUE_HEADER *header;
+    ION_TYPE           type;
+
+    for (;;) {
+        IONCHECK(ion_reader_next(reader, &type));
+        if (type == tid_EOF) break;
+        if (*p_count >= max) FAILWITH(IERR_BUFFER_TOO_SMALL);
+        header = &headers[(*p_count)++];
+        memset(header, 0, sizeof(*header));
+        header->type = type;
+        header->field_sid = -1;
+        if (in_struct) {
+            IONCHECK(ion_reader_get_field_sid(reader, &header->field_sid));
+        }
+        IONCHECK(ion_reader_get_annotation_count(reader, &header->annotations));
+        IONCHECK(ion_reader_get_value_offset(reader, &header->offset));
+        IONCHECK(ion_reader_get_value_length(reader, &header->length));
+        if (type == tid_STRUCT || type == tid_LIST || type == tid_SEXP) {
+            IONCHECK(ion_reader_step_in(reader));
+            IONCHECK(test_read_value_headers(reader, type == tid_STRUCT, headers, max, p_count));
+            IONCHECK(ion_reader_step_out(reader));
+        }
+    }
+    iRETURN;
+}
+
+iERR test_ion_binary_reader_in_memory() {
+    iENTER;
+    static BYTE               buffer[20000];
+    static TEST_VALUE_HEADER  expected[2000], actual[2000];
+    static ION_STREAM_SEGMENT segments[20000];
+    SIZE                      length, offset;
+    ION_WRITER_OPTIONS        options;
+    hWRITER                   writer = NULL;
+    hREADER                   reader = NULL;
+    ION_STREAM               *stream = NULL;
+    ION_TYPE                  type;
+    int                       expected_count = 0, actual_count = 0, count = 0, ii;
+    int32_t                   value;
+
+    memset(&options, 0, sizeof(options));
+    options.output_as_binary = TRUE;
+    IONCHECK(ion_writer_open_buffer(&writer, buffer, sizeof(buffer), &options));
+    IONCHECK(test_write_single_pass_values(writer, 300));
+    IONCHECK(ion_writer_flush(writer, &length));
+    IONCHECK(ion_writer_close(writer));
+    writer = NULL;
+
+    // segments of 1 to 3 bytes, which most value headers are split across
+    for (offset = 0; offset < length; offset += segments[count++].length) {
+        segments[count].data = buffer + offset;
+        segments[count].length = (count % 3) + 1;
+        if (segments[count].length > length - offset) segments[count].length = length - offset;
+    }
+    IONCHECK(ion_stream_open_segments(segments, count, &stream));
+    IONCHECK(ion_reader_open(&reader, stream, NULL));
+    IONCHECK(test_read_value_headers(reader, FALSE, expected, 2000, &expected_count));
+    IONCHECK(ion_reader_close(reader));
+    IONCHECK(ion_stream_close(stream));
+    reader = NULL;
+    stream = NULL;
+
+    // the buffer reader decodes the headers in place
+    IONCHECK(ion_reader_open_buffer(&reader, buffer, length, NULL));
+    IONCHECK(test_read_value_headers(reader, FALSE, actual, 2000, &actual_count));
+    ASSERT_EQUALS_INT(expected_count, actual_count, "Wrong number of values read in place");
+    for (ii = 0; ii < expected_count; ii++) {
+        ASSERT_EQUALS_INT(TRUE, expected[ii].type == actual[ii].type, "Wrong type read in place");
+        ASSERT_EQUALS_INT(expected[ii].field_sid, actual[ii].field_sid, "Wrong field sid read in place");
+        ASSERT_EQUALS_INT(expected[ii].annotations, actual[ii].annotations, "Wrong annotation count read in place");
+        ASSERT_EQUALS_INT((int)expected[ii].offset, (int)actual[ii].offset, "Wrong value offset read in place");
+        ASSERT_EQUALS_INT(expected[ii].length, actual[ii].length, "Wrong value length read in place");
+    }
+
+    // and the offsets can be sought back to
+    ASSERT_EQUALS_INT(TRUE, expected[expected_count - 1].type == tid_INT, "Wrong type for the last value");
+    IONCHECK(ion_reader_seek(reader, actual[expected_count - 1].offset, actual[expected_count - 1].length));
+    IONCHECK(ion_reader_next(reader, &type));
+    IONCHECK(expect_type(tid_INT, type));
+    IONCHECK(ion_reader_read_int32(reader, &value));
+    ASSERT_EQUALS_INT(300, value, "Wrong value after seeking to it");
+    IONCHECK(ion_reader_close(reader));
+    reader = NULL;
+
+    iRETURN;
+}
+
+iERR test_ion_binary_var_uint_round_trip(uint64_t value, BYTE *buffer, SIZE buf_length) {
+    iENTER;
+    ION_STREAM *stream = NULL;
+    uint64_t    actual;
+    int         var_len = ion_binary_len_var_uint_64(value);
+    int         len = ion_binary_len_uint_64(value);
+    POSITION    end;
+
+    memset(buffer, 0xEE, buf_length);
+    IONCHECK(ion_stream_open_buffer(buffer, buf_length, 0, FALSE, &stream));
+    IONCHECK(ion_binary_write_var_uint_64(stream, value));
+    IONCHECK(ion_binary_write_uint_64(stream, value));
+    end = ion_stream_get_position(stream);
+    ASSERT_EQUALS_INT(var_len + len, (int)end, "Wrong length written");
+    IONCHECK(ion_stream_close(stream));
+    stream = NULL;
+
+    // reading back from a buffer of exactly that length, and with bytes to spare
+    // after it so that the whole word can be loaded
+    IONCHECK(ion_stream_open_buffer(buffer, buf_length, (SIZE)end, TRUE, &stream));
+    IONCHECK(ion_binary_read_var_uint_64(stream, &actual));
+    ASSERT_EQUALS_INT(TRUE, actual == value, "Wrong VarUInt read");
+    IONCHECK(ion_binary_read_uint_64(stream, len, &actual));
+    ASSERT_EQUALS_INT(TRUE, actual == value, "Wrong UInt read");
+    IONCHECK(ion_stream_close(stream));
+    stream = NULL;
+
+    IONCHECK(ion_stream_open_buffer(buffer, buf_length, buf_length, TRUE, &stream));
+    IONCHECK(ion_binary_read_var_uint_64(stream, &actual));
+    ASSERT_EQUALS_INT(TRUE, actual == value, "Wrong VarUInt read with bytes after it");
+    ASSERT_EQUALS_INT(var_len, (int)ion_stream_get_position(stream), "Wrong VarUInt length read");
+    IONCHECK(ion_binary_read_uint_64(stream, len, &actual));
+    ASSERT_EQUALS_INT(TRUE, actual == value, "Wrong UInt read with bytes after it");
+
+fail:
+    if (stream) ion_stream_close(stream);
+    return err;
+}
+
+iERR test_ion_binary_var_uint_kernels() {
+    iENTER;
+    BYTE     buffer[32];
+    uint64_t value;
+    int      bits;
+
+    IONCHECK(test_ion_binary_var_uint_round_trip(1, buffer, sizeof(buffer)));
+    // every VarUInt length on either side of where it changes, including the
+    // 9 and 10 byte values too long for one word
+    for (bits = 7; bits < 64; bits += 7) {
+        value = ((uint64_t)1 << bits);
+        IONCHECK(test_ion_binary_var_uint_round_trip(value - 1, buffer, sizeof(buffer)));
+        IONCHECK(test_ion_binary_var_uint_round_trip(value, buffer, sizeof(buffer)));
+        IONCHECK(test_ion_binary_var_uint_round_trip(value + 0x55, buffer, sizeof(buffer)));
+    }
+    IONCHECK(test_ion_binary_var_uint_round_trip(0x0123456789ABCDEFULL, buffer, sizeof(buffer)));
+    IONCHECK(test_ion_binary_var_uint_round_trip(0x7FFFFFFFFFFFFFFFULL, buffer, sizeof(buffer)));
+
+    iRETURN;
+}
+
+// writes 1 to 10 to a memory stream, seeks back to position and calls
+// write_fn there, then reads all 10 bytes back into actual
+iERR test_ion_binary_write_over(int64_t position, int write_fn, BYTE *actual) {
+    iENTER;
+    ION_STREAM *stream = NULL;
+    BYTE        bytes[10] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    SIZE        count;
+
+    IONCHECK(ion_stream_open_memory_only(&stream));
+    IONCHECK(ion_stream_write(stream, bytes, sizeof(bytes), &count));
+    IONCHECK(ion_stream_seek(stream, position));
+    if (write_fn == 0) {
+        IONCHECK(ion_binary_write_var_uint_64(stream, 1));
+    }
+    else {
+        IONCHECK(ion_binary_write_type_desc_with_length(stream, TID_STRING, 300));
+    }
+    IONCHECK(ion_stream_seek(stream, 0));
+    IONCHECK(ion_stream_read(stream, actual, sizeof(bytes), &count));
+    ASSERT_EQUALS_INT(sizeof(bytes), count, "The stream should still hold 10 bytes");
+
+fail:
+    if (stream) ion_stream_close(stream);
+    return err;
+}
+
+// only the bytes a VarUInt or type descriptor takes may be written, not
+// the rest of the word the kernels encode it in
+iERR test_ion_binary_write_over_existing_bytes() {
+    iENTER;
+    BYTE actual[10];
+    BYTE var_uint[10]  = { 0x81, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    BYTE type_desc[10] = { 1, 0x8E, 0x02, 0xAC, 5, 6, 7, 8, 9, 10 };
+
+    IONCHECK(test_ion_binary_write_over(0, 0, actual));
+    ASSERT_EQUALS_INT(0, memcmp(var_uint, actual, sizeof(actual)), "write_var_uint_64 wrote past its VarUInt");
+
+    IONCHECK(test_ion_binary_write_over(1, 1, actual));
+    ASSERT_EQUALS_INT(0, memcmp(type_desc, actual, sizeof(actual)), "write_type_desc_with_length wrote past its length");
+
+    iRETURN;
+}
+
+iERR test_write_projection_values(hWRITER writer) {
+    iENTER;
+    ION_STRING name, note, text;
+    char       long_text[300];
+    char       field[16];
+    int        ii;
+
+    memset(long_text, 'x', sizeof(long_text));
+    ion_string_assign_cstr(&note, "note", 4);
+    ion_string_assign_cstr(&text, long_text, sizeof(long_text));
+
+#define TEST_FIELD(x) IONCHECK(ion_writer_write_field_name(writer, ion_string_assign_cstr(&name, x, (SIZE)strlen(x))))
+    // {a:1, skipped:note::"xx...", b:{x:2, y:[{x:3, z:4}], w:5}, c:[6], wide:{f0:0, ...}, d:7}
+    IONCHECK(ion_writer_start_container(writer, tid_STRUCT));
+    TEST_FIELD("a");
+    IONCHECK(ion_writer_write_int(writer, 1));
+    TEST_FIELD("skipped");
+    IONCHECK(ion_writer_add_annotation(writer, &note));
+    IONCHECK(ion_writer_write_string(writer, &text));
+    TEST_FIELD("b");
+    IONCHECK(ion_writer_start_container(writer, tid_STRUCT));
+    TEST_FIELD("x");
+    IONCHECK(ion_writer_write_int(writer, 2));
+    TEST_FIELD("y");
+    IONCHECK(ion_writer_start_container(writer, tid_LIST));
+    IONCHECK(ion_writer_start_container(writer, tid_STRUCT));
+    TEST_FIELD("x");
+    IONCHECK(ion_writer_write_int(writer, 3));
+    TEST_FIELD("z");
+    IONCHECK(ion_writer_write_int(writer, 4));
+    IONCHECK(ion_writer_finish_container(writer));
+    IONCHECK(ion_writer_finish_container(writer));
+    TEST_FIELD("w");
+    IONCHECK(ion_writer_write_int(writer, 5));
+    IONCHECK(ion_writer_finish_container(writer));
+    TEST_FIELD("c");
+    IONCHECK(ion_writer_start_container(writer, tid_LIST));
+    IONCHECK(ion_writer_write_int(writer, 6));
+    IONCHECK(ion_writer_finish_container(writer));
+    TEST_FIELD("wide");
+    IONCHECK(ion_writer_start_container(writer, tid_STRUCT));
+    for (ii = 0; ii < 200; ii++) {
+        snprintf(field, sizeof(field), "f%d", ii);
+        TEST_FIELD(field);
+        IONCHECK(ion_writer_write_int(writer, ii));
+    }
+    IONCHECK(ion_writer_finish_container(writer));
+    TEST_FIELD("d");
+    IONCHECK(ion_writer_write_int(writer, 7));
+    IONCHECK(ion_writer_finish_container(writer));
+
+    // 8 [{a:9, c:10}] {b:{y:11}}
+    IONCHECK(ion_writer_write_int(writer, 8));
+    IONCHECK(ion_writer_start_container(writer, tid_LIST));
+    IONCHECK(ion_writer_start_container(writer, tid_STRUCT));
+    TEST_FIELD("a");
+    IONCHECK(ion_writer_write_int(writer, 9));
+    TEST_FIELD("c");
+    IONCHECK(ion_writer_write_int(writer, 10));
+    IONCHECK(ion_writer_finish_container(writer));
+    IONCHECK(ion_writer_finish_container(writer));
+    IONCHECK(ion_writer_start_container(writer, tid_STRUCT));
+    TEST_FIELD("b");
+    IONCHECK(ion_writer_start_container(writer, tid_STRUCT));
+    TEST_FIELD("y");
+    IONCHECK(ion_writer_write_int(writer, 11));
+    IONCHECK(ion_writer_finish_container(writer));
+    IONCHECK(ion_writer_finish_container(writer));
+#undef TEST_FIELD
+
+    iRETURN;
+}
+
+// appends the values the reader returns to trace, as field:value with
+// containers in brackets and strings as s
+iERR test_trace_values(hREADER reader, BOOL in_struct, char *trace, SIZE trace_size) {
+    iENTER;
+    ION_TYPE   type;
+    ION_STRING name;
+    int        value;
+    SIZE       used;
+
+    for (;;) {
+        IONCHECK(ion_reader_next(reader, &type));
+        if (type == tid_EOF) break;
+        used = (SIZE)strlen(trace);
+        if (in_struct) {
+            IONCHECK(ion_reader_get_field_name(reader, &name));
+            snprintf(trace + used, trace_size - used, "%.*s:", (int)name.length, (char *)name.value);
+            used = (SIZE)strlen(trace);
+        }
+        if (type == tid_INT) {
+            IONCHECK(ion_reader_read_int(reader, &value));
+            snprintf(trace + used, trace_size - used, "%d ", value);
+        }
+        else if (type == tid_STRING) {
+            snprintf(trace + used, trace_size - used, "s ");
+        }
+        else if (type == tid_STRUCT || type == tid_LIST) {
+            snprintf(trace + used, trace_size - used, "%c", (type == tid_STRUCT) ? '{' : '[');
+            IONCHECK(ion_reader_step_in(reader));
+            IONCHECK(test_trace_values(reader, type == tid_STRUCT, trace, trace_size));
+            IONCHECK(ion_reader_step_out(reader));
+            used = (SIZE)strlen(trace);
+            snprintf(trace + used, trace_size - used, "%c ", (type == tid_STRUCT) ? '}' : ']');
+        }
+        else {
+            FAILWITH(IERR_INVALID_STATE);
+        }
+    }
+    iRETURN;
+}
+
+iERR test_read_projection(hREADER reader, const char *expected) {
+    iENTER;
+    static char trace[8000];
+    ION_STRING  path[3];
+
+    trace[0] = '\0';
+    ion_string_assign_cstr(&path[0], "a", 1);
+    IONCHECK(ion_reader_add_projection_path(reader, path, 1));
+    ion_string_assign_cstr(&path[0], "b", 1);
+    ion_string_assign_cstr(&path[1], "y", 1);
+    ion_string_assign_cstr(&path[2], "x", 1);
+    IONCHECK(ion_reader_add_projection_path(reader, path, 3));
+    ion_string_assign_cstr(&path[0], "c", 1);
+    IONCHECK(ion_reader_add_projection_path(reader, path, 1));
+    IONCHECK(test_trace_values(reader, FALSE, trace, sizeof(trace)));
+    ASSERT_EQUALS_INT(0, strcmp(expected, trace), "Wrong values read through the projection");
+
+    iRETURN;
+}
+
+iERR test_ion_binary_reader_projection() {
+    iENTER;
+    static BYTE               binary[20000], text[20000];
+    static ION_STREAM_SEGMENT segments[20000];
+    const char               *expected = "{a:1 b:{y:[{x:3 } ] } c:[6 ] } 8 [{a:9 c:10 } ] {b:{y:11 } } ";
+    SIZE                      binary_length, text_length, offset;
+    ION_WRITER_OPTIONS        options;
+    hWRITER                   writer = NULL;
+    hREADER                   reader = NULL;
+    ION_STREAM               *stream = NULL;
+    ION_TYPE                  type;
+    ION_STRING                path[2];
+    int                       count = 0;
+
+    memset(&options, 0, sizeof(options));
+    options.output_as_binary = TRUE;
+    IONCHECK(ion_writer_open_buffer(&writer, binary, sizeof(binary), &options));
+    IONCHECK(test_write_projection_values(writer));
+    IONCHECK(ion_writer_flush(writer, &binary_length));
+    IONCHECK(ion_writer_close(writer));
+    options.output_as_binary = FALSE;
+    IONCHECK(ion_writer_open_buffer(&writer, text, sizeof(text), &options));
+    IONCHECK(test_write_projection_values(writer));
+    IONCHECK(ion_writer_flush(writer, &text_length));
+    IONCHECK(ion_writer_close(writer));
+    writer = NULL;
+
+    // binary in place, binary from a stream a few bytes at a time, and text
+    IONCHECK(ion_reader_open_buffer(&reader, binary, binary_length, NULL));
+    IONCHECK(test_read_projection(reader, expected));
+    IONCHECK(ion_reader_close(reader));
+    reader = NULL;
+
+    for (offset = 0; offset < binary_length; offset += segments[count++].length) {
+        segments[count].data = binary + offset;
+        segments[count].length = (count % 3) + 1;
+        if (segments[count].length > binary_length - offset) segments[count].length = binary_length - offset;
+    }
+    IONCHECK(ion_stream_open_segments(segments, count, &stream));
+    IONCHECK(ion_reader_open(&reader, stream, NULL));
+    IONCHECK(test_read_projection(reader, expected));
+    IONCHECK(ion_reader_close(reader));
+    IONCHECK(ion_stream_close(stream));
+    reader = NULL;
+    stream = NULL;
+
+    IONCHECK(ion_reader_open_buffer(&reader, text, text_length, NULL));
+    IONCHECK(test_read_projection(reader, expected));
+
+    // a shorter path reads all of the longer one's value, and paths only
+    // change at the top level
+    IONCHECK(ion_reader_seek(reader, 0, -1));
+    ion_string_assign_cstr(&path[0], "b", 1);
+    IONCHECK(ion_reader_add_projection_path(reader, path, 1));
+    IONCHECK(ion_reader_next(reader, &type));
+    IONCHECK(ion_reader_step_in(reader));
+    ASSERT_EQUALS_INT(IERR_INVALID_STATE, ion_reader_clear_projection(reader), "Projection cleared below the top level");
+    IONCHECK(ion_reader_next(reader, &type));
+    IONCHECK(expect_type(tid_INT, type));
+    IONCHECK(ion_reader_next(reader, &type));
+    IONCHECK(expect_type(tid_STRUCT, type));
+    IONCHECK(ion_reader_step_in(reader));
+    IONCHECK(ion_reader_next(reader, &type));
+    IONCHECK(expect_type(tid_INT, type));
+    IONCHECK(ion_reader_next(reader, &type));
+    IONCHECK(expect_type(tid_LIST, type));
+    IONCHECK(ion_reader_next(reader, &type));
+    IONCHECK(expect_type(tid_INT, type));
+    IONCHECK(ion_reader_next(reader, &type));
+    IONCHECK(expect_type(tid_EOF, type));
+    IONCHECK(ion_reader_step_out(reader));
+    IONCHECK(ion_reader_next(reader, &type));
+    IONCHECK(expect_type(tid_LIST, type));
+    IONCHECK(ion_reader_step_out(reader));
+
+    // and with none every field is read again
+    IONCHECK(ion_reader_clear_projection(reader));
+    IONCHECK(ion_reader_next(reader, &type));
+    IONCHECK(expect_type(tid_INT, type));
+    IONCHECK(ion_reader_close(reader));
+    reader = NULL;
+
+fail:
+    if (writer) ion_writer_close(writer);
+    if (reader) ion_reader_close(reader);
+    if (stream) ion_stream_close(stream);
+    return err;
+}
@@ -3,3 +3,20 @@
 iERR ion_binary_test();
 iERR test_ion_binary_len_uint_64();
 iERR test_ion_binary_len_int_64();
+iERR test_write_single_pass_values(hWRITER writer, int count);
+iERR test_ion_binary_writer_single_pass();
+iERR test_ion_binary_allocator();
+iERR test_ion_binary_allocator_realloc();
+iERR test_read_all_values(hREADER reader);
+iERR test_ion_binary_alloc_stats();
+iERR test_ion_binary_reader_strings_in_place();
+iERR test_ion_binary_validate_utf8();
+iERR test_ion_binary_reader_in_memory();
+iERR test_ion_binary_var_uint_round_trip(uint64_t value, BYTE *buffer, SIZE buf_length);
+iERR test_ion_binary_var_uint_kernels();
+iERR test_ion_binary_write_over(int64_t position, int write_fn, uint8_t *actual);
+iERR test_ion_binary_write_over_existing_bytes();
+iERR test_write_projection_values(hWRITER writer);
+iERR test_trace_values(hREADER reader, BOOL in_struct, char *trace, SIZE trace_size);
+iERR test_read_projection(hREADER reader, const char *expected);
+iERR test_ion_binary_reader_projection();
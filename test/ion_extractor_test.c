@@ -0,0 +1,203 @@
+#include "ion_extractor_test.h"
+
+#include <ion.h>
+#include "ion_assert.h"
+#include "ion_unit_test.h"
+#include "tester.h"
+
+iERR ion_extractor_test() {
+    iENTER;
+
+    run_unit_test(test_ion_extractor_paths);
+    run_unit_test(test_ion_extractor_bad_paths);
+    run_unit_test(test_ion_extractor_callback_error);
+
+    iRETURN;
+}
+
+// appends path_id:value to the trace in context, with the field name for
+// containers, or top for top level ones
+iERR test_ion_extractor_record(hREADER hreader, int32_t path_id, void *context) {
+    iENTER;
+    char      *trace = (char *)context;
+    SIZE       used = (SIZE)strlen(trace);
+    ION_TYPE   type;
+    ION_STRING str;
+    SIZE       depth;
+    int        value;
+
+    IONCHECK(ion_reader_get_type(hreader, &type));
+    if (type == tid_INT) {
+        IONCHECK(ion_reader_read_int(hreader, &value));
+        sprintf(trace + used, "%d:%d ", (int)path_id, value);
+    }
+    else if (type == tid_STRING) {
+        IONCHECK(ion_reader_read_string(hreader, &str));
+        sprintf(trace + used, "%d:%.*s ", (int)path_id, (int)str.length, (char *)str.value);
+    }
+    else {
+        IONCHECK(ion_reader_get_depth(hreader, &depth));
+        if (depth == 0) {
+            sprintf(trace + used, "%d:top ", (int)path_id);
+        }
+        else {
+            IONCHECK(ion_reader_get_field_name(hreader, &str));
+            sprintf(trace + used, "%d:%.*s ", (int)path_id, (int)str.length, (char *)str.value);
+        }
+    }
+
+    iRETURN;
+}
+
+iERR test_ion_extractor_fail(hREADER hreader, int32_t path_id, void *context) {
+    return IERR_INVALID_STATE;
+}
+
+iERR test_ion_extractor_trace(BYTE *buffer, SIZE length, BOOL segmented, char **paths, int count, const char *expected) {
+    iENTER;
+    static ION_STREAM_SEGMENT segments[2000];
+    static char               trace[1000];
+    hEXTRACTOR                extractor = NULL;
+    hREADER                   reader = NULL;
+    ION_STREAM               *stream = NULL;
+    ION_TYPE                  type;
+    SIZE                      offset;
+    int32_t                   path_id;
+    int                       ii, segment_count = 0, field_count = 0;
+
+    trace[0] = '\0';
+    IONCHECK(ion_extractor_open(&extractor));
+    for (ii = 0; ii < count; ii++) {
+        IONCHECK(ion_extractor_add_path(extractor, paths[ii], test_ion_extractor_record, trace, &path_id));
+        ASSERT_EQUALS_INT(ii, path_id, "Wrong path id");
+    }
+
+    if (segmented) {
+        // segments of 1 to 3 bytes so the binary reader can't decode in place
+        for (offset = 0; offset < length; offset += segments[segment_count++].length) {
+            segments[segment_count].data = buffer + offset;
+            segments[segment_count].length = (segment_count % 3) + 1;
+            if (segments[segment_count].length > length - offset) segments[segment_count].length = length - offset;
+        }
+        IONCHECK(ion_stream_open_segments(segments, segment_count, &stream));
+        IONCHECK(ion_reader_open(&reader, stream, NULL));
+    }
+    else {
+        IONCHECK(ion_reader_open_buffer(&reader, buffer, length, NULL));
+    }
+    IONCHECK(ion_extractor_match(extractor, reader));
+    ASSERT_EQUALS_INT(0, strcmp(expected, trace), "Wrong values extracted");
+
+    // and the reader reads every field again afterwards
+    if (!segmented) {
+        IONCHECK(ion_reader_seek(reader, 0, -1));
+        IONCHECK(ion_reader_next(reader, &type));
+        IONCHECK(ion_reader_step_in(reader));
+        for (;;) {
+            IONCHECK(ion_reader_next(reader, &type));
+            if (type == tid_EOF) break;
+            field_count++;
+        }
+        IONCHECK(ion_reader_step_out(reader));
+        ASSERT_EQUALS_INT(2, field_count, "Wrong number of fields read after extracting");
+    }
+
+fail:
+    if (extractor) ion_extractor_close(extractor);
+    if (reader) ion_reader_close(reader);
+    if (stream) ion_stream_close(stream);
+    return err;
+}
+
+iERR test_ion_extractor_paths() {
+    iENTER;
+    static BYTE        binary[2000];
+    char              *text = "{order:{id:1, items:[{sku:\"a1\", qty:2}, {sku:\"b2\", qty:1}], note:\"x\"}, meta:{ts:5, other:6}}"
+                              "{order:{id:2, items:[], skipped:[1, 2, 3]}, meta:{ts:7}}"
+                              "[10, 11, 12]";
+    char              *paths[] = { "order.items[*].sku", "meta.ts", "[1]", "order.*" };
+    char              *unprojected[] = { "", "*.id" };
+    const char        *expected = "3:1 3:items 0:a1 0:b2 3:x 1:5 3:2 3:items 3:skipped 1:7 2:11 ";
+    const char        *expected_unprojected = "0:top 1:1 0:top 1:2 0:top ";
+    ION_WRITER_OPTIONS options;
+    hWRITER            writer = NULL;
+    hREADER            reader = NULL;
+    SIZE               binary_length;
+
+    memset(&options, 0, sizeof(options));
+    options.output_as_binary = TRUE;
+    IONCHECK(ion_reader_open_buffer(&reader, (BYTE *)text, (SIZE)strlen(text), NULL));
+    IONCHECK(ion_writer_open_buffer(&writer, binary, sizeof(binary), &options));
+    IONCHECK(ion_writer_write_all_values(writer, reader));
+    IONCHECK(ion_writer_flush(writer, &binary_length));
+    IONCHECK(ion_writer_close(writer));
+    IONCHECK(ion_reader_close(reader));
+    writer = NULL;
+    reader = NULL;
+
+    IONCHECK(test_ion_extractor_trace((BYTE *)text, (SIZE)strlen(text), FALSE, paths, 4, expected));
+    IONCHECK(test_ion_extractor_trace(binary, binary_length, FALSE, paths, 4, expected));
+    IONCHECK(test_ion_extractor_trace(binary, binary_length, TRUE, paths, 4, expected));
+
+    // the empty path matches the top level values, neither of these paths
+    // lets the reader skip fields
+    IONCHECK(test_ion_extractor_trace((BYTE *)text, (SIZE)strlen(text), FALSE, unprojected, 2, expected_unprojected));
+    IONCHECK(test_ion_extractor_trace(binary, binary_length, FALSE, unprojected, 2, expected_unprojected));
+
+fail:
+    if (writer) ion_writer_close(writer);
+    if (reader) ion_reader_close(reader);
+    return err;
+}
+
+iERR test_ion_extractor_bad_paths() {
+    iENTER;
+    hEXTRACTOR  extractor = NULL;
+    char       *bad[] = { "a..b", "a.", ".a", "[x]", "a[1", "a]", "a[*]b", "[99999999999]" };
+    char        good[8];
+    int         ii;
+
+    IONCHECK(ion_extractor_open(&extractor));
+    for (ii = 0; ii < (int)(sizeof(bad) / sizeof(bad[0])); ii++) {
+        ASSERT_EQUALS_INT(IERR_INVALID_SYNTAX, ion_extractor_add_path(extractor, bad[ii], test_ion_extractor_record, NULL, NULL), "Bad path accepted");
+    }
+    for (ii = 0; ii < ION_EXTRACTOR_MAX_PATHS; ii++) {
+        sprintf(good, "a%d", ii);
+        IONCHECK(ion_extractor_add_path(extractor, good, test_ion_extractor_record, NULL, NULL));
+    }
+    ASSERT_EQUALS_INT(IERR_TOO_MANY_PATHS, ion_extractor_add_path(extractor, "b", test_ion_extractor_record, NULL, NULL), "Too many paths accepted");
+
+fail:
+    if (extractor) ion_extractor_close(extractor);
+    return err;
+}
+
+iERR test_ion_extractor_callback_error() {
+    iENTER;
+    char       *text = "{a:1, b:2, c:3}";
+    hEXTRACTOR  extractor = NULL;
+    hREADER     reader = NULL;
+    ION_TYPE    type;
+    int         field_count = 0;
+
+    IONCHECK(ion_extractor_open(&extractor));
+    IONCHECK(ion_extractor_add_path(extractor, "b", test_ion_extractor_fail, NULL, NULL));
+    IONCHECK(ion_reader_open_buffer(&reader, (BYTE *)text, (SIZE)strlen(text), NULL));
+    ASSERT_EQUALS_INT(IERR_INVALID_STATE, ion_extractor_match(extractor, reader), "Callback error not returned");
+
+    // the reader isn't left projected onto b
+    IONCHECK(ion_reader_seek(reader, 0, -1));
+    IONCHECK(ion_reader_next(reader, &type));
+    IONCHECK(ion_reader_step_in(reader));
+    for (;;) {
+        IONCHECK(ion_reader_next(reader, &type));
+        if (type == tid_EOF) break;
+        field_count++;
+    }
+    ASSERT_EQUALS_INT(3, field_count, "Wrong number of fields read after a failed match");
+
+fail:
+    if (extractor) ion_extractor_close(extractor);
+    if (reader) ion_reader_close(reader);
+    return err;
+}
@@ -0,0 +1,9 @@
+#include <ion_debug.h>
+
+iERR ion_extractor_test();
+iERR test_ion_extractor_record(hREADER hreader, int32_t path_id, void *context);
+iERR test_ion_extractor_fail(hREADER hreader, int32_t path_id, void *context);
+iERR test_ion_extractor_trace(BYTE *buffer, SIZE length, BOOL segmented, char **paths, int count, const char *expected);
+iERR test_ion_extractor_paths();
+iERR test_ion_extractor_bad_paths();
+iERR test_ion_extractor_callback_error();
@@ -0,0 +1,266 @@
+#include "ion_offset_index_test.h"
+
+#include <ion.h>
+#include "ion_assert.h"
+#include "ion_unit_test.h"
+#include "tester.h"
+
+#define TEST_OFFSET_INDEX_MAX_VALUES 8
+
+iERR ion_offset_index_test() {
+    iENTER;
+
+    run_unit_test(test_ion_offset_index_binary);
+    run_unit_test(test_ion_offset_index_text);
+    run_unit_test(test_ion_offset_index_field_order);
+    run_unit_test(test_ion_offset_index_not_an_index);
+
+    iRETURN;
+}
+
+// moves to the next value and describes it as the reader sees it: where it
+// is, and the first field name and value of a struct or list, which only
+// come out right with the right symbol table
+iERR test_ion_offset_index_describe(hREADER hreader, char *description) {
+    iENTER;
+    ION_TYPE   type;
+    ION_STRING str;
+    int64_t    bytes;
+    int32_t    line, offset;
+    int        value;
+    SIZE       used;
+
+    IONCHECK(ion_reader_next(hreader, &type));
+    if (type == tid_EOF) {
+        strcpy(description, "eof");
+        SUCCEED();
+    }
+    IONCHECK(ion_reader_get_position(hreader, &bytes, &line, &offset));
+    sprintf(description, "%d:%d:%d ", (int)bytes, (int)line, (int)offset);
+
+    IONCHECK(ion_reader_step_in(hreader));
+    if (type == tid_STRUCT) {
+        IONCHECK(ion_reader_next(hreader, &type));
+        IONCHECK(ion_reader_get_field_name(hreader, &str));
+        used = (SIZE)strlen(description);
+        sprintf(description + used, "%.*s:", (int)str.length, (char *)str.value);
+    }
+    else {
+        IONCHECK(ion_reader_next(hreader, &type));
+    }
+    used = (SIZE)strlen(description);
+    if (type == tid_INT) {
+        IONCHECK(ion_reader_read_int(hreader, &value));
+        sprintf(description + used, "%d", value);
+    }
+    else {
+        IONCHECK(ion_reader_read_string(hreader, &str));
+        sprintf(description + used, "%.*s", (int)str.length, (char *)str.value);
+    }
+    IONCHECK(ion_reader_step_out(hreader));
+
+    iRETURN;
+}
+
+iERR test_ion_offset_index_check(BYTE *buffer, SIZE length, int expected_count, int *expected_symtabs) {
+    iENTER;
+    static char             descriptions[TEST_OFFSET_INDEX_MAX_VALUES][100];
+    static BYTE             written[1000];
+    char                    description[100];
+    int                     order[] = { 3, 0, 1, 2, 2, 0, 3 };
+    hOFFSET_INDEX           index = NULL, copy = NULL;
+    hREADER                 reader = NULL, index_reader = NULL;
+    hWRITER                 writer = NULL;
+    ION_WRITER_OPTIONS      options;
+    ION_OFFSET_INDEX_ENTRY  entry, copy_entry;
+    int64_t                 count;
+    SIZE                    written_length;
+    int                     ii;
+
+    IONCHECK(ion_reader_open_buffer(&reader, buffer, length, NULL));
+    IONCHECK(ion_offset_index_open(&index));
+    IONCHECK(ion_offset_index_build(index, reader));
+    IONCHECK(ion_offset_index_get_count(index, &count));
+    ASSERT_EQUALS_INT(expected_count, (int)count, "Wrong number of values indexed");
+    for (ii = 0; ii < expected_count; ii++) {
+        IONCHECK(ion_offset_index_get_entry(index, ii, &entry));
+        ASSERT_EQUALS_INT(expected_symtabs[ii], entry.symtab_id, "Wrong symbol table");
+    }
+    ASSERT_EQUALS_INT(IERR_NO_SUCH_ELEMENT, ion_offset_index_get_entry(index, count, &entry), "Value past the end found");
+
+    // how the values look read straight through
+    IONCHECK(ion_reader_seek(reader, 0, -1));
+    for (ii = 0; ii < expected_count; ii++) {
+        IONCHECK(test_ion_offset_index_describe(reader, descriptions[ii]));
+    }
+
+    // and jumping around, both to the value and on from it
+    for (ii = 0; ii < (int)(sizeof(order) / sizeof(order[0])); ii++) {
+        IONCHECK(ion_offset_index_seek(index, reader, order[ii]));
+        IONCHECK(test_ion_offset_index_describe(reader, description));
+        ASSERT_EQUALS_INT(0, strcmp(descriptions[order[ii]], description), "Wrong value after seek");
+        IONCHECK(test_ion_offset_index_describe(reader, description));
+        ASSERT_EQUALS_INT(0, strcmp(order[ii] + 1 < expected_count ? descriptions[order[ii] + 1] : "eof", description), "Wrong value after the one sought");
+    }
+
+    // the index written out and read back is the same
+    memset(&options, 0, sizeof(options));
+    options.output_as_binary = TRUE;
+    IONCHECK(ion_writer_open_buffer(&writer, written, sizeof(written), &options));
+    IONCHECK(ion_offset_index_write(index, writer));
+    IONCHECK(ion_writer_flush(writer, &written_length));
+    IONCHECK(ion_writer_close(writer));
+    writer = NULL;
+
+    IONCHECK(ion_reader_open_buffer(&index_reader, written, written_length, NULL));
+    IONCHECK(ion_offset_index_read(index_reader, &copy));
+    IONCHECK(ion_offset_index_get_count(copy, &count));
+    ASSERT_EQUALS_INT(expected_count, (int)count, "Wrong number of values read back");
+    for (ii = 0; ii < expected_count; ii++) {
+        IONCHECK(ion_offset_index_get_entry(index, ii, &entry));
+        IONCHECK(ion_offset_index_get_entry(copy, ii, &copy_entry));
+        ASSERT_EQUALS_INT(0, memcmp(&entry, &copy_entry, sizeof(entry)), "Wrong entry read back");
+    }
+    IONCHECK(ion_offset_index_seek(copy, reader, expected_count - 1));
+    IONCHECK(test_ion_offset_index_describe(reader, description));
+    ASSERT_EQUALS_INT(0, strcmp(descriptions[expected_count - 1], description), "Wrong value after seek with the index read back");
+
+fail:
+    if (index) ion_offset_index_close(index);
+    if (copy) ion_offset_index_close(copy);
+    if (writer) ion_writer_close(writer);
+    if (reader) ion_reader_close(reader);
+    if (index_reader) ion_reader_close(index_reader);
+    return err;
+}
+
+iERR test_ion_offset_index_binary() {
+    iENTER;
+    static BYTE        binary[1000];
+    // each part gets its own version marker and local symbol table, so the
+    // field names of the second part are wrong with the first part's table
+    char              *parts[] = { "{a:1} {b:2}", "{c:3} {d:4}" };
+    int                symtabs[] = { 0, 0, 1, 1 };
+    ION_WRITER_OPTIONS options;
+    hWRITER            writer = NULL;
+    hREADER            reader = NULL;
+    SIZE               binary_length = 0, part_length;
+    int                ii;
+
+    memset(&options, 0, sizeof(options));
+    options.output_as_binary = TRUE;
+    for (ii = 0; ii < 2; ii++) {
+        IONCHECK(ion_reader_open_buffer(&reader, (BYTE *)parts[ii], (SIZE)strlen(parts[ii]), NULL));
+        IONCHECK(ion_writer_open_buffer(&writer, binary + binary_length, sizeof(binary) - binary_length, &options));
+        IONCHECK(ion_writer_write_all_values(writer, reader));
+        IONCHECK(ion_writer_flush(writer, &part_length));
+        IONCHECK(ion_writer_close(writer));
+        IONCHECK(ion_reader_close(reader));
+        writer = NULL;
+        reader = NULL;
+        binary_length += part_length;
+    }
+
+    IONCHECK(test_ion_offset_index_check(binary, binary_length, 4, symtabs));
+
+fail:
+    if (writer) ion_writer_close(writer);
+    if (reader) ion_reader_close(reader);
+    return err;
+}
+
+iERR test_ion_offset_index_text() {
+    iENTER;
+    char                   *text = "$ion_1_0 {a:1}\n"
+                                   "\n"
+                                   "  {b:2}\n"
+                                   "$ion_symbol_table::{symbols:[\"x\"]} [$10]\n"
+                                   "ann::{\n"
+                                   "  d:4}";
+    int                     symtabs[] = { 0, 0, 1, 1 };
+    int                     lines[] = { 1, 3, 4, 5 };
+    int                     line_offsets[] = { 9, 2, 35, 0 };
+    hOFFSET_INDEX           index = NULL;
+    hREADER                 reader = NULL;
+    ION_OFFSET_INDEX_ENTRY  entry;
+    int                     ii;
+
+    IONCHECK(test_ion_offset_index_check((BYTE *)text, (SIZE)strlen(text), 4, symtabs));
+
+    // values start where ion_reader_get_position would count them from
+    IONCHECK(ion_reader_open_buffer(&reader, (BYTE *)text, (SIZE)strlen(text), NULL));
+    IONCHECK(ion_offset_index_open(&index));
+    IONCHECK(ion_offset_index_build(index, reader));
+    for (ii = 0; ii < 4; ii++) {
+        IONCHECK(ion_offset_index_get_entry(index, ii, &entry));
+        ASSERT_EQUALS_INT(-1, entry.length, "Text values have no length");
+        ASSERT_EQUALS_INT(lines[ii], entry.line, "Wrong line");
+        ASSERT_EQUALS_INT(line_offsets[ii], entry.line_offset, "Wrong offset in the line");
+    }
+
+fail:
+    if (index) ion_offset_index_close(index);
+    if (reader) ion_reader_close(reader);
+    return err;
+}
+
+iERR test_ion_offset_index_field_order() {
+    iENTER;
+    // values before text, the numbers only make sense once text is known
+    char                   *texts[] = { "$ion_offset_index::{values:[3, 0, 9, 1, 1, 2], symbol_tables:[0], text:true, version:1}",
+                                        "$ion_offset_index::{symbol_tables:[0], values:[3, 4, 1, 2], text:false}" };
+    POSITION                offsets[2][2] = { { 3, 4 }, { 3, 8 } };
+    SIZE                    lengths[2][2] = { { -1, -1 }, { 4, 2 } };
+    int32_t                 lines[2][2] = { { 1, 2 }, { 0, 0 } };
+    int32_t                 line_offsets[2][2] = { { 9, 2 }, { 0, 0 } };
+    hOFFSET_INDEX           index = NULL;
+    hREADER                 reader = NULL;
+    ION_OFFSET_INDEX_ENTRY  entry;
+    int64_t                 count;
+    int                     ii, jj;
+
+    for (ii = 0; ii < 2; ii++) {
+        IONCHECK(ion_reader_open_buffer(&reader, (BYTE *)texts[ii], (SIZE)strlen(texts[ii]), NULL));
+        IONCHECK(ion_offset_index_read(reader, &index));
+        IONCHECK(ion_offset_index_get_count(index, &count));
+        ASSERT_EQUALS_INT(2, (int)count, "Wrong number of values read");
+        for (jj = 0; jj < 2; jj++) {
+            IONCHECK(ion_offset_index_get_entry(index, jj, &entry));
+            ASSERT_EQUALS_INT(offsets[ii][jj], (int)entry.offset, "Wrong offset read");
+            ASSERT_EQUALS_INT(lengths[ii][jj], entry.length, "Wrong length read");
+            ASSERT_EQUALS_INT(lines[ii][jj], entry.line, "Wrong line read");
+            ASSERT_EQUALS_INT(line_offsets[ii][jj], entry.line_offset, "Wrong offset in the line read");
+        }
+        IONCHECK(ion_offset_index_close(index));
+        IONCHECK(ion_reader_close(reader));
+        index = NULL;
+        reader = NULL;
+    }
+
+fail:
+    if (index) ion_offset_index_close(index);
+    if (reader) ion_reader_close(reader);
+    return err;
+}
+
+iERR test_ion_offset_index_not_an_index() {
+    iENTER;
+    char          *texts[] = { "{version:1}", "$ion_offset_index::[]", "$ion_offset_index::{version:2}",
+                               "$ion_offset_index::{text:false, symbol_tables:[1], values:[0, 2]}",
+                               "$ion_offset_index::{symbol_tables:[0], values:[0, 2]}",
+                               "$ion_offset_index::{values:[0, 2, 4], symbol_tables:[0], text:false}" };
+    hOFFSET_INDEX  index = NULL;
+    hREADER        reader = NULL;
+    int            ii;
+
+    for (ii = 0; ii < (int)(sizeof(texts) / sizeof(texts[0])); ii++) {
+        IONCHECK(ion_reader_open_buffer(&reader, (BYTE *)texts[ii], (SIZE)strlen(texts[ii]), NULL));
+        ASSERT_EQUALS_INT(IERR_NOT_AN_OFFSET_INDEX, ion_offset_index_read(reader, &index), "Not an index read as one");
+        IONCHECK(ion_reader_close(reader));
+        reader = NULL;
+    }
+
+fail:
+    if (reader) ion_reader_close(reader);
+    return err;
+}
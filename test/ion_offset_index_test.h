@@ -0,0 +1,9 @@
+#include <ion_debug.h>
+
+iERR ion_offset_index_test();
+iERR test_ion_offset_index_describe(hREADER hreader, char *description);
+iERR test_ion_offset_index_check(BYTE *buffer, SIZE length, int expected_count, int *expected_symtabs);
+iERR test_ion_offset_index_binary();
+iERR test_ion_offset_index_text();
+iERR test_ion_offset_index_field_order();
+iERR test_ion_offset_index_not_an_index();
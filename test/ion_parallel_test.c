@@ -0,0 +1,193 @@
+#include "ion_parallel_test.h"
+
+#include <ion.h>
+#include <ion_platform_config.h>
+#include "ion_assert.h"
+#include "ion_unit_test.h"
+#include "tester.h"
+
+#ifndef ION_PLATFORM_WINDOWS
+#include <unistd.h>
+#endif
+
+#define TEST_PARALLEL_PARTS             3
+#define TEST_PARALLEL_VALUES_PER_PART   40
+#define TEST_PARALLEL_VALUES            (TEST_PARALLEL_PARTS * TEST_PARALLEL_VALUES_PER_PART)
+
+iERR ion_parallel_test() {
+    iENTER;
+
+    run_unit_test(test_ion_parallel_buffer);
+    run_unit_test(test_ion_parallel_fd);
+    run_unit_test(test_ion_parallel_stops_on_error);
+
+    iRETURN;
+}
+
+// records the value of {f<part>_<n>:<part * 1000 + n>} in the slot for
+// its value number, or -1 if the field name doesn't go with the value,
+// which is what a reader with the wrong symbol table would see
+iERR test_ion_parallel_record(hREADER hreader, int64_t value, void *context) {
+    iENTER;
+    int64_t    *recorded = (int64_t *)context;
+    ION_TYPE    type;
+    ION_STRING  field_name;
+    char        name[32];
+    int         part, n, number;
+
+    IONCHECK(ion_reader_step_in(hreader));
+    IONCHECK(ion_reader_next(hreader, &type));
+    IONCHECK(ion_reader_get_field_name(hreader, &field_name));
+    IONCHECK(ion_reader_read_int(hreader, &number));
+    IONCHECK(ion_reader_step_out(hreader));
+
+    snprintf(name, sizeof(name), "%.*s", (int)field_name.length, (char *)field_name.value);
+    if (sscanf(name, "f%d_%d", &part, &n) == 2 && part * 1000 + n == number) {
+        recorded[value] = number;
+    }
+    else {
+        recorded[value] = -1;
+    }
+
+    iRETURN;
+}
+
+iERR test_ion_parallel_fail(hREADER hreader, int64_t value, void *context) {
+    if (value == TEST_PARALLEL_VALUES / 2) return IERR_INVALID_STATE;
+    return IERR_OK;
+}
+
+// each part is written by its own writer, so has its own version marker and
+// local symbol table, and the field names are different in each part
+iERR test_ion_parallel_make_input(BYTE *buffer, SIZE size, SIZE *p_length) {
+    iENTER;
+    ION_WRITER_OPTIONS options;
+    hWRITER            writer = NULL;
+    ION_STRING         field_name;
+    char               name[32];
+    SIZE               length = 0, part_length;
+    int                part, n;
+
+    memset(&options, 0, sizeof(options));
+    options.output_as_binary = TRUE;
+    for (part = 0; part < TEST_PARALLEL_PARTS; part++) {
+        IONCHECK(ion_writer_open_buffer(&writer, buffer + length, size - length, &options));
+        for (n = 0; n < TEST_PARALLEL_VALUES_PER_PART; n++) {
+            sprintf(name, "f%d_%d", part, n);
+            IONCHECK(ion_writer_start_container(writer, tid_STRUCT));
+            IONCHECK(ion_writer_write_field_name(writer, ion_string_assign_cstr(&field_name, name, (SIZE)strlen(name))));
+            IONCHECK(ion_writer_write_int(writer, part * 1000 + n));
+            IONCHECK(ion_writer_finish_container(writer));
+        }
+        IONCHECK(ion_writer_flush(writer, &part_length));
+        IONCHECK(ion_writer_close(writer));
+        writer = NULL;
+        length += part_length;
+    }
+    *p_length = length;
+
+fail:
+    if (writer) ion_writer_close(writer);
+    return err;
+}
+
+iERR test_ion_parallel_check(int64_t *recorded, int count) {
+    iENTER;
+    int ii;
+
+    ASSERT_EQUALS_INT(TEST_PARALLEL_VALUES, count, "Wrong number of values");
+    for (ii = 0; ii < count; ii++) {
+        ASSERT_EQUALS_INT((ii / TEST_PARALLEL_VALUES_PER_PART) * 1000 + ii % TEST_PARALLEL_VALUES_PER_PART, (int)recorded[ii], "Wrong value read");
+    }
+
+    iRETURN;
+}
+
+iERR test_ion_parallel_buffer() {
+    iENTER;
+    static BYTE    buffer[10000];
+    static int64_t recorded[TEST_PARALLEL_VALUES];
+    int32_t        thread_counts[] = { 1, 2, 3, 8, 1000 };
+    hOFFSET_INDEX  index = NULL;
+    hREADER        reader = NULL;
+    SIZE           length;
+    int            ii;
+
+    IONCHECK(test_ion_parallel_make_input(buffer, sizeof(buffer), &length));
+
+    for (ii = 0; ii < (int)(sizeof(thread_counts) / sizeof(thread_counts[0])); ii++) {
+        memset(recorded, 0, sizeof(recorded));
+        IONCHECK(ion_parallel_for_each_value(buffer, length, NULL, NULL, thread_counts[ii], test_ion_parallel_record, recorded));
+        IONCHECK(test_ion_parallel_check(recorded, TEST_PARALLEL_VALUES));
+    }
+
+    // with an index built beforehand
+    IONCHECK(ion_reader_open_buffer(&reader, buffer, length, NULL));
+    IONCHECK(ion_offset_index_open(&index));
+    IONCHECK(ion_offset_index_build(index, reader));
+    memset(recorded, 0, sizeof(recorded));
+    IONCHECK(ion_parallel_for_each_value(buffer, length, index, NULL, 4, test_ion_parallel_record, recorded));
+    IONCHECK(test_ion_parallel_check(recorded, TEST_PARALLEL_VALUES));
+
+    ASSERT_EQUALS_INT(IERR_INVALID_ARG, ion_parallel_for_each_value(buffer, length, NULL, NULL, 0, test_ion_parallel_record, recorded), "No threads accepted");
+
+fail:
+    if (index) ion_offset_index_close(index);
+    if (reader) ion_reader_close(reader);
+    return err;
+}
+
+#ifndef ION_PLATFORM_WINDOWS
+// makes an unlinked temp file holding image, with the fd back at its start
+static iERR _ion_parallel_test_temp_file(BYTE *image, SIZE length, int *p_fd) {
+    iENTER;
+    char path[] = "/tmp/ion_parallel_test_XXXXXX";
+    int  fd;
+
+    *p_fd = -1;
+    fd = mkstemp(path);
+    if (fd < 0) FAILWITH(IERR_CANT_FIND_FILE);
+    unlink(path);
+    *p_fd = fd;
+    if (length > 0 && write(fd, image, length) != (ssize_t)length) FAILWITH(IERR_WRITE_ERROR);
+    if (lseek(fd, 0, SEEK_SET) != 0) FAILWITH(IERR_SEEK_ERROR);
+
+    iRETURN;
+}
+#endif
+
+iERR test_ion_parallel_fd() {
+    iENTER;
+#ifndef ION_PLATFORM_WINDOWS
+    static BYTE    buffer[10000];
+    static int64_t recorded[TEST_PARALLEL_VALUES];
+    SIZE           length;
+    int            fd = -1;
+
+    IONCHECK(test_ion_parallel_make_input(buffer, sizeof(buffer), &length));
+
+    IONCHECK(_ion_parallel_test_temp_file(buffer, length, &fd));
+
+    memset(recorded, 0, sizeof(recorded));
+    IONCHECK(ion_parallel_for_each_value_in_fd(fd, NULL, NULL, 3, test_ion_parallel_record, recorded));
+    IONCHECK(test_ion_parallel_check(recorded, TEST_PARALLEL_VALUES));
+
+fail:
+    if (fd >= 0) close(fd);
+    return err;
+#else
+    return IERR_OK;
+#endif
+}
+
+iERR test_ion_parallel_stops_on_error() {
+    iENTER;
+    static BYTE buffer[10000];
+    SIZE        length;
+
+    IONCHECK(test_ion_parallel_make_input(buffer, sizeof(buffer), &length));
+    ASSERT_EQUALS_INT(IERR_INVALID_STATE, ion_parallel_for_each_value(buffer, length, NULL, NULL, 1, test_ion_parallel_fail, NULL), "Callback error not returned");
+    ASSERT_EQUALS_INT(IERR_INVALID_STATE, ion_parallel_for_each_value(buffer, length, NULL, NULL, 4, test_ion_parallel_fail, NULL), "Callback error not returned from a thread");
+
+    iRETURN;
+}
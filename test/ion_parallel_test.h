@@ -0,0 +1,10 @@
+#include <ion_debug.h>
+
+iERR ion_parallel_test();
+iERR test_ion_parallel_record(hREADER hreader, int64_t value, void *context);
+iERR test_ion_parallel_fail(hREADER hreader, int64_t value, void *context);
+iERR test_ion_parallel_make_input(BYTE *buffer, SIZE size, SIZE *p_length);
+iERR test_ion_parallel_check(int64_t *recorded, int count);
+iERR test_ion_parallel_buffer();
+iERR test_ion_parallel_fd();
+iERR test_ion_parallel_stops_on_error();
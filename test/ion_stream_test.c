@@ -0,0 +1,598 @@
+#include "ion_stream_test.h"
+
+#include <ion.h>
+#include <ion_platform_config.h>
+#include "ion_assert.h"
+#include "ion_unit_test.h"
+#include "tester.h"
+
+#ifndef ION_PLATFORM_WINDOWS
+#include <unistd.h>
+#endif
+
+iERR ion_stream_test() {
+    iENTER;
+
+    run_unit_test(test_ion_stream_open_mmap);
+    run_unit_test(test_ion_stream_peek_span);
+    run_unit_test(test_ion_stream_reserve_commit);
+    run_unit_test(test_ion_stream_read_ahead);
+    run_unit_test(test_ion_stream_cache_budget);
+    run_unit_test(test_ion_stream_page_growth);
+    run_unit_test(test_ion_stream_skip_sequential);
+    run_unit_test(test_ion_stream_segments);
+    run_unit_test(test_ion_stream_segments_out);
+    run_unit_test(test_ion_stream_write_segments);
+
+    iRETURN;
+}
+
+#ifndef ION_PLATFORM_WINDOWS
+// makes an unlinked temp file holding image, with the fd back at its start
+static iERR _ion_stream_test_temp_file(BYTE *image, SIZE length, int *p_fd) {
+    iENTER;
+    char path[] = "/tmp/ion_stream_test_XXXXXX";
+    int  fd;
+
+    *p_fd = -1;
+    fd = mkstemp(path);
+    if (fd < 0) FAILWITH(IERR_CANT_FIND_FILE);
+    unlink(path);
+    *p_fd = fd;
+    if (length > 0 && write(fd, image, length) != (ssize_t)length) FAILWITH(IERR_WRITE_ERROR);
+    if (lseek(fd, 0, SEEK_SET) != 0) FAILWITH(IERR_SEEK_ERROR);
+
+    iRETURN;
+}
+#endif
+
+iERR test_ion_stream_open_mmap() {
+    iENTER;
+#ifndef ION_PLATFORM_WINDOWS
+    char       *image = "abc 123";
+    int         fd = -1, c, ii;
+    SIZE        bytes_read;
+    BYTE        buf[8];
+    ION_STREAM *stream = NULL;
+
+    IONCHECK(_ion_stream_test_temp_file((BYTE *)image, (SIZE)strlen(image), &fd));
+
+    IONCHECK(ion_stream_open_mmap(fd, &stream));
+    ASSERT_EQUALS_INT(TRUE, ion_stream_can_read(stream), "Mapped stream should be readable");
+    ASSERT_EQUALS_INT(FALSE, ion_stream_can_write(stream), "Mapped stream should be read only");
+
+    for (ii = 0; image[ii]; ii++) {
+        IONCHECK(ion_stream_read_byte(stream, &c));
+        ASSERT_EQUALS_INT(image[ii], c, "Wrong byte read from mapped stream");
+    }
+    IONCHECK(ion_stream_read_byte(stream, &c));
+    ASSERT_EQUALS_INT(EOF, c, "Expected eof at end of mapped stream");
+
+    IONCHECK(ion_stream_seek(stream, 4));
+    IONCHECK(ion_stream_read(stream, buf, 3, &bytes_read));
+    ASSERT_EQUALS_INT(3, bytes_read, "Wrong length read after seek");
+    ASSERT_EQUALS_INT('1', buf[0], "Wrong byte read after seek");
+    IONCHECK(ion_stream_unread_byte(stream, '3'));
+    ASSERT_EQUALS_INT(6, (int)ion_stream_get_position(stream), "Wrong position after unread");
+
+fail:
+    if (stream) ion_stream_close(stream);
+    if (fd >= 0) close(fd);
+    return err;
+#else
+    iRETURN;
+#endif
+}
+
+iERR test_ion_stream_peek_span() {
+    iENTER;
+    BYTE        image[] = "hello";
+    BYTE       *span;
+    SIZE        available;
+    int         c;
+    ION_STREAM *stream = NULL;
+
+    IONCHECK(ion_stream_open_buffer(image, 5, 5, TRUE, &stream));
+
+    IONCHECK(ion_stream_peek_span(stream, &span, &available));
+    ASSERT_EQUALS_INT(5, available, "Span should cover the whole buffer");
+    ASSERT_EQUALS_INT('h', span[0], "Span should start at the current byte");
+
+    IONCHECK(ion_stream_consume(stream, 2));
+    IONCHECK(ion_stream_read_byte(stream, &c));
+    ASSERT_EQUALS_INT('l', c, "Consume should move the stream forward");
+    ASSERT_EQUALS_INT(IERR_INVALID_ARG, ion_stream_consume(stream, 3), "Consume past the span should fail");
+
+    IONCHECK(ion_stream_consume(stream, 2));
+    IONCHECK(ion_stream_peek_span(stream, &span, &available));
+    ASSERT_EQUALS_INT(0, available, "Span should be empty at eof");
+
+fail:
+    if (stream) ion_stream_close(stream);
+    return err;
+}
+
+iERR test_ion_stream_reserve_commit() {
+    iENTER;
+    BYTE        buffer[8];
+    BYTE       *dst;
+    ION_STREAM *stream = NULL;
+
+    memset(buffer, 0, sizeof(buffer));
+    IONCHECK(ion_stream_open_buffer(buffer, sizeof(buffer), 0, FALSE, &stream));
+
+    // fits in the buffer, so the reservation is the buffer itself
+    IONCHECK(ion_stream_reserve(stream, 4, &dst));
+    ASSERT_EQUALS_INT(TRUE, dst == buffer, "Reservation should point into the buffer");
+    memcpy(dst, "abcd", 4);
+    IONCHECK(ion_stream_commit(stream, 3));
+    ASSERT_EQUALS_INT(3, (int)ion_stream_get_position(stream), "Commit should advance by the bytes used");
+    ASSERT_EQUALS_INT(IERR_INVALID_STATE, ion_stream_commit(stream, 1), "Commit without a reservation should fail");
+
+    // more than is left, the bytes are staged and copied on commit
+    IONCHECK(ion_stream_reserve(stream, 10, &dst));
+    ASSERT_EQUALS_INT(FALSE, dst == buffer + 3, "Reservation should be staged");
+    memcpy(dst, "efghijklmn", 10);
+    IONCHECK(ion_stream_commit(stream, 5));
+    ASSERT_EQUALS_INT(8, (int)ion_stream_get_position(stream), "Commit should advance by the bytes used");
+    ASSERT_EQUALS_INT(0, memcmp(buffer, "abcefghi", 8), "Wrong bytes written");
+
+fail:
+    if (stream) ion_stream_close(stream);
+    return err;
+}
+
+iERR test_ion_stream_read_ahead() {
+    iENTER;
+#ifndef ION_PLATFORM_WINDOWS
+    BYTE        image[1000];
+    int         fd = -1, c, ii;
+    int64_t     hits, misses;
+    ION_STREAM *stream = NULL;
+    ION_STREAM_OPTIONS options;
+
+    for (ii = 0; ii < (int)sizeof(image); ii++) {
+        image[ii] = (BYTE)(ii % 251);
+    }
+    IONCHECK(_ion_stream_test_temp_file(image, sizeof(image), &fd));
+
+    // small pages so the reader crosses a lot of them
+    memset(&options, 0, sizeof(options));
+    options.read_ahead_depth = 3;
+    options.page_size = 64;
+    IONCHECK(ion_stream_open_fd_in_read_ahead(fd, &options, &stream));
+
+    for (ii = 0; ii < (int)sizeof(image); ii++) {
+        IONCHECK(ion_stream_read_byte(stream, &c));
+        ASSERT_EQUALS_INT(image[ii], c, "Wrong byte read with read ahead");
+    }
+    IONCHECK(ion_stream_read_byte(stream, &c));
+    ASSERT_EQUALS_INT(EOF, c, "Expected eof at end of read ahead stream");
+
+    // jumping back sends the thread back there
+    IONCHECK(ion_stream_seek(stream, 130));
+    IONCHECK(ion_stream_read_byte(stream, &c));
+    ASSERT_EQUALS_INT(image[130], c, "Wrong byte read after seek");
+
+    IONCHECK(ion_stream_get_read_ahead_stats(stream, &hits, &misses));
+    ASSERT_EQUALS_INT(TRUE, hits + misses >= (int64_t)(sizeof(image) / 64), "Every page should be counted");
+
+fail:
+    if (stream) ion_stream_close(stream);
+    if (fd >= 0) close(fd);
+    return err;
+#else
+    iRETURN;
+#endif
+}
+
+iERR test_ion_stream_cache_budget() {
+    iENTER;
+#ifndef ION_PLATFORM_WINDOWS
+    BYTE        image[100000];
+    int         fd = -1, c, ii;
+    POSITION    pos;
+    ION_STREAM *stream = NULL;
+
+    for (ii = 0; ii < (int)sizeof(image); ii++) {
+        image[ii] = (BYTE)(ii % 253);
+    }
+    IONCHECK(_ion_stream_test_temp_file(image, sizeof(image), &fd));
+
+    IONCHECK(ion_stream_open_fd_rw(fd, FALSE, &stream));
+    IONCHECK(ion_stream_set_cache_budget(stream, 1));
+
+    // change a byte, then wander around enough to drop its page
+    IONCHECK(ion_stream_seek(stream, 500));
+    IONCHECK(ion_stream_write_byte(stream, 'x'));
+    image[500] = 'x';
+
+    for (ii = 0; ii < 200; ii++) {
+        pos = (POSITION)((ii * 7919) % sizeof(image));
+        IONCHECK(ion_stream_seek(stream, pos));
+        IONCHECK(ion_stream_read_byte(stream, &c));
+        ASSERT_EQUALS_INT(image[pos], c, "Wrong byte read with a cache budget");
+    }
+
+    IONCHECK(ion_stream_seek(stream, 500));
+    IONCHECK(ion_stream_read_byte(stream, &c));
+    ASSERT_EQUALS_INT('x', c, "Written byte should survive its page being dropped");
+
+fail:
+    if (stream) ion_stream_close(stream);
+    if (fd >= 0) close(fd);
+    return err;
+#else
+    iRETURN;
+#endif
+}
+
+iERR test_ion_stream_page_growth() {
+    iENTER;
+#ifndef ION_PLATFORM_WINDOWS
+    BYTE        image[20000];
+    int         fd = -1, c, ii;
+    SIZE        written, len;
+    ION_STREAM *stream = NULL;
+    ION_STREAM_OPTIONS options;
+
+    for (ii = 0; ii < (int)sizeof(image); ii++) {
+        image[ii] = (BYTE)(ii % 241);
+    }
+    IONCHECK(_ion_stream_test_temp_file(NULL, 0, &fd));
+
+    // start small and let the pages grow, writing in pieces that don't line up with them
+    memset(&options, 0, sizeof(options));
+    options.page_size = 64;
+    options.max_page_size = 1000;
+    IONCHECK(ion_stream_open_fd_out_with_options(fd, &options, &stream));
+    for (ii = 0; ii < (int)sizeof(image); ii += len) {
+        len = (SIZE)sizeof(image) - ii;
+        if (len > 37) len = 37;
+        IONCHECK(ion_stream_write(stream, image + ii, len, &written));
+        ASSERT_EQUALS_INT(len, written, "Short write to a growing stream");
+    }
+    IONCHECK(ion_stream_close(stream));
+    stream = NULL;
+
+    if (lseek(fd, 0, SEEK_SET) != 0) FAILWITH(IERR_SEEK_ERROR);
+    IONCHECK(ion_stream_open_fd_in_with_options(fd, &options, &stream));
+    for (ii = 0; ii < (int)sizeof(image); ii++) {
+        IONCHECK(ion_stream_read_byte(stream, &c));
+        ASSERT_EQUALS_INT(image[ii], c, "Wrong byte read from a growing stream");
+    }
+    IONCHECK(ion_stream_read_byte(stream, &c));
+    ASSERT_EQUALS_INT(EOF, c, "Expected eof at end of growing stream");
+
+    // going back after the pages have grown reads with the new page size
+    IONCHECK(ion_stream_seek(stream, 100));
+    IONCHECK(ion_stream_read_byte(stream, &c));
+    ASSERT_EQUALS_INT(image[100], c, "Wrong byte read after seeking back");
+    IONCHECK(ion_stream_seek(stream, 15001));
+    IONCHECK(ion_stream_read_byte(stream, &c));
+    ASSERT_EQUALS_INT(image[15001], c, "Wrong byte read after seeking forward");
+
+    // nonsense page sizes are refused
+    options.max_page_size = -1;
+    ASSERT_EQUALS_INT(IERR_INVALID_ARG, ion_stream_open_memory_only_with_options(&options, &stream), "Negative max page size should be rejected");
+
+fail:
+    if (stream) ion_stream_close(stream);
+    if (fd >= 0) close(fd);
+    return err;
+#else
+    iRETURN;
+#endif
+}
+
+typedef struct _test_chunked_source {
+    BYTE *data;
+    SIZE  length;
+    SIZE  chunk;
+    SIZE  handed_out;
+} TEST_CHUNKED_SOURCE;
+
+// hands the data out in small pieces, like frames arriving off the network
+static iERR test_chunked_source_handler(struct _ion_user_stream *pstream) {
+    TEST_CHUNKED_SOURCE *source = (TEST_CHUNKED_SOURCE *)pstream->handler_state;
+    SIZE                 len = source->length - source->handed_out;
+
+    if (len < 1) return IERR_EOF;
+    if (len > source->chunk) len = source->chunk;
+    pstream->curr  = source->data + source->handed_out;
+    pstream->limit = pstream->curr + len;
+    source->handed_out += len;
+    return IERR_OK;
+}
+
+iERR test_ion_stream_skip_sequential() {
+    iENTER;
+#ifndef ION_PLATFORM_WINDOWS
+    BYTE        image[30000];
+    int         fds[2] = { -1, -1 }, c, ii;
+    SIZE        skipped;
+    ION_STREAM *stream = NULL;
+    TEST_CHUNKED_SOURCE source;
+
+    for (ii = 0; ii < (int)sizeof(image); ii++) {
+        image[ii] = (BYTE)(ii % 239);
+    }
+
+    // a user handler stream steps over the handler's buffers
+    source.data = image;
+    source.length = sizeof(image);
+    source.chunk = 1000;
+    source.handed_out = 0;
+    IONCHECK(ion_stream_open_handler_in(test_chunked_source_handler, &source, &stream));
+    IONCHECK(ion_stream_skip(stream, 20001, &skipped));
+    ASSERT_EQUALS_INT(20001, skipped, "Wrong skip over a handler stream");
+    IONCHECK(ion_stream_read_byte(stream, &c));
+    ASSERT_EQUALS_INT(image[20001], c, "Wrong byte read after skipping a handler stream");
+    IONCHECK(ion_stream_skip(stream, 20000, &skipped));
+    ASSERT_EQUALS_INT(sizeof(image) - 20002, skipped, "Skipping past the end should stop at the end");
+    IONCHECK(ion_stream_read_byte(stream, &c));
+    ASSERT_EQUALS_INT(EOF, c, "Expected eof after skipping to the end");
+    IONCHECK(ion_stream_close(stream));
+    stream = NULL;
+
+    // and a pipe is read and thrown away, it can't be seeked
+    if (pipe(fds) != 0) FAILWITH(IERR_CANT_FIND_FILE);
+    if (write(fds[1], image, sizeof(image)) != (ssize_t)sizeof(image)) FAILWITH(IERR_WRITE_ERROR);
+    close(fds[1]);
+    fds[1] = -1;
+    IONCHECK(ion_stream_open_fd_in(fds[0], &stream));
+    IONCHECK(ion_stream_skip(stream, 12345, &skipped));
+    ASSERT_EQUALS_INT(12345, skipped, "Wrong skip over a pipe");
+    IONCHECK(ion_stream_read_byte(stream, &c));
+    ASSERT_EQUALS_INT(image[12345], c, "Wrong byte read after skipping a pipe");
+    IONCHECK(ion_stream_skip(stream, sizeof(image), &skipped));
+    ASSERT_EQUALS_INT(sizeof(image) - 12346, skipped, "Skipping past the end of a pipe should stop at the end");
+    IONCHECK(ion_stream_read_byte(stream, &c));
+    ASSERT_EQUALS_INT(EOF, c, "Expected eof after skipping to the end of a pipe");
+
+fail:
+    if (stream) ion_stream_close(stream);
+    if (fds[0] >= 0) close(fds[0]);
+    if (fds[1] >= 0) close(fds[1]);
+    return err;
+#else
+    iRETURN;
+#endif
+}
+
+iERR test_ion_stream_segments() {
+    iENTER;
+    char               *image = "abc \"a string that crosses several segments\" 12345";
+    SIZE                image_length = (SIZE)strlen(image), bytes_read, skipped;
+    ION_STREAM_SEGMENT  segments[40];
+    int32_t             count = 0, start, ii, value;
+    int                 c;
+    BYTE                buf[16];
+    ION_STRING          str;
+    ION_TYPE            type;
+    ION_STREAM         *stream = NULL;
+    hREADER             reader = NULL;
+
+    // 4 byte segments with an empty one every so often, and at both ends
+    segments[count].data = NULL;
+    segments[count++].length = 0;
+    for (start = 0; start < image_length; start += 4) {
+        segments[count].data = (BYTE *)image + start;
+        segments[count++].length = (image_length - start < 4) ? image_length - start : 4;
+        if (start % 12 == 0) {
+            segments[count].data = NULL;
+            segments[count++].length = 0;
+        }
+    }
+    segments[count].data = NULL;
+    segments[count++].length = 0;
+
+    IONCHECK(ion_stream_open_segments(segments, count, &stream));
+    ASSERT_EQUALS_INT(FALSE, ion_stream_can_write(stream), "Segmented stream should be read only");
+    for (ii = 0; ii < image_length; ii++) {
+        IONCHECK(ion_stream_read_byte(stream, &c));
+        ASSERT_EQUALS_INT(image[ii], c, "Wrong byte read from segmented stream");
+    }
+    IONCHECK(ion_stream_read_byte(stream, &c));
+    ASSERT_EQUALS_INT(EOF, c, "Expected eof at end of segmented stream");
+
+    // reads, unreads and seeks that cross segments
+    IONCHECK(ion_stream_seek(stream, 2));
+    IONCHECK(ion_stream_read(stream, buf, 11, &bytes_read));
+    ASSERT_EQUALS_INT(11, bytes_read, "Wrong length read across segments");
+    ASSERT_EQUALS_INT(0, memcmp(buf, image + 2, 11), "Wrong bytes read across segments");
+    IONCHECK(ion_stream_seek(stream, 8));
+    IONCHECK(ion_stream_unread_byte(stream, image[7]));
+    IONCHECK(ion_stream_read_byte(stream, &c));
+    ASSERT_EQUALS_INT(image[7], c, "Wrong byte read after unreading into the previous segment");
+    IONCHECK(ion_stream_skip(stream, 30, &skipped));
+    ASSERT_EQUALS_INT(30, skipped, "Wrong skip across segments");
+    IONCHECK(ion_stream_read_byte(stream, &c));
+    ASSERT_EQUALS_INT(image[38], c, "Wrong byte read after skipping across segments");
+    IONCHECK(ion_stream_close(stream));
+    stream = NULL;
+
+    // and values that span segments read as if the data was in one buffer
+    IONCHECK(ion_stream_open_segments(segments, count, &stream));
+    IONCHECK(ion_reader_open(&reader, stream, NULL));
+    IONCHECK(ion_reader_next(reader, &type));
+    IONCHECK(expect_type(tid_SYMBOL, type));
+    IONCHECK(ion_reader_next(reader, &type));
+    IONCHECK(expect_type(tid_STRING, type));
+    IONCHECK(ion_reader_read_string(reader, &str));
+    ASSERT_EQUALS_INT(38, str.length, "Wrong string length read across segments");
+    ASSERT_EQUALS_INT(0, memcmp(str.value, "a string that crosses several segments", str.length), "Wrong string read across segments");
+    IONCHECK(ion_reader_next(reader, &type));
+    IONCHECK(expect_type(tid_INT, type));
+    IONCHECK(ion_reader_read_int32(reader, &value));
+    ASSERT_EQUALS_INT(12345, value, "Wrong int read across segments");
+    IONCHECK(ion_reader_next(reader, &type));
+    IONCHECK(expect_type(tid_EOF, type));
+
+    // an empty list of segments is just an empty stream
+    IONCHECK(ion_reader_close(reader));
+    reader = NULL;
+    IONCHECK(ion_stream_close(stream));
+    IONCHECK(ion_stream_open_segments(NULL, 0, &stream));
+    IONCHECK(ion_stream_read_byte(stream, &c));
+    ASSERT_EQUALS_INT(EOF, c, "Expected eof from an empty segmented stream");
+
+fail:
+    if (reader) ion_reader_close(reader);
+    if (stream) ion_stream_close(stream);
+    return err;
+}
+
+typedef struct _test_segment_sink
+{
+    BYTE   *data;
+    SIZE    length;
+    SIZE    capacity;
+    int     calls;
+} TEST_SEGMENT_SINK;
+
+iERR test_segment_sink_handler(void *handler_state, BYTE *data, SIZE length) {
+    TEST_SEGMENT_SINK *sink = (TEST_SEGMENT_SINK *)handler_state;
+    if (sink->length + length > sink->capacity) return IERR_EOF;
+    memcpy(sink->data + sink->length, data, length);
+    sink->length += length;
+    sink->calls++;
+    return IERR_OK;
+}
+
+iERR test_write_segment_values(hWRITER writer) {
+    iENTER;
+    ION_STRING str;
+    int        ii;
+
+    ion_string_assign_cstr(&str, "some text to spread the values over several segments", 52);
+    for (ii = 0; ii < 50; ii++) {
+        IONCHECK(ion_writer_write_int(writer, ii * 1000));
+        IONCHECK(ion_writer_write_string(writer, &str));
+    }
+    iRETURN;
+}
+
+iERR test_ion_stream_segments_out() {
+    iENTER;
+    BYTE                expected[8192], first[5], second[3], collected[8192];
+    SIZE                expected_length, collected_length = 0, flushed;
+    ION_STREAM_SEGMENT  segments[3], *filled;
+    int32_t             filled_count, ii, binary;
+    ION_WRITER_OPTIONS  options;
+    TEST_SEGMENT_SINK   sink;
+    hWRITER             writer = NULL;
+
+    for (binary = 0; binary < 2; binary++) {
+        memset(&options, 0, sizeof(options));
+        options.output_as_binary = binary;
+        IONCHECK(ion_writer_open_buffer(&writer, expected, sizeof(expected), &options));
+        IONCHECK(test_write_segment_values(writer));
+        IONCHECK(ion_writer_flush(writer, &expected_length));
+        IONCHECK(ion_writer_close(writer));
+        writer = NULL;
+
+        // the caller's segments are used first, then the writer adds
+        // its own, growing from 64 up to 256 bytes
+        segments[0].data = first;
+        segments[0].length = sizeof(first);
+        segments[1].data = NULL;
+        segments[1].length = 0;
+        segments[2].data = second;
+        segments[2].length = sizeof(second);
+        options.stream_page_size = 64;
+        options.stream_max_page_size = 256;
+        IONCHECK(ion_writer_open_segments(&writer, segments, 3, NULL, NULL, &options));
+        IONCHECK(test_write_segment_values(writer));
+        IONCHECK(ion_writer_flush(writer, &flushed));
+        IONCHECK(ion_writer_get_segments(writer, &filled, &filled_count));
+        ASSERT_EQUALS_INT(TRUE, filled_count > 3, "Expected the writer to add segments");
+        ASSERT_EQUALS_INT(TRUE, filled[0].data == first && filled[1].data == second, "Expected the caller's segments first");
+        ASSERT_EQUALS_INT(256, filled[filled_count - 2].length, "Expected the added segments to grow");
+        collected_length = 0;
+        for (ii = 0; ii < filled_count; ii++) {
+            ASSERT_EQUALS_INT(TRUE, collected_length + filled[ii].length <= (SIZE)sizeof(collected), "Too much output");
+            memcpy(collected + collected_length, filled[ii].data, filled[ii].length);
+            collected_length += filled[ii].length;
+        }
+        ASSERT_EQUALS_INT(expected_length, collected_length, "Wrong length written to segments");
+        ASSERT_EQUALS_INT(0, memcmp(expected, collected, expected_length), "Wrong bytes written to segments");
+        IONCHECK(ion_writer_close(writer));
+        writer = NULL;
+
+        // with a handler every byte is handed off by the time the writer is closed
+        sink.data = collected;
+        sink.length = 0;
+        sink.capacity = sizeof(collected);
+        sink.calls = 0;
+        options.stream_page_size = 100;
+        options.stream_max_page_size = 0;
+        IONCHECK(ion_writer_open_segments(&writer, NULL, 0, test_segment_sink_handler, &sink, &options));
+        IONCHECK(test_write_segment_values(writer));
+        IONCHECK(ion_writer_close(writer));
+        writer = NULL;
+        ASSERT_EQUALS_INT(TRUE, sink.calls > 1, "Expected the handler to see several segments");
+        ASSERT_EQUALS_INT(expected_length, sink.length, "Wrong length handed to the segment handler");
+        ASSERT_EQUALS_INT(0, memcmp(expected, collected, expected_length), "Wrong bytes handed to the segment handler");
+    }
+
+fail:
+    if (writer) ion_writer_close(writer);
+    return err;
+}
+
+iERR test_ion_stream_write_segments() {
+    iENTER;
+#ifndef ION_PLATFORM_WINDOWS
+    BYTE                big[20000], expected[20100], actual[20100];
+    SIZE                written, expected_length = 0;
+    ssize_t             actual_length;
+    ION_STREAM_SEGMENT  segments[4];
+    ION_STREAM         *stream = NULL;
+    int                 fd = -1, ii;
+
+    for (ii = 0; ii < (int)sizeof(big); ii++) {
+        big[ii] = (BYTE)(ii % 251);
+    }
+    segments[0].data = (BYTE *)"abc";
+    segments[0].length = 3;
+    segments[1].data = NULL;
+    segments[1].length = 0;
+    segments[2].data = big;
+    segments[2].length = sizeof(big);
+    segments[3].data = (BYTE *)"xyz";
+    segments[3].length = 3;
+
+    IONCHECK(_ion_stream_test_temp_file(NULL, 0, &fd));
+
+    // pending bytes go out first, then the segments, and
+    // the stream carries on writing after them
+    IONCHECK(ion_stream_open_fd_out(fd, &stream));
+    IONCHECK(ion_stream_write(stream, (BYTE *)"12", 2, &written));
+    IONCHECK(ion_stream_write_segments(stream, segments, 4, &written));
+    ASSERT_EQUALS_INT(sizeof(big) + 6, written, "Wrong length written from segments");
+    ASSERT_EQUALS_INT(sizeof(big) + 8, (int)ion_stream_get_position(stream), "Wrong position after writing segments");
+    IONCHECK(ion_stream_write(stream, (BYTE *)"34", 2, &written));
+    IONCHECK(ion_stream_close(stream));
+    stream = NULL;
+
+    memcpy(expected, "12abc", 5);
+    expected_length = 5;
+    memcpy(expected + expected_length, big, sizeof(big));
+    expected_length += sizeof(big);
+    memcpy(expected + expected_length, "xyz34", 5);
+    expected_length += 5;
+
+    if (lseek(fd, 0, SEEK_SET) != 0) FAILWITH(IERR_READ_ERROR);
+    actual_length = read(fd, actual, sizeof(actual));
+    ASSERT_EQUALS_INT(expected_length, (int)actual_length, "Wrong length in the file");
+    ASSERT_EQUALS_INT(0, memcmp(expected, actual, expected_length), "Wrong bytes in the file");
+
+fail:
+    if (stream) ion_stream_close(stream);
+    if (fd >= 0) close(fd);
+    return err;
+#else
+    iRETURN;
+#endif
+}
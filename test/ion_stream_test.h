@@ -0,0 +1,13 @@
+#include <ion_debug.h>
+
+iERR ion_stream_test();
+iERR test_ion_stream_open_mmap();
+iERR test_ion_stream_peek_span();
+iERR test_ion_stream_reserve_commit();
+iERR test_ion_stream_read_ahead();
+iERR test_ion_stream_cache_budget();
+iERR test_ion_stream_page_growth();
+iERR test_ion_stream_skip_sequential();
+iERR test_ion_stream_segments();
+iERR test_ion_stream_segments_out();
+iERR test_ion_stream_write_segments();
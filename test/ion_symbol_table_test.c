@@ -0,0 +1,297 @@
+#include "ion_symbol_table_test.h"
+
+#include <ion.h>
+#include "ion_assert.h"
+#include "ion_unit_test.h"
+#include "tester.h"
+
+#define TEST_SYMBOL_TABLE_SHARED_SYMBOLS 100
+#define TEST_SYMBOL_TABLE_SYSTEM_MAX_ID  9
+#define TEST_SYMBOL_TABLE_INDEX_SYMBOLS  3000
+
+iERR ion_symbol_table_test() {
+    iENTER;
+
+    run_unit_test(test_ion_symbol_table_layers);
+    run_unit_test(test_ion_symbol_table_layers_round_trip);
+    run_unit_test(test_ion_symbol_table_catalog_versions);
+    run_unit_test(test_ion_symbol_table_name_index);
+
+    iRETURN;
+}
+
+// a shared table "shared" version 1 with the symbols s0 to s99 at sids 1
+// to 100, loaded from its Ion form and added to catalog. It's in a list
+// since at the top level the reader would take it for itself
+iERR test_ion_symbol_table_make_shared(hCATALOG catalog, hSYMTAB *p_shared) {
+    iENTER;
+    static char text[2000];
+    hREADER     reader = NULL;
+    hSYMTAB     loaded;
+    ION_TYPE    type;
+    ION_STRING  name;
+    SIZE        used;
+    int         ii;
+
+    strcpy(text, "[$ion_shared_symbol_table::{name:\"shared\",version:1,symbols:[");
+    for (ii = 0; ii < TEST_SYMBOL_TABLE_SHARED_SYMBOLS; ii++) {
+        used = (SIZE)strlen(text);
+        sprintf(text + used, "%s\"s%d\"", ii ? "," : "", ii);
+    }
+    strcat(text, "]}]");
+
+    IONCHECK(ion_reader_open_buffer(&reader, (BYTE *)text, (SIZE)strlen(text), NULL));
+    IONCHECK(ion_reader_next(reader, &type));
+    IONCHECK(ion_reader_step_in(reader));
+    IONCHECK(ion_reader_next(reader, &type));
+    IONCHECK(ion_symbol_table_load(reader, reader, &loaded));
+    IONCHECK(ion_catalog_add_symbol_table(catalog, loaded));
+    IONCHECK(ion_reader_close(reader));
+
+    IONCHECK(ion_catalog_find_best_match(catalog, ion_string_assign_cstr(&name, "shared", 6), 1, p_shared));
+
+    iRETURN;
+}
+
+iERR test_ion_symbol_table_check_sid(hSYMTAB hsymtab, char *name, SID expected) {
+    iENTER;
+    ION_STRING  str, *found;
+    SID         sid;
+
+    IONCHECK(ion_symbol_table_find_by_name(hsymtab, ion_string_assign_cstr(&str, name, (SIZE)strlen(name)), &sid));
+    ASSERT_EQUALS_INT(expected, sid, "find_by_name gave the wrong sid");
+
+    IONCHECK(ion_symbol_table_find_by_sid(hsymtab, expected, &found));
+    ASSERT_EQUALS_INT((int)strlen(name), found->length, "find_by_sid gave the wrong name");
+    ASSERT_EQUALS_INT(0, memcmp(name, found->value, found->length), "find_by_sid gave the wrong name");
+
+    iRETURN;
+}
+
+iERR test_ion_symbol_table_layers() {
+    iENTER;
+    hCATALOG    catalog = NULL;
+    hSYMTAB     shared, local;
+    ION_SYMBOL *sym;
+    ION_STRING  str;
+    SID         sid, max_id;
+
+    IONCHECK(ion_catalog_open(&catalog));
+    IONCHECK(test_ion_symbol_table_make_shared(catalog, &shared));
+
+    IONCHECK(ion_symbol_table_open(&local, NULL));
+    IONCHECK(ion_symbol_table_import_symbol_table(local, shared));
+
+    // the system symbols, then the shared table's after them
+    IONCHECK(ion_symbol_table_get_max_sid(local, &max_id));
+    ASSERT_EQUALS_INT(TEST_SYMBOL_TABLE_SYSTEM_MAX_ID + TEST_SYMBOL_TABLE_SHARED_SYMBOLS, max_id, "imports should take up max_id sids");
+    IONCHECK(test_ion_symbol_table_check_sid(local, "name", 4));
+    IONCHECK(test_ion_symbol_table_check_sid(local, "s0", TEST_SYMBOL_TABLE_SYSTEM_MAX_ID + 1));
+    IONCHECK(test_ion_symbol_table_check_sid(local, "s99", TEST_SYMBOL_TABLE_SYSTEM_MAX_ID + 100));
+
+    // adding an imported symbol finds it, a new one goes after the imports
+    IONCHECK(ion_symbol_table_add_symbol(local, ion_string_assign_cstr(&str, "s5", 2), &sid));
+    ASSERT_EQUALS_INT(TEST_SYMBOL_TABLE_SYSTEM_MAX_ID + 6, sid, "imported symbols shouldn't be added again");
+    IONCHECK(ion_symbol_table_add_symbol(local, ion_string_assign_cstr(&str, "fresh", 5), &sid));
+    ASSERT_EQUALS_INT(max_id + 1, sid, "local symbols should follow the imports");
+    IONCHECK(test_ion_symbol_table_check_sid(local, "fresh", max_id + 1));
+
+    IONCHECK(ion_symbol_table_get_local_symbol(local, max_id + 1, &sym));
+    ASSERT_EQUALS_INT(TRUE, sym != NULL, "the new symbol should be local");
+    IONCHECK(ion_symbol_table_get_local_symbol(local, TEST_SYMBOL_TABLE_SYSTEM_MAX_ID + 6, &sym));
+    ASSERT_EQUALS_INT(TRUE, sym == NULL, "imported symbols shouldn't be local");
+
+    // the shared table is untouched by all this
+    IONCHECK(ion_symbol_table_find_by_name(shared, &str, &sid));
+    ASSERT_EQUALS_INT(UNKNOWN_SID, sid, "the local symbol shouldn't be in the shared table");
+    IONCHECK(test_ion_symbol_table_check_sid(shared, "s0", 1));
+
+    IONCHECK(ion_symbol_table_close(local));
+    IONCHECK(ion_catalog_close(catalog));
+
+    iRETURN;
+}
+
+// the writer encodes with the shared table as its import, and a reader
+// with the same catalog reads the same symbols back
+iERR test_ion_symbol_table_layers_round_trip() {
+    iENTER;
+    static BYTE         buffer[1000];
+    char               *names[] = { "s42", "fresh", "s0", "symbols", "s99", "fresh" };
+    int                 count = sizeof(names) / sizeof(names[0]);
+    hCATALOG            catalog = NULL;
+    hSYMTAB             shared;
+    hWRITER             writer = NULL;
+    hREADER             reader = NULL;
+    ION_WRITER_OPTIONS  writer_options;
+    ION_READER_OPTIONS  reader_options;
+    ION_STRING          str;
+    ION_TYPE            type;
+    SIZE                length;
+    SID                 sid;
+    int                 ii;
+
+    IONCHECK(ion_catalog_open(&catalog));
+    IONCHECK(test_ion_symbol_table_make_shared(catalog, &shared));
+
+    memset(&writer_options, 0, sizeof(writer_options));
+    writer_options.output_as_binary = TRUE;
+    writer_options.pcatalog = HANDLE_TO_PTR(catalog, ION_CATALOG);
+    writer_options.encoding_psymbol_table = HANDLE_TO_PTR(shared, ION_SYMBOL_TABLE);
+    IONCHECK(ion_writer_open_buffer(&writer, buffer, sizeof(buffer), &writer_options));
+    for (ii = 0; ii < count; ii++) {
+        IONCHECK(ion_writer_write_symbol(writer, ion_string_assign_cstr(&str, names[ii], (SIZE)strlen(names[ii]))));
+    }
+    IONCHECK(ion_writer_flush(writer, &length));
+    IONCHECK(ion_writer_close(writer));
+
+    memset(&reader_options, 0, sizeof(reader_options));
+    reader_options.pcatalog = HANDLE_TO_PTR(catalog, ION_CATALOG);
+    IONCHECK(ion_reader_open_buffer(&reader, buffer, length, &reader_options));
+    for (ii = 0; ii < count; ii++) {
+        IONCHECK(ion_reader_next(reader, &type));
+        ASSERT_EQUALS_INT((intptr_t)tid_SYMBOL, (intptr_t)type, "expected a symbol");
+        IONCHECK(ion_reader_read_string(reader, &str));
+        ASSERT_EQUALS_INT((int)strlen(names[ii]), str.length, "symbol read back with the wrong text");
+        ASSERT_EQUALS_INT(0, memcmp(names[ii], str.value, str.length), "symbol read back with the wrong text");
+    }
+    IONCHECK(ion_reader_next(reader, &type));
+    ASSERT_EQUALS_INT((intptr_t)tid_EOF, (intptr_t)type, "expected the end");
+    IONCHECK(ion_reader_close(reader));
+
+    // and the sid for s42 is where the import puts it
+    IONCHECK(ion_reader_open_buffer(&reader, buffer, length, &reader_options));
+    IONCHECK(ion_reader_next(reader, &type));
+    IONCHECK(ion_reader_read_symbol_sid(reader, &sid));
+    ASSERT_EQUALS_INT(TEST_SYMBOL_TABLE_SYSTEM_MAX_ID + 43, sid, "s42 should be read with the shared table's sid");
+    IONCHECK(ion_reader_close(reader));
+
+    IONCHECK(ion_catalog_close(catalog));
+
+    iRETURN;
+}
+
+iERR test_ion_symbol_table_catalog_add(hCATALOG catalog, char *name, int32_t version) {
+    iENTER;
+    hSYMTAB     symtab;
+    ION_STRING  str;
+
+    IONCHECK(ion_symbol_table_open(&symtab, NULL));
+    IONCHECK(ion_symbol_table_set_name(symtab, ion_string_assign_cstr(&str, name, (SIZE)strlen(name))));
+    IONCHECK(ion_symbol_table_set_version(symtab, version));
+    IONCHECK(ion_catalog_add_symbol_table(catalog, symtab));
+    IONCHECK(ion_symbol_table_close(symtab));
+
+    iRETURN;
+}
+
+// the version of the table the catalog finds for name and version, 0 for none
+iERR test_ion_symbol_table_catalog_find(hCATALOG catalog, char *name, int32_t version, BOOL best_match, int32_t *p_found) {
+    iENTER;
+    hSYMTAB     symtab;
+    ION_STRING  str;
+
+    ion_string_assign_cstr(&str, name, (SIZE)strlen(name));
+    if (best_match) {
+        IONCHECK(ion_catalog_find_best_match(catalog, &str, version, &symtab));
+    }
+    else {
+        IONCHECK(ion_catalog_find_symbol_table(catalog, &str, version, &symtab));
+    }
+    *p_found = 0;
+    if (symtab) {
+        IONCHECK(ion_symbol_table_get_version(symtab, p_found));
+    }
+
+    iRETURN;
+}
+
+iERR test_ion_symbol_table_catalog_versions() {
+    iENTER;
+    hCATALOG    catalog = NULL;
+    hSYMTAB     symtab;
+    ION_STRING  str;
+    int32_t     found, count;
+
+    IONCHECK(ion_catalog_open(&catalog));
+    IONCHECK(test_ion_symbol_table_catalog_add(catalog, "shared", 3));
+    IONCHECK(test_ion_symbol_table_catalog_add(catalog, "shared", 1));
+    IONCHECK(test_ion_symbol_table_catalog_add(catalog, "other", 2));
+    IONCHECK(test_ion_symbol_table_catalog_add(catalog, "shared", 5));
+    IONCHECK(test_ion_symbol_table_catalog_add(catalog, "shared", 3));
+    IONCHECK(ion_catalog_get_symbol_table_count(catalog, &count));
+    ASSERT_EQUALS_INT(4, count, "the same name and version should only be added once");
+
+    IONCHECK(test_ion_symbol_table_catalog_find(catalog, "shared", 3, FALSE, &found));
+    ASSERT_EQUALS_INT(3, found, "exact match");
+    IONCHECK(test_ion_symbol_table_catalog_find(catalog, "shared", 2, FALSE, &found));
+    ASSERT_EQUALS_INT(0, found, "no exact match");
+    IONCHECK(test_ion_symbol_table_catalog_find(catalog, "missing", 1, FALSE, &found));
+    ASSERT_EQUALS_INT(0, found, "no such name");
+
+    IONCHECK(test_ion_symbol_table_catalog_find(catalog, "shared", 3, TRUE, &found));
+    ASSERT_EQUALS_INT(3, found, "best match is an exact match when there is one");
+    IONCHECK(test_ion_symbol_table_catalog_find(catalog, "shared", 2, TRUE, &found));
+    ASSERT_EQUALS_INT(3, found, "best match is the next version up");
+    IONCHECK(test_ion_symbol_table_catalog_find(catalog, "shared", 9, TRUE, &found));
+    ASSERT_EQUALS_INT(5, found, "best match is the latest when there's none higher");
+    IONCHECK(test_ion_symbol_table_catalog_find(catalog, "shared", -1, TRUE, &found));
+    ASSERT_EQUALS_INT(5, found, "best match for any version is the latest");
+    IONCHECK(test_ion_symbol_table_catalog_find(catalog, "other", 1, TRUE, &found));
+    ASSERT_EQUALS_INT(2, found, "best match for another name");
+
+    IONCHECK(ion_catalog_find_symbol_table(catalog, ion_string_assign_cstr(&str, "shared", 6), 5, &symtab));
+    IONCHECK(ion_catalog_release_symbol_table(catalog, symtab));
+    IONCHECK(ion_catalog_get_symbol_table_count(catalog, &count));
+    ASSERT_EQUALS_INT(3, count, "released table should be gone");
+    IONCHECK(test_ion_symbol_table_catalog_find(catalog, "shared", 9, TRUE, &found));
+    ASSERT_EQUALS_INT(3, found, "released table shouldn't be found");
+
+    IONCHECK(ion_catalog_close(catalog));
+
+    iRETURN;
+}
+
+// name i for the index test: 1 to 40 characters of a shared prefix, then i,
+// so the names hash through every length case and collide in their prefixes
+void test_ion_symbol_table_index_name(int ii, char *name) {
+    static const char *prefix = "a_long_prefix_shared_by_every_name_here_";
+
+    memcpy(name, prefix, ii % 41);
+    sprintf(name + ii % 41, "%d", ii);
+}
+
+iERR test_ion_symbol_table_name_index() {
+    iENTER;
+    hSYMTAB     local;
+    ION_STRING  str;
+    char        name[60];
+    SID         sid;
+    int         ii;
+
+    IONCHECK(ion_symbol_table_open(&local, NULL));
+
+    // enough to grow the index several times
+    for (ii = 0; ii < TEST_SYMBOL_TABLE_INDEX_SYMBOLS; ii++) {
+        test_ion_symbol_table_index_name(ii, name);
+        IONCHECK(ion_symbol_table_add_symbol(local, ion_string_assign_cstr(&str, name, (SIZE)strlen(name)), &sid));
+        ASSERT_EQUALS_INT(TEST_SYMBOL_TABLE_SYSTEM_MAX_ID + 1 + ii, sid, "new symbols should get the next sid");
+    }
+
+    for (ii = 0; ii < TEST_SYMBOL_TABLE_INDEX_SYMBOLS; ii++) {
+        test_ion_symbol_table_index_name(ii, name);
+        IONCHECK(test_ion_symbol_table_check_sid(local, name, TEST_SYMBOL_TABLE_SYSTEM_MAX_ID + 1 + ii));
+        IONCHECK(ion_symbol_table_add_symbol(local, ion_string_assign_cstr(&str, name, (SIZE)strlen(name)), &sid));
+        ASSERT_EQUALS_INT(TEST_SYMBOL_TABLE_SYSTEM_MAX_ID + 1 + ii, sid, "adding a symbol again should find it");
+    }
+
+    IONCHECK(test_ion_symbol_table_check_sid(local, "name", 4));
+    IONCHECK(ion_symbol_table_find_by_name(local, ion_string_assign_cstr(&str, "a_long_prefix", 13), &sid));
+    ASSERT_EQUALS_INT(UNKNOWN_SID, sid, "a prefix of a name isn't that name");
+    IONCHECK(ion_symbol_table_find_by_name(local, ion_string_assign_cstr(&str, "a_long_prefix_shared_by_every_name_here_3000", 44), &sid));
+    ASSERT_EQUALS_INT(UNKNOWN_SID, sid, "a name that was never added shouldn't be found");
+
+    IONCHECK(ion_symbol_table_close(local));
+
+    iRETURN;
+}
@@ -0,0 +1,12 @@
+#include <ion_debug.h>
+
+iERR ion_symbol_table_test();
+iERR test_ion_symbol_table_make_shared(hCATALOG catalog, hSYMTAB *p_shared);
+iERR test_ion_symbol_table_check_sid(hSYMTAB hsymtab, char *name, SID expected);
+iERR test_ion_symbol_table_layers();
+iERR test_ion_symbol_table_layers_round_trip();
+iERR test_ion_symbol_table_catalog_add(hCATALOG catalog, char *name, int32_t version);
+iERR test_ion_symbol_table_catalog_find(hCATALOG catalog, char *name, int32_t version, BOOL best_match, int32_t *p_found);
+iERR test_ion_symbol_table_catalog_versions();
+void test_ion_symbol_table_index_name(int ii, char *name);
+iERR test_ion_symbol_table_name_index();
@@ -20,6 +20,11 @@
 #include "tester.h"
 
 #include "ion_binary_test.h"
+#include "ion_extractor_test.h"
+#include "ion_offset_index_test.h"
+#include "ion_parallel_test.h"
+#include "ion_stream_test.h"
+#include "ion_symbol_table_test.h"
 #include "ion_test_utils.h"
 
 BOOL  g_no_print             = TRUE;
@@ -72,6 +77,11 @@ int main(int argc, char **argv)
         g_iontests_path = argv[1];
         if (g_no_print == FALSE) printf("TEST_FILES: %s\n", g_iontests_path);
         RUNTEST(ion_binary_test, NULL);
+        RUNTEST(ion_stream_test, NULL);
+        RUNTEST(ion_extractor_test, NULL);
+        RUNTEST(ion_offset_index_test, NULL);
+        RUNTEST(ion_parallel_test, NULL);
+        RUNTEST(ion_symbol_table_test, NULL);
         RUNTEST(test_step_out_nested_s_expressions, NULL);
         RUNTEST(test_reader_good_files, g_iontests_path);
         RUNTEST(test_reader_bad_files, g_iontests_path);